@@ -0,0 +1,214 @@
+#include "can_isotp.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "CAN_ISOTP";
+
+/**
+ * @brief 发送ISO-TP流控帧
+ */
+static void isotp_send_flow_control(const can_isotp_config_t* config, can_isotp_flow_status_t flow_status) {
+    if (!config->send_flow_control) {
+        return;
+    }
+    uint8_t data[CAN_ISOTP_FRAME_SIZE];
+    data[0] = (CAN_ISOTP_FLOW_CONTROL << 4) | (flow_status & 0x0F);
+    data[1] = config->block_size;
+    data[2] = config->st_min;
+    memset(&data[3], CAN_ISOTP_PADDING, CAN_ISOTP_FRAME_SIZE - 3);
+    config->send_flow_control(data, config->context);
+}
+
+/**
+ * @brief 放弃当前正在重组的多帧消息
+ */
+static void isotp_abort(can_isotp_rx_t* rx) {
+    rx->in_progress = false;
+    rx->expected_length = 0;
+    rx->received_length = 0;
+}
+
+void can_isotp_reset(can_isotp_rx_t* rx) {
+    memset(rx, 0, sizeof(*rx));
+}
+
+bool can_isotp_receive(can_isotp_rx_t* rx, const can_isotp_config_t* config,
+                       const uint8_t* data, uint8_t dlc, int64_t now_us) {
+    if (!rx || !config || !data || dlc == 0) {
+        return false;
+    }
+
+    if (rx->held) {
+        // 接收端忙：新消息的首帧/单帧暂存，首帧回复FC WAIT让发送端暂停；连续帧按意外帧处理
+        uint8_t type = data[0] >> 4;
+        if (type == CAN_ISOTP_SINGLE_FRAME || type == CAN_ISOTP_FIRST_FRAME) {
+            if (rx->held_frame_dlc) {
+                rx->busy_rejects++;
+                if (type == CAN_ISOTP_FIRST_FRAME) {
+                    isotp_send_flow_control(config, CAN_ISOTP_FC_OVERFLOW);
+                }
+                return false;
+            }
+            uint8_t size = dlc < CAN_ISOTP_FRAME_SIZE ? dlc : CAN_ISOTP_FRAME_SIZE;
+            memcpy(rx->held_frame, data, size);
+            rx->held_frame_dlc = size;
+            if (type == CAN_ISOTP_FIRST_FRAME) {
+                rx->wait_frames = 1;
+                rx->wait_frames_sent++;
+                rx->last_wait_us = now_us;
+                isotp_send_flow_control(config, CAN_ISOTP_FC_WAIT);
+            }
+            return false;
+        }
+        if (type == CAN_ISOTP_CONSECUTIVE_FRAME) {
+            rx->sequence_errors++;
+        }
+        return false;
+    }
+
+    // N_Cr超时检查：多帧接收中长时间未收到连续帧则丢弃
+    if (rx->in_progress &&
+        now_us - rx->last_frame_time_us > (int64_t)CAN_ISOTP_RX_TIMEOUT_MS * 1000) {
+        ESP_LOGW(TAG, "ISO-TP接收超时，丢弃未完成消息 (%u/%u字节)",
+                 rx->received_length, rx->expected_length);
+        rx->timeouts++;
+        isotp_abort(rx);
+    }
+
+    switch ((can_isotp_frame_type_t)(data[0] >> 4)) {
+        case CAN_ISOTP_SINGLE_FRAME: {
+            uint8_t length = data[0] & 0x0F;
+            if (length == 0 || length > dlc - 1) {
+                rx->sequence_errors++;
+                return false;
+            }
+            if (rx->in_progress) {
+                // 新消息打断未完成的多帧消息
+                rx->sequence_errors++;
+            }
+            memcpy(rx->buffer, &data[1], length);
+            rx->expected_length = length;
+            rx->received_length = length;
+            rx->in_progress = false;
+            break;
+        }
+
+        case CAN_ISOTP_FIRST_FRAME: {
+            if (dlc < CAN_ISOTP_FRAME_SIZE) {
+                rx->sequence_errors++;
+                return false;
+            }
+            uint16_t length = ((uint16_t)(data[0] & 0x0F) << 8) | data[1];
+            if (length <= 7) {
+                // 首帧声明的长度必须大于单帧容量
+                rx->sequence_errors++;
+                return false;
+            }
+            if (rx->in_progress) {
+                rx->sequence_errors++;
+            }
+            if (length > CAN_ISOTP_MAX_PAYLOAD) {
+                rx->overflows++;
+                isotp_abort(rx);
+                isotp_send_flow_control(config, CAN_ISOTP_FC_OVERFLOW);
+                return false;
+            }
+            memcpy(rx->buffer, &data[2], 6);
+            rx->expected_length = length;
+            rx->received_length = 6;
+            rx->next_sequence = 1;
+            rx->block_count = 0;
+            rx->in_progress = true;
+            rx->last_frame_time_us = now_us;
+            isotp_send_flow_control(config, CAN_ISOTP_FC_CONTINUE);
+            return false;
+        }
+
+        case CAN_ISOTP_CONSECUTIVE_FRAME: {
+            if (!rx->in_progress) {
+                rx->sequence_errors++;
+                return false;
+            }
+            if ((data[0] & 0x0F) != rx->next_sequence) {
+                ESP_LOGW(TAG, "ISO-TP序号错误: 期望%u, 收到%u", rx->next_sequence, data[0] & 0x0F);
+                rx->sequence_errors++;
+                isotp_abort(rx);
+                return false;
+            }
+            uint16_t remaining = rx->expected_length - rx->received_length;
+            uint16_t chunk = remaining < 7 ? remaining : 7;
+            if (chunk > dlc - 1) {
+                rx->sequence_errors++;
+                isotp_abort(rx);
+                return false;
+            }
+            memcpy(&rx->buffer[rx->received_length], &data[1], chunk);
+            rx->received_length += chunk;
+            rx->next_sequence = (rx->next_sequence + 1) & 0x0F;
+            rx->last_frame_time_us = now_us;
+
+            if (rx->received_length < rx->expected_length) {
+                // 块结束后发送下一个流控帧
+                if (config->block_size > 0 && ++rx->block_count >= config->block_size) {
+                    rx->block_count = 0;
+                    isotp_send_flow_control(config, CAN_ISOTP_FC_CONTINUE);
+                }
+                return false;
+            }
+            rx->in_progress = false;
+            break;
+        }
+
+        case CAN_ISOTP_FLOW_CONTROL:
+            // 本端只接收，不发送分段消息，忽略流控帧
+            return false;
+
+        default:
+            rx->sequence_errors++;
+            return false;
+    }
+
+    rx->buffer[rx->received_length] = '\0';
+    rx->messages_completed++;
+    return true;
+}
+
+void can_isotp_hold(can_isotp_rx_t* rx) {
+    if (rx) {
+        rx->held = true;
+    }
+}
+
+void can_isotp_poll(can_isotp_rx_t* rx, const can_isotp_config_t* config, int64_t now_us) {
+    if (!rx || !config || !rx->held || !rx->held_frame_dlc ||
+        (rx->held_frame[0] >> 4) != CAN_ISOTP_FIRST_FRAME ||
+        now_us - rx->last_wait_us < (int64_t)CAN_ISOTP_WAIT_INTERVAL_MS * 1000) {
+        return;
+    }
+    rx->last_wait_us = now_us;
+    if (rx->wait_frames >= CAN_ISOTP_MAX_WAIT_FRAMES) {
+        ESP_LOGW(TAG, "ISO-TP接收端忙超过%d个FC WAIT，拒绝新消息", CAN_ISOTP_MAX_WAIT_FRAMES);
+        rx->held_frame_dlc = 0;
+        rx->busy_rejects++;
+        isotp_send_flow_control(config, CAN_ISOTP_FC_OVERFLOW);
+        return;
+    }
+    rx->wait_frames++;
+    rx->wait_frames_sent++;
+    isotp_send_flow_control(config, CAN_ISOTP_FC_WAIT);
+}
+
+bool can_isotp_release(can_isotp_rx_t* rx, const can_isotp_config_t* config, int64_t now_us) {
+    if (!rx || !rx->held) {
+        return false;
+    }
+    rx->held = false;
+    if (!rx->held_frame_dlc) {
+        return false;
+    }
+    uint8_t frame[CAN_ISOTP_FRAME_SIZE];
+    uint8_t dlc = rx->held_frame_dlc;
+    memcpy(frame, rx->held_frame, dlc);
+    rx->held_frame_dlc = 0;
+    return can_isotp_receive(rx, config, frame, dlc, now_us);
+}
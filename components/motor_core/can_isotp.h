@@ -0,0 +1,114 @@
+#ifndef CAN_ISOTP_H
+#define CAN_ISOTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ISO-TP (ISO 15765-2) 接收重组：单帧/首帧/连续帧、序号检查、N_Cr超时与流控帧生成
+// 只处理帧内容与时间，不依赖TWAI驱动：流控帧经回调发出（设备上由can_monitor发到TWAI，
+// 抓包回放不发送，主机基准接到模拟总线），时间由调用者传入，超时可在主机上确定性复现
+
+#define CAN_ISOTP_MAX_PAYLOAD     4095    // 经典CAN下ISO-TP单条消息最大长度（12位长度字段）
+#define CAN_ISOTP_RX_TIMEOUT_MS   1000    // N_Cr：等待下一个连续帧的超时时间
+#define CAN_ISOTP_FRAME_SIZE      8       // 经典CAN帧数据长度
+#define CAN_ISOTP_PADDING         0xCC    // 流控帧填充值（ISO-TP推荐）
+#define CAN_ISOTP_WAIT_INTERVAL_MS 500    // 接收端忙时重复发送FC WAIT的间隔（小于发送端N_Bs超时1000ms）
+#define CAN_ISOTP_MAX_WAIT_FRAMES 20      // N_WFTmax：同一首帧最多连续回复的FC WAIT数，超过后以FC OVFLW拒绝
+
+// ISO-TP协议控制信息（PCI）帧类型
+typedef enum {
+    CAN_ISOTP_SINGLE_FRAME = 0x0,       // 单帧 (SF)
+    CAN_ISOTP_FIRST_FRAME = 0x1,        // 首帧 (FF)
+    CAN_ISOTP_CONSECUTIVE_FRAME = 0x2,  // 连续帧 (CF)
+    CAN_ISOTP_FLOW_CONTROL = 0x3        // 流控帧 (FC)
+} can_isotp_frame_type_t;
+
+// ISO-TP流控状态
+typedef enum {
+    CAN_ISOTP_FC_CONTINUE = 0x0,        // 继续发送 (CTS)
+    CAN_ISOTP_FC_WAIT = 0x1,            // 等待
+    CAN_ISOTP_FC_OVERFLOW = 0x2         // 溢出，放弃本次传输
+} can_isotp_flow_status_t;
+
+/**
+ * @brief 发送一帧流控帧（8字节，已填充）
+ */
+typedef void (*can_isotp_send_fn_t)(const uint8_t* data, void* context);
+
+// 接收端参数
+typedef struct {
+    uint8_t block_size;                 // 流控块大小BS（0表示不分块，一次发送全部连续帧）
+    uint8_t st_min;                     // 流控最小帧间隔STmin (ms, 0-127)
+    can_isotp_send_fn_t send_flow_control; // 流控帧发送回调（NULL表示不发送，如抓包回放）
+    void* context;                      // 回调参数
+} can_isotp_config_t;
+
+// ISO-TP接收重组状态
+typedef struct {
+    uint8_t buffer[CAN_ISOTP_MAX_PAYLOAD + 1]; // 重组缓冲区（+1用于字符串结束符）
+    uint16_t expected_length;           // 首帧声明的消息总长度
+    uint16_t received_length;           // 已接收长度
+    uint8_t next_sequence;              // 期望的下一个连续帧序号(0-15)
+    uint8_t block_count;                // 当前块内已接收的连续帧数
+    bool in_progress;                   // 是否正在接收多帧消息
+    int64_t last_frame_time_us;         // 最后一帧接收时间(us)
+
+    // 接收端忙（上一条消息仍被应用占用，缓冲区不能覆盖）
+    bool held;                          // 已完成的消息尚未处理完
+    uint8_t held_frame[CAN_ISOTP_FRAME_SIZE]; // 占用期间到达的首帧/单帧，释放后处理
+    uint8_t held_frame_dlc;             // 暂存帧长度（0表示无）
+    uint8_t wait_frames;                // 已为暂存首帧发送的FC WAIT数
+    int64_t last_wait_us;               // 最近一次发送FC WAIT的时间(us)
+
+    // 统计信息
+    uint32_t messages_completed;        // 完整接收的消息数
+    uint32_t sequence_errors;           // 序号错误/意外帧次数
+    uint32_t timeouts;                  // N_Cr超时次数
+    uint32_t overflows;                 // 超长消息被拒绝次数
+    uint32_t wait_frames_sent;          // 接收端忙时发送的FC WAIT总数
+    uint32_t busy_rejects;              // 接收端忙时被拒绝的消息数（已有暂存帧，或FC WAIT超过上限）
+} can_isotp_rx_t;
+
+/**
+ * @brief 清空重组状态与统计
+ */
+void can_isotp_reset(can_isotp_rx_t* rx);
+
+/**
+ * @brief 处理一帧ISO-TP数据（单帧/首帧/连续帧），必要时经回调发送流控帧
+ * @param data 帧数据
+ * @param dlc 帧数据长度
+ * @param now_us 帧接收时间（us，用于N_Cr超时判断）
+ * @return 完整消息重组完成时返回true，消息在rx->buffer中（已加结束符），长度为rx->received_length
+ */
+bool can_isotp_receive(can_isotp_rx_t* rx, const can_isotp_config_t* config,
+                       const uint8_t* data, uint8_t dlc, int64_t now_us);
+
+/**
+ * @brief 应用暂时处理不完刚完成的消息：保留缓冲区，之后到达的首帧回复FC WAIT、单帧暂存，直到can_isotp_release
+ * 背压经流控施加到发送端，接收任务不必阻塞等待应用
+ */
+void can_isotp_hold(can_isotp_rx_t* rx);
+
+/**
+ * @brief 占用期间周期调用：每CAN_ISOTP_WAIT_INTERVAL_MS重发FC WAIT，超过CAN_ISOTP_MAX_WAIT_FRAMES后以FC OVFLW拒绝暂存的首帧
+ * @param now_us 当前时间(us)
+ */
+void can_isotp_poll(can_isotp_rx_t* rx, const can_isotp_config_t* config, int64_t now_us);
+
+/**
+ * @brief 应用已处理完消息：解除占用并处理暂存帧（首帧此时回复CTS）
+ * @param now_us 当前时间(us)
+ * @return 暂存的单帧构成完整消息时返回true（同can_isotp_receive）
+ */
+bool can_isotp_release(can_isotp_rx_t* rx, const can_isotp_config_t* config, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_ISOTP_H
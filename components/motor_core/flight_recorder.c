@@ -0,0 +1,720 @@
+#include "flight_recorder.h"
+#include "motor_control.h"
+#include <string.h>
+#include <math.h>
+
+const char* const FLIGHT_RECORD_TYPE_NAMES[FLIGHT_RECORD_TYPES] = {
+    [0] = "unknown",
+    [FLIGHT_RECORD_STATUS] = "status",
+    [FLIGHT_RECORD_COMMAND] = "command",
+    [FLIGHT_RECORD_ERROR] = "error",
+    [FLIGHT_RECORD_FREEZE] = "freeze",
+};
+
+const char* const FLIGHT_COMMAND_NAMES[FLIGHT_COMMANDS] = {
+    [FLIGHT_COMMAND_ENABLE] = "enable",
+    [FLIGHT_COMMAND_DISABLE] = "disable",
+    [FLIGHT_COMMAND_CLEAR_ERRORS] = "clear_errors",
+    [FLIGHT_COMMAND_MODE_POSITION] = "mode_position",
+    [FLIGHT_COMMAND_MODE_PASSTHROUGH] = "mode_passthrough",
+    [FLIGHT_COMMAND_MODE_VELOCITY] = "mode_velocity",
+    [FLIGHT_COMMAND_MODE_TORQUE] = "mode_torque",
+    [FLIGHT_COMMAND_TARGET_POSITION] = "target_position",
+    [FLIGHT_COMMAND_TARGET_VELOCITY] = "target_velocity",
+    [FLIGHT_COMMAND_TARGET_TORQUE] = "target_torque",
+    [FLIGHT_COMMAND_MOVE] = "move",
+};
+
+#define RECORDER_HEADER_SIZE    sizeof(flight_recorder_sector_header_t)
+#define RECORDER_NODE_SHIFT     (MOTOR_CMD_BITS + 1)   // 节点ID占6位（MOTOR_MAX_NODE_ID）
+#define RECORDER_NODE(uart_port, node_id)   (((uint32_t)(uart_port) << RECORDER_NODE_SHIFT) | (node_id))
+
+// ====================================================================================
+// --- 编码工具（写入与解码共用） ---
+// ====================================================================================
+
+static inline uint64_t recorder_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t recorder_unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * @brief 查找或登记节点的差分基准，表满时返回NULL（该节点按绝对值记录）
+ */
+static int64_t* recorder_delta_slot(flight_recorder_delta_t* delta, uint32_t node) {
+    for (uint8_t i = 0; i < delta->count; i++) {
+        if (delta->nodes[i].node == node) {
+            return &delta->nodes[i].position;
+        }
+    }
+    if (delta->count >= FLIGHT_RECORDER_MAX_NODES) {
+        return NULL;
+    }
+    memset(&delta->nodes[delta->count], 0, sizeof(delta->nodes[0]));
+    delta->nodes[delta->count].node = node;
+    return &delta->nodes[delta->count++].position;
+}
+
+static bool recorder_header_valid(const flight_recorder_sector_header_t* header) {
+    return memcmp(header->magic, FLIGHT_RECORDER_MAGIC, 4) == 0 &&
+           header->version == FLIGHT_RECORDER_FORMAT_VERSION;
+}
+
+// ====================================================================================
+// --- 转储解码 ---
+// ====================================================================================
+
+static bool reader_get_varint(const uint8_t* data, size_t end, size_t* pos, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= end) {
+            return false;
+        }
+        uint8_t byte = data[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool reader_header(const flight_recorder_reader_t* reader, uint32_t index,
+                          flight_recorder_sector_header_t* header) {
+    memcpy(header, reader->data + (size_t)index * FLIGHT_RECORDER_SECTOR_SIZE, RECORDER_HEADER_SIZE);
+    return recorder_header_valid(header);
+}
+
+/**
+ * @brief 切换到序号大于当前扇区的最旧扇区（冻结扇区与循环写入的扇区交错，只能按序号排序）
+ */
+static bool reader_next_sector(flight_recorder_reader_t* reader) {
+    flight_recorder_sector_header_t header;
+    flight_recorder_sector_header_t best;
+    int32_t best_index = -1;
+
+    for (uint32_t i = 0; i < reader->sector_count; i++) {
+        if (!reader_header(reader, i, &header)) {
+            continue;
+        }
+        if (reader->sector >= 0 && header.sequence <= reader->header.sequence) {
+            continue;
+        }
+        if (best_index < 0 || header.sequence < best.sequence) {
+            best = header;
+            best_index = (int32_t)i;
+        }
+    }
+    if (best_index < 0) {
+        return false;
+    }
+
+    reader->sector = best_index;
+    reader->header = best;
+    reader->offset = RECORDER_HEADER_SIZE;
+    reader->time_us = best.base_time_us;
+    reader->delta.count = 0;
+    return true;
+}
+
+/**
+ * @brief 解码当前扇区的下一条记录，遇到擦除态、未知类型或截断（写入中掉电）时返回false
+ */
+static bool reader_decode(flight_recorder_reader_t* reader, flight_recorder_event_t* event) {
+    const uint8_t* data = reader->data + (size_t)reader->sector * FLIGHT_RECORDER_SECTOR_SIZE;
+    const size_t end = FLIGHT_RECORDER_SECTOR_SIZE;
+    size_t pos = reader->offset;
+    if (pos >= end) {
+        return false;
+    }
+
+    uint8_t type = data[pos++];
+    if (type == 0 || type >= FLIGHT_RECORD_TYPES) {
+        return false;
+    }
+
+    uint64_t dt, node;
+    if (!reader_get_varint(data, end, &pos, &dt) || !reader_get_varint(data, end, &pos, &node)) {
+        return false;
+    }
+
+    memset(event, 0, sizeof(*event));
+    event->type = (flight_record_type_t)type;
+    event->sequence = reader->header.sequence;
+    event->boot_id = reader->header.boot_id;
+    event->frozen = !(reader->header.flags & FLIGHT_RECORDER_FLAG_FROZEN);
+    event->time_us = reader->time_us + recorder_unzigzag(dt);
+    event->uart_port = (uint8_t)(node >> RECORDER_NODE_SHIFT);
+    event->node_id = (uint8_t)(node & MOTOR_MAX_NODE_ID);
+
+    uint64_t raw[3];
+    switch (event->type) {
+        case FLIGHT_RECORD_STATUS: {
+            for (int i = 0; i < 3; i++) {
+                if (!reader_get_varint(data, end, &pos, &raw[i])) {
+                    return false;
+                }
+            }
+            int64_t* base = recorder_delta_slot(&reader->delta, (uint32_t)node);
+            int64_t values[3];
+            for (int i = 0; i < 3; i++) {
+                values[i] = (base ? base[i] : 0) + recorder_unzigzag(raw[i]);
+                if (base) {
+                    base[i] = values[i];
+                }
+            }
+            event->position = (float)values[0] / FLIGHT_RECORDER_POSITION_SCALE;
+            event->velocity = (float)values[1] / FLIGHT_RECORDER_VELOCITY_SCALE;
+            event->torque = (float)values[2] / FLIGHT_RECORDER_TORQUE_SCALE;
+            break;
+        }
+        case FLIGHT_RECORD_COMMAND:
+            if (end - pos < 1 + sizeof(float) || data[pos] >= FLIGHT_COMMANDS) {
+                return false;
+            }
+            event->command = (flight_command_t)data[pos++];
+            memcpy(&event->value, &data[pos], sizeof(float));
+            pos += sizeof(float);
+            break;
+        case FLIGHT_RECORD_ERROR:
+        case FLIGHT_RECORD_FREEZE:
+            if (pos >= end) {
+                return false;
+            }
+            event->error_type = data[pos++];
+            if (!reader_get_varint(data, end, &pos, &raw[0])) {
+                return false;
+            }
+            event->code = (uint32_t)raw[0];
+            break;
+        default:
+            return false;
+    }
+
+    reader->offset = pos;
+    reader->time_us = event->time_us;
+    return true;
+}
+
+bool flight_recorder_reader_init(flight_recorder_reader_t* reader, const uint8_t* dump, size_t length) {
+    if (!reader || !dump || length == 0 || length % FLIGHT_RECORDER_SECTOR_SIZE != 0) {
+        return false;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    reader->data = dump;
+    reader->sector_count = length / FLIGHT_RECORDER_SECTOR_SIZE;
+    reader->sector = -1;
+
+    flight_recorder_sector_header_t header;
+    for (uint32_t i = 0; i < reader->sector_count; i++) {
+        if (reader_header(reader, i, &header)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool flight_recorder_reader_next(flight_recorder_reader_t* reader, flight_recorder_event_t* event) {
+    while (reader->sector < 0 || !reader_decode(reader, event)) {
+        if (!reader_next_sector(reader)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if CONFIG_FLIGHT_RECORDER
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "motor_registry.h"
+#include "motor_task_plan.h"
+
+static const char *TAG = "FLIGHT_REC";
+
+#define RECORDER_MAX_RECORD     (1 + 10 + 5 + 3 * 10)   // 类型 + 时间差 + 节点 + 3个64位varint
+#define RECORDER_BATCH_SIZE     512         // 内存批量缓冲，满或到刷新周期才写闪存
+#define RECORDER_QUEUE_DEPTH    32          // 命令队列深度
+#define RECORDER_TASK_STACK     4096
+#define RECORDER_TASK_PRIORITY  2           // 低于全部电机任务与HTTP服务器
+#define RECORDER_ERROR_TYPES    4
+
+// 采样的异常类型（与parse_error_data的error_type一致）
+static const uint8_t recorder_error_types[RECORDER_ERROR_TYPES] = {0, 1, 3, 4};
+
+// 队列中的命令
+typedef struct {
+    int64_t time_us;
+    float value;
+    uint8_t uart_port;
+    uint8_t node_id;
+    uint8_t command;
+} recorder_command_t;
+
+typedef struct {
+    const esp_partition_t* partition;
+    SemaphoreHandle_t lock;             // 保护闪存操作与写入状态
+    QueueHandle_t commands;
+    TaskHandle_t task;
+    uint32_t sector_count;
+    uint32_t sector;                    // 当前扇区下标
+    uint32_t sequence;                  // 当前扇区序号
+    uint32_t boot_id;
+    bool sector_open;                   // 当前扇区已擦除并写好扇区头
+    bool full;                          // 其余扇区全部冻结，停止记录
+    size_t flushed;                     // 当前扇区已写入闪存的记录字节数
+    uint8_t batch[RECORDER_BATCH_SIZE];
+    size_t batch_used;
+    int64_t last_time_us;               // 上一条记录的时间
+    flight_recorder_delta_t delta;
+    uint32_t status_generation[MOTOR_REGISTRY_MAX_MOTORS];  // 各轴上次采样的状态代次
+    uint32_t error_codes[MOTOR_REGISTRY_MAX_MOTORS][RECORDER_ERROR_TYPES];  // 各轴上次采样的异常码
+    flight_recorder_stats_t stats;
+} flight_recorder_t;
+
+static flight_recorder_t g_recorder;
+
+static size_t recorder_put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static int64_t recorder_fixed(float value, float scale) {
+    return isfinite(value) ? llroundf(value * scale) : 0;
+}
+
+// ====================================================================================
+// --- 扇区管理（调用者持有锁） ---
+// ====================================================================================
+
+static bool recorder_read_header(uint32_t index, flight_recorder_sector_header_t* header) {
+    if (esp_partition_read(g_recorder.partition, (size_t)index * FLIGHT_RECORDER_SECTOR_SIZE,
+                           header, RECORDER_HEADER_SIZE) != ESP_OK) {
+        return false;
+    }
+    return recorder_header_valid(header);
+}
+
+static void recorder_flush_locked(void) {
+    if (g_recorder.batch_used == 0) {
+        return;
+    }
+    size_t offset = (size_t)g_recorder.sector * FLIGHT_RECORDER_SECTOR_SIZE + RECORDER_HEADER_SIZE +
+                    g_recorder.flushed;
+    esp_err_t err = esp_partition_write(g_recorder.partition, offset, g_recorder.batch, g_recorder.batch_used);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "写入记录失败: %s", esp_err_to_name(err));
+    } else {
+        g_recorder.stats.bytes_written += g_recorder.batch_used;
+    }
+    // 写失败也前移：该段保持擦除态，读取时视为扇区结束
+    g_recorder.flushed += g_recorder.batch_used;
+    g_recorder.batch_used = 0;
+}
+
+/**
+ * @brief 擦除下一个未冻结的扇区并写入扇区头，扇区内时间与差分基准重新起算
+ */
+static bool recorder_open_sector_locked(int64_t now_us) {
+    recorder_flush_locked();
+    flight_recorder_sector_header_t header;
+
+    for (uint32_t i = 1; i <= g_recorder.sector_count; i++) {
+        uint32_t index = (g_recorder.sector + i) % g_recorder.sector_count;
+        if (recorder_read_header(index, &header) && !(header.flags & FLIGHT_RECORDER_FLAG_FROZEN)) {
+            continue;
+        }
+
+        size_t offset = (size_t)index * FLIGHT_RECORDER_SECTOR_SIZE;
+        if (esp_partition_erase_range(g_recorder.partition, offset, FLIGHT_RECORDER_SECTOR_SIZE) != ESP_OK) {
+            ESP_LOGE(TAG, "擦除扇区%lu失败", (unsigned long)index);
+            continue;
+        }
+        g_recorder.stats.sector_erases++;
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, FLIGHT_RECORDER_MAGIC, 4);
+        header.version = FLIGHT_RECORDER_FORMAT_VERSION;
+        header.sequence = g_recorder.sequence + 1;
+        header.boot_id = g_recorder.boot_id;
+        header.flags = 0xFFFFFFFF;
+        header.base_time_us = now_us;
+        if (esp_partition_write(g_recorder.partition, offset, &header, sizeof(header)) != ESP_OK) {
+            ESP_LOGE(TAG, "写入扇区头%lu失败", (unsigned long)index);
+            continue;
+        }
+
+        g_recorder.sector = index;
+        g_recorder.sequence = header.sequence;
+        g_recorder.sector_open = true;
+        g_recorder.flushed = 0;
+        g_recorder.last_time_us = now_us;
+        g_recorder.delta.count = 0;
+        return true;
+    }
+
+    g_recorder.sector_open = false;
+    g_recorder.full = true;
+    ESP_LOGE(TAG, "没有可写扇区（冻结扇区已占满），停止记录");
+    return false;
+}
+
+/**
+ * @brief 为一条记录预留空间：当前扇区放不下时换扇区，批量缓冲放不下时先写闪存
+ * @return 记录写入位置；无可写扇区返回NULL
+ */
+static uint8_t* recorder_reserve_locked(int64_t now_us) {
+    if (g_recorder.full) {
+        return NULL;
+    }
+    if (!g_recorder.sector_open ||
+        RECORDER_HEADER_SIZE + g_recorder.flushed + g_recorder.batch_used + RECORDER_MAX_RECORD >
+            FLIGHT_RECORDER_SECTOR_SIZE) {
+        if (!recorder_open_sector_locked(now_us)) {
+            return NULL;
+        }
+    }
+    if (g_recorder.batch_used + RECORDER_MAX_RECORD > RECORDER_BATCH_SIZE) {
+        recorder_flush_locked();
+    }
+    return &g_recorder.batch[g_recorder.batch_used];
+}
+
+static size_t recorder_record_head(uint8_t* out, flight_record_type_t type, int64_t time_us, uint32_t node) {
+    size_t n = 0;
+    out[n++] = (uint8_t)type;
+    n += recorder_put_varint(&out[n], recorder_zigzag(time_us - g_recorder.last_time_us));
+    n += recorder_put_varint(&out[n], node);
+    g_recorder.last_time_us = time_us;
+    return n;
+}
+
+static void recorder_commit(size_t length) {
+    g_recorder.batch_used += length;
+    g_recorder.stats.records++;
+}
+
+// ====================================================================================
+// --- 记录写入（调用者持有锁） ---
+// ====================================================================================
+
+static void recorder_write_status(int64_t now_us, uint32_t node, const motor_status_t* status) {
+    uint8_t* out = recorder_reserve_locked(now_us);
+    if (!out) {
+        return;
+    }
+
+    size_t n = recorder_record_head(out, FLIGHT_RECORD_STATUS, now_us, node);
+    int64_t values[3] = {
+        recorder_fixed(status->position, FLIGHT_RECORDER_POSITION_SCALE),
+        recorder_fixed(status->velocity, FLIGHT_RECORDER_VELOCITY_SCALE),
+        recorder_fixed(status->current_torque, FLIGHT_RECORDER_TORQUE_SCALE),
+    };
+    int64_t* base = recorder_delta_slot(&g_recorder.delta, node);
+    for (int i = 0; i < 3; i++) {
+        n += recorder_put_varint(&out[n], recorder_zigzag(values[i] - (base ? base[i] : 0)));
+        if (base) {
+            base[i] = values[i];
+        }
+    }
+    recorder_commit(n);
+}
+
+static void recorder_write_command(const recorder_command_t* command) {
+    uint8_t* out = recorder_reserve_locked(command->time_us);
+    if (!out) {
+        return;
+    }
+
+    size_t n = recorder_record_head(out, FLIGHT_RECORD_COMMAND, command->time_us,
+                                    RECORDER_NODE(command->uart_port, command->node_id));
+    out[n++] = command->command;
+    memcpy(&out[n], &command->value, sizeof(float));
+    n += sizeof(float);
+    recorder_commit(n);
+}
+
+static void recorder_write_error(flight_record_type_t type, int64_t now_us, uint32_t node,
+                                 uint8_t error_type, uint32_t code) {
+    uint8_t* out = recorder_reserve_locked(now_us);
+    if (!out) {
+        return;
+    }
+
+    size_t n = recorder_record_head(out, type, now_us, node);
+    out[n++] = error_type;
+    n += recorder_put_varint(&out[n], code);
+    recorder_commit(n);
+}
+
+/**
+ * @brief 冻结覆盖最近CONFIG_FLIGHT_RECORDER_FREEZE_SECONDS秒的扇区
+ * 按序号从当前扇区往回找（中间可能夹着更早冻结的扇区），冻结扇区最多占分区一半，保证仍能循环记录
+ */
+static void recorder_freeze_locked(int64_t now_us) {
+    recorder_flush_locked();
+    g_recorder.stats.freezes++;
+
+    int64_t cutoff_us = now_us - (int64_t)CONFIG_FLIGHT_RECORDER_FREEZE_SECONDS * 1000000;
+    uint32_t wanted = g_recorder.sequence;
+    uint32_t frozen = 0;
+    flight_recorder_sector_header_t header;
+
+    for (uint32_t i = 0; i < g_recorder.sector_count && g_recorder.sector_open; i++) {
+        uint32_t index = (g_recorder.sector + g_recorder.sector_count - i) % g_recorder.sector_count;
+        if (!recorder_read_header(index, &header) || header.sequence != wanted) {
+            continue;
+        }
+        if (header.boot_id != g_recorder.boot_id) {
+            break;      // 不跨越重启：上一次启动的时间基准不可比
+        }
+
+        if (header.flags & FLIGHT_RECORDER_FLAG_FROZEN) {
+            if (g_recorder.stats.frozen_sectors + 1 > g_recorder.sector_count / 2) {
+                g_recorder.stats.skipped_freezes++;
+                ESP_LOGW(TAG, "冻结扇区已达上限(%lu)，保留更早的故障现场",
+                         (unsigned long)g_recorder.stats.frozen_sectors);
+                break;
+            }
+            uint32_t flags = header.flags & ~FLIGHT_RECORDER_FLAG_FROZEN;
+            size_t offset = (size_t)index * FLIGHT_RECORDER_SECTOR_SIZE +
+                            offsetof(flight_recorder_sector_header_t, flags);
+            if (esp_partition_write(g_recorder.partition, offset, &flags, sizeof(flags)) == ESP_OK) {
+                g_recorder.stats.frozen_sectors++;
+                frozen++;
+            }
+        }
+
+        if (header.base_time_us <= cutoff_us) {
+            break;
+        }
+        wanted--;
+    }
+
+    ESP_LOGW(TAG, "检测到新异常位，冻结%lu个扇区（共%lu个已冻结）", (unsigned long)frozen,
+             (unsigned long)g_recorder.stats.frozen_sectors);
+}
+
+/**
+ * @brief 采样各轴状态（代次变化才记录）与异常码（变化即记录，出现新异常位时冻结）
+ */
+static void recorder_sample_locked(int64_t now_us) {
+    bool freeze = false;
+
+    for (uint8_t axis = 0; axis < motor_registry_count(); axis++) {
+        motor_controller_t* controller = motor_registry_get(axis)->controller;
+        const motor_status_t* status = &controller->status;
+        uint32_t node = RECORDER_NODE(controller->driver_config.uart_port, controller->driver_config.node_id);
+
+        uint32_t generation = __atomic_load_n(&status->generation, __ATOMIC_ACQUIRE);
+        if (generation != 0 && generation != g_recorder.status_generation[axis]) {
+            g_recorder.status_generation[axis] = generation;
+            recorder_write_status(now_us, node, status);
+        }
+
+        for (int i = 0; i < RECORDER_ERROR_TYPES; i++) {
+            uint8_t error_type = recorder_error_types[i];
+            const motor_fault_list_t* faults = get_motor_faults(status, error_type);
+            uint32_t code = faults ? faults->code : 0;
+            uint32_t previous = g_recorder.error_codes[axis][i];
+            if (code == previous) {
+                continue;
+            }
+            g_recorder.error_codes[axis][i] = code;
+            recorder_write_error(FLIGHT_RECORD_ERROR, now_us, node, error_type, code);
+            if (code & ~previous) {
+                recorder_write_error(FLIGHT_RECORD_FREEZE, now_us, node, error_type, code & ~previous);
+                freeze = true;
+            }
+        }
+    }
+
+    if (freeze) {
+        recorder_freeze_locked(now_us);
+    }
+}
+
+static void flight_recorder_task(void* arg) {
+    TickType_t period = pdMS_TO_TICKS(CONFIG_FLIGHT_RECORDER_SAMPLE_MS);
+    if (period == 0) {
+        period = 1;
+    }
+    TickType_t next_sample = xTaskGetTickCount() + period;
+    int64_t last_flush_us = esp_timer_get_time();
+    recorder_command_t command;
+
+    while (1) {
+        TickType_t elapsed = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(next_sample - elapsed) > 0 ? next_sample - elapsed : 0;
+        bool received = xQueueReceive(g_recorder.commands, &command, wait) == pdTRUE;
+
+        xSemaphoreTake(g_recorder.lock, portMAX_DELAY);
+        if (received) {
+            recorder_write_command(&command);
+        }
+        if ((int32_t)(xTaskGetTickCount() - next_sample) >= 0) {
+            recorder_sample_locked(esp_timer_get_time());
+            next_sample += period;
+        }
+        int64_t now_us = esp_timer_get_time();
+        if (now_us - last_flush_us >= (int64_t)CONFIG_FLIGHT_RECORDER_FLUSH_MS * 1000) {
+            recorder_flush_locked();
+            last_flush_us = now_us;
+        }
+        xSemaphoreGive(g_recorder.lock);
+    }
+}
+
+// ====================================================================================
+// --- 对外接口 ---
+// ====================================================================================
+
+bool flight_recorder_init(void) {
+    if (g_recorder.task) {
+        return true;
+    }
+
+    g_recorder.partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                    (esp_partition_subtype_t)FLIGHT_RECORDER_PARTITION_SUBTYPE,
+                                                    FLIGHT_RECORDER_PARTITION_LABEL);
+    if (!g_recorder.partition) {
+        ESP_LOGE(TAG, "未找到记录分区 %s（检查partitions.csv）", FLIGHT_RECORDER_PARTITION_LABEL);
+        return false;
+    }
+    g_recorder.sector_count = g_recorder.partition->size / FLIGHT_RECORDER_SECTOR_SIZE;
+    if (g_recorder.sector_count < 2) {
+        ESP_LOGE(TAG, "记录分区过小: %lu字节", (unsigned long)g_recorder.partition->size);
+        g_recorder.partition = NULL;
+        return false;
+    }
+
+    // 扫描扇区头：从序号最大的扇区之后续写，启动序号取已有最大值加1
+    flight_recorder_sector_header_t header;
+    bool found = false;
+    uint32_t max_boot_id = 0;
+    g_recorder.sector = g_recorder.sector_count - 1;
+    g_recorder.sequence = 0;
+    for (uint32_t i = 0; i < g_recorder.sector_count; i++) {
+        if (!recorder_read_header(i, &header)) {
+            continue;
+        }
+        if (!found || header.sequence > g_recorder.sequence) {
+            g_recorder.sequence = header.sequence;
+            g_recorder.sector = i;
+        }
+        if (!found || header.boot_id > max_boot_id) {
+            max_boot_id = header.boot_id;
+        }
+        if (!(header.flags & FLIGHT_RECORDER_FLAG_FROZEN)) {
+            g_recorder.stats.frozen_sectors++;
+        }
+        found = true;
+    }
+    g_recorder.boot_id = max_boot_id + 1;
+
+    g_recorder.lock = xSemaphoreCreateMutex();
+    g_recorder.commands = xQueueCreate(RECORDER_QUEUE_DEPTH, sizeof(recorder_command_t));
+    if (!g_recorder.lock || !g_recorder.commands ||
+        xTaskCreatePinnedToCore(flight_recorder_task, "flight_rec", RECORDER_TASK_STACK, NULL,
+                                RECORDER_TASK_PRIORITY, &g_recorder.task, MOTOR_TASK_NETWORK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "记录任务创建失败");
+        if (g_recorder.lock) vSemaphoreDelete(g_recorder.lock);
+        if (g_recorder.commands) vQueueDelete(g_recorder.commands);
+        memset(&g_recorder, 0, sizeof(g_recorder));
+        return false;
+    }
+
+    ESP_LOGI(TAG, "飞行记录仪已启动 - %lu个扇区, 启动序号%lu, 已冻结%lu个扇区",
+             (unsigned long)g_recorder.sector_count, (unsigned long)g_recorder.boot_id,
+             (unsigned long)g_recorder.stats.frozen_sectors);
+    return true;
+}
+
+void flight_recorder_command(uint8_t uart_port, uint8_t node_id, flight_command_t command, float value) {
+    if (!g_recorder.commands) {
+        return;
+    }
+
+    recorder_command_t item = {
+        .time_us = esp_timer_get_time(),
+        .value = value,
+        .uart_port = uart_port,
+        .node_id = node_id,
+        .command = (uint8_t)command
+    };
+    if (xQueueSend(g_recorder.commands, &item, 0) != pdTRUE) {
+        __atomic_fetch_add(&g_recorder.stats.dropped_commands, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void flight_recorder_flush(void) {
+    if (!g_recorder.lock) {
+        return;
+    }
+    xSemaphoreTake(g_recorder.lock, portMAX_DELAY);
+    recorder_flush_locked();
+    xSemaphoreGive(g_recorder.lock);
+}
+
+void flight_recorder_clear(void) {
+    if (!g_recorder.lock) {
+        return;
+    }
+    xSemaphoreTake(g_recorder.lock, portMAX_DELAY);
+    if (esp_partition_erase_range(g_recorder.partition, 0, g_recorder.partition->size) != ESP_OK) {
+        ESP_LOGE(TAG, "擦除记录分区失败");
+    }
+    // 序号继续递增，下一条记录从扇区0开始
+    g_recorder.sector = g_recorder.sector_count - 1;
+    g_recorder.sector_open = false;
+    g_recorder.full = false;
+    g_recorder.batch_used = 0;
+    g_recorder.stats.frozen_sectors = 0;
+    xSemaphoreGive(g_recorder.lock);
+    ESP_LOGI(TAG, "记录分区已清空");
+}
+
+void flight_recorder_get_stats(flight_recorder_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!g_recorder.lock) {
+        return;
+    }
+    xSemaphoreTake(g_recorder.lock, portMAX_DELAY);
+    *stats = g_recorder.stats;
+    stats->enabled = !g_recorder.full;
+    stats->sector_count = g_recorder.sector_count;
+    stats->current_sector = g_recorder.sector;
+    stats->sequence = g_recorder.sequence;
+    stats->boot_id = g_recorder.boot_id;
+    stats->dropped_commands = __atomic_load_n(&g_recorder.stats.dropped_commands, __ATOMIC_RELAXED);
+    xSemaphoreGive(g_recorder.lock);
+}
+
+bool flight_recorder_read(size_t offset, void* buffer, size_t length) {
+    if (!g_recorder.lock || offset > g_recorder.partition->size || length > g_recorder.partition->size - offset) {
+        return false;
+    }
+    xSemaphoreTake(g_recorder.lock, portMAX_DELAY);
+    bool ok = esp_partition_read(g_recorder.partition, offset, buffer, length) == ESP_OK;
+    xSemaphoreGive(g_recorder.lock);
+    return ok;
+}
+
+size_t flight_recorder_partition_size(void) {
+    return g_recorder.lock ? g_recorder.partition->size : 0;
+}
+
+#endif // CONFIG_FLIGHT_RECORDER
@@ -0,0 +1,202 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 飞行记录仪：状态采样、控制命令与异常码变化追加写入专用闪存分区（partitions.csv中的flightrec）
+//
+// 分区按4KB扇区循环使用（逐扇区轮换擦除，各扇区擦写次数均衡），每个扇区可独立解码：
+//   flight_recorder_sector_header_t + 变长记录 + 0xFF填充（擦除态，类型0xFF即扇区内记录结束）
+// 记录（小端）：[类型] [距上一条记录的微秒数: zigzag varint] [节点: varint (uart_port << 6 | node_id)] [载荷]
+//   STATUS  : 位置(×10000转)、速度(×1000转/s)、力矩(×1000Nm)定点值相对本扇区同节点上一条STATUS的差，zigzag varint
+//   COMMAND : 命令类型(1字节) + 参数(float，4字节)
+//   ERROR   : 异常类型(1字节) + 新异常码(varint)
+//   FREEZE  : 异常类型(1字节) + 新出现的异常位(varint)
+// 时间与差分基准都在扇区头重新起算。出现新异常位时把覆盖最近FLIGHT_RECORDER_FREEZE_SECONDS秒的扇区标记冻结：
+// 擦除后flags为全1，冻结只把FROZEN位原地写成0（NOR闪存无需擦除即可把1改为0），循环分配时跳过冻结扇区
+// 版本2：节点字段的uart_port左移6位（版本1左移5位，节点ID 32-63会与uart_port混淆），版本1的扇区不再解码
+
+#define FLIGHT_RECORDER_MAGIC           "FREC"
+#define FLIGHT_RECORDER_FORMAT_VERSION  2
+#define FLIGHT_RECORDER_SECTOR_SIZE     4096
+#define FLIGHT_RECORDER_PARTITION_LABEL "flightrec"
+#define FLIGHT_RECORDER_PARTITION_SUBTYPE 0x40  // 自定义数据分区子类型
+#define FLIGHT_RECORDER_FLAG_FROZEN     0x00000001  // flags中该位为0表示扇区已冻结
+#define FLIGHT_RECORDER_MAX_NODES       8       // 单扇区内做差分的节点数上限（超出的节点按绝对值记录）
+#define FLIGHT_RECORDER_POSITION_SCALE  10000.0f
+#define FLIGHT_RECORDER_VELOCITY_SCALE  1000.0f
+#define FLIGHT_RECORDER_TORQUE_SCALE    1000.0f
+
+// 扇区头
+typedef struct __attribute__((packed)) {
+    char magic[4];                      // FLIGHT_RECORDER_MAGIC
+    uint8_t version;                    // FLIGHT_RECORDER_FORMAT_VERSION
+    uint8_t reserved[3];
+    uint32_t sequence;                  // 扇区写入序号（跨重启单调递增，按它恢复时间顺序）
+    uint32_t boot_id;                   // 写入该扇区时的启动序号
+    uint32_t flags;                     // 擦除态全1，冻结时清除FLIGHT_RECORDER_FLAG_FROZEN
+    int64_t base_time_us;               // 时间基准（esp_timer微秒，本次启动内有效）
+} flight_recorder_sector_header_t;
+
+// 记录类型
+typedef enum {
+    FLIGHT_RECORD_STATUS = 1,           // 状态采样
+    FLIGHT_RECORD_COMMAND = 2,          // 控制命令
+    FLIGHT_RECORD_ERROR = 3,            // 异常码变化
+    FLIGHT_RECORD_FREEZE = 4,           // 新异常位，此前的记录被冻结
+    FLIGHT_RECORD_TYPES
+} flight_record_type_t;
+
+// 命令类型
+typedef enum {
+    FLIGHT_COMMAND_ENABLE = 0,
+    FLIGHT_COMMAND_DISABLE,
+    FLIGHT_COMMAND_CLEAR_ERRORS,
+    FLIGHT_COMMAND_MODE_POSITION,
+    FLIGHT_COMMAND_MODE_PASSTHROUGH,
+    FLIGHT_COMMAND_MODE_VELOCITY,
+    FLIGHT_COMMAND_MODE_TORQUE,
+    FLIGHT_COMMAND_TARGET_POSITION,     // 参数：目标位置（转）
+    FLIGHT_COMMAND_TARGET_VELOCITY,     // 参数：目标速度（转/s）
+    FLIGHT_COMMAND_TARGET_TORQUE,       // 参数：目标力矩（Nm）
+    FLIGHT_COMMAND_MOVE,                // G1多轴运动目标，参数：输出轴角度（度）
+    FLIGHT_COMMANDS
+} flight_command_t;
+
+extern const char* const FLIGHT_RECORD_TYPE_NAMES[FLIGHT_RECORD_TYPES];
+extern const char* const FLIGHT_COMMAND_NAMES[FLIGHT_COMMANDS];
+
+// 扇区内差分状态（写入与解码共用）
+typedef struct {
+    uint8_t count;
+    struct {
+        uint32_t node;
+        int64_t position;
+        int64_t velocity;
+        int64_t torque;
+    } nodes[FLIGHT_RECORDER_MAX_NODES];
+} flight_recorder_delta_t;
+
+// 解码后的一条记录
+typedef struct {
+    flight_record_type_t type;
+    uint32_t sequence;                  // 所在扇区序号
+    uint32_t boot_id;                   // 所在扇区的启动序号
+    bool frozen;                        // 所在扇区是否已冻结
+    int64_t time_us;                    // 绝对时间戳（esp_timer微秒）
+    uint8_t uart_port;
+    uint8_t node_id;
+    float position;                     // STATUS
+    float velocity;                     // STATUS
+    float torque;                       // STATUS
+    flight_command_t command;           // COMMAND
+    float value;                        // COMMAND
+    uint8_t error_type;                 // ERROR/FREEZE
+    uint32_t code;                      // ERROR：新异常码；FREEZE：新出现的异常位
+} flight_recorder_event_t;
+
+// 分区转储的顺序读取器：按扇区序号从旧到新读出全部记录
+typedef struct {
+    const uint8_t* data;
+    uint32_t sector_count;
+    int32_t sector;                     // 当前扇区下标（-1表示尚未开始）
+    flight_recorder_sector_header_t header; // 当前扇区头
+    size_t offset;                      // 下一条记录在扇区内的偏移
+    int64_t time_us;                    // 上一条记录的绝对时间
+    flight_recorder_delta_t delta;
+} flight_recorder_reader_t;
+
+// 记录仪状态
+typedef struct {
+    bool enabled;                       // 分区可用且记录任务在运行
+    uint32_t sector_count;              // 分区扇区数
+    uint32_t current_sector;            // 正在写入的扇区下标
+    uint32_t sequence;                  // 正在写入的扇区序号
+    uint32_t boot_id;                   // 本次启动序号
+    uint32_t frozen_sectors;            // 已冻结的扇区数
+    uint32_t records;                   // 本次启动写入的记录数
+    uint32_t dropped_commands;          // 命令队列满丢弃的命令数
+    uint32_t bytes_written;             // 本次启动写入闪存的字节数
+    uint32_t sector_erases;             // 本次启动擦除的扇区数
+    uint32_t freezes;                   // 本次启动的冻结次数
+    uint32_t skipped_freezes;           // 冻结扇区已达上限而未冻结的次数
+} flight_recorder_stats_t;
+
+#if CONFIG_FLIGHT_RECORDER
+#define FLIGHT_RECORDER_COMMAND(uart_port, node_id, command, value) \
+    flight_recorder_command((uart_port), (node_id), (command), (value))
+#else
+#define FLIGHT_RECORDER_COMMAND(uart_port, node_id, command, value) ((void)0)
+#endif
+
+/**
+ * @brief 打开记录分区、扫描扇区头恢复写入位置并启动记录任务
+ * 各轴状态与异常码按CONFIG_FLIGHT_RECORDER_SAMPLE_MS周期从电机注册表采样
+ * @return 分区不存在或资源分配失败返回false
+ */
+bool flight_recorder_init(void);
+
+/**
+ * @brief 记录一条控制命令（只入队，不访问闪存；未初始化时直接返回）
+ * @param uart_port 电机UART端口
+ * @param node_id 驱动器节点ID
+ * @param command 命令类型
+ * @param value 命令参数（无参数的命令填0）
+ */
+void flight_recorder_command(uint8_t uart_port, uint8_t node_id, flight_command_t command, float value);
+
+/**
+ * @brief 把内存中尚未写入的记录写入闪存
+ */
+void flight_recorder_flush(void);
+
+/**
+ * @brief 擦除整个记录分区（包括冻结扇区），之后从新扇区继续记录
+ */
+void flight_recorder_clear(void);
+
+/**
+ * @brief 获取记录仪状态
+ */
+void flight_recorder_get_stats(flight_recorder_stats_t* stats);
+
+/**
+ * @brief 读取记录分区原始内容（供下载转储）
+ * @param offset 分区内偏移
+ * @param buffer 输出缓冲区
+ * @param length 读取长度
+ * @return 未初始化或越界返回false
+ */
+bool flight_recorder_read(size_t offset, void* buffer, size_t length);
+
+/**
+ * @brief 获取记录分区大小（未初始化返回0）
+ */
+size_t flight_recorder_partition_size(void);
+
+/**
+ * @brief 校验分区转储并初始化读取器
+ * @param dump 转储数据（整数个扇区）
+ * @param length 转储长度
+ * @return 长度不是扇区整数倍或没有任何有效扇区返回false
+ */
+bool flight_recorder_reader_init(flight_recorder_reader_t* reader, const uint8_t* dump, size_t length);
+
+/**
+ * @brief 读取下一条记录（跨扇区按序号顺序）
+ * @return 没有更多记录返回false
+ */
+bool flight_recorder_reader_next(flight_recorder_reader_t* reader, flight_recorder_event_t* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,1306 @@
+#include "gcode_unified_control.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "motor_units.h"
+#include "motor_metrics.h"
+#include "motor_task_plan.h"
+#include "flight_recorder.h"
+
+static const char *TAG = "GCODE_CTRL";
+
+#define GCODE_EXECUTOR_STACK_SIZE       4096
+#define GCODE_PROGRAM_ENQUEUE_TIMEOUT_MS 5000   // 程序流式入队时等待队列空位的最长时间
+#define GCODE_ENCODER_WAIT_MS           50      // 起点未知的相对/最短路径运动等待编码器响应的最长时间
+#define GCODE_TARGET_CONFIRM_DEG        0.5     // 斜坡模式运动的到达确认容差（输出轴度）
+#define GCODE_TRAJECTORY_POLL_MS        10      // 等待轨迹结束时检查停止请求的间隔
+#define GCODE_TRAJECTORY_MARGIN_MS      500     // 轨迹超过规划时长仍未结束时强制中止的裕量
+#define GCODE_STOP_WAIT_MS              20      // 中止后等待流式任务停止输出的最长时间
+
+static void gcode_executor_task(void *pvParameters);
+static void gcode_trajectory_setpoint(const float* offsets, uint8_t axis_count, void* context);
+static gcode_result_t gcode_submit_command(gcode_controller_t* controller, const char* command,
+                                           TickType_t wait);
+static void gcode_setpoint_hook(motor_controller_t* motor, void* context);
+static motor_controller_t* gcode_axis_motor(int axis);
+
+/**
+ * @brief 按结果码累计G代码处理结果（/metrics导出）
+ */
+static inline void gcode_count_result(uint32_t* counters, gcode_result_t result)
+{
+    if ((unsigned)result < MOTOR_METRICS_GCODE_RESULTS) {
+        MOTOR_METRICS_INC(counters[result]);
+    }
+}
+
+/**
+ * @brief 写入响应消息（CAN任务与执行任务共用，互斥保护）
+ */
+static void gcode_set_response(gcode_controller_t* controller, const char* fmt, ...)
+{
+    if (!controller->config.response_buffer) {
+        return;
+    }
+
+    if (controller->response_mutex) {
+        xSemaphoreTake(controller->response_mutex, portMAX_DELAY);
+    }
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(controller->config.response_buffer, controller->config.response_buffer_size, fmt, args);
+    va_end(args);
+    if (controller->response_mutex) {
+        xSemaphoreGive(controller->response_mutex);
+    }
+}
+
+/**
+ * @brief 初始化G代码控制器
+ */
+gcode_controller_t* gcode_controller_init(const gcode_controller_config_t* config)
+{
+    if (!config) {
+        ESP_LOGE(TAG, "配置参数无效");
+        return NULL;
+    }
+
+    gcode_controller_t* controller = malloc(sizeof(gcode_controller_t));
+    if (!controller) {
+        ESP_LOGE(TAG, "内存分配失败");
+        return NULL;
+    }
+
+    memset(controller, 0, sizeof(gcode_controller_t));
+    controller->config = *config;
+    controller->last_line_number = -1;
+
+    controller->response_mutex = xSemaphoreCreateMutex();
+    controller->stop_mutex = xSemaphoreCreateMutex();
+    if (!controller->response_mutex || !controller->stop_mutex) {
+        ESP_LOGE(TAG, "创建互斥锁失败");
+        if (controller->response_mutex) {
+            vSemaphoreDelete(controller->response_mutex);
+        }
+        if (controller->stop_mutex) {
+            vSemaphoreDelete(controller->stop_mutex);
+        }
+        free(controller);
+        return NULL;
+    }
+
+    if (config->motion_queue_depth > 0) {
+        // 解析与执行分离：CAN任务只负责入队，执行任务负责串口发送
+        controller->motion_queue = xQueueCreate(config->motion_queue_depth, sizeof(gcode_line_t));
+        if (!controller->motion_queue) {
+            ESP_LOGE(TAG, "创建运动队列失败");
+            vSemaphoreDelete(controller->response_mutex);
+            vSemaphoreDelete(controller->stop_mutex);
+            free(controller);
+            return NULL;
+        }
+
+        BaseType_t ret = motor_task_create(gcode_executor_task, "gcode_exec", GCODE_EXECUTOR_STACK_SIZE,
+                                           controller, MOTOR_TASK_PRIORITY_GCODE, &controller->executor_task);
+        if (ret != pdPASS) {
+            ESP_LOGE(TAG, "创建G代码执行任务失败");
+            vQueueDelete(controller->motion_queue);
+            vSemaphoreDelete(controller->response_mutex);
+            vSemaphoreDelete(controller->stop_mutex);
+            free(controller);
+            return NULL;
+        }
+    }
+
+    if (config->use_trajectory) {
+        trajectory_generator_config_t trajectory_config = {
+            .rate_hz = config->trajectory_rate_hz,
+            .profile = config->trajectory_profile,
+            .limits = config->trajectory_limits,
+            .setpoint_cb = gcode_trajectory_setpoint,
+            .context = controller
+        };
+        controller->trajectory = trajectory_generator_init(&trajectory_config);
+        if (!controller->trajectory) {
+            // 轨迹发生器不可用时退回驱动器斜坡模式，不影响其他功能
+            ESP_LOGW(TAG, "轨迹发生器初始化失败，G1 X将使用驱动器斜坡模式");
+        }
+    }
+
+    // 任何来源改写电机设定点（HTTP、故障、M0/M1）时中止仍在向该电机输出的轨迹
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_control_set_setpoint_hook(gcode_axis_motor(i), gcode_setpoint_hook, controller);
+    }
+
+    controller->is_initialized = true;
+
+    ESP_LOGI(TAG, "G代码控制器初始化成功 - 运动队列深度: %u", (unsigned)config->motion_queue_depth);
+    return controller;
+}
+
+/**
+ * @brief 销毁G代码控制器
+ */
+void gcode_controller_deinit(gcode_controller_t* controller)
+{
+    if (controller) {
+        controller->is_initialized = false;
+        for (uint8_t i = 0; i < motor_registry_count(); i++) {
+            motor_control_clear_setpoint_hook(gcode_axis_motor(i), controller);
+        }
+        if (controller->executor_task) {
+            vTaskDelete(controller->executor_task);
+        }
+        if (controller->trajectory) {
+            trajectory_generator_deinit(controller->trajectory);
+        }
+        if (controller->motion_queue) {
+            vQueueDelete(controller->motion_queue);
+        }
+        if (controller->response_mutex) {
+            vSemaphoreDelete(controller->response_mutex);
+        }
+        if (controller->stop_mutex) {
+            vSemaphoreDelete(controller->stop_mutex);
+        }
+        free(controller);
+        ESP_LOGI(TAG, "G代码控制器已销毁");
+    }
+}
+
+/**
+ * @brief 检查是否为G代码CAN帧
+ */
+bool gcode_is_gcode_can_frame(const uint8_t* data, size_t length)
+{
+    // 检查CAN ID: 0x0100 (小端格式: 00 01)
+    // 数据格式: [ID_LOW, ID_HIGH, DATA...]
+    return (length >= 2 && data[0] == 0x00 && data[1] == 0x01);
+}
+
+/**
+ * @brief ASCII十六进制解码
+ */
+int gcode_hex_decode(const uint8_t* hex_data, size_t hex_length, 
+                    char* output, size_t output_size)
+{
+    if (!hex_data || !output || hex_length % 2 != 0) {
+        return -1;
+    }
+
+    size_t output_length = hex_length / 2;
+    if (output_length >= output_size) {
+        return -1; // 输出缓冲区不够
+    }
+
+    for (size_t i = 0; i < output_length; i++) {
+        char high_nibble = hex_data[i * 2];
+        char low_nibble = hex_data[i * 2 + 1];
+
+        // 转换高位
+        uint8_t high_value;
+        if (high_nibble >= '0' && high_nibble <= '9') {
+            high_value = high_nibble - '0';
+        } else if (high_nibble >= 'A' && high_nibble <= 'F') {
+            high_value = high_nibble - 'A' + 10;
+        } else if (high_nibble >= 'a' && high_nibble <= 'f') {
+            high_value = high_nibble - 'a' + 10;
+        } else {
+            return -1; // 无效字符
+        }
+
+        // 转换低位
+        uint8_t low_value;
+        if (low_nibble >= '0' && low_nibble <= '9') {
+            low_value = low_nibble - '0';
+        } else if (low_nibble >= 'A' && low_nibble <= 'F') {
+            low_value = low_nibble - 'A' + 10;
+        } else if (low_nibble >= 'a' && low_nibble <= 'f') {
+            low_value = low_nibble - 'a' + 10;
+        } else {
+            return -1; // 无效字符
+        }
+
+        output[i] = (high_value << 4) | low_value;
+    }
+
+    output[output_length] = '\0'; // 添加字符串结束符
+    return output_length;
+}
+
+/**
+ * @brief 结束当前行：原地加结束符并执行
+ * @return 行执行结果，空行返回GCODE_RESULT_OK
+ */
+static gcode_result_t line_ring_complete_line(gcode_controller_t* controller)
+{
+    gcode_line_ring_t* ring = &controller->line_ring;
+    uint16_t length = (uint16_t)(ring->head - ring->tail);
+    char* line = &ring->data[ring->tail & (GCODE_LINE_RING_SIZE - 1)];
+
+    // 镜像保证line[0..length)连续；结束符写在下一个待写位置上，不会破坏有效数据
+    line[length] = '\0';
+    ring->tail = ring->head;
+
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    if (*line == '\0') {
+        return GCODE_RESULT_OK; // 空行（如\r\n中的\n）
+    }
+
+    ring->lines_completed++;
+    return gcode_execute_command(controller, line);
+}
+
+/**
+ * @brief 处理CAN帧数据
+ */
+gcode_result_t gcode_process_can_frame(gcode_controller_t* controller, 
+                                     const uint8_t* data, size_t length)
+{
+    if (!controller || !controller->is_initialized || !data) {
+        return GCODE_RESULT_ERROR;
+    }
+
+    // 检查是否为G代码帧
+    if (!gcode_is_gcode_can_frame(data, length)) {
+        return GCODE_RESULT_INVALID_COMMAND; // 不是G代码帧
+    }
+
+    // 跳过CAN ID (前2字节)
+    const uint8_t* payload = data + 2;
+    size_t payload_length = length - 2;
+
+    if (payload_length == 0) {
+        return GCODE_RESULT_INVALID_PARAMETER;
+    }
+
+    gcode_line_ring_t* ring = &controller->line_ring;
+    gcode_result_t result = GCODE_RESULT_OK;
+
+    for (size_t i = 0; i < payload_length; i++) {
+        uint8_t c = payload[i];
+
+        if (c == '\n' || c == '\r') {
+            if (ring->discarding) {
+                // 超长行到此结束，恢复正常接收
+                ring->discarding = false;
+                ring->tail = ring->head;
+                continue;
+            }
+            gcode_result_t line_result = line_ring_complete_line(controller);
+            if (line_result != GCODE_RESULT_OK && result == GCODE_RESULT_OK) {
+                result = line_result;
+            }
+            continue;
+        }
+
+        // 只保留可打印ASCII字符和制表符，其余（含填充用的0x00）直接丢弃
+        if ((c < 32 || c > 126) && c != '\t') {
+            continue;
+        }
+
+        if (ring->discarding) {
+            ring->overflow_bytes++;
+            continue;
+        }
+
+        if ((uint16_t)(ring->head - ring->tail) >= GCODE_LINE_RING_SIZE) {
+            // 单行超过缓冲区容量：丢弃整行并显式报告，而不是清空缓冲区吞掉后续命令
+            ESP_LOGW(TAG, "G代码行超过%d字节，丢弃该行", GCODE_LINE_RING_SIZE);
+            ring->overflow_count++;
+            ring->overflow_bytes += (uint16_t)(ring->head - ring->tail) + 1;
+            ring->tail = ring->head;
+            ring->discarding = true;
+            result = GCODE_RESULT_BUFFER_FULL;
+            continue;
+        }
+
+        uint16_t index = ring->head & (GCODE_LINE_RING_SIZE - 1);
+        ring->data[index] = (char)c;
+        ring->data[index + GCODE_LINE_RING_SIZE] = (char)c;
+        ring->head++;
+    }
+
+    // 不足8字节的短帧或以0x00填充结尾的帧视为一条命令的最后一帧：主机不发送换行符时也能执行
+    // （补齐到DLC 8的"M1\0\0\0\0\0\0"同样结束该行；无填充的完整8字节帧之后仍等待后续数据，
+    // 避免把"G1 X9"+"0"提前当成X9执行）
+    if (payload_length < 8 || payload[payload_length - 1] == 0x00) {
+        if (ring->discarding) {
+            // 超长行到此结束：不发换行符的主机在丢弃一行后仍能继续发送命令
+            ring->discarding = false;
+            ring->tail = ring->head;
+        } else if (ring->head != ring->tail) {
+            gcode_result_t line_result = line_ring_complete_line(controller);
+            if (line_result != GCODE_RESULT_OK && result == GCODE_RESULT_OK) {
+                result = line_result;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief 逐行提交一段程序
+ * @param wait 运动队列满时等待空位的时间；为0时队列满直接返回GCODE_RESULT_BUFFER_FULL（该行未提交，不计为拒绝）
+ * @param consumed 输出：已提交部分的字节数（行边界）
+ */
+static gcode_result_t gcode_program_lines(gcode_controller_t* controller, char* program, size_t length,
+                                          TickType_t wait, size_t* consumed)
+{
+    size_t line_number = 0;
+    size_t line_start = 0;
+    *consumed = 0;
+    // 提交期间（含队列满暂停续传）队列排空计为欠载
+    __atomic_store_n(&controller->program_feeding, true, __ATOMIC_RELEASE);
+    for (size_t i = 0; i <= length; i++) {
+        if (i < length && program[i] != '\n' && program[i] != '\r') {
+            continue;
+        }
+
+        // 原地切分：把行结束符替换为字符串结束符
+        char saved = (i < length) ? program[i] : '\0';
+        program[i] = '\0';
+        line_number++;
+
+        const char* line = program + line_start;
+        while (*line && isspace((unsigned char)*line)) {
+            line++;
+        }
+        if (*line != '\0') {
+            if (wait == 0 && controller->motion_queue && uxQueueSpacesAvailable(controller->motion_queue) == 0) {
+                program[i] = saved;
+                return GCODE_RESULT_BUFFER_FULL;    // 程序仍在供给，program_feeding保持
+            }
+            gcode_result_t result = gcode_submit_command(controller, line, wait);
+            gcode_count_result(g_motor_metrics.gcode_submit_results, result);
+            if (result != GCODE_RESULT_OK) {
+                ESP_LOGW(TAG, "G代码程序第%u行执行失败(%d)，停止执行: %s",
+                         (unsigned)line_number, result, line);
+                program[i] = saved;
+                __atomic_store_n(&controller->program_feeding, false, __ATOMIC_RELEASE);
+                return result;
+            }
+        }
+
+        program[i] = saved;
+        line_start = i + 1;
+        *consumed = line_start < length ? line_start : length;
+    }
+
+    __atomic_store_n(&controller->program_feeding, false, __ATOMIC_RELEASE);
+    return GCODE_RESULT_OK;
+}
+
+/**
+ * @brief 处理一段完整的G代码程序
+ */
+gcode_result_t gcode_process_program(gcode_controller_t* controller, char* program, size_t length)
+{
+    if (!controller || !controller->is_initialized || !program) {
+        return GCODE_RESULT_ERROR;
+    }
+
+    // 程序整体已在本地缓冲，队列满时等待执行任务腾出空位
+    size_t consumed;
+    return gcode_program_lines(controller, program, length, pdMS_TO_TICKS(GCODE_PROGRAM_ENQUEUE_TIMEOUT_MS),
+                               &consumed);
+}
+
+/**
+ * @brief 提交一段完整的G代码程序，队列满时不等待
+ */
+gcode_result_t gcode_submit_program(gcode_controller_t* controller, char* program, size_t length,
+                                    size_t* consumed)
+{
+    if (!controller || !controller->is_initialized || !program || !consumed) {
+        return GCODE_RESULT_ERROR;
+    }
+    return gcode_program_lines(controller, program, length, 0, consumed);
+}
+
+// 字符分类表：单遍解析时每个字节只查一次表
+typedef enum {
+    CC_OTHER = 0,       // 非法字符
+    CC_SPACE,           // 空白
+    CC_LETTER,          // 字母（大小写）
+    CC_DIGIT,           // 数字
+    CC_SIGN,            // + -
+    CC_DOT,             // 小数点
+    CC_SEMICOLON,       // ; 行尾注释
+    CC_PAREN_OPEN,      // ( 括号注释开始
+    CC_STAR,            // * 校验
+    CC_END              // 字符串结束
+} gcode_char_class_t;
+
+static const uint8_t gcode_char_class[256] = {
+    ['\0'] = CC_END,
+    [' '] = CC_SPACE, ['\t'] = CC_SPACE, ['\r'] = CC_SPACE, ['\n'] = CC_SPACE,
+    ['A' ... 'Z'] = CC_LETTER,
+    ['a' ... 'z'] = CC_LETTER,
+    ['0' ... '9'] = CC_DIGIT,
+    ['+'] = CC_SIGN, ['-'] = CC_SIGN,
+    ['.'] = CC_DOT,
+    [';'] = CC_SEMICOLON,
+    ['('] = CC_PAREN_OPEN,
+    ['*'] = CC_STAR,
+};
+
+// 小数位缩放表，避免逐位浮点除法
+static const float gcode_pow10_inv[] = {
+    1.0f, 1e-1f, 1e-2f, 1e-3f, 1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-8f, 1e-9f
+};
+
+#define GCODE_MAX_SIGNIFICANT_DIGITS 9      // uint32尾数可无溢出累加的有效位数
+
+/**
+ * @brief 解析一个十进制数（不使用strtof）
+ * @param p 输入位置，返回时指向数值之后的字符
+ * @param checksum 同步累计的*校验值
+ * @param value 输出数值
+ * @return 是否至少读取到一个数字
+ */
+static bool gcode_parse_number(const char** p, uint8_t* checksum, float* value)
+{
+    const char* s = *p;
+    uint8_t sum = *checksum;
+    bool negative = false;
+    uint32_t mantissa = 0;
+    int significant = 0;
+    int fraction_digits = 0;
+    int dropped_integer_digits = 0;
+    bool seen_digit = false;
+    bool seen_dot = false;
+
+    if (gcode_char_class[(uint8_t)*s] == CC_SIGN) {
+        negative = (*s == '-');
+        sum ^= (uint8_t)*s++;
+    }
+
+    for (;; s++) {
+        uint8_t cls = gcode_char_class[(uint8_t)*s];
+        if (cls == CC_DIGIT) {
+            seen_digit = true;
+            if (seen_dot) {
+                // 超出精度或缩放表范围的小数位直接忽略
+                if (significant < GCODE_MAX_SIGNIFICANT_DIGITS &&
+                    fraction_digits < GCODE_MAX_SIGNIFICANT_DIGITS) {
+                    mantissa = mantissa * 10 + (uint32_t)(*s - '0');
+                    if (mantissa != 0) {
+                        significant++;
+                    }
+                    fraction_digits++;
+                }
+            } else if (significant < GCODE_MAX_SIGNIFICANT_DIGITS) {
+                mantissa = mantissa * 10 + (uint32_t)(*s - '0');
+                if (mantissa != 0) {
+                    significant++;
+                }
+            } else {
+                dropped_integer_digits++;   // 超出精度的整数位只保留数量级
+            }
+        } else if (cls == CC_DOT && !seen_dot) {
+            seen_dot = true;
+        } else {
+            break;
+        }
+        sum ^= (uint8_t)*s;
+    }
+
+    if (!seen_digit) {
+        return false;
+    }
+
+    float result = (float)mantissa;
+    if (fraction_digits > 0) {
+        result *= gcode_pow10_inv[fraction_digits];
+    }
+    while (dropped_integer_digits-- > 0) {
+        result *= 10.0f;
+    }
+    if (isinf(result)) {
+        return false;   // 整数位过多超出float范围，按无效数值处理，不把inf交给电机
+    }
+
+    *value = negative ? -result : result;
+    *checksum = sum;
+    *p = s;
+    return true;
+}
+
+/**
+ * @brief 单遍解析一行G代码
+ */
+gcode_result_t gcode_parse_line(const char* line, gcode_line_t* parsed)
+{
+    if (!line || !parsed) {
+        return GCODE_RESULT_INVALID_PARAMETER;
+    }
+
+    parsed->word_mask = 0;
+    parsed->line_number = -1;
+    parsed->has_checksum = false;
+    parsed->checksum = 0;
+    parsed->ingest_us = 0;
+
+    const char* p = line;
+    uint8_t running_checksum = 0;
+
+    for (;;) {
+        uint8_t cls = gcode_char_class[(uint8_t)*p];
+        switch (cls) {
+            case CC_SPACE:
+                running_checksum ^= (uint8_t)*p++;
+                break;
+
+            case CC_LETTER: {
+                char letter = *p & ~0x20;               // 转大写
+                running_checksum ^= (uint8_t)*p++;
+                float value;
+                if (!gcode_parse_number(&p, &running_checksum, &value)) {
+                    return GCODE_RESULT_INVALID_PARAMETER; // 字母后没有数值
+                }
+                uint32_t bit = GCODE_WORD_BIT(letter);
+                if (parsed->word_mask & bit) {
+                    return GCODE_RESULT_INVALID_PARAMETER; // 同一字母重复出现
+                }
+                parsed->word_mask |= bit;
+                parsed->values[letter - 'A'] = value;
+                if (letter == 'N') {
+                    parsed->line_number = (int32_t)value;
+                }
+                break;
+            }
+
+            case CC_PAREN_OPEN:
+                // 括号注释：跳到')'，未闭合则视为注释到行尾
+                while (*p && *p != ')') {
+                    running_checksum ^= (uint8_t)*p++;
+                }
+                if (*p == ')') {
+                    running_checksum ^= (uint8_t)*p++;
+                }
+                break;
+
+            case CC_STAR: {
+                p++;
+                uint32_t expected = 0;
+                int digits = 0;
+                while (gcode_char_class[(uint8_t)*p] == CC_DIGIT && digits < 3) {
+                    expected = expected * 10 + (uint32_t)(*p++ - '0');
+                    digits++;
+                }
+                if (digits == 0 || expected > 255) {
+                    return GCODE_RESULT_INVALID_PARAMETER;
+                }
+                parsed->has_checksum = true;
+                parsed->checksum = (uint8_t)expected;
+                if (parsed->checksum != running_checksum) {
+                    return GCODE_RESULT_CHECKSUM_ERROR;
+                }
+                // 校验之后只允许空白或注释
+                while (gcode_char_class[(uint8_t)*p] == CC_SPACE) {
+                    p++;
+                }
+                if (*p != '\0' && *p != ';') {
+                    return GCODE_RESULT_INVALID_PARAMETER;
+                }
+                return GCODE_RESULT_OK;
+            }
+
+            case CC_SEMICOLON:
+            case CC_END:
+                return GCODE_RESULT_OK;
+
+            default:
+                return GCODE_RESULT_INVALID_PARAMETER;
+        }
+    }
+}
+
+/**
+ * @brief 按轴号获取电机控制器
+ */
+static motor_controller_t* gcode_axis_motor(int axis)
+{
+    motor_registry_entry_t* entry = (axis >= 0) ? motor_registry_get((uint8_t)axis) : NULL;
+    return entry ? entry->controller : NULL;
+}
+
+/**
+ * @brief 读取P轴选择字，缺省返回default_axis
+ */
+static int gcode_selected_axis(const gcode_line_t* parsed, int default_axis)
+{
+    if (parsed->word_mask & GCODE_WORD_BIT('P')) {
+        return (int)parsed->values['P' - 'A'];
+    }
+    return default_axis;
+}
+
+/**
+ * @brief 多轴目标位置突发发送，并记录轴间偏差
+ * @param positions 各轴电机位置值
+ */
+static void gcode_burst_positions(gcode_controller_t* controller, motor_controller_t* const* motors,
+                                  const float* positions, uint8_t axis_count)
+{
+    uint32_t skew_us = motor_control_stream_positions(motors, positions, axis_count);
+    if (axis_count > 1) {
+        __atomic_store_n(&controller->queue_stats.axis_skew_last_us, skew_us, __ATOMIC_RELAXED);
+        if (skew_us > MOTOR_METRICS_GET(controller->queue_stats.axis_skew_max_us)) {
+            __atomic_store_n(&controller->queue_stats.axis_skew_max_us, skew_us, __ATOMIC_RELAXED);
+        }
+        if (skew_us > controller->move_skew_max_us) {
+            controller->move_skew_max_us = skew_us;
+        }
+    }
+}
+
+/**
+ * @brief 轨迹发生器设定点回调：各轴相对起点的位移加上起点（双精度）-> 电机位置，同一节拍内突发发送
+ */
+static void gcode_trajectory_setpoint(const float* offsets, uint8_t axis_count, void* context)
+{
+    gcode_controller_t* controller = (gcode_controller_t*)context;
+    float positions[MOTOR_REGISTRY_MAX_MOTORS];
+    for (uint8_t i = 0; i < axis_count; i++) {
+        positions[i] = motor_units_absolute_to_position((uint8_t)controller->trajectory_axes[i],
+                                                        controller->trajectory_base[i] + offsets[i]);
+    }
+    gcode_burst_positions(controller, controller->trajectory_motors, positions, axis_count);
+}
+
+/**
+ * @brief 该轴的目标不再可信（速度/力矩/M命令或运动被中止）
+ */
+static void gcode_forget_target(gcode_controller_t* controller, int axis)
+{
+    if (axis >= 0 && axis < MOTOR_REGISTRY_MAX_MOTORS) {
+        controller->commanded_state[axis] = GCODE_TARGET_UNKNOWN;
+    }
+}
+
+/**
+ * @brief 取出当前命令之后是否有停止请求
+ */
+static bool gcode_stop_requested(gcode_controller_t* controller)
+{
+    return __atomic_load_n(&controller->stop_requests, __ATOMIC_ACQUIRE) != controller->executing_stop_requests;
+}
+
+/**
+ * @brief 停止G代码运动：丢弃排队命令，中止正在输出的轨迹并等待流式任务停止（有界）
+ * 不获取轨迹完成信号量（只属于执行任务），执行任务发现停止请求后自行结束当前运动
+ * @param reason 日志中的停止原因
+ */
+static void gcode_stop_motion(gcode_controller_t* controller, const char* reason)
+{
+    // 与执行任务取命令互斥：清空之前取出的命令一定能看到停止请求，之后取出的都是新入队的命令
+    xSemaphoreTake(controller->stop_mutex, portMAX_DELAY);
+    __atomic_add_fetch(&controller->stop_requests, 1, __ATOMIC_ACQ_REL);
+    UBaseType_t waiting = 0;
+    if (controller->motion_queue) {
+        waiting = uxQueueMessagesWaiting(controller->motion_queue);
+        xQueueReset(controller->motion_queue);
+        MOTOR_METRICS_ADD(controller->queue_stats.flushed, waiting);
+    }
+    xSemaphoreGive(controller->stop_mutex);
+
+    if (controller->trajectory) {
+        trajectory_generator_abort(controller->trajectory);
+        for (uint32_t waited_ms = 0; trajectory_generator_is_active(controller->trajectory) &&
+                                     waited_ms < GCODE_STOP_WAIT_MS; waited_ms += portTICK_PERIOD_MS) {
+            vTaskDelay(1);
+        }
+    }
+    ESP_LOGW(TAG, "%s: 停止G代码运动，丢弃%u条排队命令", reason, (unsigned)waiting);
+}
+
+/**
+ * @brief 电机设定点代次变化通知：改写的是正在输出轨迹的电机时停止G代码运动
+ * 在改写者的任务中、其命令发送之前执行，返回后流式设定点不会再覆盖该命令
+ */
+static void gcode_setpoint_hook(motor_controller_t* motor, void* context)
+{
+    gcode_controller_t* controller = (gcode_controller_t*)context;
+    if (!controller->trajectory || !trajectory_generator_is_active(controller->trajectory)) {
+        return;
+    }
+    for (uint8_t i = 0; i < controller->trajectory_axis_count; i++) {
+        if (controller->trajectory_motors[i] == motor) {
+            gcode_stop_motion(controller, "设定点被其他来源改写");
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 等待轨迹运动结束：期间有停止请求，或超过规划时长加裕量仍未结束时中止
+ */
+static void gcode_wait_trajectory(gcode_controller_t* controller)
+{
+    trajectory_generator_t* trajectory = controller->trajectory;
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)(trajectory->plan.total_time * 1000000.0f) +
+                          (int64_t)GCODE_TRAJECTORY_MARGIN_MS * 1000;
+    while (!trajectory_generator_wait_done(trajectory, pdMS_TO_TICKS(GCODE_TRAJECTORY_POLL_MS))) {
+        bool stopped = gcode_stop_requested(controller);
+        if (stopped || esp_timer_get_time() > deadline_us) {
+            if (!stopped) {
+                ESP_LOGW(TAG, "轨迹超过规划时长仍未结束，强制中止");
+            }
+            trajectory_generator_abort(trajectory);
+            trajectory_generator_wait_done(trajectory, pdMS_TO_TICKS(GCODE_STOP_WAIT_MS));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 获取一个轴的当前绝对角度
+ * 上一条G代码位置运动已完成（轨迹结束，或斜坡运动经编码器确认到达）且其后设定点未被其他来源改写时取其目标，
+ * 否则查询编码器展开计数
+ * @param trusted 输出：结果是否为已确认到达的目标（可作为轨迹起点）
+ * @return 需要查询编码器但无响应时返回false
+ */
+static bool gcode_current_angle(gcode_controller_t* controller, int axis, motor_controller_t* motor,
+                                double* angle, bool* trusted)
+{
+    *trusted = false;
+    if (controller->commanded_state[axis] != GCODE_TARGET_UNKNOWN &&
+        motor_control_setpoint_epoch(motor) != controller->commanded_epoch[axis]) {
+        // HTTP、驱动器故障等改写过设定点
+        controller->commanded_state[axis] = GCODE_TARGET_UNKNOWN;
+    }
+    if (controller->commanded_state[axis] == GCODE_TARGET_REACHED) {
+        *angle = controller->commanded_angle[axis];
+        *trusted = true;
+        return true;
+    }
+
+    int64_t count;
+    if (!motor_control_query_absolute_count(motor, GCODE_ENCODER_WAIT_MS, &count)) {
+        return false;
+    }
+    *angle = motor_units_count_to_angle((uint8_t)axis, count);
+
+    if (controller->commanded_state[axis] == GCODE_TARGET_PENDING) {
+        // 单圈轴的目标归一化在[0, 360)，按整圈取模比较
+        double error = *angle - controller->commanded_angle[axis];
+        const motor_units_axis_t* units = motor_units_axis((uint8_t)axis);
+        if (units && units->turn_mode == MOTOR_UNITS_SINGLE_TURN) {
+            error = remainder(error, 360.0);
+        }
+        if (fabs(error) <= GCODE_TARGET_CONFIRM_DEG) {
+            controller->commanded_state[axis] = GCODE_TARGET_REACHED;
+            *angle = controller->commanded_angle[axis];
+            *trusted = true;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 多轴协调位置运动：各轴同时开始、同时结束
+ */
+static gcode_result_t gcode_move_axes(gcode_controller_t* controller, uint8_t axis_count,
+                                      const int* axes, const float* angles)
+{
+    motor_controller_t* motors[MOTOR_REGISTRY_MAX_MOTORS];
+    double start[MOTOR_REGISTRY_MAX_MOTORS];
+    double target[MOTOR_REGISTRY_MAX_MOTORS];
+    uint32_t epoch[MOTOR_REGISTRY_MAX_MOTORS];
+    bool start_known = true;
+
+    for (uint8_t i = 0; i < axis_count; i++) {
+        motors[i] = gcode_axis_motor(axes[i]);
+        if (!motors[i]) {
+            return GCODE_RESULT_INVALID_PARAMETER;
+        }
+
+        // 相对运动与最短路径需要当前位置；轨迹需要可信的起点，否则由驱动器斜坡模式完成
+        bool needs_current = motor_units_needs_current((uint8_t)axes[i], controller->relative);
+        bool trusted = false;
+        start[i] = controller->commanded_angle[axes[i]];
+        if (needs_current || (controller->trajectory && controller->commanded_state[axes[i]] != GCODE_TARGET_UNKNOWN)) {
+            if (!gcode_current_angle(controller, axes[i], motors[i], &start[i], &trusted) && needs_current) {
+                gcode_set_response(controller, "ERROR - 轴%d 当前位置未知（编码器无响应）", axes[i]);
+                return GCODE_RESULT_MOTOR_ERROR;
+            }
+        }
+        start_known = start_known && trusted;
+
+        target[i] = motor_units_resolve_target((uint8_t)axes[i], start[i], angles[i], controller->relative);
+        FLIGHT_RECORDER_COMMAND(motors[i]->driver_config.uart_port, motors[i]->driver_config.node_id,
+                                FLIGHT_COMMAND_MOVE, (float)target[i]);
+    }
+
+    controller->move_skew_max_us = 0;
+    if (axis_count > 1) {
+        MOTOR_METRICS_INC(controller->queue_stats.coordinated_moves);
+    }
+
+    for (uint8_t i = 0; i < axis_count; i++) {
+        controller->commanded_angle[axes[i]] = target[i];
+    }
+
+    if (controller->trajectory && start_known) {
+        // 设备端轨迹：驱动器直通跟随，按F(r/s)限制位移最大轴的速度，运动结束后才执行下一条
+        float max_velocity = controller->feed_rate > 0.0f ? controller->feed_rate * 360.0f : 0.0f;
+        for (uint8_t i = 0; i < axis_count; i++) {
+            motor_control_set_position_passthrough_mode(motors[i]);
+            epoch[i] = motor_control_setpoint_epoch(motors[i]);
+        }
+        // 按相对起点的位移规划（float），起点保留在双精度中：多圈轴远离零点时设定点分辨率不下降
+        float zero[MOTOR_REGISTRY_MAX_MOTORS] = {0};
+        float distance[MOTOR_REGISTRY_MAX_MOTORS];
+        for (uint8_t i = 0; i < axis_count; i++) {
+            distance[i] = (float)(target[i] - start[i]);
+        }
+        memcpy(controller->trajectory_motors, motors, sizeof(motors[0]) * axis_count);
+        memcpy(controller->trajectory_axes, axes, sizeof(axes[0]) * axis_count);
+        memcpy(controller->trajectory_base, start, sizeof(start[0]) * axis_count);
+        controller->trajectory_axis_count = axis_count;
+        uint32_t aborted = controller->trajectory->stats.moves_aborted;
+        if (gcode_stop_requested(controller) ||
+            !trajectory_generator_start_move_multi(controller->trajectory, axis_count, zero, distance,
+                                                   max_velocity)) {
+            for (uint8_t i = 0; i < axis_count; i++) {
+                gcode_forget_target(controller, axes[i]);
+            }
+            return GCODE_RESULT_MOTOR_ERROR;
+        }
+        gcode_wait_trajectory(controller);
+
+        // 轨迹走完且期间没有其他来源改写设定点：终点即当前位置
+        bool completed = !trajectory_generator_is_active(controller->trajectory) &&
+                         controller->trajectory->stats.moves_aborted == aborted;
+        for (uint8_t i = 0; i < axis_count; i++) {
+            controller->commanded_epoch[axes[i]] = epoch[i];
+            controller->commanded_state[axes[i]] =
+                completed && motor_control_setpoint_epoch(motors[i]) == epoch[i] ? GCODE_TARGET_REACHED
+                                                                                  : GCODE_TARGET_UNKNOWN;
+        }
+        gcode_set_response(controller, "OK - %d轴轨迹位置模式, 时长 %.3f s, 最大轴间偏差 %lu us",
+                           axis_count, controller->trajectory->plan.total_time,
+                           (unsigned long)controller->move_skew_max_us);
+    } else {
+        // 起点不可信（上电后第一次、速度/力矩之后、斜坡运动尚未确认到达）或未启用轨迹：
+        // 由驱动器斜坡模式完成，目标位置一次突发发送，到达后经编码器反馈确认才作为后续运动的起点
+        float positions[MOTOR_REGISTRY_MAX_MOTORS];
+        for (uint8_t i = 0; i < axis_count; i++) {
+            motor_control_set_position_mode(motors[i]);
+            controller->commanded_epoch[axes[i]] = motor_control_setpoint_epoch(motors[i]);
+            controller->commanded_state[axes[i]] = GCODE_TARGET_PENDING;
+            positions[i] = motor_units_absolute_to_position((uint8_t)axes[i], target[i]);
+        }
+        gcode_burst_positions(controller, motors, positions, axis_count);
+        gcode_set_response(controller, "OK - %d轴位置模式, 最大轴间偏差 %lu us",
+                           axis_count, (unsigned long)controller->move_skew_max_us);
+    }
+
+    return GCODE_RESULT_OK;
+}
+
+/**
+ * @brief 命令带有到达时间时开始测量该轴的命令->反馈延迟
+ */
+static void gcode_latency_begin(motor_controller_t* motor, const gcode_line_t* parsed)
+{
+    if (parsed->ingest_us) {
+        motor_control_latency_begin(motor, parsed->ingest_us);
+    }
+}
+
+/**
+ * @brief 执行G1命令
+ */
+gcode_result_t gcode_execute_g1(gcode_controller_t* controller, const gcode_line_t* parsed)
+{
+    if (!controller || !parsed) {
+        return GCODE_RESULT_ERROR;
+    }
+
+    uint32_t mask = parsed->word_mask;
+    uint32_t axis_mask = mask & GCODE_AXIS_WORD_MASK;
+
+    if (axis_mask) {
+        // 位置模式；同一行的F作为模态进给速度保存
+        if (mask & GCODE_WORD_BIT('F')) {
+            controller->feed_rate = parsed->values['F' - 'A'];
+        }
+
+        // 同一行的各轴组成一次协调运动
+        int axes[MOTOR_REGISTRY_MAX_MOTORS];
+        float angles[MOTOR_REGISTRY_MAX_MOTORS];
+        uint8_t axis_count = 0;
+        for (int axis = 0; axis < MOTOR_REGISTRY_MAX_MOTORS; axis++) {
+            char letter = GCODE_AXIS_LETTERS[axis];
+            if (mask & GCODE_WORD_BIT(letter)) {
+                gcode_latency_begin(gcode_axis_motor(axis), parsed);
+                axes[axis_count] = axis;
+                angles[axis_count] = parsed->values[letter - 'A'];
+                ESP_LOGI(TAG, "执行G1命令: %c%.2f (F%.2f)", letter, angles[axis_count], controller->feed_rate);
+                axis_count++;
+            }
+        }
+        return gcode_move_axes(controller, axis_count, axes, angles);
+    } else if (mask & GCODE_WORD_BIT('F')) {
+        // 速度模式
+        int axis = gcode_selected_axis(parsed, 0);
+        motor_controller_t* motor = gcode_axis_motor(axis);
+        if (!motor) {
+            return GCODE_RESULT_INVALID_PARAMETER;
+        }
+        float value = parsed->values['F' - 'A'];
+        ESP_LOGI(TAG, "执行G1命令: F%.2f P%d", value, axis);
+        gcode_latency_begin(motor, parsed);
+        gcode_forget_target(controller, axis);
+        motor_control_set_velocity_mode(motor);
+        float velocity = motor_units_velocity_to_internal((uint8_t)axis, value);
+        motor_control_set_velocity(motor, velocity);
+        gcode_set_response(controller, "OK - 轴%d 速度模式: %.2f r/s -> %.2f r/s", axis, value, velocity);
+    } else if (mask & GCODE_WORD_BIT('T')) {
+        // 力矩模式
+        int axis = gcode_selected_axis(parsed, 0);
+        motor_controller_t* motor = gcode_axis_motor(axis);
+        if (!motor) {
+            return GCODE_RESULT_INVALID_PARAMETER;
+        }
+        float value = parsed->values['T' - 'A'];
+        ESP_LOGI(TAG, "执行G1命令: T%.2f P%d", value, axis);
+        gcode_latency_begin(motor, parsed);
+        gcode_forget_target(controller, axis);
+        motor_control_set_torque_mode(motor);
+        float torque = motor_units_torque_to_internal((uint8_t)axis, value);
+        motor_control_set_torque(motor, torque);
+        gcode_set_response(controller, "OK - 轴%d 力矩模式: %.2f Nm -> %.2f Nm", axis, value, torque);
+    } else {
+        return GCODE_RESULT_INVALID_PARAMETER;
+    }
+
+    return GCODE_RESULT_OK;
+}
+
+/**
+ * @brief 执行M命令
+ * @param axis 目标轴，-1表示全部轴
+ */
+gcode_result_t gcode_execute_m(gcode_controller_t* controller, int m_code, int axis)
+{
+    if (!controller) {
+        return GCODE_RESULT_ERROR;
+    }
+
+    if (m_code != 0 && m_code != 1) {
+        return GCODE_RESULT_INVALID_COMMAND;
+    }
+
+    int first = (axis < 0) ? 0 : axis;
+    int last = (axis < 0) ? (int)motor_registry_count() - 1 : axis;
+    if (first > last || !gcode_axis_motor(last)) {
+        return GCODE_RESULT_INVALID_PARAMETER;
+    }
+
+    ESP_LOGI(TAG, "执行M命令: M%d (轴 %d-%d)", m_code, first, last);
+
+    // M0 - 失能电机，M1 - 使能电机
+    for (int i = first; i <= last; i++) {
+        // 失能后电机可被外力转动，重新使能后也从编码器读取起点
+        gcode_forget_target(controller, i);
+        motor_control_enable(gcode_axis_motor(i), m_code == 1);
+    }
+
+    if (axis < 0) {
+        gcode_set_response(controller, "OK - 全部电机已%s", m_code == 1 ? "使能" : "失能");
+    } else {
+        gcode_set_response(controller, "OK - 轴%d 电机已%s", axis, m_code == 1 ? "使能" : "失能");
+    }
+
+    return GCODE_RESULT_OK;
+}
+
+/**
+ * @brief 检查已解析的命令是否受支持（入队前同步校验，错误可立即回报给主机）
+ */
+static gcode_result_t gcode_validate_parsed(const gcode_line_t* parsed)
+{
+    uint32_t mask = parsed->word_mask;
+
+    if (mask & GCODE_WORD_BIT('G')) {
+        int g_code = (int)parsed->values['G' - 'A'];
+        if (g_code == 90 || g_code == 91) {
+            // 距离模式只改变模态状态，不涉及电机
+            uint32_t motion_mask = GCODE_AXIS_WORD_MASK | GCODE_WORD_BIT('F') | GCODE_WORD_BIT('T') | GCODE_WORD_BIT('P');
+            return (mask & motion_mask) ? GCODE_RESULT_INVALID_PARAMETER : GCODE_RESULT_OK;
+        }
+        if (g_code != 0 && g_code != 1) {
+            return GCODE_RESULT_INVALID_COMMAND;
+        }
+        uint32_t axis_mask = mask & GCODE_AXIS_WORD_MASK;
+        if (!(axis_mask | (mask & (GCODE_WORD_BIT('F') | GCODE_WORD_BIT('T'))))) {
+            return GCODE_RESULT_INVALID_PARAMETER;
+        }
+        // 轴字母对应的电机必须已注册，且已完成上电握手
+        bool ready = true;
+        for (int axis = 0; axis < MOTOR_REGISTRY_MAX_MOTORS; axis++) {
+            if (axis_mask & GCODE_WORD_BIT(GCODE_AXIS_LETTERS[axis])) {
+                motor_controller_t* motor = gcode_axis_motor(axis);
+                if (!motor) {
+                    return GCODE_RESULT_INVALID_PARAMETER;
+                }
+                ready = ready && motor_control_is_ready(motor);
+            }
+        }
+        if (!axis_mask) {
+            motor_controller_t* motor = gcode_axis_motor(gcode_selected_axis(parsed, 0));
+            if (!motor) {
+                return GCODE_RESULT_INVALID_PARAMETER;
+            }
+            ready = motor_control_is_ready(motor);
+        }
+        return ready ? GCODE_RESULT_OK : GCODE_RESULT_NOT_READY;
+    }
+
+    if (mask & GCODE_WORD_BIT('M')) {
+        int m_code = (int)parsed->values['M' - 'A'];
+        if (m_code != 0 && m_code != 1) {
+            return GCODE_RESULT_INVALID_COMMAND;
+        }
+        int axis = gcode_selected_axis(parsed, -1);
+        if (axis >= 0 && !gcode_axis_motor(axis)) {
+            return GCODE_RESULT_INVALID_PARAMETER;
+        }
+        if (motor_registry_count() == 0) {
+            return GCODE_RESULT_ERROR;
+        }
+        // M0失能任何时候都允许；M1使能须等相关电机就绪（上电模式已设置）
+        if (m_code == 1) {
+            for (uint8_t i = 0; i < motor_registry_count(); i++) {
+                if ((axis < 0 || axis == i) && !motor_control_is_ready(gcode_axis_motor(i))) {
+                    return GCODE_RESULT_NOT_READY;
+                }
+            }
+        }
+        return GCODE_RESULT_OK;
+    }
+
+    return GCODE_RESULT_INVALID_COMMAND;
+}
+
+/**
+ * @brief 执行已解析并校验过的命令
+ */
+static gcode_result_t gcode_execute_parsed(gcode_controller_t* controller, const gcode_line_t* parsed)
+{
+    if (parsed->word_mask & GCODE_WORD_BIT('N')) {
+        controller->last_line_number = parsed->line_number;
+    }
+
+    if (parsed->word_mask & GCODE_WORD_BIT('G')) {
+        int g_code = (int)parsed->values['G' - 'A'];
+        if (g_code == 90 || g_code == 91) {
+            controller->relative = (g_code == 91);
+            gcode_set_response(controller, "OK - %s坐标模式", controller->relative ? "相对" : "绝对");
+            return GCODE_RESULT_OK;
+        }
+        // G0/G1 - 本控制器不区分快速移动与直线插补
+        return gcode_execute_g1(controller, parsed);
+    }
+    return gcode_execute_m(controller, (int)parsed->values['M' - 'A'], gcode_selected_axis(parsed, -1));
+}
+
+/**
+ * @brief 主机是否仍在供给命令：程序尚未提交完，或最近两行的到达间隔与距今时间都在underrun_window_ms以内
+ * （孤立的单条命令执行完排空队列不算）
+ */
+static bool gcode_feed_active(gcode_controller_t* controller)
+{
+    if (__atomic_load_n(&controller->program_feeding, __ATOMIC_ACQUIRE)) {
+        return true;
+    }
+    uint32_t window_us = controller->config.underrun_window_ms * 1000;
+    uint32_t since_us = (uint32_t)esp_timer_get_time() - MOTOR_METRICS_GET(controller->last_enqueue_us);
+    return window_us > 0 && since_us < window_us && MOTOR_METRICS_GET(controller->last_enqueue_gap_us) < window_us;
+}
+
+/**
+ * @brief 运动执行任务：从运动队列取出命令并发送到电机
+ */
+static void gcode_executor_task(void *pvParameters)
+{
+    gcode_controller_t* controller = (gcode_controller_t*)pvParameters;
+    gcode_line_t parsed;
+
+    ESP_LOGI(TAG, "G代码执行任务启动成功");
+
+    while (true) {
+        if (xQueuePeek(controller->motion_queue, &parsed, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // 取命令与停止请求互斥：命令被M0或外部改写清空后不会再执行
+        xSemaphoreTake(controller->stop_mutex, portMAX_DELAY);
+        bool received = xQueueReceive(controller->motion_queue, &parsed, 0) == pdTRUE;
+        controller->executing_stop_requests = __atomic_load_n(&controller->stop_requests, __ATOMIC_ACQUIRE);
+        xSemaphoreGive(controller->stop_mutex);
+        if (!received) {
+            continue;
+        }
+        if (gcode_stop_requested(controller)) {
+            // 取出后、执行前发生了停止
+            MOTOR_METRICS_INC(controller->queue_stats.flushed);
+            continue;
+        }
+
+        gcode_result_t result = gcode_execute_parsed(controller, &parsed);
+        gcode_count_result(g_motor_metrics.gcode_execute_results, result);
+        MOTOR_METRICS_INC(controller->queue_stats.executed);
+        if (result != GCODE_RESULT_OK) {
+            MOTOR_METRICS_INC(controller->queue_stats.execute_errors);
+            ESP_LOGW(TAG, "队列命令执行失败: %d", result);
+        }
+        if (uxQueueMessagesWaiting(controller->motion_queue) == 0 && gcode_feed_active(controller)) {
+            // 主机仍在供给时队列排空（在排空时计数，每次排空一次）：下一条命令到达前电机停下，运动不连续
+            MOTOR_METRICS_INC(controller->queue_stats.underruns);
+        }
+    }
+}
+
+/**
+ * @brief 解析一行命令，并入队或直接执行
+ * @param wait 运动队列满时等待空位的时间
+ */
+static gcode_result_t gcode_submit_command(gcode_controller_t* controller, const char* command,
+                                           TickType_t wait)
+{
+    if (!controller || !command) {
+        return GCODE_RESULT_INVALID_PARAMETER;
+    }
+
+    ESP_LOGI(TAG, "收到G代码命令: %s", command);
+
+    uint32_t ingest_us = (uint32_t)esp_timer_get_time();
+    gcode_line_t parsed;
+    gcode_result_t result = gcode_parse_line(command, &parsed);
+    if (result != GCODE_RESULT_OK) {
+        gcode_set_response(controller, result == GCODE_RESULT_CHECKSUM_ERROR ?
+                           "ERROR - 校验错误: %s" : "ERROR - 命令格式无效: %s", command);
+        return result;
+    }
+
+    if (parsed.word_mask == 0) {
+        return GCODE_RESULT_OK; // 纯注释行，无需执行
+    }
+    parsed.ingest_us = ingest_us;
+
+    result = gcode_validate_parsed(&parsed);
+    if (result == GCODE_RESULT_INVALID_PARAMETER) {
+        gcode_set_response(controller, "ERROR - G1命令参数无效");
+        return result;
+    } else if (result == GCODE_RESULT_NOT_READY) {
+        gcode_set_response(controller, "ERROR - 电机未就绪: %s", command);
+        return result;
+    } else if (result != GCODE_RESULT_OK) {
+        gcode_set_response(controller, "ERROR - 未知命令: %s", command);
+        return result;
+    }
+
+    if (!controller->motion_queue) {
+        controller->executing_stop_requests = __atomic_load_n(&controller->stop_requests, __ATOMIC_ACQUIRE);
+        return gcode_execute_parsed(controller, &parsed);
+    }
+
+    if ((parsed.word_mask & GCODE_WORD_BIT('M')) && (int)parsed.values['M' - 'A'] == 0) {
+        // M0不排在运动之后：先中止正在执行的轨迹并清空队列，失能紧接着执行
+        gcode_stop_motion(controller, "M0");
+    }
+
+    if (xQueueSend(controller->motion_queue, &parsed, wait) != pdTRUE) {
+        MOTOR_METRICS_INC(controller->queue_stats.rejected);
+        gcode_set_response(controller, "ERROR - 运动队列已满(%u)", 
+                           (unsigned)controller->config.motion_queue_depth);
+        return GCODE_RESULT_BUFFER_FULL;
+    }
+
+    MOTOR_METRICS_INC(controller->queue_stats.enqueued);
+    uint32_t depth = uxQueueMessagesWaiting(controller->motion_queue);
+    if (depth > MOTOR_METRICS_GET(controller->queue_stats.high_watermark)) {
+        __atomic_store_n(&controller->queue_stats.high_watermark, depth, __ATOMIC_RELAXED);
+    }
+    gcode_set_response(controller, "OK - 已入队 (队列深度: %lu)", (unsigned long)depth);
+    return GCODE_RESULT_OK;
+}
+
+/**
+ * @brief 解析并执行G代码命令
+ */
+gcode_result_t gcode_execute_command(gcode_controller_t* controller, const char* command)
+{
+    // 单条命令不阻塞CAN接收：队列满时立即返回GCODE_RESULT_BUFFER_FULL
+    gcode_result_t result = gcode_submit_command(controller, command, 0);
+    gcode_count_result(g_motor_metrics.gcode_submit_results, result);
+    if (result == GCODE_RESULT_OK && controller && controller->motion_queue) {
+        // 逐行发送的命令流：记录到达间隔，供执行任务判断排空时主机是否仍在发送
+        uint32_t now_us = (uint32_t)esp_timer_get_time();
+        __atomic_store_n(&controller->last_enqueue_gap_us, now_us - MOTOR_METRICS_GET(controller->last_enqueue_us),
+                         __ATOMIC_RELAXED);
+        __atomic_store_n(&controller->last_enqueue_us, now_us, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+/**
+ * @brief 获取运动队列统计信息
+ */
+bool gcode_get_queue_stats(gcode_controller_t* controller, gcode_queue_stats_t* stats)
+{
+    if (!controller || !stats || !controller->motion_queue) {
+        return false;
+    }
+
+    // 各计数器由CAN任务与执行任务原子更新，逐项原子读取
+    const gcode_queue_stats_t* source = &controller->queue_stats;
+    stats->high_watermark = MOTOR_METRICS_GET(source->high_watermark);
+    stats->enqueued = MOTOR_METRICS_GET(source->enqueued);
+    stats->executed = MOTOR_METRICS_GET(source->executed);
+    stats->execute_errors = MOTOR_METRICS_GET(source->execute_errors);
+    stats->rejected = MOTOR_METRICS_GET(source->rejected);
+    stats->flushed = MOTOR_METRICS_GET(source->flushed);
+    stats->underruns = MOTOR_METRICS_GET(source->underruns);
+    stats->coordinated_moves = MOTOR_METRICS_GET(source->coordinated_moves);
+    stats->axis_skew_last_us = MOTOR_METRICS_GET(source->axis_skew_last_us);
+    stats->axis_skew_max_us = MOTOR_METRICS_GET(source->axis_skew_max_us);
+    stats->depth = uxQueueMessagesWaiting(controller->motion_queue);
+    stats->capacity = controller->config.motion_queue_depth;
+    return true;
+}
+
+/**
+ * @brief 获取最后一次操作的响应消息（在响应互斥锁内复制，不会读到执行任务写了一半的内容）
+ */
+const char* gcode_get_response(gcode_controller_t* controller, char* buffer, size_t size)
+{
+    if (!buffer || size == 0) {
+        return "ERROR - 无响应缓冲区";
+    }
+    if (!controller || !controller->config.response_buffer) {
+        snprintf(buffer, size, "ERROR - 无响应缓冲区");
+        return buffer;
+    }
+
+    if (controller->response_mutex) {
+        xSemaphoreTake(controller->response_mutex, portMAX_DELAY);
+    }
+    snprintf(buffer, size, "%s", controller->config.response_buffer);
+    if (controller->response_mutex) {
+        xSemaphoreGive(controller->response_mutex);
+    }
+    return buffer;
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#ifndef GCODE_UNIFIED_CONTROL_H
+#define GCODE_UNIFIED_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "motor_control.h"
+#include "motor_registry.h"
+#include "trajectory_generator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 行重组环形缓冲区容量（必须为2的幂，单行最长不超过该值）
+#define GCODE_LINE_RING_SIZE 256
+
+// G代码行重组环形缓冲区
+// 每个字节同时写入 i 和 i+SIZE 两处（镜像），任何不超过SIZE的行在内存中都是连续的，
+// 因此可以直接在缓冲区内原地解析，无需拷贝或memmove
+typedef struct {
+    char data[GCODE_LINE_RING_SIZE * 2 + 1]; // 镜像存储区
+    uint16_t head;                      // 写入计数（自由递增，取模使用）
+    uint16_t tail;                      // 当前未完成行的起始计数
+    bool discarding;                    // 溢出后丢弃数据直到下一个行结束符
+    uint32_t lines_completed;           // 已切分出的完整行数
+    uint32_t overflow_count;            // 溢出次数（超长行被丢弃）
+    uint32_t overflow_bytes;            // 因溢出丢弃的字节数
+} gcode_line_ring_t;
+
+// 单行G代码解析结果（定长，无动态分配）
+#define GCODE_WORD_COUNT 26                         // 字母A-Z
+#define GCODE_WORD_BIT(letter) (1UL << ((letter) - 'A'))
+#define GCODE_AXIS_LETTERS "XYZABC"                 // 轴0-5的字母（与电机注册表顺序一致）
+#define GCODE_AXIS_WORD_MASK (GCODE_WORD_BIT('X') | GCODE_WORD_BIT('Y') | GCODE_WORD_BIT('Z') | \
+                              GCODE_WORD_BIT('A') | GCODE_WORD_BIT('B') | GCODE_WORD_BIT('C'))
+
+typedef struct {
+    uint32_t word_mask;                   // 出现过的字母位掩码 (bit0='A' ... bit25='Z')
+    float values[GCODE_WORD_COUNT];       // 各字母对应的数值，按word_mask判断是否有效
+    int32_t line_number;                  // N行号（word_mask含N时有效）
+    bool has_checksum;                    // 是否带有*校验
+    uint8_t checksum;                     // *后面的校验值
+    uint32_t ingest_us;                   // 整行到达时间（esp_timer微秒低32位，0表示未记录），用于命令->反馈延迟统计
+} gcode_line_t;
+
+// G代码控制器配置结构（电机通过电机注册表按轴查找，X/Y/Z/A/B/C对应轴0-5）
+typedef struct {
+    char* response_buffer;                 // 响应缓冲区
+    size_t response_buffer_size;          // 响应缓冲区大小
+    uint16_t motion_queue_depth;          // 运动队列深度（0表示在调用者任务中同步执行）
+    bool use_trajectory;                  // G1 X是否由设备端轨迹发生器生成设定点流
+    uint32_t trajectory_rate_hz;          // 设定点输出频率 (Hz)
+    trajectory_profile_t trajectory_profile; // 速度曲线类型
+    trajectory_limits_t trajectory_limits;   // 运动约束（输出轴：度/s、度/s²、度/s³）
+    uint32_t underrun_window_ms;          // 逐行命令流的欠载判定窗口（最近两行到达间隔与距今都在窗口内视为仍在发送，0表示只看程序提交）
+} gcode_controller_config_t;
+
+// 运动队列统计信息
+typedef struct {
+    uint32_t depth;                       // 当前队列中的命令数
+    uint32_t capacity;                    // 队列容量
+    uint32_t high_watermark;              // 历史最大深度
+    uint32_t enqueued;                    // 已入队命令数
+    uint32_t executed;                    // 已执行命令数
+    uint32_t execute_errors;              // 执行失败次数
+    uint32_t rejected;                    // 队列满被拒绝的命令数
+    uint32_t flushed;                     // 停止（M0、运动中设定点被其他来源改写）时丢弃的排队命令数
+    uint32_t underruns;                   // 主机仍在供给时队列排空的次数（程序未提交完，或命令流仍在窗口内到达），运动不连续
+    uint32_t coordinated_moves;           // 多轴协调运动次数
+    uint32_t axis_skew_last_us;           // 最近一次多轴突发发送的轴间偏差 (us)
+    uint32_t axis_skew_max_us;            // 历史最大轴间偏差 (us)
+} gcode_queue_stats_t;
+
+// G代码各轴已下发目标的可信程度（决定相对/最短路径运动的起点与能否走轨迹）
+typedef enum {
+    GCODE_TARGET_UNKNOWN = 0,             // 未知：上电后、速度/力矩/M命令之后、运动被中止或设定点被其他来源改写
+    GCODE_TARGET_PENDING,                 // 斜坡模式已下发，等待编码器反馈确认到达
+    GCODE_TARGET_REACHED                  // 轨迹运动完成，或编码器反馈已确认到达
+} gcode_target_state_t;
+
+// G代码控制器句柄
+typedef struct {
+    gcode_controller_config_t config;     // 配置信息
+    gcode_line_ring_t line_ring;          // 命令行重组环形缓冲区
+    float feed_rate;                      // 模态进给速度F (r/s)，随G1 X.. F..更新
+    bool relative;                        // 模态距离模式：G90绝对（默认）/ G91相对
+    int32_t last_line_number;             // 最后执行的N行号（-1表示未使用行号）
+    QueueHandle_t motion_queue;           // 运动队列（元素为gcode_line_t）
+    TaskHandle_t executor_task;           // 运动执行任务句柄
+    SemaphoreHandle_t response_mutex;     // 响应缓冲区互斥锁
+    trajectory_generator_t* trajectory;   // 轨迹发生器（未启用时为NULL）
+    uint8_t trajectory_axis_count;        // 轨迹发生器当前输出的轴数
+    motor_controller_t* trajectory_motors[MOTOR_REGISTRY_MAX_MOTORS]; // 当前运动各轴的电机（与设定点顺序一致）
+    int trajectory_axes[MOTOR_REGISTRY_MAX_MOTORS];   // 当前运动各轴的轴号（按轴标定换算设定点）
+    double trajectory_base[MOTOR_REGISTRY_MAX_MOTORS]; // 当前运动各轴的起点角度（轨迹按相对起点的位移规划）
+    uint32_t move_skew_max_us;            // 当前运动中的最大轴间偏差 (us)
+    double commanded_angle[MOTOR_REGISTRY_MAX_MOTORS];      // 各轴最后一次下发的绝对目标角度 (度, 单圈轴为0-360, 多圈轴含圈数)
+    uint8_t commanded_state[MOTOR_REGISTRY_MAX_MOTORS];     // 各轴目标角度的可信程度（gcode_target_state_t）
+    uint32_t commanded_epoch[MOTOR_REGISTRY_MAX_MOTORS];    // 下发目标时电机的设定点代次，不一致说明已被其他来源改写
+    gcode_queue_stats_t queue_stats;      // 运动队列统计（计数器由CAN任务与执行任务原子更新）
+    SemaphoreHandle_t stop_mutex;         // 停止请求与执行任务取命令之间的互斥锁（清空队列与取出命令不交错）
+    uint32_t stop_requests;               // 停止请求计数（原子访问）
+    uint32_t executing_stop_requests;     // 取出当前命令时的停止请求计数，之后发生变化说明该命令已被停止
+    bool program_feeding;                 // 程序正在逐行提交（含队列满暂停续传，原子访问）
+    uint32_t last_enqueue_us;             // 逐行命令最近一次入队时间（esp_timer低32位，原子访问）
+    uint32_t last_enqueue_gap_us;         // 逐行命令最近两次入队的间隔（原子访问）
+    bool is_initialized;                  // 初始化状态
+} gcode_controller_t;
+
+// G代码解析结果
+typedef enum {
+    GCODE_RESULT_OK = 0,                  // 执行成功
+    GCODE_RESULT_ERROR = 1,               // 执行错误
+    GCODE_RESULT_INVALID_COMMAND = 2,     // 无效命令
+    GCODE_RESULT_INVALID_PARAMETER = 3,   // 无效参数
+    GCODE_RESULT_MOTOR_ERROR = 4,         // 电机错误
+    GCODE_RESULT_BUFFER_FULL = 5,         // 缓冲区满
+    GCODE_RESULT_CHECKSUM_ERROR = 6,      // *校验错误
+    GCODE_RESULT_NOT_READY = 7            // 电机尚未完成上电握手
+} gcode_result_t;
+
+// 电机控制模式
+typedef enum {
+    MOTOR_MODE_POSITION = 0,              // 位置模式
+    MOTOR_MODE_VELOCITY = 1,              // 速度模式
+    MOTOR_MODE_TORQUE = 2                 // 力矩模式
+} motor_control_mode_t;
+
+/**
+ * @brief 初始化G代码控制器
+ * @param config 控制器配置
+ * @return G代码控制器句柄，失败返回NULL
+ */
+gcode_controller_t* gcode_controller_init(const gcode_controller_config_t* config);
+
+/**
+ * @brief 销毁G代码控制器
+ * @param controller G代码控制器句柄
+ */
+void gcode_controller_deinit(gcode_controller_t* controller);
+
+/**
+ * @brief 处理CAN帧数据
+ * @param controller G代码控制器句柄
+ * @param data CAN帧数据
+ * @param length 数据长度
+ * @return 处理结果：帧内所有完整行均成功时为GCODE_RESULT_OK；
+ *         行超长被丢弃时为GCODE_RESULT_BUFFER_FULL；否则为第一个失败行的结果
+ */
+gcode_result_t gcode_process_can_frame(gcode_controller_t* controller, 
+                                     const uint8_t* data, size_t length);
+
+/**
+ * @brief 处理一段完整的G代码程序（如ISO-TP重组后的消息），逐行执行
+ * @param controller G代码控制器句柄
+ * @param program 程序文本（原地切分，会被修改；缓冲区至少length+1字节）
+ * @param length 程序长度
+ * @return 全部成功返回GCODE_RESULT_OK，否则返回第一个失败行的结果（后续行不再执行）
+ * @note 运动队列满时在调用者任务中等待空位（每行最多5秒），CAN接收任务应使用gcode_submit_program
+ */
+gcode_result_t gcode_process_program(gcode_controller_t* controller, char* program, size_t length);
+
+/**
+ * @brief 提交一段完整的G代码程序，运动队列满时不等待（背压由调用者经传输层施加，如ISO-TP FC WAIT）
+ * @param controller G代码控制器句柄
+ * @param program 程序文本（原地切分，返回前恢复）
+ * @param length 程序长度
+ * @param consumed 输出：已提交部分的字节数（行边界）
+ * @return 全部提交返回GCODE_RESULT_OK；队列满返回GCODE_RESULT_BUFFER_FULL（不计为拒绝），
+ *         之后从program + *consumed继续提交；其他为第一个失败行的结果（后续行不再执行）
+ */
+gcode_result_t gcode_submit_program(gcode_controller_t* controller, char* program, size_t length,
+                                    size_t* consumed);
+
+/**
+ * @brief 检查是否为G代码CAN帧
+ * @param data CAN帧数据
+ * @param length 数据长度
+ * @return true为G代码帧，false为其他帧
+ */
+bool gcode_is_gcode_can_frame(const uint8_t* data, size_t length);
+
+/**
+ * @brief ASCII十六进制解码
+ * @param hex_data ASCII十六进制数据
+ * @param hex_length 十六进制数据长度
+ * @param output 输出缓冲区
+ * @param output_size 输出缓冲区大小
+ * @return 解码后的字符串长度，-1表示错误
+ */
+int gcode_hex_decode(const uint8_t* hex_data, size_t hex_length, 
+                    char* output, size_t output_size);
+
+/**
+ * @brief 解析并执行G代码命令
+ * 配置了运动队列时只做解析校验并入队（不阻塞），由执行任务异步发送到电机
+ * M0立即中止正在执行的轨迹运动并清空运动队列，然后入队执行失能
+ * 轴选择：G1 X/Y/Z/A/B/C 分别控制轴0-5（同一行的多个轴协调运动，同时开始、同时结束）；
+ * F、T、M 用 P{轴号} 指定轴（F/T缺省轴0，M缺省全部轴）
+ * 距离模式：G90绝对（默认）、G91相对，单独成行，按队列顺序生效；目标按各轴圈数模式解析（见motor_units_resolve_target）
+ * @param controller G代码控制器句柄
+ * @param command G代码命令字符串
+ * @return 执行结果（入队模式下队列满返回GCODE_RESULT_BUFFER_FULL）
+ */
+gcode_result_t gcode_execute_command(gcode_controller_t* controller, 
+                                   const char* command);
+
+/**
+ * @brief 获取运动队列统计信息
+ * @param controller G代码控制器句柄
+ * @param stats 输出统计信息
+ * @return 未配置运动队列时返回false
+ */
+bool gcode_get_queue_stats(gcode_controller_t* controller, gcode_queue_stats_t* stats);
+
+/**
+ * @brief 获取最后一次操作的响应消息
+ * 响应缓冲区由执行任务改写，这里在响应互斥锁内复制一份，调用者持有的是稳定的副本
+ * @param controller G代码控制器句柄
+ * @param buffer 输出缓冲区（超长时截断）
+ * @param size 输出缓冲区大小
+ * @return buffer（参数无效时返回错误提示字符串）
+ */
+const char* gcode_get_response(gcode_controller_t* controller, char* buffer, size_t size);
+
+/**
+ * @brief 单遍解析一行G代码的全部"字母+数值"对
+ * 支持 ;注释 与 (注释)、N行号、*校验（RepRap异或校验，覆盖*之前的全部字符）
+ * @param line 以'\0'结尾的一行G代码
+ * @param parsed 输出解析结果
+ * @return 解析结果
+ */
+gcode_result_t gcode_parse_line(const char* line, gcode_line_t* parsed);
+
+// 内部函数声明（用于测试）
+gcode_result_t gcode_execute_g1(gcode_controller_t* controller, const gcode_line_t* parsed);
+gcode_result_t gcode_execute_m(gcode_controller_t* controller, int m_code, int axis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GCODE_UNIFIED_CONTROL_H
\ No newline at end of file
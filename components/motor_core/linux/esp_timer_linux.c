@@ -0,0 +1,100 @@
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <time.h>
+
+#define ESP_TIMER_LINUX_STACK_SIZE  4096
+#define ESP_TIMER_LINUX_PRIORITY    (configMAX_PRIORITIES - 2)
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    TaskHandle_t task;
+    TickType_t period_ticks;
+    volatile bool running;
+};
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void esp_timer_linux_task(void* arg) {
+    struct esp_timer* timer = (struct esp_timer*)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true) {
+        if (!timer->running) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+            continue;
+        }
+        vTaskDelayUntil(&last_wake, timer->period_ticks);
+        if (timer->running) {
+            timer->callback(timer->arg);
+        }
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    if (!create_args || !create_args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct esp_timer* timer = calloc(1, sizeof(struct esp_timer));
+    if (!timer) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+
+    if (xTaskCreate(esp_timer_linux_task, create_args->name ? create_args->name : "esp_timer",
+                    ESP_TIMER_LINUX_STACK_SIZE, timer, ESP_TIMER_LINUX_PRIORITY, &timer->task) != pdPASS) {
+        free(timer);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 周期按节拍取整，至少1个节拍（CONFIG_FREERTOS_HZ=1000时分辨率为1ms）
+    TickType_t ticks = (TickType_t)((period * configTICK_RATE_HZ + 500000) / 1000000);
+    timer->period_ticks = ticks > 0 ? ticks : 1;
+    timer->running = true;
+    xTaskNotifyGive(timer->task);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->running = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    vTaskDelete(timer->task);
+    free(timer);
+    return ESP_OK;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// linux目标垫片：电机配置里的引脚号只做记录，主机上没有GPIO
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC (-1)
@@ -0,0 +1,32 @@
+#pragma once
+
+// linux目标垫片：只提供控制核心用到的UART类型，收发由motor_uart.h接到驱动器模拟器
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef int uart_port_t;
+
+#define UART_NUM_0      0
+#define UART_NUM_1      1
+#define UART_NUM_2      2
+#define UART_NUM_MAX    3
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
@@ -0,0 +1,353 @@
+#include "motor_config.h"
+#include "motor_units.h"
+#include "motor_registry.h"
+#include "motor_status_scheduler.h"
+#include "motor_task_plan.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "nvs.h"
+#endif
+
+static const char *TAG = "MOTOR_CONFIG";
+
+#define CONFIG_VERSION_KEY      "version"
+#define CONFIG_COMMIT_STACK     3072
+#define CONFIG_COMMIT_PRIORITY  1       // 只做NVS写入，低于所有业务任务
+
+#define MOTOR_CONFIG_DEFAULT_VALUES {               \
+    .gear_ratio = GEAR_RATIO,                       \
+    .torque_factor = TORQUE_FACTOR,                 \
+    .query_frequency = 1.0f,                        \
+    .can_bitrate = 500000,                          \
+    .startup_mode = MOTOR_STARTUP_POSITION,         \
+    .auto_query = 0,                                \
+    .auto_enable = 0,                               \
+}
+
+static const motor_config_t motor_config_default = MOTOR_CONFIG_DEFAULT_VALUES;
+
+// 未调用motor_config_init（linux目标）时热点路径同样读到默认值
+motor_config_t g_motor_config = MOTOR_CONFIG_DEFAULT_VALUES;
+
+static const uint32_t can_bitrates[] = {125000, 250000, 500000, 1000000};
+
+static const motor_config_field_t motor_config_fields[] = {
+    {"gear_ratio",    MOTOR_CONFIG_FLOAT, offsetof(motor_config_t, gear_ratio),      1.0f,   1000.0f,   NULL, 0, false},
+    {"torque_factor", MOTOR_CONFIG_FLOAT, offsetof(motor_config_t, torque_factor),   0.001f, 100.0f,    NULL, 0, false},
+    {"query_hz",      MOTOR_CONFIG_FLOAT, offsetof(motor_config_t, query_frequency), 0.5f,   5.0f,      NULL, 0, false},  // 与状态调度器允许范围一致
+    {"can_bitrate",   MOTOR_CONFIG_UINT,  offsetof(motor_config_t, can_bitrate),     125000, 1000000,
+     can_bitrates, sizeof(can_bitrates) / sizeof(can_bitrates[0]), true},
+    {"startup_mode",  MOTOR_CONFIG_UINT,  offsetof(motor_config_t, startup_mode),    0,      MOTOR_STARTUP_MODES - 1, NULL, 0, true},
+    {"auto_query",    MOTOR_CONFIG_UINT,  offsetof(motor_config_t, auto_query),      0,      1,         NULL, 0, true},
+    {"auto_enable",   MOTOR_CONFIG_UINT,  offsetof(motor_config_t, auto_enable),     0,      1,         NULL, 0, true},
+};
+
+#define CONFIG_FIELD_COUNT  (sizeof(motor_config_fields) / sizeof(motor_config_fields[0]))
+
+typedef struct {
+    SemaphoreHandle_t lock;             // 保护脏字段位图与NVS读写
+    TaskHandle_t commit_task;
+    uint32_t dirty;                     // 待提交字段位图（按motor_config_fields下标）
+    uint32_t commits;
+    bool persistent;                    // NVS可用
+} motor_config_state_t;
+
+static motor_config_state_t g_config_state;
+
+// ====================================================================================
+// --- 字段读写 ---
+// ====================================================================================
+
+static uint32_t config_raw(const motor_config_field_t* field, const motor_config_t* config) {
+    uint32_t raw;
+    memcpy(&raw, (const uint8_t*)config + field->offset, sizeof(raw));
+    return raw;
+}
+
+static bool config_valid(const motor_config_field_t* field, uint32_t raw) {
+    if (field->type == MOTOR_CONFIG_FLOAT) {
+        float value;
+        memcpy(&value, &raw, sizeof(value));
+        return isfinite(value) && value >= field->min && value <= field->max;
+    }
+    if (field->choices) {
+        for (uint8_t i = 0; i < field->choice_count; i++) {
+            if (field->choices[i] == raw) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return raw >= (uint32_t)field->min && raw <= (uint32_t)field->max;
+}
+
+static bool config_parse(const motor_config_field_t* field, const char* text, uint32_t* raw) {
+    char* end = NULL;
+    if (field->type == MOTOR_CONFIG_FLOAT) {
+        float value = strtof(text, &end);
+        memcpy(raw, &value, sizeof(value));
+    } else {
+        if (*text == '-') {
+            return false;
+        }
+        *raw = (uint32_t)strtoul(text, &end, 0);
+    }
+    return end != text && *end == '\0' && config_valid(field, *raw);
+}
+
+/**
+ * @brief 把新值写入内存配置（单个32位字段，读者不会读到半个值）并让需要的模块立即生效
+ */
+static void config_apply(const motor_config_field_t* field, uint32_t raw) {
+    memcpy((uint8_t*)&g_motor_config + field->offset, &raw, sizeof(raw));
+
+    if (field->offset == offsetof(motor_config_t, query_frequency)) {
+        for (uint8_t i = 0; i < motor_registry_count(); i++) {
+            motor_registry_entry_t* entry = motor_registry_get(i);
+            if (entry && entry->scheduler) {
+                motor_status_scheduler_set_frequency(entry->scheduler, g_motor_config.query_frequency);
+            }
+        }
+    } else if (field->offset == offsetof(motor_config_t, gear_ratio) ||
+               field->offset == offsetof(motor_config_t, torque_factor)) {
+        // 跟随运行时配置的轴重新计算换算系数
+        motor_units_refresh();
+    }
+}
+
+static void config_lock(void) {
+    if (g_config_state.lock) {
+        xSemaphoreTake(g_config_state.lock, portMAX_DELAY);
+    }
+}
+
+static void config_unlock(void) {
+    if (g_config_state.lock) {
+        xSemaphoreGive(g_config_state.lock);
+    }
+}
+
+static void config_schedule_commit(void) {
+    if (g_config_state.commit_task) {
+        xTaskNotifyGive(g_config_state.commit_task);
+    }
+}
+
+// ====================================================================================
+// --- NVS持久化 ---
+// ====================================================================================
+
+#if !CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief 逐键读取：缺失的键保持默认值，越界的键告警后保持默认值
+ */
+static bool config_load(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MOTOR_CONFIG_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "NVS中没有保存的配置，使用默认值");
+        return true;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "打开NVS失败: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    uint32_t version = 0;
+    nvs_get_u32(handle, CONFIG_VERSION_KEY, &version);
+    if (version > MOTOR_CONFIG_VERSION) {
+        // 固件回退：更高版本的字段语义未知，整体使用默认值，下次提交时按当前版本覆盖
+        ESP_LOGW(TAG, "保存的配置版本%lu高于固件支持的%d，使用默认值", (unsigned long)version, MOTOR_CONFIG_VERSION);
+        nvs_close(handle);
+        return true;
+    }
+    // 旧版本配置的迁移在此按version补充（当前只有版本1）
+
+    uint8_t loaded = 0;
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const motor_config_field_t* field = &motor_config_fields[i];
+        uint32_t raw;
+        if (nvs_get_u32(handle, field->key, &raw) != ESP_OK) {
+            continue;
+        }
+        if (!config_valid(field, raw)) {
+            ESP_LOGW(TAG, "保存的%s越界，使用默认值", field->key);
+            continue;
+        }
+        memcpy((uint8_t*)&g_motor_config + field->offset, &raw, sizeof(raw));
+        loaded++;
+    }
+    nvs_close(handle);
+    ESP_LOGI(TAG, "已从NVS加载%d个配置项（版本%lu）", loaded, (unsigned long)version);
+    return true;
+}
+
+/**
+ * @brief 把脏字段与版本号写入NVS并提交一次（调用者持有锁）
+ */
+static bool config_store(uint32_t dirty) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MOTOR_CONFIG_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "打开NVS失败: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT && err == ESP_OK; i++) {
+        if (dirty & (1u << i)) {
+            err = nvs_set_u32(handle, motor_config_fields[i].key, config_raw(&motor_config_fields[i], &g_motor_config));
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle, CONFIG_VERSION_KEY, MOTOR_CONFIG_VERSION);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存配置失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 批量提交任务：收到修改通知后等到连续CONFIG_MOTOR_CONFIG_COMMIT_DELAY_MS没有新修改再提交
+ */
+static void config_commit_task(void* arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_MOTOR_CONFIG_COMMIT_DELAY_MS)) > 0) {
+        }
+        motor_config_commit();
+    }
+}
+#endif
+
+// ====================================================================================
+// --- 对外接口 ---
+// ====================================================================================
+
+bool motor_config_init(void) {
+    if (g_config_state.lock) {
+        return g_config_state.persistent;
+    }
+    g_config_state.lock = xSemaphoreCreateMutex();
+    if (!g_config_state.lock) {
+        ESP_LOGE(TAG, "配置锁创建失败");
+        return false;
+    }
+
+#if CONFIG_IDF_TARGET_LINUX
+    return false;
+#else
+    g_config_state.persistent = config_load();
+    if (g_config_state.persistent &&
+        xTaskCreatePinnedToCore(config_commit_task, "config_commit", CONFIG_COMMIT_STACK, NULL,
+                                CONFIG_COMMIT_PRIORITY, &g_config_state.commit_task,
+                                MOTOR_TASK_NETWORK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "配置提交任务创建失败，修改需手动提交");
+    }
+    return g_config_state.persistent;
+#endif
+}
+
+const motor_config_t* motor_config_defaults(void) {
+    return &motor_config_default;
+}
+
+uint8_t motor_config_field_count(void) {
+    return CONFIG_FIELD_COUNT;
+}
+
+const motor_config_field_t* motor_config_field(uint8_t index) {
+    return index < CONFIG_FIELD_COUNT ? &motor_config_fields[index] : NULL;
+}
+
+bool motor_config_set(const char* key, const char* text) {
+    if (!key || !text) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const motor_config_field_t* field = &motor_config_fields[i];
+        if (strcmp(field->key, key) != 0) {
+            continue;
+        }
+
+        uint32_t raw;
+        if (!config_parse(field, text, &raw)) {
+            ESP_LOGW(TAG, "配置%s的值无效: %s", key, text);
+            return false;
+        }
+        config_lock();
+        if (raw != config_raw(field, &g_motor_config)) {
+            config_apply(field, raw);
+            g_config_state.dirty |= 1u << i;
+        }
+        config_unlock();
+        config_schedule_commit();
+        ESP_LOGI(TAG, "配置%s = %s%s", key, text, field->restart_required ? "（重启后生效）" : "");
+        return true;
+    }
+    return false;
+}
+
+int motor_config_format(const motor_config_field_t* field, const motor_config_t* config, char* buffer, size_t size) {
+    uint32_t raw = config_raw(field, config);
+    if (field->type == MOTOR_CONFIG_FLOAT) {
+        float value;
+        memcpy(&value, &raw, sizeof(value));
+        return snprintf(buffer, size, "%g", value);
+    }
+    return snprintf(buffer, size, "%lu", (unsigned long)raw);
+}
+
+void motor_config_reset(void) {
+    config_lock();
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const motor_config_field_t* field = &motor_config_fields[i];
+        uint32_t raw = config_raw(field, &motor_config_default);
+        if (raw != config_raw(field, &g_motor_config)) {
+            config_apply(field, raw);
+        }
+        g_config_state.dirty |= 1u << i;
+    }
+    config_unlock();
+    config_schedule_commit();
+    ESP_LOGI(TAG, "配置已恢复默认值");
+}
+
+bool motor_config_commit(void) {
+    config_lock();
+    uint32_t dirty = g_config_state.dirty;
+    bool ok = dirty == 0;
+#if !CONFIG_IDF_TARGET_LINUX
+    if (!ok && g_config_state.persistent && config_store(dirty)) {
+        g_config_state.dirty = 0;
+        g_config_state.commits++;
+        ok = true;
+        ESP_LOGI(TAG, "配置已保存到NVS（%d项）", __builtin_popcount(dirty));
+    }
+#endif
+    config_unlock();
+    return ok;
+}
+
+uint8_t motor_config_pending(void) {
+    return (uint8_t)__builtin_popcount(__atomic_load_n(&g_config_state.dirty, __ATOMIC_RELAXED));
+}
+
+uint32_t motor_config_commit_count(void) {
+    return g_config_state.commits;
+}
@@ -0,0 +1,119 @@
+#ifndef MOTOR_CONFIG_H
+#define MOTOR_CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 运行时配置：启动时从NVS（命名空间MOTOR_CONFIG_NAMESPACE）一次性读入内存，热点路径只读g_motor_config
+// 每个字段一个NVS键，缺失或越界的键取默认值；另存格式版本键，新固件读到更高版本时整体回退默认值
+// 修改先写内存并立即生效，脏字段由后台任务在最后一次修改后CONFIG_MOTOR_CONFIG_COMMIT_DELAY_MS批量写入并提交一次
+// linux目标没有NVS，只使用默认值
+
+#define MOTOR_CONFIG_NAMESPACE      "motor_cfg"
+#define MOTOR_CONFIG_VERSION        1       // 字段语义变化时递增，并在motor_config.c中补迁移
+
+// 上电控制模式
+typedef enum {
+    MOTOR_STARTUP_POSITION = 0,
+    MOTOR_STARTUP_VELOCITY,
+    MOTOR_STARTUP_TORQUE,
+    MOTOR_STARTUP_MODES
+} motor_startup_mode_t;
+
+typedef struct {
+    float gear_ratio;               // 外部减速比
+    float torque_factor;            // 输出轴力矩 -> 电机力矩系数
+    float query_frequency;          // 状态自动查询频率 (Hz)
+    uint32_t can_bitrate;           // G代码CAN波特率（重启生效）
+    uint32_t startup_mode;          // 上电控制模式motor_startup_mode_t（重启生效）
+    uint32_t auto_query;            // 上电后自动开始状态查询（重启生效）
+    uint32_t auto_enable;           // 驱动器就绪后自动使能（重启生效，默认关闭）
+} motor_config_t;
+
+typedef enum {
+    MOTOR_CONFIG_FLOAT = 0,
+    MOTOR_CONFIG_UINT,
+} motor_config_type_t;
+
+// 字段描述（键名同时用作NVS键与/api/config参数名，不超过15字符）
+typedef struct {
+    const char* key;
+    motor_config_type_t type;
+    size_t offset;                  // 在motor_config_t中的偏移
+    float min;
+    float max;
+    const uint32_t* choices;        // 非NULL时只允许这些取值
+    uint8_t choice_count;
+    bool restart_required;          // 修改后需重启才生效
+} motor_config_field_t;
+
+// 当前配置（热点路径直接读取；只通过motor_config_set/motor_config_reset修改）
+extern motor_config_t g_motor_config;
+
+/**
+ * @brief 从NVS加载配置并启动批量提交任务（须在nvs_flash_init之后、电机注册之前调用）
+ * @return NVS不可用时返回false，此时使用默认值且修改不会持久化
+ */
+bool motor_config_init(void);
+
+/**
+ * @brief 默认配置
+ */
+const motor_config_t* motor_config_defaults(void);
+
+/**
+ * @brief 字段个数
+ */
+uint8_t motor_config_field_count(void);
+
+/**
+ * @brief 按下标获取字段描述，越界返回NULL
+ */
+const motor_config_field_t* motor_config_field(uint8_t index);
+
+/**
+ * @brief 解析、校验并修改一个字段，立即生效并安排持久化
+ * @param key 字段键名
+ * @param text 新值文本
+ * @return 未知键、格式错误或越界返回false
+ */
+bool motor_config_set(const char* key, const char* text);
+
+/**
+ * @brief 把字段值格式化为文本
+ * @return 写入的字符数（不含结尾0）
+ */
+int motor_config_format(const motor_config_field_t* field, const motor_config_t* config, char* buffer, size_t size);
+
+/**
+ * @brief 全部字段恢复默认值并安排持久化
+ */
+void motor_config_reset(void);
+
+/**
+ * @brief 立即把脏字段写入NVS并提交
+ * @return 没有待提交字段或提交成功返回true
+ */
+bool motor_config_commit(void);
+
+/**
+ * @brief 尚未提交的字段个数
+ */
+uint8_t motor_config_pending(void);
+
+/**
+ * @brief 本次启动成功提交的次数
+ */
+uint32_t motor_config_commit_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_CONFIG_H
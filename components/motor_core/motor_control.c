@@ -0,0 +1,787 @@
+#include "motor_control.h"
+#include "motor_uart.h"
+#include "motor_metrics.h"
+#include "flight_recorder.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+// ====================================================================================
+// --- 常量定义 ---
+// ====================================================================================
+
+// 已初始化的电机控制器（按UART端口+节点ID查找，同一UART可挂多个驱动器）
+static motor_controller_t* g_controllers[MOTOR_CONTROL_MAX_MOTORS] = {0};
+
+// CAN 指令数据
+static const uint8_t ENABLE_DATA[]      = {0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // 致能马达
+static const uint8_t DISABLE_DATA[]     = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // 失能马达
+static const uint8_t VEL_DIRECT_MODE_DATA[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00}; // 速度直接模式数据
+static const uint8_t POS_DATA[]         = {0x03, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00}; // 进入位置斜坡模式
+static const uint8_t POS_PASSTHROUGH_DATA[] = {0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00}; // 位置直通模式（跟随上位机设定点流）
+static const uint8_t TORQUE_DIRECT_MODE_DATA[] = {0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00}; // 力矩直接模式数据
+static const uint8_t CLEAR_ERROR_DATA[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // 清除错误和异常数据
+static const uint8_t RESTART_MOTOR_DATA[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // 重启电机数据
+static const uint8_t QUERY_DATA[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // 查询指令通用数据
+
+// 内部函数声明
+static void send_serial_can_frame(uart_port_t uart_port, uint8_t node_id, const char* cmd_name, 
+                                 uint8_t cmd, const uint8_t *data, uint8_t len);
+
+// ====================================================================================
+// --- 电机控制器主要接口实现 ---
+// ====================================================================================
+
+motor_controller_t* motor_control_init(const motor_driver_config_t* driver_config) {
+    if (!driver_config) {
+        printf("[错误] 电机控制器配置参数为空！\n");
+        return NULL;
+    }
+
+    // 分配控制器内存
+    motor_controller_t* controller = (motor_controller_t*)malloc(sizeof(motor_controller_t));
+    if (!controller) {
+        printf("[错误] 电机控制器内存分配失败！\n");
+        return NULL;
+    }
+
+    // 复制配置
+    memcpy(&controller->driver_config, driver_config, sizeof(motor_driver_config_t));
+
+    if (driver_config->uart_port < 0 || driver_config->uart_port >= UART_NUM_MAX ||
+        driver_config->node_id > MOTOR_MAX_NODE_ID ||
+        motor_control_find(driver_config->uart_port, driver_config->node_id)) {
+        printf("[错误] UART%d 节点%d 无效或已被其他电机占用！\n", driver_config->uart_port, driver_config->node_id);
+        free(controller);
+        return NULL;
+    }
+
+    int slot = -1;
+    motor_controller_t* bus_peer = NULL;   // 同一UART上已初始化的控制器
+    for (int i = 0; i < MOTOR_CONTROL_MAX_MOTORS; i++) {
+        if (!g_controllers[i]) {
+            if (slot < 0) slot = i;
+        } else if (g_controllers[i]->driver_config.uart_port == driver_config->uart_port) {
+            bus_peer = g_controllers[i];
+        }
+    }
+    if (slot < 0) {
+        printf("[错误] 电机控制器数量已达上限 %d！\n", MOTOR_CONTROL_MAX_MOTORS);
+        free(controller);
+        return NULL;
+    }
+
+    // 初始化电机状态
+    controller->motor_enabled = false;
+    controller->ready = false;
+    controller->ready_us = 0;
+    memset(&controller->status, 0, sizeof(controller->status));
+    controller->last_exception_query_type = -1;
+    controller->uart_event_queue = NULL;
+    memset(controller->tx_frames, 0, sizeof(controller->tx_frames));
+    memset(controller->rx_frames, 0, sizeof(controller->rx_frames));
+    memset(&controller->latency, 0, sizeof(controller->latency));
+    motor_derived_reset(&controller->derived);
+    controller->setpoint_epoch = 0;
+    controller->setpoint_hook = NULL;
+    controller->setpoint_hook_context = NULL;
+
+    if (bus_peer) {
+        // 菊花链：UART驱动已由同一总线上的第一个驱动器安装，直接复用
+        if (bus_peer->driver_config.txd_pin != driver_config->txd_pin ||
+            bus_peer->driver_config.rxd_pin != driver_config->rxd_pin ||
+            bus_peer->driver_config.baud_rate != driver_config->baud_rate) {
+            printf("[警告] UART%d 节点%d 的引脚/波特率与总线已有配置不同，沿用已有配置\n",
+                   driver_config->uart_port, driver_config->node_id);
+            controller->driver_config.txd_pin = bus_peer->driver_config.txd_pin;
+            controller->driver_config.rxd_pin = bus_peer->driver_config.rxd_pin;
+            controller->driver_config.baud_rate = bus_peer->driver_config.baud_rate;
+        }
+        controller->uart_event_queue = bus_peer->uart_event_queue;
+    } else {
+        // 安装事件队列，供共享的UART监听任务按事件驱动读取
+        // 发送环形缓冲区使uart_write_bytes只做拷贝，多轴突发发送时不等待前一个端口出FIFO
+        if (motor_uart_driver_install(driver_config->uart_port, driver_config->buf_size * 2, driver_config->buf_size,
+                                      MOTOR_UART_EVENT_QUEUE_SIZE, &controller->uart_event_queue) != ESP_OK) {
+            printf("[错误] UART%d 驱动安装失败！\n", driver_config->uart_port);
+            free(controller);
+            return NULL;
+        }
+        motor_uart_configure(driver_config->uart_port, driver_config->baud_rate,
+                             driver_config->txd_pin, driver_config->rxd_pin);
+    }
+
+    g_controllers[slot] = controller;
+
+    // 初始化电机（不设置模式，等待后续配置）
+    printf("[信息] 电机UART已配置，等待模式设置\n");
+
+    printf("[信息] 电机控制器在 UART%d 节点%d 上初始化完成\n", 
+           driver_config->uart_port, driver_config->node_id);
+    return controller;
+}
+
+void motor_control_deinit(motor_controller_t* controller) {
+    if (!controller) return;
+
+    // 失能电机
+    motor_control_enable(controller, false);
+
+    // 同一UART上没有其他驱动器时才删除UART驱动
+    bool bus_in_use = false;
+    for (int i = 0; i < MOTOR_CONTROL_MAX_MOTORS; i++) {
+        if (g_controllers[i] == controller) {
+            g_controllers[i] = NULL;
+        } else if (g_controllers[i] &&
+                   g_controllers[i]->driver_config.uart_port == controller->driver_config.uart_port) {
+            bus_in_use = true;
+        }
+    }
+    if (!bus_in_use) {
+        motor_uart_driver_delete(controller->driver_config.uart_port);
+    }
+
+    // 释放内存
+    free(controller);
+    
+    printf("[信息] 电机控制器已销毁\n");
+}
+
+void motor_control_enable(motor_controller_t* controller, bool enable) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            enable ? FLIGHT_COMMAND_ENABLE : FLIGHT_COMMAND_DISABLE, 0.0f);
+    if (enable) {
+        enable_motor(controller->driver_config.uart_port, controller->driver_config.node_id);
+        controller->motor_enabled = true;
+        printf("[信息] 电机已使能\n");
+    } else {
+        disable_motor(controller->driver_config.uart_port, controller->driver_config.node_id);
+        controller->motor_enabled = false;
+        printf("[信息] 电机已失能\n");
+    }
+}
+
+
+void motor_control_set_velocity_mode(motor_controller_t* controller) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    set_motor_velocity_mode(controller->driver_config.uart_port, controller->driver_config.node_id);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_MODE_VELOCITY, 0.0f);
+    printf("[信息] 电机已设置为速度模式\n");
+}
+
+void motor_control_set_velocity(motor_controller_t* controller, float velocity) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    send_target_velocity(controller->driver_config.uart_port, controller->driver_config.node_id, velocity);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_TARGET_VELOCITY, velocity);
+    printf("[信息] 电机目标速度设置为: %.2f r/s\n", velocity);
+}
+
+void motor_control_set_position_mode(motor_controller_t* controller) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    set_motor_position_mode(controller->driver_config.uart_port, controller->driver_config.node_id);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_MODE_POSITION, 0.0f);
+    printf("[信息] 电机已设置为位置模式\n");
+}
+
+void motor_control_set_position_passthrough_mode(motor_controller_t* controller) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    set_motor_position_passthrough_mode(controller->driver_config.uart_port, controller->driver_config.node_id);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_MODE_PASSTHROUGH, 0.0f);
+    printf("[信息] 电机已设置为位置直通模式\n");
+}
+
+void motor_control_set_position(motor_controller_t* controller, float position) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    send_target_position(controller->driver_config.uart_port, controller->driver_config.node_id, position);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_TARGET_POSITION, position);
+    printf("[信息] 电机目标位置设置为: %.2f\n", position);
+}
+
+void motor_control_set_torque_mode(motor_controller_t* controller) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    set_motor_torque_mode(controller->driver_config.uart_port, controller->driver_config.node_id);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_MODE_TORQUE, 0.0f);
+    printf("[信息] 电机已设置为力矩模式\n");
+}
+
+void motor_control_set_torque(motor_controller_t* controller, float torque) {
+    if (!controller) return;
+
+    motor_control_setpoint_changed(controller);
+    send_target_torque(controller->driver_config.uart_port, controller->driver_config.node_id, torque);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_TARGET_TORQUE, torque);
+    printf("[信息] 电机目标力矩设置为: %.2f Nm\n", torque);
+}
+
+
+void motor_control_clear_errors(motor_controller_t* controller) {
+    if (!controller) return;
+
+    clear_motor_errors(controller->driver_config.uart_port, controller->driver_config.node_id);
+    FLIGHT_RECORDER_COMMAND(controller->driver_config.uart_port, controller->driver_config.node_id,
+                            FLIGHT_COMMAND_CLEAR_ERRORS, 0.0f);
+    printf("[信息] 电机错误和异常已清除\n");
+}
+
+bool motor_control_is_enabled(motor_controller_t* controller) {
+    if (!controller) return false;
+    return controller->motor_enabled;
+}
+
+bool motor_control_is_ready(const motor_controller_t* controller) {
+    return controller && __atomic_load_n(&controller->ready, __ATOMIC_ACQUIRE);
+}
+
+bool motor_control_query_absolute_count(motor_controller_t* controller, uint32_t wait_ms, int64_t* count) {
+    if (!controller || !count) return false;
+    // 展开计数在UART监听任务解析编码器响应后更新，以样本数变化判断收到新响应
+    uint32_t samples = motor_derived_encoder_samples(&controller->derived);
+    query_encoder_count(controller->driver_config.uart_port, controller->driver_config.node_id);
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)wait_ms * 1000;
+    while (motor_derived_encoder_samples(&controller->derived) == samples) {
+        if (esp_timer_get_time() >= deadline_us) {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return motor_derived_absolute_count(&controller->derived, count);
+}
+
+uint32_t motor_control_setpoint_epoch(const motor_controller_t* controller) {
+    return controller ? __atomic_load_n(&controller->setpoint_epoch, __ATOMIC_ACQUIRE) : 0;
+}
+
+void motor_control_setpoint_changed(motor_controller_t* controller) {
+    if (!controller) return;
+    // 在发送命令之前加1：并发的G代码运动结束时一定能看到代次变化
+    __atomic_add_fetch(&controller->setpoint_epoch, 1, __ATOMIC_ACQ_REL);
+    // 通知回调中止仍在输出的轨迹，返回后流式设定点不会再覆盖调用者接下来发送的命令
+    motor_setpoint_hook_t hook = __atomic_load_n(&controller->setpoint_hook, __ATOMIC_ACQUIRE);
+    if (hook) {
+        hook(controller, __atomic_load_n(&controller->setpoint_hook_context, __ATOMIC_ACQUIRE));
+    }
+}
+
+void motor_control_set_setpoint_hook(motor_controller_t* controller, motor_setpoint_hook_t hook, void* context) {
+    if (!controller) return;
+    // 先清空回调再换上下文，并发的通知不会拿新回调配旧上下文
+    __atomic_store_n(&controller->setpoint_hook, NULL, __ATOMIC_RELEASE);
+    __atomic_store_n(&controller->setpoint_hook_context, context, __ATOMIC_RELEASE);
+    __atomic_store_n(&controller->setpoint_hook, hook, __ATOMIC_RELEASE);
+}
+
+void motor_control_clear_setpoint_hook(motor_controller_t* controller, void* context) {
+    if (controller && __atomic_load_n(&controller->setpoint_hook_context, __ATOMIC_ACQUIRE) == context) {
+        __atomic_store_n(&controller->setpoint_hook, NULL, __ATOMIC_RELEASE);
+    }
+}
+
+void motor_control_mark_ready(motor_controller_t* controller) {
+    if (!controller || motor_control_is_ready(controller)) return;
+    // 先写就绪时间再发布ready，读到ready的一方总能读到有效的ready_us
+    controller->ready_us = esp_timer_get_time();
+    __atomic_store_n(&controller->ready, true, __ATOMIC_RELEASE);
+}
+
+// ====================================================================================
+// --- 低级别电机驱动函数实现 ---
+// ====================================================================================
+
+static void build_serial_can_frame(uint8_t *tx_buffer, uint8_t node_id, uint8_t cmd,
+                                   const uint8_t *data, uint8_t len) {
+    uint16_t id = MOTOR_FRAME_ID(node_id, cmd);
+    tx_buffer[0] = (id >> 8) & 0xFF; // CAN ID high byte
+    tx_buffer[1] = id & 0xFF;        // CAN ID low byte
+    memcpy(&tx_buffer[2], data, len); // Copy data
+}
+
+/**
+ * @brief 目标帧已写入UART：等待下发的延迟探针进入等待反馈阶段
+ * 探针可能被HTTP、G代码执行、轨迹任务与UART监听任务并发访问，状态用原子操作切换，
+ * 时间字段在状态切换前写入；极少数交错（新命令恰在反馈时覆盖）只影响单个样本
+ */
+static void latency_mark_tx(motor_controller_t* controller) {
+    if (__atomic_load_n(&controller->latency.state, __ATOMIC_ACQUIRE) != MOTOR_LATENCY_DISPATCHED) {
+        return;
+    }
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    controller->latency.tx_us = now_us;
+    uint8_t expected = MOTOR_LATENCY_DISPATCHED;
+    if (__atomic_compare_exchange_n(&controller->latency.state, &expected, MOTOR_LATENCY_SENT, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        motor_metrics_observe(&g_motor_metrics.latency_us[MOTOR_LATENCY_INGEST_DISPATCH],
+                              controller->latency.dispatch_us - controller->latency.ingest_us);
+        motor_metrics_observe(&g_motor_metrics.latency_us[MOTOR_LATENCY_DISPATCH_TX],
+                              now_us - controller->latency.dispatch_us);
+    }
+}
+
+static bool is_setpoint_cmd(uint8_t cmd) {
+    return cmd == MOTOR_CMD_TARGET_POS || cmd == MOTOR_CMD_TARGET_VEL || cmd == MOTOR_CMD_TARGET_TORQUE;
+}
+
+static void send_serial_can_frame(uart_port_t uart_port, uint8_t node_id, const char* cmd_name, 
+                                 uint8_t cmd, const uint8_t *data, uint8_t len) {
+    uint8_t tx_buffer[10];
+    build_serial_can_frame(tx_buffer, node_id, cmd, data, len);
+    
+    // 发送完整的10字节数据包：2字节ID + 8字节数据
+    motor_uart_write(uart_port, tx_buffer, sizeof(tx_buffer));
+    
+    motor_controller_t* controller = motor_control_find(uart_port, node_id);
+    if (controller) {
+        MOTOR_METRICS_INC(controller->tx_frames[cmd]);
+        if (is_setpoint_cmd(cmd)) {
+            latency_mark_tx(controller);
+        }
+    } else {
+        MOTOR_METRICS_INC(g_motor_metrics.uart_tx_unmatched);
+    }
+    
+    // cmd_name为NULL表示高频流式发送，不打印日志以免拖慢控制台
+    if (cmd_name) {
+        printf("[UART] 发送: %s, 节点:%d, ID:0x%04X, 10字节\n", cmd_name, node_id,
+               MOTOR_FRAME_ID(node_id, cmd));
+    }
+}
+
+void set_motor_velocity_mode(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "设置速度模式", MOTOR_CMD_SET_CONTROL_MODE, VEL_DIRECT_MODE_DATA, sizeof(VEL_DIRECT_MODE_DATA));
+}
+
+void set_motor_position_mode(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "设置位置模式", MOTOR_CMD_SET_CONTROL_MODE, POS_DATA, sizeof(POS_DATA));
+}
+
+void set_motor_position_passthrough_mode(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "设置位置直通模式", MOTOR_CMD_SET_CONTROL_MODE, POS_PASSTHROUGH_DATA, sizeof(POS_PASSTHROUGH_DATA));
+}
+
+void stream_target_position(uart_port_t uart_port, uint8_t node_id, float position) {
+    uint8_t can_data[8] = {0};
+    memcpy(can_data, &position, sizeof(position));
+    send_serial_can_frame(uart_port, node_id, NULL, MOTOR_CMD_TARGET_POS, can_data, sizeof(can_data));
+}
+
+uint32_t motor_control_stream_positions(motor_controller_t* const* controllers, const float* positions, uint8_t count) {
+    uint8_t frames[MOTOR_CONTROL_MAX_MOTORS][10];
+    if (count > MOTOR_CONTROL_MAX_MOTORS) {
+        count = MOTOR_CONTROL_MAX_MOTORS;
+    }
+    
+    // 先组好全部帧，发送循环内只做写入，缩短轴间间隔
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t can_data[8] = {0};
+        memcpy(can_data, &positions[i], sizeof(positions[i]));
+        build_serial_can_frame(frames[i], controllers[i]->driver_config.node_id, MOTOR_CMD_TARGET_POS,
+                               can_data, sizeof(can_data));
+    }
+    
+    int64_t first_us = esp_timer_get_time();
+    int64_t last_us = first_us;
+    for (uint8_t i = 0; i < count; i++) {
+        last_us = esp_timer_get_time();
+        motor_uart_write(controllers[i]->driver_config.uart_port, frames[i], sizeof(frames[i]));
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        MOTOR_METRICS_INC(controllers[i]->tx_frames[MOTOR_CMD_TARGET_POS]);
+        latency_mark_tx(controllers[i]);
+    }
+    return (uint32_t)(last_us - first_us);
+}
+
+void send_target_position(uart_port_t uart_port, uint8_t node_id, float position) {
+    uint8_t can_data[8] = {0};
+    memcpy(can_data, &position, sizeof(position)); // Copy float position to CAN data
+    send_serial_can_frame(uart_port, node_id, "设置目标位置", MOTOR_CMD_TARGET_POS, can_data, sizeof(can_data));
+}
+
+void send_target_velocity(uart_port_t uart_port, uint8_t node_id, float velocity) {
+    uint8_t can_data[8] = {0};
+    memcpy(can_data, &velocity, sizeof(velocity)); // Copy float velocity to CAN data
+    send_serial_can_frame(uart_port, node_id, "设置目标速度", MOTOR_CMD_TARGET_VEL, can_data, sizeof(can_data));
+}
+
+void set_motor_torque_mode(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "设置力矩模式", MOTOR_CMD_SET_CONTROL_MODE, TORQUE_DIRECT_MODE_DATA, sizeof(TORQUE_DIRECT_MODE_DATA));
+}
+
+void send_target_torque(uart_port_t uart_port, uint8_t node_id, float torque) {
+    uint8_t can_data[8] = {0};
+    memcpy(can_data, &torque, sizeof(torque)); // Copy float torque to CAN data
+    send_serial_can_frame(uart_port, node_id, "设置目标力矩", MOTOR_CMD_TARGET_TORQUE, can_data, sizeof(can_data));
+}
+
+void enable_motor(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "致能马达", MOTOR_CMD_SET_AXIS_STATE, ENABLE_DATA, sizeof(ENABLE_DATA));
+}
+
+void disable_motor(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "失能马达", MOTOR_CMD_SET_AXIS_STATE, DISABLE_DATA, sizeof(DISABLE_DATA));
+}
+
+
+void clear_motor_errors(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "清除错误和异常", MOTOR_CMD_CLEAR_ERROR, CLEAR_ERROR_DATA, sizeof(CLEAR_ERROR_DATA));
+}
+
+void restart_motor(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "重启电机", MOTOR_CMD_RESTART, RESTART_MOTOR_DATA, sizeof(RESTART_MOTOR_DATA));
+}
+
+void query_motor_torque(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "查询电机力矩", MOTOR_CMD_QUERY_TORQUE, QUERY_DATA, sizeof(QUERY_DATA));
+}
+
+void query_motor_power(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "查询电机功率", MOTOR_CMD_QUERY_POWER, QUERY_DATA, sizeof(QUERY_DATA));
+}
+
+void query_encoder_count(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "查询编码器计数", MOTOR_CMD_QUERY_ENCODER, QUERY_DATA, sizeof(QUERY_DATA));
+}
+
+void query_motor_exceptions(uart_port_t uart_port, uint8_t node_id, int exception_type) {
+    uint8_t exception_data[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    if (exception_type >= 0 && exception_type <= 4) {
+        exception_data[0] = exception_type;
+        // 记录查询的异常类型，用于后续解析该端口的异常响应
+        motor_controller_t* controller = motor_control_find(uart_port, node_id);
+        if (controller) {
+            controller->last_exception_query_type = exception_type;
+        }
+        ESP_LOGI("MOTOR_CONTROL", "UART%d 节点%d 设置异常查询类型为: %d", uart_port, node_id, exception_type);
+    }
+    send_serial_can_frame(uart_port, node_id, "查询电机异常", MOTOR_CMD_QUERY_EXCEPTION, exception_data, sizeof(exception_data));
+}
+
+void query_motor_position_speed(uart_port_t uart_port, uint8_t node_id) {
+    send_serial_can_frame(uart_port, node_id, "查询位置和转速", MOTOR_CMD_QUERY_POS_SPEED, QUERY_DATA, sizeof(QUERY_DATA));
+}
+
+int get_last_exception_query_type(uart_port_t uart_port, uint8_t node_id) {
+    motor_controller_t* controller = motor_control_find(uart_port, node_id);
+    return controller ? controller->last_exception_query_type : -1;
+}
+
+motor_controller_t* motor_control_find(uart_port_t uart_port, uint8_t node_id) {
+    for (int i = 0; i < MOTOR_CONTROL_MAX_MOTORS; i++) {
+        motor_controller_t* controller = g_controllers[i];
+        if (controller && controller->driver_config.uart_port == uart_port &&
+            controller->driver_config.node_id == node_id) {
+            return controller;
+        }
+    }
+    return NULL;
+}
+
+void motor_control_latency_begin(motor_controller_t* controller, uint32_t ingest_us) {
+    if (!controller) return;
+
+    controller->latency.ingest_us = ingest_us;
+    controller->latency.dispatch_us = (uint32_t)esp_timer_get_time();
+    __atomic_store_n(&controller->latency.state, MOTOR_LATENCY_DISPATCHED, __ATOMIC_RELEASE);
+}
+
+void motor_control_latency_feedback(motor_controller_t* controller) {
+    uint8_t expected = MOTOR_LATENCY_SENT;
+    if (!controller || !__atomic_compare_exchange_n(&controller->latency.state, &expected, MOTOR_LATENCY_IDLE,
+                                                    false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return;
+    }
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    motor_metrics_observe(&g_motor_metrics.latency_us[MOTOR_LATENCY_TX_FEEDBACK], now_us - controller->latency.tx_us);
+    motor_metrics_observe(&g_motor_metrics.latency_us[MOTOR_LATENCY_END_TO_END], now_us - controller->latency.ingest_us);
+}
+
+// ====================================================================================
+// --- 数据解析函数实现 ---
+// ====================================================================================
+
+// 异常位描述表：按位号索引，NULL为未定义的位
+
+// 电机异常位
+static const char* const motor_error_bits[MOTOR_ERROR_BITS] = {
+    [0]  = "相间电阻超出正常范围",              // 0x00000001
+    [1]  = "相间电感超出正常范围",              // 0x00000002
+    [4]  = "FOC频率太高",                       // 0x00000010
+    [7]  = "SVM调制异常",                       // 0x00000080
+    [10] = "相间电流饱和",                      // 0x00000400
+    [12] = "电机电流过大",                      // 0x00001000
+    [17] = "电机温度过高",                      // 0x00020000
+    [18] = "驱动器温度过高",                    // 0x00040000
+    [19] = "FOC处理不及时",                     // 0x00080000
+    [20] = "相间电流采样失效",                  // 0x00100000
+    [21] = "控制器异常",                        // 0x00200000
+    [22] = "母线电压超限",                      // 0x00400000
+    [23] = "刹车电阻驱动异常",                  // 0x00800000
+    [24] = "系统级异常",                        // 0x01000000
+    [25] = "相间电流采样不及时",                // 0x02000000
+    [26] = "电机位置未知",                      // 0x04000000
+    [27] = "电机速度未知",                      // 0x08000000
+    [28] = "力矩未知",                          // 0x10000000
+    [29] = "力矩控制未知",                      // 0x20000000
+    [30] = "电流采样值未知",                    // 0x40000000
+};
+
+// 编码器异常位
+static const char* const encoder_error_bits[MOTOR_ERROR_BITS] = {
+    [0]  = "编码器带宽过高",                    // 0x00000001
+    [1]  = "CPR和极对数不匹配",                 // 0x00000002
+    [2]  = "编码器无响应",                      // 0x00000004
+    [10] = "第二编码器通信错误",                // 0x00000400
+};
+
+// 控制器异常位
+static const char* const controller_error_bits[MOTOR_ERROR_BITS] = {
+    [0]  = "速度过高",                          // 0x00000001
+    [1]  = "控制输入模式不正确",                // 0x00000002
+    [2]  = "锁相环增益不稳",                    // 0x00000004
+    [5]  = "位置/速度不稳定",                   // 0x00000020
+    [7]  = "机械功率和电气功率不匹配(编码器校准不正确,或磁钢不稳)",  // 0x00000080
+};
+
+// 系统异常位
+static const char* const system_error_bits[MOTOR_ERROR_BITS] = {
+    [1]  = "电源电压过低",                      // 0x00000002
+    [2]  = "电源电压过高",                      // 0x00000004
+    [3]  = "电源反向（充电）电流过高",          // 0x00000008
+    [4]  = "电源正向（放电）电流过高",          // 0x00000010
+};
+
+// 异常类型信息结构
+typedef struct {
+    const char* const* bit_table;
+    size_t field_offset;  // 异常码在motor_status_t中的字段偏移量
+    size_t faults_offset; // 解码缓存在motor_status_t中的字段偏移量
+    motor_status_field_t field;  // 异常码的状态字段编号
+} error_type_info_t;
+
+// 统一的异常类型信息获取函数
+static const error_type_info_t* get_error_type_info(uint8_t error_type) {
+    static const error_type_info_t error_types[] = {
+        [0] = {motor_error_bits,      offsetof(motor_status_t, motor_error),        offsetof(motor_status_t, motor_faults),        MOTOR_STATUS_MOTOR_ERROR},     // 电机异常
+        [1] = {encoder_error_bits,    offsetof(motor_status_t, encoder_error),      offsetof(motor_status_t, encoder_faults),      MOTOR_STATUS_ENCODER_ERROR},   // 编码器异常
+        [3] = {controller_error_bits, offsetof(motor_status_t, controller_error),   offsetof(motor_status_t, controller_faults),   MOTOR_STATUS_CONTROLLER_ERROR}, // 控制器异常
+        [4] = {system_error_bits,     offsetof(motor_status_t, system_error),       offsetof(motor_status_t, system_faults),       MOTOR_STATUS_SYSTEM_ERROR},    // 系统异常
+    };
+    
+    if (error_type < sizeof(error_types)/sizeof(error_types[0]) && 
+        error_types[error_type].bit_table != NULL) {
+        return &error_types[error_type];
+    }
+    return NULL;
+}
+
+float ieee754_bytes_to_float(const uint8_t *bytes) {
+    union {
+        float f;
+        uint32_t u;
+    } converter;
+    
+    // 小端序转换
+    converter.u = (uint32_t)bytes[0] | 
+                  ((uint32_t)bytes[1] << 8) | 
+                  ((uint32_t)bytes[2] << 16) | 
+                  ((uint32_t)bytes[3] << 24);
+    
+    return converter.f;
+}
+
+int32_t bytes_to_int32(const uint8_t *bytes) {
+    return (int32_t)bytes[0] | 
+           ((int32_t)bytes[1] << 8) | 
+           ((int32_t)bytes[2] << 16) | 
+           ((int32_t)bytes[3] << 24);
+}
+
+/**
+ * @brief 写入一个4字节状态字段，按位比较判断是否变化（NaN也能判定为未变）
+ * @return 字段值是否变化
+ */
+static bool status_store(motor_status_t *status, motor_status_field_t field, void *dst, const void *value,
+                         uint32_t generation) {
+    if (memcmp(dst, value, 4) == 0) {
+        return false;
+    }
+    memcpy(dst, value, 4);
+    status->field_generation[field] = generation;
+    return true;
+}
+
+/**
+ * @brief 完成一帧响应的写入：更新有效标志、分组时间戳并发布新代次
+ */
+static void status_publish(motor_status_t *status, motor_status_group_t group, uint32_t generation) {
+    int64_t now_us = esp_timer_get_time();
+    if (!status->data_valid) {
+        status->data_valid = true;
+        status->field_generation[MOTOR_STATUS_DATA_VALID] = generation;
+    }
+    status->last_update_time = (uint32_t)(now_us / 1000); // 毫秒时间戳
+    status->field_generation[MOTOR_STATUS_LAST_UPDATE_TIME] = generation;
+    status->group_update_us[group] = now_us;
+    status->group_generation[group] = generation;
+    __atomic_store_n(&status->generation, generation, __ATOMIC_RELEASE);
+}
+
+const char* const MOTOR_STATUS_GROUP_NAMES[MOTOR_STATUS_GROUPS] = {
+    "torque", "power", "encoder", "position_speed", "exception"
+};
+
+bool motor_status_group_stale(const motor_status_t *status, motor_status_group_t group, int64_t now_us) {
+    int64_t updated_us = status->group_update_us[group];
+    if (updated_us == 0) {
+        return true;
+    }
+    uint32_t period_us = status->group_period_us[group];
+    return period_us && now_us - updated_us > (int64_t)period_us * MOTOR_STATUS_STALE_PERIODS;
+}
+
+void parse_torque_data(const uint8_t *data, motor_status_t *status) {
+    if (!data || !status) return;
+    
+    uint32_t generation = status->generation + 1;
+    float target_torque = ieee754_bytes_to_float(&data[0]);
+    float current_torque = ieee754_bytes_to_float(&data[4]);
+    status_store(status, MOTOR_STATUS_TARGET_TORQUE, &status->target_torque, &target_torque, generation);
+    status_store(status, MOTOR_STATUS_CURRENT_TORQUE, &status->current_torque, &current_torque, generation);
+    status_publish(status, MOTOR_STATUS_GROUP_TORQUE, generation);
+}
+
+void parse_power_data(const uint8_t *data, motor_status_t *status) {
+    if (!data || !status) return;
+    
+    uint32_t generation = status->generation + 1;
+    float electrical_power = ieee754_bytes_to_float(&data[0]);
+    float mechanical_power = ieee754_bytes_to_float(&data[4]);
+    status_store(status, MOTOR_STATUS_ELECTRICAL_POWER, &status->electrical_power, &electrical_power, generation);
+    status_store(status, MOTOR_STATUS_MECHANICAL_POWER, &status->mechanical_power, &mechanical_power, generation);
+    status_publish(status, MOTOR_STATUS_GROUP_POWER, generation);
+}
+
+void parse_encoder_data(const uint8_t *data, motor_status_t *status) {
+    if (!data || !status) return;
+    
+    uint32_t generation = status->generation + 1;
+    int32_t shadow_count = bytes_to_int32(&data[0]);
+    int32_t count_in_cpr = bytes_to_int32(&data[4]);
+    status_store(status, MOTOR_STATUS_SHADOW_COUNT, &status->shadow_count, &shadow_count, generation);
+    status_store(status, MOTOR_STATUS_COUNT_IN_CPR, &status->count_in_cpr, &count_in_cpr, generation);
+    status_publish(status, MOTOR_STATUS_GROUP_ENCODER, generation);
+}
+
+void parse_position_speed_data(const uint8_t *data, motor_status_t *status) {
+    if (!data || !status) return;
+    
+    uint32_t generation = status->generation + 1;
+    float position = ieee754_bytes_to_float(&data[0]);
+    float velocity = ieee754_bytes_to_float(&data[4]);
+    status_store(status, MOTOR_STATUS_POSITION, &status->position, &position, generation);
+    status_store(status, MOTOR_STATUS_VELOCITY, &status->velocity, &velocity, generation);
+    status_publish(status, MOTOR_STATUS_GROUP_POSITION_SPEED, generation);
+}
+
+void parse_error_data(const uint8_t *data, uint8_t error_type, motor_status_t *status) {
+    if (!data || !status) return;
+    
+    // 取前4字节作为异常码（小端序）
+    uint32_t error_code = (uint32_t)data[0] | 
+                          ((uint32_t)data[1] << 8) | 
+                          ((uint32_t)data[2] << 16) | 
+                          ((uint32_t)data[3] << 24);
+    
+    // 使用统一接口获取异常类型信息
+    uint32_t generation = status->generation + 1;
+    const error_type_info_t *type_info = get_error_type_info(error_type);
+    if (type_info) {
+        // 异常码不变时沿用上次的解码结果，状态查询接口直接读取缓存
+        motor_fault_list_t *faults = (motor_fault_list_t*)((char*)status + type_info->faults_offset);
+        if (faults->code != error_code) {
+            motor_error_decode(error_code, error_type, faults);
+        }
+
+        // 通过偏移量计算字段地址并存储异常码（包括0x00000000的正常状态）
+        uint32_t *error_field = (uint32_t*)((char*)status + type_info->field_offset);
+        status_store(status, type_info->field, error_field, &error_code, generation);
+    }
+    
+    status_publish(status, MOTOR_STATUS_GROUP_EXCEPTION, generation);
+}
+
+const char* get_error_description(uint32_t error_code, uint8_t error_type) {
+    if (error_code == 0) {
+        return "正常";
+    }
+    
+    const error_type_info_t *type_info = get_error_type_info(error_type);
+    if (!type_info) {
+        return "未知异常类型";
+    }
+    
+    if (error_code & (error_code - 1)) {
+        return "多项异常";
+    }
+    const char *description = type_info->bit_table[__builtin_ctz(error_code)];
+    return description ? description : "未知异常码";
+}
+
+uint8_t motor_error_decode(uint32_t error_code, uint8_t error_type, motor_fault_list_t *faults) {
+    faults->code = error_code;
+    faults->count = 0;
+    if (!get_error_type_info(error_type)) {
+        return 0;
+    }
+
+    // 每轮取最低置位并清除，循环次数等于置位个数
+    for (uint32_t remaining = error_code; remaining; remaining &= remaining - 1) {
+        faults->bits[faults->count++] = (uint8_t)__builtin_ctz(remaining);
+    }
+    return faults->count;
+}
+
+const char* motor_error_bit_description(uint8_t error_type, uint8_t bit) {
+    const error_type_info_t *type_info = get_error_type_info(error_type);
+    if (!type_info || bit >= MOTOR_ERROR_BITS || !type_info->bit_table[bit]) {
+        return "未知异常位";
+    }
+    return type_info->bit_table[bit];
+}
+
+const motor_fault_list_t* get_motor_faults(const motor_status_t *status, uint8_t error_type) {
+    const error_type_info_t *type_info = get_error_type_info(error_type);
+    if (!status || !type_info) {
+        return NULL;
+    }
+    return (const motor_fault_list_t*)((const char*)status + type_info->faults_offset);
+}
+
+motor_status_t* get_motor_status(uart_port_t uart_port, uint8_t node_id) {
+    motor_controller_t* controller = motor_control_find(uart_port, node_id);
+    return controller ? &controller->status : NULL;
+}
\ No newline at end of file
@@ -0,0 +1,581 @@
+#ifndef MOTOR_CONTROL_H
+#define MOTOR_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "driver/gpio.h"
+#include "motor_derived.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ====================================================================================
+// --- 电机控制模块数据结构定义 ---
+// ====================================================================================
+
+// 电机驱动配置结构
+typedef struct {
+    uart_port_t uart_port;          // UART端口号
+    gpio_num_t txd_pin;             // TXD引脚
+    gpio_num_t rxd_pin;             // RXD引脚
+    int baud_rate;                  // 波特率
+    int buf_size;                   // 缓冲区大小
+    uint8_t node_id;                // 驱动器节点ID (0-63)，同一UART上的多个驱动器按节点区分
+} motor_driver_config_t;
+
+#define MOTOR_ERROR_BITS            32      // 异常码位数
+
+// 异常码解码结果：异常码按位组合，每个置位对应一项异常
+typedef struct {
+    uint32_t code;                          // 解码时的异常码（异常码变化时才重新解码）
+    uint8_t count;                          // 置位个数
+    uint8_t bits[MOTOR_ERROR_BITS];         // 置位的位号（从低到高）
+} motor_fault_list_t;
+
+// 状态字段编号：每个字段记录最后一次变化时的状态代次，用于增量输出
+typedef enum {
+    MOTOR_STATUS_TARGET_TORQUE = 0,
+    MOTOR_STATUS_CURRENT_TORQUE,
+    MOTOR_STATUS_ELECTRICAL_POWER,
+    MOTOR_STATUS_MECHANICAL_POWER,
+    MOTOR_STATUS_SHADOW_COUNT,
+    MOTOR_STATUS_COUNT_IN_CPR,
+    MOTOR_STATUS_POSITION,
+    MOTOR_STATUS_VELOCITY,
+    MOTOR_STATUS_MOTOR_ERROR,
+    MOTOR_STATUS_ENCODER_ERROR,
+    MOTOR_STATUS_CONTROLLER_ERROR,
+    MOTOR_STATUS_SYSTEM_ERROR,
+    MOTOR_STATUS_DATA_VALID,
+    MOTOR_STATUS_LAST_UPDATE_TIME,
+    MOTOR_STATUS_FIELDS
+} motor_status_field_t;
+
+// 状态分组：同一种响应帧更新的字段为一组，顺序与调度器的query_event_type_t一致
+typedef enum {
+    MOTOR_STATUS_GROUP_TORQUE = 0,          // 力矩 (0x1C)
+    MOTOR_STATUS_GROUP_POWER,               // 功率 (0x1D)
+    MOTOR_STATUS_GROUP_ENCODER,             // 编码器 (0x0A)
+    MOTOR_STATUS_GROUP_POSITION_SPEED,      // 位置速度 (0x09)
+    MOTOR_STATUS_GROUP_EXCEPTION,           // 异常 (0x03，任一异常类型)
+    MOTOR_STATUS_GROUPS
+} motor_status_group_t;
+
+#define MOTOR_STATUS_STALE_PERIODS  2       // 距上次更新超过轮询周期的倍数视为过期（容许丢一次响应）
+
+extern const char* const MOTOR_STATUS_GROUP_NAMES[MOTOR_STATUS_GROUPS];
+
+// 电机实时状态结构
+typedef struct {
+    // 力矩反馈 (0x003C)
+    float target_torque;           // 目标力矩 (Nm)
+    float current_torque;          // 当前力矩 (Nm)
+    
+    // 功率反馈 (0x003D) 
+    float electrical_power;        // 电功率 (W)
+    float mechanical_power;        // 机械功率 (W)
+    
+    // 编码器反馈 (0x002A)
+    int32_t shadow_count;          // 多圈计数
+    int32_t count_in_cpr;          // 单圈计数
+    
+    // 位置转速反馈 (0x0029)
+    float position;                // 位置 (转)
+    float velocity;                // 转速 (转/s)
+    
+    // 异常状态 (0x0023)
+    uint32_t motor_error;          // 电机异常码
+    uint32_t encoder_error;        // 编码器异常码
+    uint32_t controller_error;     // 控制器异常码
+    uint32_t system_error;         // 系统异常码
+    motor_fault_list_t motor_faults;       // 电机异常码解码缓存
+    motor_fault_list_t encoder_faults;     // 编码器异常码解码缓存
+    motor_fault_list_t controller_faults;  // 控制器异常码解码缓存
+    motor_fault_list_t system_faults;      // 系统异常码解码缓存
+    
+    bool data_valid;               // 数据有效性标志
+    uint32_t last_update_time;     // 最后更新时间戳（毫秒，任一分组）
+
+    // 变化检测：每解析一帧响应代次加1，值有变化的字段记下该代次（last_update_time每帧都变）
+    // 先写字段代次再发布generation，读者先读generation，按代次过滤不会漏掉正在写入的字段
+    uint32_t generation;                                // 最新代次（0表示尚未收到响应）
+    uint32_t field_generation[MOTOR_STATUS_FIELDS];     // 各字段最后变化时的代次
+
+    // 分组新鲜度：时间戳取esp_timer单调微秒时钟，与值是否变化无关
+    int64_t group_update_us[MOTOR_STATUS_GROUPS];       // 各组最近一次响应的解析时间（0表示从未收到）
+    uint32_t group_generation[MOTOR_STATUS_GROUPS];     // 各组最近一次响应的代次
+    uint32_t group_period_us[MOTOR_STATUS_GROUPS];      // 各组的轮询周期（由状态调度器设置，0表示未轮询）
+} motor_status_t;
+
+// 帧ID布局（CANSimple风格）：16位ID = node_id << 5 | cmd，10字节帧 = 2字节ID(大端) + 8字节数据
+#define MOTOR_CMD_BITS              5
+#define MOTOR_MAX_NODE_ID           0x3F
+#define MOTOR_DEFAULT_NODE_ID       1
+#define MOTOR_FRAME_ID(node, cmd)   ((uint16_t)(((node) << MOTOR_CMD_BITS) | (cmd)))
+#define MOTOR_FRAME_NODE(id)        ((uint8_t)(((id) >> MOTOR_CMD_BITS) & MOTOR_MAX_NODE_ID))
+#define MOTOR_FRAME_CMD(id)         ((uint8_t)((id) & ((1 << MOTOR_CMD_BITS) - 1)))
+
+// 驱动器命令号（帧ID低5位）
+#define MOTOR_CMD_QUERY_EXCEPTION   0x03    // 查询电机异常
+#define MOTOR_CMD_SET_AXIS_STATE    0x07    // 使能/失能
+#define MOTOR_CMD_QUERY_POS_SPEED   0x09    // 查询转子位置和转速
+#define MOTOR_CMD_QUERY_ENCODER     0x0A    // 查询编码器多圈计数和单圈计数
+#define MOTOR_CMD_SET_CONTROL_MODE  0x0B    // 设置控制模式（速度/位置/力矩）
+#define MOTOR_CMD_TARGET_POS        0x0C    // 目标位置
+#define MOTOR_CMD_TARGET_VEL        0x0D    // 目标速度
+#define MOTOR_CMD_TARGET_TORQUE     0x0E    // 目标力矩
+#define MOTOR_CMD_RESTART           0x16    // 重启电机
+#define MOTOR_CMD_CLEAR_ERROR       0x18    // 清除错误和异常
+#define MOTOR_CMD_QUERY_TORQUE      0x1C    // 查询目标力矩和当前力矩
+#define MOTOR_CMD_QUERY_POWER       0x1D    // 查询电功率和机械功率
+
+#define MOTOR_CONTROL_MAX_MOTORS    6       // 控制器总数上限（可多个共用一个UART）
+
+// 每个电机UART驱动事件队列长度（共享UART监听任务的队列集合按此计算容量）
+#define MOTOR_UART_EVENT_QUEUE_SIZE 20
+
+// 命令->反馈延迟探针状态
+#define MOTOR_LATENCY_IDLE          0       // 无待测命令
+#define MOTOR_LATENCY_DISPATCHED    1       // 已开始下发，等待目标帧写入UART
+#define MOTOR_LATENCY_SENT          2       // 目标帧已写入，等待首个位置速度响应
+
+// 命令->反馈延迟探针（时间为esp_timer微秒低32位，差值按无符号回绕计算）
+typedef struct {
+    uint8_t state;                  // MOTOR_LATENCY_*，原子读写
+    uint32_t ingest_us;             // 命令到达
+    uint32_t dispatch_us;           // 开始下发
+    uint32_t tx_us;                 // 目标帧写入UART
+} motor_latency_probe_t;
+
+struct motor_controller;
+
+/**
+ * @brief 设定点代次变化通知（在调用motor_control_setpoint_changed的任务上下文中执行）
+ * 轨迹发生器据此中止仍在向该电机输出设定点的运动
+ */
+typedef void (*motor_setpoint_hook_t)(struct motor_controller* controller, void* context);
+
+// 电机控制器主结构
+typedef struct motor_controller {
+    motor_driver_config_t driver_config;   // 驱动配置
+    bool motor_enabled;                    // 电机使能状态
+    motor_status_t status;                 // 电机实时状态
+    int last_exception_query_type;         // 最后查询的异常类型（-1:未查询），用于解析异常响应
+    QueueHandle_t uart_event_queue;        // UART驱动事件队列（同一UART上的控制器共用，供共享UART监听任务使用）
+    uint32_t tx_frames[1 << MOTOR_CMD_BITS];  // 按命令号统计的发送帧数（原子自增，供/metrics导出）
+    uint32_t rx_frames[1 << MOTOR_CMD_BITS];  // 按命令号统计的已解析响应帧数
+    motor_latency_probe_t latency;         // 最近一条目标命令的延迟探针
+    motor_derived_t derived;               // 派生信号（滤波速度/加速度、累计能量、力矩窗口统计）
+    bool ready;                            // 驱动器已响应并完成上电模式设置（原子读写，之后才接受运动命令）
+    int64_t ready_us;                      // 就绪时间（esp_timer微秒，即上电到就绪的耗时）
+    uint32_t setpoint_epoch;               // 设定点代次：模式切换、单次目标下发、使能变化、重启或检测到故障时加1（原子）；
+                                           // 流式位置（motor_control_stream_positions）不改变代次，G代码据此判断目标是否被其他来源改写
+    motor_setpoint_hook_t setpoint_hook;   // 代次变化通知（NULL表示无），由G代码控制器注册
+    void* setpoint_hook_context;           // 通知回调上下文
+} motor_controller_t;
+
+// ====================================================================================
+// --- 电机控制模块接口函数 ---
+// ====================================================================================
+
+/**
+ * @brief 初始化电机控制器
+ * @param driver_config 驱动配置
+ * @return 电机控制器句柄，失败返回NULL
+ */
+motor_controller_t* motor_control_init(const motor_driver_config_t* driver_config);
+
+/**
+ * @brief 销毁电机控制器
+ * @param controller 电机控制器句柄
+ */
+void motor_control_deinit(motor_controller_t* controller);
+
+/**
+ * @brief 使能/失能电机
+ * @param controller 电机控制器句柄
+ * @param enable true为使能，false为失能
+ */
+void motor_control_enable(motor_controller_t* controller, bool enable);
+
+
+/**
+ * @brief 设置电机速度模式
+ * @param controller 电机控制器句柄
+ */
+void motor_control_set_velocity_mode(motor_controller_t* controller);
+
+/**
+ * @brief 设置电机目标速度
+ * @param controller 电机控制器句柄
+ * @param velocity 目标速度 (r/s)
+ */
+void motor_control_set_velocity(motor_controller_t* controller, float velocity);
+
+/**
+ * @brief 设置电机位置模式
+ * @param controller 电机控制器句柄
+ */
+void motor_control_set_position_mode(motor_controller_t* controller);
+
+/**
+ * @brief 设置电机位置直通模式（驱动器直接跟随设定点，由轨迹发生器负责加减速）
+ * @param controller 电机控制器句柄
+ */
+void motor_control_set_position_passthrough_mode(motor_controller_t* controller);
+
+/**
+ * @brief 设置电机目标位置
+ * @param controller 电机控制器句柄
+ * @param position 目标位置 
+ */
+void motor_control_set_position(motor_controller_t* controller, float position);
+
+/**
+ * @brief 多电机目标位置突发发送：先组好全部帧，再连续写入各UART（同一UART上的节点依次排队）
+ * @param controllers 各电机控制器句柄
+ * @param positions 各电机目标位置
+ * @param count 电机数
+ * @return 轴间偏差 (us)：第一帧与最后一帧交给UART驱动的时间差
+ */
+uint32_t motor_control_stream_positions(motor_controller_t* const* controllers, const float* positions, uint8_t count);
+
+/**
+ * @brief 设置电机力矩模式
+ * @param controller 电机控制器句柄
+ */
+void motor_control_set_torque_mode(motor_controller_t* controller);
+
+/**
+ * @brief 设置电机目标力矩
+ * @param controller 电机控制器句柄
+ * @param torque 目标力矩 (Nm)
+ */
+void motor_control_set_torque(motor_controller_t* controller, float torque);
+
+
+/**
+ * @brief 清除电机错误和异常
+ * @param controller 电机控制器句柄
+ */
+void motor_control_clear_errors(motor_controller_t* controller);
+
+/**
+ * @brief 获取电机使能状态
+ * @param controller 电机控制器句柄
+ * @return 使能状态
+ */
+bool motor_control_is_enabled(motor_controller_t* controller);
+
+/**
+ * @brief 驱动器是否已就绪（见motor_registry_bring_up），未就绪时拒绝运动命令
+ */
+bool motor_control_is_ready(const motor_controller_t* controller);
+
+/**
+ * @brief 查询编码器并等待响应，读取展开后的64位多圈计数（绝对位置，见motor_units_count_to_angle）
+ * @param wait_ms 等待新响应的最长时间
+ * @return 超时未收到新的编码器响应返回false
+ */
+bool motor_control_query_absolute_count(motor_controller_t* controller, uint32_t wait_ms, int64_t* count);
+
+/**
+ * @brief 标记驱动器已就绪并记录就绪时间（由motor_registry_bring_up在驱动器响应后调用）
+ */
+void motor_control_mark_ready(motor_controller_t* controller);
+
+/**
+ * @brief 当前设定点代次（见motor_controller_t.setpoint_epoch）
+ */
+uint32_t motor_control_setpoint_epoch(const motor_controller_t* controller);
+
+/**
+ * @brief 设定点代次加1：控制模块之外改变了驱动器的目标或状态（如直接发送重启命令、检测到故障）
+ * 加1后调用已注册的通知回调（中止正在流式输出的轨迹），回调返回后才发送新的命令
+ */
+void motor_control_setpoint_changed(motor_controller_t* controller);
+
+/**
+ * @brief 注册设定点代次变化通知（每个电机一个，后注册的覆盖先注册的）
+ * @param hook 通知回调，NULL表示注销
+ * @param context 回调上下文
+ */
+void motor_control_set_setpoint_hook(motor_controller_t* controller, motor_setpoint_hook_t hook, void* context);
+
+/**
+ * @brief 注销设定点代次变化通知（仅当当前注册的上下文为context时）
+ */
+void motor_control_clear_setpoint_hook(motor_controller_t* controller, void* context);
+
+// ====================================================================================
+// --- 低级别电机驱动函数 ---
+// ====================================================================================
+
+/**
+ * @brief 设置电机为速度直接模式
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void set_motor_velocity_mode(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 设置电机为位置模式
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void set_motor_position_mode(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 设置电机为位置直通模式
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void set_motor_position_passthrough_mode(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 发送目标位置
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @param position 目标位置 
+ */
+void send_target_position(uart_port_t uart_port, uint8_t node_id, float position);
+
+/**
+ * @brief 高频流式发送目标位置（不打印日志，供轨迹发生器使用）
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @param position 目标位置
+ */
+void stream_target_position(uart_port_t uart_port, uint8_t node_id, float position);
+
+/**
+ * @brief 发送目标速度
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @param velocity 目标速度 (r/s)
+ */
+void send_target_velocity(uart_port_t uart_port, uint8_t node_id, float velocity);
+
+/**
+ * @brief 设置电机为力矩模式
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void set_motor_torque_mode(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 发送目标力矩
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @param torque 目标力矩 (Nm)
+ */
+void send_target_torque(uart_port_t uart_port, uint8_t node_id, float torque);
+
+/**
+ * @brief 使能电机
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void enable_motor(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 失能电机
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void disable_motor(uart_port_t uart_port, uint8_t node_id);
+
+
+/**
+ * @brief 清除电机错误和异常
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void clear_motor_errors(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 重启电机
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void restart_motor(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 查询电机目标力矩和当前力矩
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void query_motor_torque(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 查询电机电功率和机械功率
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void query_motor_power(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 查询编码器多圈计数和单圈计数
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void query_encoder_count(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 查询电机异常信息
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @param exception_type 异常类型 (0-4: 电机异常/编码器异常/控制异常/系统异常)
+ */
+void query_motor_exceptions(uart_port_t uart_port, uint8_t node_id, int exception_type);
+
+/**
+ * @brief 获取最后查询的异常类型
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @return 异常类型 (0:电机, 1:编码器, 3:控制器, 4:系统, -1:未查询)
+ */
+int get_last_exception_query_type(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 查询电机转子位置和转速
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ */
+void query_motor_position_speed(uart_port_t uart_port, uint8_t node_id);
+
+// ====================================================================================
+// --- 数据解析函数 ---
+// ====================================================================================
+
+/**
+ * @brief 将4字节小端序数据转换为IEEE754浮点数
+ * @param bytes 4字节数据指针
+ * @return float32值
+ */
+float ieee754_bytes_to_float(const uint8_t *bytes);
+
+/**
+ * @brief 将4字节小端序数据转换为int32
+ * @param bytes 4字节数据指针
+ * @return int32值
+ */
+int32_t bytes_to_int32(const uint8_t *bytes);
+
+/**
+ * @brief 解析力矩反馈数据
+ * @param data 8字节CAN数据
+ * @param status 电机状态结构体指针
+ */
+void parse_torque_data(const uint8_t *data, motor_status_t *status);
+
+/**
+ * @brief 解析功率反馈数据
+ * @param data 8字节CAN数据
+ * @param status 电机状态结构体指针
+ */
+void parse_power_data(const uint8_t *data, motor_status_t *status);
+
+/**
+ * @brief 解析编码器反馈数据
+ * @param data 8字节CAN数据
+ * @param status 电机状态结构体指针
+ */
+void parse_encoder_data(const uint8_t *data, motor_status_t *status);
+
+/**
+ * @brief 解析位置转速反馈数据
+ * @param data 8字节CAN数据
+ * @param status 电机状态结构体指针
+ */
+void parse_position_speed_data(const uint8_t *data, motor_status_t *status);
+
+/**
+ * @brief 解析异常反馈数据
+ * @param data 8字节CAN数据
+ * @param error_type 异常类型 (0:电机 1:编码器 3:控制器 4:系统)
+ * @param status 电机状态结构体指针
+ */
+void parse_error_data(const uint8_t *data, uint8_t error_type, motor_status_t *status);
+
+/**
+ * @brief 根据异常码获取异常描述
+ * @param error_code 异常码
+ * @param error_type 异常类型
+ * @return 异常描述字符串（多个位同时置位时返回"多项异常"，逐项描述见motor_error_decode）
+ */
+const char* get_error_description(uint32_t error_code, uint8_t error_type);
+
+/**
+ * @brief 按位解码异常码（逐个取最低置位）
+ * @param error_code 异常码
+ * @param error_type 异常类型
+ * @param faults 输出置位列表
+ * @return 置位个数
+ */
+uint8_t motor_error_decode(uint32_t error_code, uint8_t error_type, motor_fault_list_t *faults);
+
+/**
+ * @brief 获取单个异常位的描述
+ * @param error_type 异常类型
+ * @param bit 位号 (0-31)
+ * @return 异常描述；未定义的位返回"未知异常位"
+ */
+const char* motor_error_bit_description(uint8_t error_type, uint8_t bit);
+
+/**
+ * @brief 状态分组是否过期：从未收到响应，或距上次响应超过MOTOR_STATUS_STALE_PERIODS个轮询周期
+ * @param status 电机状态结构体指针
+ * @param group 状态分组
+ * @param now_us 当前esp_timer时间（微秒）
+ */
+bool motor_status_group_stale(const motor_status_t *status, motor_status_group_t group, int64_t now_us);
+
+/**
+ * @brief 获取异常码的解码缓存（parse_error_data在异常码变化时更新）
+ * @param status 电机状态结构体指针
+ * @param error_type 异常类型
+ * @return 解码缓存，异常类型无效时返回NULL
+ */
+const motor_fault_list_t* get_motor_faults(const motor_status_t *status, uint8_t error_type);
+
+/**
+ * @brief 获取指定UART端口、节点上电机的状态
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @return 电机状态结构体指针，未初始化该电机时返回NULL
+ */
+motor_status_t* get_motor_status(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 根据UART端口和节点ID查找电机控制器
+ * @param uart_port UART端口
+ * @param node_id 驱动器节点ID
+ * @return 电机控制器句柄，未找到返回NULL
+ */
+motor_controller_t* motor_control_find(uart_port_t uart_port, uint8_t node_id);
+
+/**
+ * @brief 开始测量一条目标命令（位置/速度/力矩）的命令->反馈延迟，在下发前调用
+ * 之后该电机第一个目标帧写入UART记为发送时间，第一个位置速度响应解析完成记为反馈时间，
+ * 各阶段耗时计入g_motor_metrics.latency_us；反馈到达前的新命令覆盖旧命令
+ * @param controller 电机控制器句柄（NULL时忽略）
+ * @param ingest_us 命令到达时间（esp_timer微秒低32位）
+ */
+void motor_control_latency_begin(motor_controller_t* controller, uint32_t ingest_us);
+
+/**
+ * @brief 位置速度响应解析完成（UART监听调用），结束等待反馈的延迟测量
+ */
+void motor_control_latency_feedback(motor_controller_t* controller);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_CONTROL_H
\ No newline at end of file
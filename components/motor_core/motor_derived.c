@@ -0,0 +1,128 @@
+#include "motor_derived.h"
+#include <string.h>
+#include <math.h>
+
+#define WINDOW MOTOR_DERIVED_TORQUE_WINDOW
+
+void motor_derived_reset(motor_derived_t* derived) {
+    memset(derived, 0, sizeof(motor_derived_t));
+}
+
+void motor_derived_encoder(motor_derived_t* derived, int32_t shadow_count, int64_t now_us) {
+    // 展开多圈计数：与滤波不同，长时间无样本也按差值累加（两次样本间转动不超过2^31计数即正确）
+    int64_t absolute = derived->encoder_valid ?
+        derived->absolute_count + (int32_t)((uint32_t)shadow_count - (uint32_t)derived->encoder_count) : shadow_count;
+    __atomic_store_n(&derived->absolute_count, absolute, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&derived->encoder_samples, 1, __ATOMIC_RELEASE);
+
+    int64_t dt_us = now_us - derived->encoder_us;
+    if (!derived->encoder_valid || dt_us <= 0 || dt_us > MOTOR_DERIVED_MAX_GAP_US) {
+        // 首个样本或长时间无样本：以当前计数为起点，速度与加速度从0开始收敛
+        derived->encoder_valid = true;
+        derived->encoder_count = shadow_count;
+        derived->encoder_us = now_us;
+        derived->position_offset = 0.0f;
+        derived->velocity = 0.0f;
+        derived->acceleration = 0.0f;
+        return;
+    }
+
+    float dt = (float)dt_us / 1000000.0f;
+    // 按无符号相减，多圈计数回绕时差值仍正确
+    float measured = (float)(int32_t)((uint32_t)shadow_count - (uint32_t)derived->encoder_count);
+    float predicted = derived->position_offset + derived->velocity * dt;
+    float residual = measured - predicted;
+    float velocity = derived->velocity + MOTOR_DERIVED_BETA * residual / dt;
+
+    derived->acceleration += MOTOR_DERIVED_ACCEL_SMOOTHING *
+                             ((velocity - derived->velocity) / dt - derived->acceleration);
+    derived->velocity = velocity;
+    derived->position_offset = predicted + MOTOR_DERIVED_ALPHA * residual - measured;
+    derived->encoder_count = shadow_count;
+    derived->encoder_us = now_us;
+}
+
+bool motor_derived_absolute_count(const motor_derived_t* derived, int64_t* count) {
+    if (motor_derived_encoder_samples(derived) == 0) {
+        return false;
+    }
+    *count = __atomic_load_n(&derived->absolute_count, __ATOMIC_RELAXED);
+    return true;
+}
+
+uint32_t motor_derived_encoder_samples(const motor_derived_t* derived) {
+    return __atomic_load_n(&derived->encoder_samples, __ATOMIC_ACQUIRE);
+}
+
+void motor_derived_power(motor_derived_t* derived, float electrical_power, float mechanical_power, int64_t now_us) {
+    if (derived->power_valid) {
+        int64_t dt_us = now_us - derived->power_us;
+        if (dt_us > 0 && dt_us <= MOTOR_DERIVED_MAX_GAP_US) {
+            double dt = (double)dt_us / 1000000.0;
+            derived->electrical_energy += 0.5 * (derived->electrical_power + electrical_power) * dt;
+            derived->mechanical_energy += 0.5 * (derived->mechanical_power + mechanical_power) * dt;
+        } else {
+            derived->power_gaps++;
+        }
+    }
+    derived->power_valid = true;
+    derived->power_us = now_us;
+    derived->electrical_power = electrical_power;
+    derived->mechanical_power = mechanical_power;
+}
+
+static inline float torque_at(const motor_derived_t* derived, uint32_t seq) {
+    return derived->torque_samples[seq % WINDOW];
+}
+
+void motor_derived_torque(motor_derived_t* derived, float torque) {
+    uint32_t seq = derived->torque_seq;
+
+    // 窗口已满：移出最旧样本（其环形槽位随后被新样本覆盖）
+    if (seq >= WINDOW) {
+        uint32_t oldest = seq - WINDOW;
+        float old = torque_at(derived, oldest);
+        derived->torque_sum_sq -= (double)old * old;
+        if (derived->min_count && derived->min_queue[derived->min_head] == oldest) {
+            derived->min_head = (derived->min_head + 1) % WINDOW;
+            derived->min_count--;
+        }
+        if (derived->max_count && derived->max_queue[derived->max_head] == oldest) {
+            derived->max_head = (derived->max_head + 1) % WINDOW;
+            derived->max_count--;
+        }
+    }
+    derived->torque_samples[seq % WINDOW] = torque;
+    derived->torque_sum_sq += (double)torque * torque;
+
+    // 单调队列：从队尾弹出被新样本支配的序号，每个样本最多入队出队各一次，均摊O(1)
+    while (derived->min_count &&
+           torque_at(derived, derived->min_queue[(derived->min_head + derived->min_count - 1) % WINDOW]) >= torque) {
+        derived->min_count--;
+    }
+    derived->min_queue[(derived->min_head + derived->min_count) % WINDOW] = seq;
+    derived->min_count++;
+
+    while (derived->max_count &&
+           torque_at(derived, derived->max_queue[(derived->max_head + derived->max_count - 1) % WINDOW]) <= torque) {
+        derived->max_count--;
+    }
+    derived->max_queue[(derived->max_head + derived->max_count) % WINDOW] = seq;
+    derived->max_count++;
+
+    derived->torque_seq = seq + 1;
+}
+
+void motor_derived_get_torque_stats(const motor_derived_t* derived, motor_derived_torque_stats_t* stats) {
+    uint32_t samples = derived->torque_seq < WINDOW ? derived->torque_seq : WINDOW;
+    stats->samples = (uint8_t)samples;
+    if (samples == 0 || !derived->min_count || !derived->max_count) {
+        stats->min = stats->max = stats->rms = 0.0f;
+        return;
+    }
+    stats->min = torque_at(derived, derived->min_queue[derived->min_head]);
+    stats->max = torque_at(derived, derived->max_queue[derived->max_head]);
+    // 滑动加减的平方和可能因舍入略小于0
+    double mean_sq = derived->torque_sum_sq / samples;
+    stats->rms = mean_sq > 0.0 ? (float)sqrt(mean_sq) : 0.0f;
+}
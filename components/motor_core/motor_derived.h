@@ -0,0 +1,103 @@
+#ifndef MOTOR_DERIVED_H
+#define MOTOR_DERIVED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 派生信号：由UART响应解析直接驱动，固定内存、每个样本O(1)
+//   编码器多圈计数 -> alpha-beta滤波的速度，速度差分再指数平滑得到加速度（单位：计数/s、计数/s²）
+//   电功率/机械功率 -> 梯形积分得到累计能量（焦耳）
+//   当前力矩 -> 最近MOTOR_DERIVED_TORQUE_WINDOW个样本的最小/最大值（单调队列）与均方根（滑动平方和）
+
+#define MOTOR_DERIVED_TORQUE_WINDOW     32          // 力矩统计窗口（样本数）
+#define MOTOR_DERIVED_ALPHA             0.5f        // alpha-beta滤波位置增益
+#define MOTOR_DERIVED_BETA              0.2f        // alpha-beta滤波速度增益
+#define MOTOR_DERIVED_ACCEL_SMOOTHING   0.3f        // 加速度指数平滑系数（新样本权重）
+#define MOTOR_DERIVED_MAX_GAP_US        2000000     // 相邻样本间隔超过该值时重新起算（不跨间隙滤波/积分）
+
+typedef struct {
+    // 编码器滤波：位置以上一次原始计数为参考点存偏移量，多圈计数很大时浮点也不丢精度
+    bool encoder_valid;
+    int32_t encoder_count;                  // 上一次的原始多圈计数
+    int64_t encoder_us;                     // 上一次编码器样本时间
+    float position_offset;                  // 滤波位置 - 上一次原始计数（计数）
+    float velocity;                         // 滤波速度（计数/s）
+    float acceleration;                     // 平滑加速度（计数/s²）
+    // 绝对位置：原始int32计数按回绕差值累加到64位，长时间多圈运行不溢出（原子读写，供其他任务读取）
+    int64_t absolute_count;                 // 展开后的多圈计数
+    uint32_t encoder_samples;               // 已处理的编码器样本数（absolute_count写入后递增）
+
+    // 能量积分
+    bool power_valid;
+    int64_t power_us;                       // 上一次功率样本时间
+    float electrical_power;                 // 上一次电功率 (W)
+    float mechanical_power;                 // 上一次机械功率 (W)
+    double electrical_energy;               // 累计电能 (J)
+    double mechanical_energy;               // 累计机械能 (J)
+    uint32_t power_gaps;                    // 因间隔过长未积分的区间数
+
+    // 力矩滑动窗口：样本按序号环形存放，单调队列存样本序号
+    float torque_samples[MOTOR_DERIVED_TORQUE_WINDOW];
+    uint32_t torque_seq;                    // 已收到的力矩样本数（下一个样本的序号）
+    uint32_t min_queue[MOTOR_DERIVED_TORQUE_WINDOW];   // 值递增的样本序号，队首为窗口最小值
+    uint32_t max_queue[MOTOR_DERIVED_TORQUE_WINDOW];   // 值递减的样本序号，队首为窗口最大值
+    uint8_t min_head, min_count;
+    uint8_t max_head, max_count;
+    double torque_sum_sq;                   // 窗口内力矩平方和
+} motor_derived_t;
+
+// 力矩窗口统计
+typedef struct {
+    uint8_t samples;                        // 窗口内样本数（0表示尚无样本）
+    float min;
+    float max;
+    float rms;
+} motor_derived_torque_stats_t;
+
+/**
+ * @brief 清零派生信号状态
+ */
+void motor_derived_reset(motor_derived_t* derived);
+
+/**
+ * @brief 输入一次编码器多圈计数
+ * @param now_us 样本时间（esp_timer微秒）
+ */
+void motor_derived_encoder(motor_derived_t* derived, int32_t shadow_count, int64_t now_us);
+
+/**
+ * @brief 读取展开后的64位多圈计数（可在其他任务中调用）
+ * @return 尚未收到编码器样本返回false
+ */
+bool motor_derived_absolute_count(const motor_derived_t* derived, int64_t* count);
+
+/**
+ * @brief 已处理的编码器样本数（用于等待下一次编码器响应）
+ */
+uint32_t motor_derived_encoder_samples(const motor_derived_t* derived);
+
+/**
+ * @brief 输入一次功率样本并累计能量
+ * @param now_us 样本时间（esp_timer微秒）
+ */
+void motor_derived_power(motor_derived_t* derived, float electrical_power, float mechanical_power, int64_t now_us);
+
+/**
+ * @brief 输入一次当前力矩样本
+ */
+void motor_derived_torque(motor_derived_t* derived, float torque);
+
+/**
+ * @brief 读取力矩窗口统计
+ */
+void motor_derived_get_torque_stats(const motor_derived_t* derived, motor_derived_torque_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_DERIVED_H
@@ -0,0 +1,614 @@
+#include "sdkconfig.h"
+
+#if CONFIG_MOTOR_DRIVE_SIM
+
+#include "motor_drive_sim.h"
+#include "motor_control.h"
+#include "motor_units.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_log.h"
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "DRIVE_SIM";
+
+#define SIM_FRAME_SIZE          10      // 2字节ID + 8字节数据
+#define SIM_PENDING_DEPTH       32      // 待发送响应队列深度
+#define SIM_TASK_STACK_SIZE     4096
+#define SIM_TASK_PRIORITY       6       // 高于状态查询任务，低于轨迹设定点任务
+
+// 电机+负载模型参数（折算到电机轴）
+#define SIM_TWO_PI              6.2831853f
+#define SIM_INERTIA             0.0002f // 转动惯量 (kg·m²)
+#define SIM_DAMPING             0.0004f // 粘性阻尼 (Nm/(rad/s))
+#define SIM_COULOMB_FRICTION    0.01f   // 库仑摩擦 (Nm)
+#define SIM_TORQUE_LIMIT        1.5f    // 力矩限幅 (Nm)
+#define SIM_CURRENT_TAU         0.002f  // 电流环等效时间常数 (s)
+#define SIM_POS_GAIN            20.0f   // 位置环增益 ((转/s)/转)
+#define SIM_VEL_GAIN            0.1f    // 速度环增益 (Nm/(转/s))
+#define SIM_VEL_INTEGRATOR_GAIN 0.5f    // 速度环积分增益 (Nm/转)，消除摩擦造成的稳态误差
+#define SIM_VEL_LIMIT_PASSTHROUGH 50.0f // 位置直通模式速度上限 (转/s)
+#define SIM_VEL_LIMIT_RAMP      10.0f   // 位置斜坡模式速度上限 (转/s)
+#define SIM_COPPER_LOSS         2.0f    // 铜损系数 (W/Nm²)：电功率 = 机械功率 + k·T²
+
+// 命令数据中的模式编码（与motor_control.c发送的数据一致）
+#define SIM_AXIS_STATE_CLOSED_LOOP 0x08
+#define SIM_CONTROL_MODE_TORQUE    1
+#define SIM_CONTROL_MODE_VELOCITY  2
+#define SIM_CONTROL_MODE_POSITION  3
+#define SIM_INPUT_MODE_PASSTHROUGH 1
+
+typedef struct {
+    bool used;
+    uart_port_t uart_port;
+    uint8_t node_id;
+    motor_drive_sim_node_t state;
+    float position_target;      // 位置目标 (转)
+    float velocity_target;      // 速度目标 (转/s)
+    float torque_target;        // 力矩目标 (Nm)
+    float torque_command;       // 控制律输出（限幅后，电流环前）
+    float velocity_integrator;  // 速度环积分项 (Nm)
+} sim_node_t;
+
+typedef struct {
+    bool attached;
+    QueueHandle_t event_queue;          // 送给uart_monitor的UART事件
+    StreamBufferHandle_t rx_stream;     // 驱动器 -> 主机 字节流
+    uint8_t tx_frame[SIM_FRAME_SIZE];   // 主机 -> 驱动器 未凑满一帧的字节
+    uint8_t tx_length;
+} sim_port_t;
+
+typedef struct {
+    uart_port_t uart_port;
+    int64_t due_us;                     // 最早送达时间
+    uint8_t length;
+    uint8_t offset;                     // 已送达字节数（分片投递）
+    uint8_t bytes[SIM_FRAME_SIZE + 1];  // 响应帧（可能带一个前置噪声字节）
+} sim_response_t;
+
+static SemaphoreHandle_t g_sim_lock = NULL;     // 保护节点、端口帧重组、故障参数和统计
+static QueueHandle_t g_pending = NULL;
+static TaskHandle_t g_sim_task = NULL;
+static esp_timer_handle_t g_sim_timer = NULL;
+static sim_port_t g_ports[UART_NUM_MAX];
+static sim_node_t g_nodes[MOTOR_DRIVE_SIM_MAX_NODES];
+static motor_drive_sim_stats_t g_stats;
+static motor_drive_sim_faults_t g_faults = {
+    .latency_us = CONFIG_MOTOR_DRIVE_SIM_LATENCY_US,
+    .fragment_size = CONFIG_MOTOR_DRIVE_SIM_FRAGMENT_SIZE,
+    .drop_permille = CONFIG_MOTOR_DRIVE_SIM_DROP_PERMILLE,
+    .corrupt_permille = CONFIG_MOTOR_DRIVE_SIM_CORRUPT_PERMILLE,
+    .noise_permille = CONFIG_MOTOR_DRIVE_SIM_NOISE_PERMILLE,
+};
+
+static bool sim_chance(uint16_t permille) {
+    return permille > 0 && (esp_random() % 1000) < permille;
+}
+
+static void sim_put_float(uint8_t* bytes, float value) {
+    memcpy(bytes, &value, sizeof(value));   // 小端序，与ieee754_bytes_to_float一致
+}
+
+static void sim_put_int32(uint8_t* bytes, int32_t value) {
+    bytes[0] = value & 0xFF;
+    bytes[1] = (value >> 8) & 0xFF;
+    bytes[2] = (value >> 16) & 0xFF;
+    bytes[3] = (value >> 24) & 0xFF;
+}
+
+static float sim_clampf(float value, float limit) {
+    if (value > limit) return limit;
+    if (value < -limit) return -limit;
+    return value;
+}
+
+static sim_node_t* sim_find_node(uart_port_t uart_port, uint8_t node_id, bool create) {
+    sim_node_t* free_node = NULL;
+    for (int i = 0; i < MOTOR_DRIVE_SIM_MAX_NODES; i++) {
+        if (g_nodes[i].used) {
+            if (g_nodes[i].uart_port == uart_port && g_nodes[i].node_id == node_id) {
+                return &g_nodes[i];
+            }
+        } else if (!free_node) {
+            free_node = &g_nodes[i];
+        }
+    }
+    if (!create || !free_node) {
+        return NULL;
+    }
+
+    // 总线上首次被寻址的节点视为在线，上电状态：失能、位置模式、停在零点
+    memset(free_node, 0, sizeof(*free_node));
+    free_node->used = true;
+    free_node->uart_port = uart_port;
+    free_node->node_id = node_id;
+    free_node->state.control_mode = SIM_CONTROL_MODE_POSITION;
+    free_node->state.input_mode = SIM_INPUT_MODE_PASSTHROUGH;
+    ESP_LOGI(TAG, "UART%d 模拟驱动器节点%d 上线", uart_port, node_id);
+    return free_node;
+}
+
+/**
+ * @brief 组装响应帧并按故障注入参数排入待发送队列（调用方持有g_sim_lock）
+ */
+static void sim_queue_response(uart_port_t uart_port, uint16_t can_id, const uint8_t* data) {
+    if (sim_chance(g_faults.drop_permille)) {
+        g_stats.responses_dropped++;
+        return;
+    }
+
+    sim_response_t response = {
+        .uart_port = uart_port,
+        .due_us = esp_timer_get_time() + g_faults.latency_us,
+        .length = 0,
+        .offset = 0,
+    };
+    if (sim_chance(g_faults.noise_permille)) {
+        response.bytes[response.length++] = esp_random() & 0xFF;
+        g_stats.noise_bytes++;
+    }
+    uint8_t* frame = &response.bytes[response.length];
+    frame[0] = (can_id >> 8) & 0xFF;
+    frame[1] = can_id & 0xFF;
+    memcpy(&frame[2], data, 8);
+    response.length += SIM_FRAME_SIZE;
+    if (sim_chance(g_faults.corrupt_permille)) {
+        frame[esp_random() % 2] ^= 1 << (esp_random() % 8);
+        g_stats.responses_corrupted++;
+    }
+
+    if (xQueueSend(g_pending, &response, 0) != pdPASS) {
+        g_stats.responses_dropped++;
+        return;
+    }
+    UBaseType_t depth = uxQueueMessagesWaiting(g_pending);
+    if (depth > g_stats.pending_high_watermark) {
+        g_stats.pending_high_watermark = depth;
+    }
+}
+
+static void sim_build_response(sim_node_t* node, uint8_t cmd, const uint8_t* request, uint8_t* data) {
+    const motor_drive_sim_node_t* s = &node->state;
+    memset(data, 0, 8);
+    switch (cmd) {
+        case MOTOR_CMD_QUERY_TORQUE:
+            sim_put_float(&data[0], node->torque_command);
+            sim_put_float(&data[4], s->torque);
+            break;
+        case MOTOR_CMD_QUERY_POWER: {
+            float mechanical = s->torque * s->velocity * SIM_TWO_PI;
+            sim_put_float(&data[0], mechanical + SIM_COPPER_LOSS * s->torque * s->torque);
+            sim_put_float(&data[4], mechanical);
+            break;
+        }
+        case MOTOR_CMD_QUERY_ENCODER: {
+            // 编码器每转MOTOR_DRIVE_SIM_ENCODER_CPR计数，对应ANGLE_TO_POSITION_SCALE个位置值
+            int32_t shadow = (int32_t)floor((double)s->position *
+                                            (MOTOR_DRIVE_SIM_ENCODER_CPR / ANGLE_TO_POSITION_SCALE));
+            int32_t in_cpr = shadow % MOTOR_DRIVE_SIM_ENCODER_CPR;
+            if (in_cpr < 0) in_cpr += MOTOR_DRIVE_SIM_ENCODER_CPR;
+            sim_put_int32(&data[0], shadow);
+            sim_put_int32(&data[4], in_cpr);
+            break;
+        }
+        case MOTOR_CMD_QUERY_POS_SPEED:
+            sim_put_float(&data[0], s->position);
+            sim_put_float(&data[4], s->velocity);
+            break;
+        case MOTOR_CMD_QUERY_EXCEPTION:
+            if (request[0] < 5) {
+                sim_put_int32(&data[0], (int32_t)s->errors[request[0]]);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief 处理一条完整命令帧（调用方持有g_sim_lock）
+ * @return 是否为已知命令
+ */
+static bool sim_handle_frame(uart_port_t uart_port, const uint8_t* frame) {
+    uint16_t can_id = (frame[0] << 8) | frame[1];
+    uint8_t cmd = MOTOR_FRAME_CMD(can_id);
+    const uint8_t* data = &frame[2];
+
+    switch (cmd) {
+        case MOTOR_CMD_SET_AXIS_STATE:
+        case MOTOR_CMD_SET_CONTROL_MODE:
+        case MOTOR_CMD_TARGET_POS:
+        case MOTOR_CMD_TARGET_VEL:
+        case MOTOR_CMD_TARGET_TORQUE:
+        case MOTOR_CMD_RESTART:
+        case MOTOR_CMD_CLEAR_ERROR:
+        case MOTOR_CMD_QUERY_EXCEPTION:
+        case MOTOR_CMD_QUERY_POS_SPEED:
+        case MOTOR_CMD_QUERY_ENCODER:
+        case MOTOR_CMD_QUERY_TORQUE:
+        case MOTOR_CMD_QUERY_POWER:
+            break;
+        default:
+            return false;
+    }
+
+    sim_node_t* node = sim_find_node(uart_port, MOTOR_FRAME_NODE(can_id), true);
+    if (!node) {
+        g_stats.frames_ignored++;
+        return true;
+    }
+    motor_drive_sim_node_t* s = &node->state;
+
+    switch (cmd) {
+        case MOTOR_CMD_SET_AXIS_STATE:
+            // 电机异常未清除时拒绝进入闭环
+            s->enabled = data[0] == SIM_AXIS_STATE_CLOSED_LOOP && s->errors[0] == 0;
+            node->position_target = s->position;
+            break;
+        case MOTOR_CMD_SET_CONTROL_MODE:
+            // 切换模式时目标取当前状态，避免跳变
+            s->control_mode = data[0];
+            s->input_mode = data[4];
+            node->position_target = s->position;
+            node->velocity_target = 0.0f;
+            node->torque_target = 0.0f;
+            node->velocity_integrator = 0.0f;
+            break;
+        case MOTOR_CMD_TARGET_POS:
+            node->position_target = ieee754_bytes_to_float(data);
+            break;
+        case MOTOR_CMD_TARGET_VEL:
+            node->velocity_target = ieee754_bytes_to_float(data);
+            break;
+        case MOTOR_CMD_TARGET_TORQUE:
+            node->torque_target = ieee754_bytes_to_float(data);
+            break;
+        case MOTOR_CMD_RESTART:
+            memset(s, 0, sizeof(*s));
+            s->control_mode = SIM_CONTROL_MODE_POSITION;
+            s->input_mode = SIM_INPUT_MODE_PASSTHROUGH;
+            node->position_target = node->velocity_target = node->torque_target = 0.0f;
+            node->torque_command = 0.0f;
+            node->velocity_integrator = 0.0f;
+            break;
+        case MOTOR_CMD_CLEAR_ERROR:
+            memset(s->errors, 0, sizeof(s->errors));
+            break;
+        default: {
+            uint8_t response[8];
+            sim_build_response(node, cmd, data, response);
+            sim_queue_response(uart_port, can_id, response);
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 单节点积分一步：级联位置/速度环 -> 力矩 -> 惯量+阻尼+摩擦
+ */
+static void sim_step_node(sim_node_t* node, float dt) {
+    motor_drive_sim_node_t* s = &node->state;
+    float command = 0.0f;
+
+    if (s->enabled) {
+        float velocity_command = 0.0f;
+        switch (s->control_mode) {
+            case SIM_CONTROL_MODE_TORQUE:
+                command = node->torque_target;
+                s->target = node->torque_target;
+                break;
+            case SIM_CONTROL_MODE_VELOCITY:
+                velocity_command = node->velocity_target;
+                s->target = node->velocity_target;
+                break;
+            default: {
+                float limit = s->input_mode == SIM_INPUT_MODE_PASSTHROUGH ?
+                              SIM_VEL_LIMIT_PASSTHROUGH : SIM_VEL_LIMIT_RAMP;
+                velocity_command = sim_clampf(SIM_POS_GAIN * (node->position_target - s->position), limit);
+                s->target = node->position_target;
+                break;
+            }
+        }
+        if (s->control_mode != SIM_CONTROL_MODE_TORQUE) {
+            float error = velocity_command - s->velocity;
+            node->velocity_integrator = sim_clampf(node->velocity_integrator + SIM_VEL_INTEGRATOR_GAIN * error * dt,
+                                                   SIM_TORQUE_LIMIT);
+            command = SIM_VEL_GAIN * error + node->velocity_integrator;
+        }
+    } else {
+        node->velocity_integrator = 0.0f;
+    }
+    node->torque_command = sim_clampf(command, SIM_TORQUE_LIMIT);
+    s->torque += (node->torque_command - s->torque) * (dt / (SIM_CURRENT_TAU + dt));
+
+    float omega = s->velocity * SIM_TWO_PI;
+    float friction = SIM_DAMPING * omega;
+    if (fabsf(omega) > 1e-3f) {
+        friction += omega > 0.0f ? SIM_COULOMB_FRICTION : -SIM_COULOMB_FRICTION;
+    } else if (fabsf(s->torque) <= SIM_COULOMB_FRICTION) {
+        // 静摩擦：力矩不足以起动时保持静止
+        s->velocity = 0.0f;
+        return;
+    }
+    omega += (s->torque - friction) / SIM_INERTIA * dt;
+    s->velocity = omega / SIM_TWO_PI;
+    s->position += s->velocity * dt;
+}
+
+/**
+ * @brief 把待发送响应投递到目标端口的接收流，并像UART驱动一样发出事件
+ * @return 该响应是否已全部送达
+ */
+static bool sim_deliver(sim_response_t* response) {
+    sim_port_t* port = &g_ports[response->uart_port];
+    uint8_t remaining = response->length - response->offset;
+    uint8_t chunk = (g_faults.fragment_size > 0 && g_faults.fragment_size < remaining) ?
+                    g_faults.fragment_size : remaining;
+
+    if (!port->attached) {
+        return true;
+    }
+
+    size_t sent = xStreamBufferSend(port->rx_stream, &response->bytes[response->offset], chunk, 0);
+    uart_event_t event = {
+        .type = sent < chunk ? UART_BUFFER_FULL : UART_DATA,
+        .size = sent,
+    };
+    if (sent < chunk) {
+        g_stats.rx_overflows++;
+    }
+    xQueueSend(port->event_queue, &event, 0);
+
+    response->offset += chunk;
+    if (response->offset < response->length) {
+        return false;
+    }
+    g_stats.responses_sent++;
+    return true;
+}
+
+static void sim_timer_callback(void* arg) {
+    xTaskNotifyGive(g_sim_task);
+}
+
+static void sim_task(void *pvParameters) {
+    sim_response_t inflight;
+    bool inflight_valid = false;
+    int64_t last_us = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "驱动器模拟任务已启动 - %d Hz", MOTOR_DRIVE_SIM_RATE_HZ);
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int64_t now_us = esp_timer_get_time();
+        float dt = (now_us - last_us) / 1e6f;
+        last_us = now_us;
+        if (dt > 0.01f) {
+            dt = 0.01f;     // 任务被长时间抢占后不做大步长积分
+        }
+
+        xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+        for (int i = 0; i < MOTOR_DRIVE_SIM_MAX_NODES; i++) {
+            if (g_nodes[i].used) {
+                sim_step_node(&g_nodes[i], dt);
+            }
+        }
+
+        // 投递已到期的响应；分片模式下每个节拍只送一片，模拟半包到达
+        while (true) {
+            if (!inflight_valid) {
+                if (xQueuePeek(g_pending, &inflight, 0) != pdPASS || inflight.due_us > now_us) {
+                    break;
+                }
+                xQueueReceive(g_pending, &inflight, 0);
+                inflight_valid = true;
+            }
+            if (!sim_deliver(&inflight)) {
+                break;
+            }
+            inflight_valid = false;
+        }
+        xSemaphoreGive(g_sim_lock);
+    }
+}
+
+static bool sim_start(void) {
+    g_sim_lock = xSemaphoreCreateMutex();
+    g_pending = xQueueCreate(SIM_PENDING_DEPTH, sizeof(sim_response_t));
+    if (!g_sim_lock || !g_pending) {
+        ESP_LOGE(TAG, "模拟器资源创建失败");
+        return false;
+    }
+
+    memset(g_nodes, 0, sizeof(g_nodes));
+    memset(&g_stats, 0, sizeof(g_stats));
+
+    if (xTaskCreate(sim_task, "drive_sim", SIM_TASK_STACK_SIZE, NULL, SIM_TASK_PRIORITY, &g_sim_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建模拟任务失败");
+        return false;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = sim_timer_callback,
+        .name = "drive_sim"
+    };
+    if (esp_timer_create(&timer_args, &g_sim_timer) != ESP_OK ||
+        esp_timer_start_periodic(g_sim_timer, 1000000 / MOTOR_DRIVE_SIM_RATE_HZ) != ESP_OK) {
+        ESP_LOGE(TAG, "创建模拟定时器失败");
+        return false;
+    }
+
+    ESP_LOGW(TAG, "电机驱动器模拟模式：UART不接硬件，响应由软件模型产生");
+    return true;
+}
+
+bool motor_drive_sim_attach(uart_port_t uart_port, int rx_buffer_size, int queue_size, QueueHandle_t* uart_queue) {
+    if (uart_port < 0 || uart_port >= UART_NUM_MAX || !uart_queue) {
+        return false;
+    }
+    if (!g_sim_task && !sim_start()) {
+        return false;
+    }
+
+    sim_port_t* port = &g_ports[uart_port];
+    if (port->attached) {
+        ESP_LOGE(TAG, "UART%d 已接入模拟总线", uart_port);
+        return false;
+    }
+
+    port->event_queue = xQueueCreate(queue_size, sizeof(uart_event_t));
+    port->rx_stream = xStreamBufferCreate(rx_buffer_size, 1);
+    if (!port->event_queue || !port->rx_stream) {
+        ESP_LOGE(TAG, "UART%d 模拟缓冲区创建失败", uart_port);
+        if (port->event_queue) vQueueDelete(port->event_queue);
+        if (port->rx_stream) vStreamBufferDelete(port->rx_stream);
+        return false;
+    }
+
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    port->tx_length = 0;
+    port->attached = true;
+    xSemaphoreGive(g_sim_lock);
+
+    *uart_queue = port->event_queue;
+    ESP_LOGI(TAG, "UART%d 已接入模拟总线", uart_port);
+    return true;
+}
+
+void motor_drive_sim_detach(uart_port_t uart_port) {
+    if (uart_port < 0 || uart_port >= UART_NUM_MAX || !g_sim_lock) {
+        return;
+    }
+
+    sim_port_t* port = &g_ports[uart_port];
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    if (port->attached) {
+        port->attached = false;
+        vQueueDelete(port->event_queue);
+        vStreamBufferDelete(port->rx_stream);
+        port->event_queue = NULL;
+        port->rx_stream = NULL;
+        for (int i = 0; i < MOTOR_DRIVE_SIM_MAX_NODES; i++) {
+            if (g_nodes[i].used && g_nodes[i].uart_port == uart_port) {
+                g_nodes[i].used = false;
+            }
+        }
+    }
+    xSemaphoreGive(g_sim_lock);
+}
+
+int motor_drive_sim_write(uart_port_t uart_port, const uint8_t* data, size_t length) {
+    if (uart_port < 0 || uart_port >= UART_NUM_MAX || !g_ports[uart_port].attached) {
+        return -1;
+    }
+
+    sim_port_t* port = &g_ports[uart_port];
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    for (size_t i = 0; i < length; i++) {
+        port->tx_frame[port->tx_length++] = data[i];
+        if (port->tx_length < SIM_FRAME_SIZE) {
+            continue;
+        }
+        if (sim_handle_frame(uart_port, port->tx_frame)) {
+            g_stats.frames_received++;
+            port->tx_length = 0;
+        } else {
+            // 未知命令：丢弃1字节重新对齐帧边界
+            g_stats.frames_ignored++;
+            memmove(port->tx_frame, &port->tx_frame[1], SIM_FRAME_SIZE - 1);
+            port->tx_length = SIM_FRAME_SIZE - 1;
+        }
+    }
+    xSemaphoreGive(g_sim_lock);
+    return (int)length;
+}
+
+int motor_drive_sim_read(uart_port_t uart_port, uint8_t* buffer, size_t length) {
+    if (uart_port < 0 || uart_port >= UART_NUM_MAX || !g_ports[uart_port].attached) {
+        return -1;
+    }
+    return (int)xStreamBufferReceive(g_ports[uart_port].rx_stream, buffer, length, 0);
+}
+
+size_t motor_drive_sim_buffered_len(uart_port_t uart_port) {
+    if (uart_port < 0 || uart_port >= UART_NUM_MAX || !g_ports[uart_port].attached) {
+        return 0;
+    }
+    return xStreamBufferBytesAvailable(g_ports[uart_port].rx_stream);
+}
+
+void motor_drive_sim_flush_input(uart_port_t uart_port) {
+    if (uart_port < 0 || uart_port >= UART_NUM_MAX || !g_ports[uart_port].attached) {
+        return;
+    }
+    xStreamBufferReset(g_ports[uart_port].rx_stream);
+}
+
+void motor_drive_sim_set_faults(const motor_drive_sim_faults_t* faults) {
+    if (!faults || !g_sim_lock) {
+        return;
+    }
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    g_faults = *faults;
+    if (g_faults.fragment_size > SIM_FRAME_SIZE) {
+        g_faults.fragment_size = SIM_FRAME_SIZE;
+    }
+    xSemaphoreGive(g_sim_lock);
+    ESP_LOGI(TAG, "故障注入 - 延迟:%lu us, 分片:%d, 丢弃:%d‰, 损坏:%d‰, 噪声:%d‰",
+             (unsigned long)g_faults.latency_us, g_faults.fragment_size, g_faults.drop_permille,
+             g_faults.corrupt_permille, g_faults.noise_permille);
+}
+
+void motor_drive_sim_get_faults(motor_drive_sim_faults_t* faults) {
+    if (faults) {
+        *faults = g_faults;
+    }
+}
+
+bool motor_drive_sim_set_error(uart_port_t uart_port, uint8_t node_id, uint8_t error_type, uint32_t error_code) {
+    if (error_type >= 5 || !g_sim_lock) {
+        return false;
+    }
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    sim_node_t* node = sim_find_node(uart_port, node_id, false);
+    if (node) {
+        node->state.errors[error_type] = error_code;
+        if (error_type == 0 && error_code != 0) {
+            node->state.enabled = false;
+        }
+    }
+    xSemaphoreGive(g_sim_lock);
+    return node != NULL;
+}
+
+bool motor_drive_sim_get_node(uart_port_t uart_port, uint8_t node_id, motor_drive_sim_node_t* node_state) {
+    if (!node_state || !g_sim_lock) {
+        return false;
+    }
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    sim_node_t* node = sim_find_node(uart_port, node_id, false);
+    if (node) {
+        *node_state = node->state;
+    }
+    xSemaphoreGive(g_sim_lock);
+    return node != NULL;
+}
+
+void motor_drive_sim_get_stats(motor_drive_sim_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!g_sim_lock) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(g_sim_lock, portMAX_DELAY);
+    *stats = g_stats;
+    xSemaphoreGive(g_sim_lock);
+}
+
+#endif // CONFIG_MOTOR_DRIVE_SIM
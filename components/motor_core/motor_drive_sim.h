@@ -0,0 +1,130 @@
+#ifndef MOTOR_DRIVE_SIM_H
+#define MOTOR_DRIVE_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "driver/uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 软件驱动器模拟器：在没有电机硬件时替代UART另一端的驱动器
+// 按10字节帧协议（ID = node<<5 | cmd）接收模式/设定点/使能/查询命令，
+// 用"电机+负载"一阶惯量模型在1kHz下积分，对查询命令返回力矩/功率/编码器/位置/异常响应。
+// 响应经模拟接收缓冲区和UART事件队列送达，uart_monitor无需区分真实硬件和模拟器。
+
+#define MOTOR_DRIVE_SIM_RATE_HZ      1000    // 模型积分与响应投递频率
+#define MOTOR_DRIVE_SIM_MAX_NODES    6       // 模拟驱动器（节点）总数上限
+#define MOTOR_DRIVE_SIM_ENCODER_CPR  CONFIG_MOTOR_ENCODER_CPR   // 模拟编码器每转计数
+
+// 故障注入配置
+typedef struct {
+    uint32_t latency_us;        // 查询到响应的延迟 (us)
+    uint8_t fragment_size;      // 响应分片字节数，每个模拟节拍送达一片（0表示整帧一次送达）
+    uint16_t drop_permille;     // 丢弃响应的概率 (‰)
+    uint16_t corrupt_permille;  // 响应帧ID翻转一位的概率 (‰)
+    uint16_t noise_permille;    // 响应帧前插入一个噪声字节的概率 (‰)
+} motor_drive_sim_faults_t;
+
+// 模拟器统计
+typedef struct {
+    uint32_t frames_received;   // 收到的完整命令帧
+    uint32_t frames_ignored;    // 未知命令或节点数已满而忽略的帧
+    uint32_t responses_sent;    // 已送达的响应帧
+    uint32_t responses_dropped; // 故障注入丢弃的响应
+    uint32_t responses_corrupted; // 故障注入损坏的响应
+    uint32_t noise_bytes;       // 注入的噪声字节
+    uint32_t rx_overflows;      // 模拟接收缓冲区满的次数
+    uint32_t pending_high_watermark; // 待发送响应队列最大深度
+} motor_drive_sim_stats_t;
+
+// 单个模拟驱动器的可观测状态
+typedef struct {
+    bool enabled;               // 闭环使能
+    uint8_t control_mode;       // 1=力矩 2=速度 3=位置
+    uint8_t input_mode;         // 1=直通 3=斜坡
+    float position;             // 位置 (转)
+    float velocity;             // 转速 (转/s)
+    float torque;               // 当前力矩 (Nm)
+    float target;               // 当前模式下的目标值
+    uint32_t errors[5];         // 各类型异常码（与query_motor_exceptions的类型一致）
+} motor_drive_sim_node_t;
+
+/**
+ * @brief 将一个UART端口接到模拟总线（替代uart_driver_install）
+ * @param uart_port UART端口号
+ * @param rx_buffer_size 模拟接收缓冲区大小
+ * @param queue_size 事件队列长度
+ * @param uart_queue 输出：UART事件队列，语义与ESP-IDF UART驱动一致
+ * @return 是否成功（首次调用时启动模拟任务）
+ */
+bool motor_drive_sim_attach(uart_port_t uart_port, int rx_buffer_size, int queue_size, QueueHandle_t* uart_queue);
+
+/**
+ * @brief 断开UART端口，释放接收缓冲区和事件队列
+ */
+void motor_drive_sim_detach(uart_port_t uart_port);
+
+/**
+ * @brief 主机 -> 驱动器：写入命令字节（可跨调用拆帧）
+ * @return 接受的字节数，端口未接入返回-1
+ */
+int motor_drive_sim_write(uart_port_t uart_port, const uint8_t* data, size_t length);
+
+/**
+ * @brief 驱动器 -> 主机：读取已送达的响应字节（不阻塞）
+ * @return 读取的字节数
+ */
+int motor_drive_sim_read(uart_port_t uart_port, uint8_t* buffer, size_t length);
+
+/**
+ * @brief 已送达但尚未读取的字节数
+ */
+size_t motor_drive_sim_buffered_len(uart_port_t uart_port);
+
+/**
+ * @brief 丢弃已送达但尚未读取的字节
+ */
+void motor_drive_sim_flush_input(uart_port_t uart_port);
+
+/**
+ * @brief 设置故障注入参数（运行中立即生效）
+ */
+void motor_drive_sim_set_faults(const motor_drive_sim_faults_t* faults);
+
+/**
+ * @brief 获取当前故障注入参数
+ */
+void motor_drive_sim_get_faults(motor_drive_sim_faults_t* faults);
+
+/**
+ * @brief 给模拟驱动器注入异常码；电机异常(类型0)非零时驱动器像真实硬件一样退出闭环
+ * @param uart_port UART端口号
+ * @param node_id 节点ID
+ * @param error_type 异常类型 (0-4)
+ * @param error_code 异常码，0表示清除
+ * @return 节点存在且类型有效时返回true
+ */
+bool motor_drive_sim_set_error(uart_port_t uart_port, uint8_t node_id, uint8_t error_type, uint32_t error_code);
+
+/**
+ * @brief 读取模拟驱动器状态（用于与主机侧解析结果对比）
+ * @return 节点存在时返回true
+ */
+bool motor_drive_sim_get_node(uart_port_t uart_port, uint8_t node_id, motor_drive_sim_node_t* node);
+
+/**
+ * @brief 获取模拟器统计
+ */
+void motor_drive_sim_get_stats(motor_drive_sim_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_DRIVE_SIM_H
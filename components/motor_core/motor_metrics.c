@@ -0,0 +1,129 @@
+#include "motor_metrics.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+// HTTP处理耗时桶上界（微秒）
+static const uint32_t HTTP_REQUEST_US_BOUNDS[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+};
+
+// 命令->反馈延迟桶上界（微秒）：64us起按2倍递增到约2.1s，覆盖HTTP处理到低频状态查询的全部范围
+static const uint32_t LATENCY_US_BOUNDS[] = {
+    1u << 6, 1u << 7, 1u << 8, 1u << 9, 1u << 10, 1u << 11, 1u << 12, 1u << 13,
+    1u << 14, 1u << 15, 1u << 16, 1u << 17, 1u << 18, 1u << 19, 1u << 20, 1u << 21
+};
+
+// 轨迹节拍抖动桶上界（微秒）：500Hz时周期为2000us
+static const uint32_t STREAM_JITTER_US_BOUNDS[] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000
+};
+
+#define HISTOGRAM_BOUNDS(table) .bounds = (table), .bound_count = sizeof(table) / sizeof((table)[0])
+
+const char* const MOTOR_LATENCY_STAGE_NAMES[MOTOR_LATENCY_STAGES] = {
+    "ingest_dispatch", "dispatch_tx", "tx_feedback", "end_to_end"
+};
+
+motor_metrics_t g_motor_metrics = {
+    .http_request_us = { HISTOGRAM_BOUNDS(HTTP_REQUEST_US_BOUNDS) },
+    .latency_us = {
+        [MOTOR_LATENCY_INGEST_DISPATCH] = { HISTOGRAM_BOUNDS(LATENCY_US_BOUNDS) },
+        [MOTOR_LATENCY_DISPATCH_TX] = { HISTOGRAM_BOUNDS(LATENCY_US_BOUNDS) },
+        [MOTOR_LATENCY_TX_FEEDBACK] = { HISTOGRAM_BOUNDS(LATENCY_US_BOUNDS) },
+        [MOTOR_LATENCY_END_TO_END] = { HISTOGRAM_BOUNDS(LATENCY_US_BOUNDS) }
+    },
+    .stream_jitter_us = { HISTOGRAM_BOUNDS(STREAM_JITTER_US_BOUNDS) }
+};
+
+void motor_metrics_observe(motor_metrics_histogram_t* histogram, uint32_t value) {
+    uint8_t bucket = 0;
+    while (bucket < histogram->bound_count && value > histogram->bounds[bucket]) {
+        bucket++;
+    }
+    MOTOR_METRICS_INC(histogram->buckets[bucket]);
+    MOTOR_METRICS_ADD(histogram->sum, value);
+    MOTOR_METRICS_INC(histogram->count);
+}
+
+void motor_metrics_histogram_reset(motor_metrics_histogram_t* histogram) {
+    for (uint8_t i = 0; i <= histogram->bound_count; i++) {
+        __atomic_store_n(&histogram->buckets[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&histogram->sum, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->count, 0, __ATOMIC_RELAXED);
+}
+
+uint32_t motor_metrics_histogram_percentile(const motor_metrics_histogram_t* histogram, float quantile) {
+    uint32_t counts[MOTOR_METRICS_MAX_BUCKETS + 1];
+    uint32_t total = 0;
+    for (uint8_t i = 0; i <= histogram->bound_count; i++) {
+        counts[i] = MOTOR_METRICS_GET(histogram->buckets[i]);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // 第ceil(q*total)个样本所在的桶
+    float target = quantile * total;
+    uint32_t rank = (uint32_t)target;
+    if ((float)rank < target) {
+        rank++;
+    }
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < histogram->bound_count; i++) {
+        cumulative += counts[i];
+        if (cumulative >= rank) {
+            return histogram->bounds[i];
+        }
+    }
+    return UINT32_MAX;
+}
+
+/**
+ * @brief 格式化一行并交给写入回调
+ */
+static bool metrics_write_line(motor_metrics_write_fn_t write, void* context, const char* fmt, ...) {
+    char line[MOTOR_METRICS_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= sizeof(line)) {
+        return false;
+    }
+    return write(line, (size_t)n, context);
+}
+
+bool motor_metrics_format_histogram(motor_metrics_write_fn_t write, void* context, const char* name,
+                                    const char* labels, const motor_metrics_histogram_t* histogram) {
+    const char* sep = labels ? "," : "";
+    labels = labels ? labels : "";
+    uint32_t cumulative = 0;
+    bool ok = true;
+
+    // 各桶单独原子读取，采样期间有并发观测时累计值与count可能差几个，采集端可容忍
+    for (uint8_t i = 0; i <= histogram->bound_count; i++) {
+        cumulative += MOTOR_METRICS_GET(histogram->buckets[i]);
+        if (i < histogram->bound_count) {
+            ok &= metrics_write_line(write, context, "%s_bucket{%s%sle=\"%lu\"} %lu\n", name, labels, sep,
+                                     (unsigned long)histogram->bounds[i], (unsigned long)cumulative);
+        } else {
+            ok &= metrics_write_line(write, context, "%s_bucket{%s%sle=\"+Inf\"} %lu\n", name, labels, sep,
+                                     (unsigned long)cumulative);
+        }
+    }
+
+    const char* lbrace = *labels ? "{" : "";
+    const char* rbrace = *labels ? "}" : "";
+    ok &= metrics_write_line(write, context, "%s_sum%s%s%s %lu\n", name, lbrace, labels, rbrace,
+                             (unsigned long)MOTOR_METRICS_GET(histogram->sum));
+    ok &= metrics_write_line(write, context, "%s_count%s%s%s %lu\n", name, lbrace, labels, rbrace,
+                             (unsigned long)cumulative);
+    return ok;
+}
@@ -0,0 +1,107 @@
+#ifndef MOTOR_METRICS_H
+#define MOTOR_METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 运行指标：热点路径上只做无锁原子自增（relaxed内存序，不关中断、不加锁），
+// 由/metrics处理函数读取后按Prometheus文本格式输出
+// 计数器均为32位，溢出后回绕，采集端按counter语义自动处理重置
+
+#define MOTOR_METRICS_INC(counter)          __atomic_fetch_add(&(counter), 1, __ATOMIC_RELAXED)
+#define MOTOR_METRICS_ADD(counter, value)   __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+#define MOTOR_METRICS_GET(counter)          __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+
+#define MOTOR_METRICS_MAX_BUCKETS   16      // 直方图上界个数上限（另有一个+Inf桶）
+#define MOTOR_METRICS_GCODE_RESULTS 8       // gcode_result_t取值个数
+
+// CAN接收帧分类
+typedef enum {
+    MOTOR_METRICS_CAN_GCODE = 0,            // 单帧G代码片段
+    MOTOR_METRICS_CAN_ISOTP,                // ISO-TP程序帧
+    MOTOR_METRICS_CAN_OTHER,                // 其他ID
+    MOTOR_METRICS_CAN_KINDS
+} motor_metrics_can_kind_t;
+
+// 命令->反馈延迟的阶段（时间点见motor_control_latency_begin）
+typedef enum {
+    MOTOR_LATENCY_INGEST_DISPATCH = 0,      // 命令到达（HTTP请求/完整G代码行） -> 开始下发（含运动队列等待）
+    MOTOR_LATENCY_DISPATCH_TX,              // 开始下发 -> 目标帧写入UART（含模式切换帧、轨迹首个节拍）
+    MOTOR_LATENCY_TX_FEEDBACK,              // 目标帧写入 -> 首个位置速度响应解析完成（受查询频率影响）
+    MOTOR_LATENCY_END_TO_END,               // 命令到达 -> 首个位置速度响应
+    MOTOR_LATENCY_STAGES
+} motor_latency_stage_t;
+
+extern const char* const MOTOR_LATENCY_STAGE_NAMES[MOTOR_LATENCY_STAGES];
+
+// 直方图：各桶非累计计数，输出时再累加成Prometheus的le桶
+// sum用32位以保证在ESP32上是单条原子指令，微秒级观测约71分钟的累计量后回绕
+typedef struct {
+    const uint32_t* bounds;                 // 升序上界
+    uint8_t bound_count;                    // 上界个数（<= MOTOR_METRICS_MAX_BUCKETS）
+    uint32_t buckets[MOTOR_METRICS_MAX_BUCKETS + 1];
+    uint32_t sum;
+    uint32_t count;
+} motor_metrics_histogram_t;
+
+// 全局指标（各字段只由对应模块原子自增）
+typedef struct {
+    uint32_t uart_tx_unmatched;             // 发往未注册节点的帧数
+    uint32_t uart_parse_errors;             // 无对应电机/长度不足/未知命令的响应帧数
+    uint32_t can_rx_frames[MOTOR_METRICS_CAN_KINDS];
+    uint32_t gcode_submit_results[MOTOR_METRICS_GCODE_RESULTS];   // 解析/校验/入队（或直接执行）结果
+    uint32_t gcode_execute_results[MOTOR_METRICS_GCODE_RESULTS];  // 执行任务从运动队列取出后的执行结果
+    motor_metrics_histogram_t http_request_us;  // HTTP处理函数耗时（微秒）
+    motor_metrics_histogram_t latency_us[MOTOR_LATENCY_STAGES];  // 命令->反馈各阶段延迟（微秒，2倍对数桶）
+    motor_metrics_histogram_t stream_jitter_us;  // 轨迹流式节拍间隔与定时周期之差的绝对值（微秒）
+} motor_metrics_t;
+
+extern motor_metrics_t g_motor_metrics;
+
+/**
+ * @brief 记录一次直方图观测（无锁）
+ */
+void motor_metrics_observe(motor_metrics_histogram_t* histogram, uint32_t value);
+
+/**
+ * @brief 清零直方图（与并发观测交错时可能丢失少量样本）
+ */
+void motor_metrics_histogram_reset(motor_metrics_histogram_t* histogram);
+
+/**
+ * @brief 按桶估计分位数
+ * @param quantile 分位（0-1）
+ * @return 分位所在桶的上界；无样本返回0，落在+Inf桶返回UINT32_MAX
+ */
+uint32_t motor_metrics_histogram_percentile(const motor_metrics_histogram_t* histogram, float quantile);
+
+/**
+ * @brief 输出一行指标文本（含换行符）
+ * @return 写入失败（如输出缓冲区容纳不下一行）返回false
+ */
+typedef bool (*motor_metrics_write_fn_t)(const char* text, size_t length, void* context);
+
+#define MOTOR_METRICS_LINE_MAX      192     // 直方图单行文本上限（指标名 + 标签 + le + 计数）
+
+/**
+ * @brief 按Prometheus文本格式输出直方图（_bucket/_sum/_count三组样本），逐行交给写入回调，
+ *        输出端可在行之间分块发送，直方图总长度不受单个缓冲区限制
+ * @param write 行写入回调
+ * @param context 回调上下文
+ * @param name 指标名
+ * @param labels 附加标签（如"node=\"1\""，可为NULL）
+ * @return 全部行都写入成功返回true；某行超过MOTOR_METRICS_LINE_MAX或回调失败时跳过该行并返回false
+ */
+bool motor_metrics_format_histogram(motor_metrics_write_fn_t write, void* context, const char* name,
+                                    const char* labels, const motor_metrics_histogram_t* histogram);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_METRICS_H
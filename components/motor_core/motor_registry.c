@@ -0,0 +1,252 @@
+#include "sdkconfig.h"
+#include "motor_registry.h"
+#include "motor_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "MOTOR_REGISTRY";
+
+// G代码轴字母，下标即轴号
+static const char g_axis_letters[MOTOR_REGISTRY_MAX_MOTORS] = { 'X', 'Y', 'Z', 'A', 'B', 'C' };
+
+// Kconfig中配置的各轴电机（轴0-5对应G代码X/Y/Z/A/B/C；同一UART上可挂多个驱动器，按节点ID区分）
+#define MOTOR_AXIS_CONFIG(n) {                        \
+        .uart_port = CONFIG_MOTOR_AXIS##n##_UART_NUM, \
+        .txd_pin = CONFIG_MOTOR_AXIS##n##_TXD,        \
+        .rxd_pin = CONFIG_MOTOR_AXIS##n##_RXD,        \
+        .node_id = CONFIG_MOTOR_AXIS##n##_NODE_ID,    \
+        .baud_rate = 115200,                          \
+        .buf_size = 1024                              \
+    }
+static const motor_driver_config_t g_configured_motors[] = {
+    MOTOR_AXIS_CONFIG(0),                       // 默认UART1 节点1 (GPIO13/12)
+#if CONFIG_MOTOR_AXIS_COUNT >= 2
+    MOTOR_AXIS_CONFIG(1),
+#endif
+#if CONFIG_MOTOR_AXIS_COUNT >= 3
+    MOTOR_AXIS_CONFIG(2),
+#endif
+#if CONFIG_MOTOR_AXIS_COUNT >= 4
+    MOTOR_AXIS_CONFIG(3),
+#endif
+#if CONFIG_MOTOR_AXIS_COUNT >= 5
+    MOTOR_AXIS_CONFIG(4),
+#endif
+#if CONFIG_MOTOR_AXIS_COUNT >= 6
+    MOTOR_AXIS_CONFIG(5),
+#endif
+};
+#undef MOTOR_AXIS_CONFIG
+
+// 注册表（启动阶段写入，之后只读，无需加锁）
+static motor_registry_entry_t g_motors[MOTOR_REGISTRY_MAX_MOTORS];
+static uint8_t g_motor_count = 0;
+static uart_monitor_t* g_uart_monitor = NULL;
+
+/**
+ * @brief 查找同一UART上已注册的电机（该端口的监听与调度器已创建）
+ */
+static motor_registry_entry_t* motor_registry_find_port(uart_port_t uart_port) {
+    for (uint8_t i = 0; i < g_motor_count; i++) {
+        if (g_motors[i].controller->driver_config.uart_port == uart_port) {
+            return &g_motors[i];
+        }
+    }
+    return NULL;
+}
+
+bool motor_registry_init(const uart_monitor_config_t* monitor_config) {
+    if (g_uart_monitor) {
+        ESP_LOGW(TAG, "电机注册表已初始化");
+        return true;
+    }
+    
+    g_uart_monitor = uart_monitor_init(monitor_config);
+    if (!g_uart_monitor) {
+        ESP_LOGE(TAG, "共享UART监听器初始化失败");
+        return false;
+    }
+    
+    memset(g_motors, 0, sizeof(g_motors));
+    g_motor_count = 0;
+    return true;
+}
+
+motor_registry_entry_t* motor_registry_add(const motor_driver_config_t* driver_config, float query_frequency) {
+    if (!g_uart_monitor || !driver_config) {
+        ESP_LOGE(TAG, "注册表未初始化或配置为空");
+        return NULL;
+    }
+    
+    if (g_motor_count >= MOTOR_REGISTRY_MAX_MOTORS) {
+        ESP_LOGE(TAG, "电机数量已达上限 %d", MOTOR_REGISTRY_MAX_MOTORS);
+        return NULL;
+    }
+    
+    motor_controller_t* controller = motor_control_init(driver_config);
+    if (!controller) {
+        ESP_LOGE(TAG, "UART%d 电机控制器初始化失败", driver_config->uart_port);
+        return NULL;
+    }
+    
+    motor_registry_entry_t* bus_peer = motor_registry_find_port(driver_config->uart_port);
+    motor_registry_entry_t* entry = &g_motors[g_motor_count];
+    entry->axis = g_motor_count;
+    entry->axis_letter = g_axis_letters[g_motor_count];
+    entry->controller = controller;
+    
+    if (bus_peer) {
+        // 菊花链：端口已在监听，调度器加入该节点轮询即可
+        entry->scheduler = bus_peer->scheduler;
+        if (entry->scheduler && !motor_status_scheduler_add_node(entry->scheduler, driver_config->node_id)) {
+            ESP_LOGW(TAG, "轴%d 节点%d 未加入状态查询轮询", entry->axis, driver_config->node_id);
+        }
+    } else {
+        if (!uart_monitor_add_port(g_uart_monitor, driver_config->uart_port, controller->uart_event_queue)) {
+            motor_control_deinit(controller);
+            return NULL;
+        }
+        
+        scheduler_config_t scheduler_config = {
+            .frequency = query_frequency,
+            .uart_port = driver_config->uart_port,
+            .node_id = driver_config->node_id,
+            .enable_all_queries = false      // 默认不启动自动查询，等待用户手动启动
+        };
+        
+        entry->scheduler = motor_status_scheduler_init(&scheduler_config);
+        if (!entry->scheduler) {
+            // 调度器失败不影响运动控制，仅无法自动查询状态
+            ESP_LOGW(TAG, "轴%d 状态查询调度器初始化失败", entry->axis);
+        }
+    }
+    g_motor_count++;
+    
+    ESP_LOGI(TAG, "注册电机 轴%d(%c) - UART%d 节点%d TX:%d RX:%d", entry->axis, entry->axis_letter,
+             driver_config->uart_port, driver_config->node_id, driver_config->txd_pin, driver_config->rxd_pin);
+    return entry;
+}
+
+uint8_t motor_registry_add_configured(float query_frequency) {
+    uint8_t added = 0;
+    for (size_t i = 0; i < sizeof(g_configured_motors) / sizeof(g_configured_motors[0]); i++) {
+        if (motor_registry_add(&g_configured_motors[i], query_frequency)) {
+            added++;
+        } else {
+            ESP_LOGE(TAG, "轴%d 电机初始化失败", (int)i);
+        }
+    }
+    return added;
+}
+
+bool motor_registry_start(void) {
+    if (!g_uart_monitor) {
+        ESP_LOGE(TAG, "注册表未初始化");
+        return false;
+    }
+    return uart_monitor_start(g_uart_monitor);
+}
+
+/**
+ * @brief 驱动器已响应：设置上电控制模式，按配置使能，然后开放运动命令
+ */
+static void motor_registry_make_ready(motor_registry_entry_t* entry) {
+    motor_controller_t* controller = entry->controller;
+    switch (g_motor_config.startup_mode) {
+        case MOTOR_STARTUP_VELOCITY:
+            motor_control_set_velocity_mode(controller);
+            break;
+        case MOTOR_STARTUP_TORQUE:
+            motor_control_set_torque_mode(controller);
+            break;
+        default:
+            motor_control_set_position_mode(controller);
+            break;
+    }
+    if (g_motor_config.auto_enable) {
+        motor_control_enable(controller, true);
+    }
+    motor_control_mark_ready(controller);
+    ESP_LOGI(TAG, "轴%d(%c) 驱动器就绪 - 上电后%lldms", entry->axis, entry->axis_letter,
+             (long long)(controller->ready_us / 1000));
+}
+
+uint8_t motor_registry_bring_up(uint32_t timeout_ms) {
+    int64_t start_us = esp_timer_get_time();
+    bool warned = false;
+
+    while (true) {
+        uint8_t ready = 0;
+        for (uint8_t i = 0; i < g_motor_count; i++) {
+            motor_registry_entry_t* entry = &g_motors[i];
+            motor_controller_t* controller = entry->controller;
+            if (motor_control_is_ready(controller)) {
+                ready++;
+            } else if (__atomic_load_n(&controller->status.generation, __ATOMIC_ACQUIRE) != 0) {
+                // 收到过任意状态响应即说明驱动器已上电并能通信
+                motor_registry_make_ready(entry);
+                ready++;
+            } else {
+                query_motor_position_speed(controller->driver_config.uart_port, controller->driver_config.node_id);
+            }
+        }
+        if (ready == g_motor_count) {
+            ESP_LOGI(TAG, "全部%d轴就绪 - 上电后%lldms", g_motor_count,
+                     (long long)(motor_registry_ready_us() / 1000));
+            return ready;
+        }
+
+        uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+        if (timeout_ms && elapsed_ms >= timeout_ms) {
+            ESP_LOGW(TAG, "上电握手超时 - %d/%d轴就绪", ready, g_motor_count);
+            return ready;
+        }
+        if (!warned && elapsed_ms >= MOTOR_REGISTRY_READY_WARN_MS) {
+            ESP_LOGW(TAG, "%d/%d轴在%dms内未响应，继续探测", g_motor_count - ready, g_motor_count,
+                     MOTOR_REGISTRY_READY_WARN_MS);
+            warned = true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(warned ? MOTOR_REGISTRY_READY_SLOW_MS : MOTOR_REGISTRY_READY_PROBE_MS));
+    }
+}
+
+int64_t motor_registry_ready_us(void) {
+    int64_t latest_us = 0;
+    for (uint8_t i = 0; i < g_motor_count; i++) {
+        motor_controller_t* controller = g_motors[i].controller;
+        if (!motor_control_is_ready(controller)) {
+            return 0;
+        }
+        if (controller->ready_us > latest_us) {
+            latest_us = controller->ready_us;
+        }
+    }
+    return latest_us;
+}
+
+uint8_t motor_registry_count(void) {
+    return g_motor_count;
+}
+
+motor_registry_entry_t* motor_registry_get(uint8_t axis) {
+    if (axis >= g_motor_count) {
+        return NULL;
+    }
+    return &g_motors[axis];
+}
+
+int motor_registry_axis_from_letter(char letter) {
+    for (int i = 0; i < MOTOR_REGISTRY_MAX_MOTORS; i++) {
+        if (g_axis_letters[i] == letter) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uart_monitor_t* motor_registry_get_monitor(void) {
+    return g_uart_monitor;
+}
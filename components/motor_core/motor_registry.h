@@ -0,0 +1,104 @@
+#ifndef MOTOR_REGISTRY_H
+#define MOTOR_REGISTRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_control.h"
+#include "motor_status_scheduler.h"
+#include "uart_monitor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTOR_REGISTRY_MAX_MOTORS MOTOR_CONTROL_MAX_MOTORS  // 最多6轴，可按节点ID共用UART端口
+#define MOTOR_REGISTRY_READY_PROBE_MS   20      // 上电握手的探测周期
+#define MOTOR_REGISTRY_READY_WARN_MS    3000    // 超过该时间仍未响应则告警，并按慢速周期继续探测
+#define MOTOR_REGISTRY_READY_SLOW_MS    500     // 告警后的探测周期
+
+// 已注册电机（一个轴）
+typedef struct {
+    uint8_t axis;                           // 轴号（注册顺序，从0开始）
+    char axis_letter;                       // G代码轴字母（轴0-5对应X/Y/Z/A/B/C）
+    motor_controller_t* controller;         // 电机控制器（含该电机的实时状态）
+    motor_status_scheduler_t* scheduler;    // 所在UART的状态查询调度器（同端口的节点共用，轮流查询）
+} motor_registry_entry_t;
+
+/**
+ * @brief 初始化电机注册表，并创建所有电机共享的UART监听器
+ * @param monitor_config 共享UART监听器配置
+ * @return 是否初始化成功
+ */
+bool motor_registry_init(const uart_monitor_config_t* monitor_config);
+
+/**
+ * @brief 注册一个电机：初始化控制器与状态调度器，并把其UART加入共享监听任务
+ *
+ * 同一UART上的多个驱动器（节点ID不同）共用一个监听端口和一个调度器，
+ * 调度器在这些节点间轮流查询，因此每个节点的刷新率为 query_frequency / 节点数。
+ * @param driver_config 电机驱动配置（UART端口+节点ID须唯一）
+ * @param query_frequency 状态查询频率 (Hz)，同端口后注册的电机沿用首个电机的频率
+ * @return 注册项，失败返回NULL
+ */
+motor_registry_entry_t* motor_registry_add(const motor_driver_config_t* driver_config, float query_frequency);
+
+/**
+ * @brief 按Kconfig (MOTOR_AXIS_COUNT及各轴UART/引脚/节点ID) 依次注册全部电机
+ * @param query_frequency 状态查询频率 (Hz)
+ * @return 成功注册的电机数量（某轴失败时继续注册其余轴）
+ */
+uint8_t motor_registry_add_configured(float query_frequency);
+
+/**
+ * @brief 启动共享UART监听任务（所有电机注册完成后调用）
+ * @return 是否启动成功
+ */
+bool motor_registry_start(void);
+
+/**
+ * @brief 上电握手：主动查询尚未就绪的轴，驱动器一响应即设置上电控制模式（运行时配置startup_mode）、
+ * 按auto_enable使能并标记就绪，就绪前该轴拒绝运动命令
+ *
+ * 须在motor_registry_start之后调用（响应由共享UART监听任务解析）。
+ * @param timeout_ms 最长等待时间，0表示一直探测直到全部就绪（超过MOTOR_REGISTRY_READY_WARN_MS后降低探测频率）
+ * @return 已就绪的电机数量
+ */
+uint8_t motor_registry_bring_up(uint32_t timeout_ms);
+
+/**
+ * @brief 全部电机就绪的时间（esp_timer微秒，即上电到系统就绪的耗时）
+ * @return 尚有电机未就绪时返回0
+ */
+int64_t motor_registry_ready_us(void);
+
+/**
+ * @brief 获取已注册电机数量
+ * @return 电机数量
+ */
+uint8_t motor_registry_count(void);
+
+/**
+ * @brief 按轴号获取电机
+ * @param axis 轴号
+ * @return 注册项，不存在返回NULL
+ */
+motor_registry_entry_t* motor_registry_get(uint8_t axis);
+
+/**
+ * @brief G代码轴字母转换为轴号
+ * @param letter 轴字母（'X'/'Y'/'Z'/'A'/'B'/'C'）
+ * @return 轴号，不是轴字母时返回-1（不检查该轴是否已注册）
+ */
+int motor_registry_axis_from_letter(char letter);
+
+/**
+ * @brief 获取共享UART监听器
+ * @return 监听器句柄，未初始化返回NULL
+ */
+uart_monitor_t* motor_registry_get_monitor(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_REGISTRY_H
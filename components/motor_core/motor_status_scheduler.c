@@ -1,7 +1,11 @@
 #include "motor_status_scheduler.h"
 #include "motor_control.h"
+#include "motor_metrics.h"
+#include "motor_task_plan.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 static const char *TAG = "MOTOR_SCHEDULER";
@@ -32,29 +36,30 @@ static void query_task(void *pvParameters) {
             // 根据事件类型执行相应的查询操作
             switch (event.type) {
                 case QUERY_EVENT_TORQUE:
-                    query_motor_torque(event.uart_port);
-                    ESP_LOGI(TAG, "自动查询力矩");
+                    query_motor_torque(event.uart_port, event.node_id);
+                    ESP_LOGI(TAG, "节点%d 自动查询力矩", event.node_id);
                     break;
                 case QUERY_EVENT_POWER:
-                    query_motor_power(event.uart_port);
-                    ESP_LOGI(TAG, "自动查询功率");
+                    query_motor_power(event.uart_port, event.node_id);
+                    ESP_LOGI(TAG, "节点%d 自动查询功率", event.node_id);
                     break;
                 case QUERY_EVENT_ENCODER:
-                    query_encoder_count(event.uart_port);
-                    ESP_LOGI(TAG, "自动查询编码器");
+                    query_encoder_count(event.uart_port, event.node_id);
+                    ESP_LOGI(TAG, "节点%d 自动查询编码器", event.node_id);
                     break;
                 case QUERY_EVENT_POSITION_SPEED:
-                    query_motor_position_speed(event.uart_port);
-                    ESP_LOGI(TAG, "自动查询位置速度");
+                    query_motor_position_speed(event.uart_port, event.node_id);
+                    ESP_LOGI(TAG, "节点%d 自动查询位置速度", event.node_id);
                     break;
                 case QUERY_EVENT_EXCEPTIONS:
-                    query_motor_exceptions(event.uart_port, event.exception_type);
-                    ESP_LOGI(TAG, "自动查询异常状态(类型:%d)", event.exception_type);
+                    query_motor_exceptions(event.uart_port, event.node_id, event.exception_type);
+                    ESP_LOGI(TAG, "节点%d 自动查询异常状态(类型:%d)", event.node_id, event.exception_type);
                     break;
                 default:
                     ESP_LOGW(TAG, "未知查询事件类型: %d", event.type);
-                    break;
+                    continue;
             }
+            MOTOR_METRICS_INC(scheduler->queries_sent);
         }
     }
 }
@@ -79,12 +84,19 @@ motor_status_scheduler_t* motor_status_scheduler_init(const scheduler_config_t*
     scheduler->query_frequency = config->frequency;
     scheduler->auto_query_enabled = config->enable_all_queries;
     scheduler->uart_port = config->uart_port;
+    scheduler->node_ids[0] = config->node_id;
+    scheduler->node_count = 1;
+    scheduler->current_node_index = 0;
     scheduler->current_query_index = 0;
     scheduler->current_exception_type = 0;
     scheduler->is_running = false;
     scheduler->query_timer = NULL;
     scheduler->query_queue = NULL;
     scheduler->query_task_handle = NULL;
+    scheduler->queries_sent = 0;
+    scheduler->queries_skipped = 0;
+    scheduler->queries_requeried = 0;
+    memset(scheduler->requested_us, 0, sizeof(scheduler->requested_us));
     
     // 创建查询事件队列
     scheduler->query_queue = xQueueCreate(QUERY_QUEUE_SIZE, sizeof(query_event_t));
@@ -95,8 +107,8 @@ motor_status_scheduler_t* motor_status_scheduler_init(const scheduler_config_t*
     }
     
     // 创建查询任务
-    BaseType_t ret = xTaskCreate(query_task, "motor_query", 4096, 
-                                scheduler, 5, &scheduler->query_task_handle);
+    BaseType_t ret = motor_task_create(query_task, "motor_query", 4096,
+                                       scheduler, MOTOR_TASK_PRIORITY_QUERY, &scheduler->query_task_handle);
     if (ret != pdPASS) {
         ESP_LOGE(TAG, "创建查询任务失败");
         vQueueDelete(scheduler->query_queue);
@@ -128,6 +140,46 @@ motor_status_scheduler_t* motor_status_scheduler_init(const scheduler_config_t*
     return scheduler;
 }
 
+/**
+ * @brief 把轮询周期写入各节点的状态分组（每个节点的每一组每 节点数×查询类型数 个定时周期查询一次）
+ * @param frequency 查询频率，0表示停止轮询
+ */
+static void scheduler_publish_periods(motor_status_scheduler_t* scheduler, float frequency) {
+    uint32_t period_us = frequency > 0.0f ?
+        (uint32_t)(scheduler->node_count * QUERY_TYPES_COUNT * 1000000.0f / frequency) : 0;
+    for (uint8_t i = 0; i < scheduler->node_count; i++) {
+        motor_controller_t* controller = motor_control_find(scheduler->uart_port, scheduler->node_ids[i]);
+        if (!controller) {
+            continue;
+        }
+        for (int group = 0; group < MOTOR_STATUS_GROUPS; group++) {
+            controller->status.group_period_us[group] = period_us;
+        }
+    }
+}
+
+/**
+ * @brief 查找节点上需要补查的过期分组（取最久未更新者）
+ * 同一分组两次补查至少间隔一个轮询周期，不应答的分组不会挤占其他查询
+ * @return 分组编号，无需补查时返回-1
+ */
+static int scheduler_find_stale_group(motor_status_scheduler_t* scheduler, uint8_t node_index, int64_t now_us) {
+    motor_controller_t* controller = motor_control_find(scheduler->uart_port, scheduler->node_ids[node_index]);
+    if (!controller) {
+        return -1;
+    }
+    const motor_status_t* status = &controller->status;
+    int stale = -1;
+    for (int group = 0; group < QUERY_EVENT_MAX; group++) {
+        if (motor_status_group_stale(status, group, now_us) &&
+            now_us - scheduler->requested_us[node_index][group] > status->group_period_us[group] &&
+            (stale < 0 || status->group_update_us[group] < status->group_update_us[stale])) {
+            stale = group;
+        }
+    }
+    return stale;
+}
+
 // 轻量级定时器回调 - 只发送事件到队列
 static void query_timer_callback(TimerHandle_t xTimer) {
     motor_status_scheduler_t* scheduler = (motor_status_scheduler_t*)pvTimerGetTimerID(xTimer);
@@ -136,29 +188,76 @@ static void query_timer_callback(TimerHandle_t xTimer) {
         return;
     }
     
-    // 创建查询事件
+    // 创建查询事件：每个节点依次查询同一类型，所有节点轮完后再切换到下一类型
+    // 当前节点有过期分组时先补查，轮询位置不前进，被让出的查询在下一个周期发出
+    int64_t now_us = esp_timer_get_time();
+    uint8_t node_index = scheduler->current_node_index;
+    int stale = scheduler_find_stale_group(scheduler, node_index, now_us);
+    bool requery = stale >= 0 && stale != scheduler->current_query_index;
+
     query_event_t event;
     event.uart_port = scheduler->uart_port;
-    event.type = (query_event_type_t)scheduler->current_query_index;
+    event.node_id = scheduler->node_ids[node_index];
+    event.type = (query_event_type_t)(requery ? stale : scheduler->current_query_index);
     event.exception_type = 0; // 默认值
     
-    // 如果是异常查询，设置异常类型并更新计数器
+    // 如果是异常查询，设置异常类型
     if (event.type == QUERY_EVENT_EXCEPTIONS) {
         event.exception_type = scheduler->current_exception_type;
-        scheduler->current_exception_type = (scheduler->current_exception_type + 1) % 5; // 0-4循环
     }
     
     // 发送事件到队列（非阻塞）
     BaseType_t ret = xQueueSendFromISR(scheduler->query_queue, &event, NULL);
     if (ret != pdPASS) {
         // 队列满了，跳过这次查询（避免阻塞）
+        MOTOR_METRICS_INC(scheduler->queries_skipped);
+        return;
+    }
+    scheduler->requested_us[node_index][event.type] = now_us;
+    if (requery) {
+        MOTOR_METRICS_INC(scheduler->queries_requeried);
         return;
     }
     
-    // 更新查询索引
+    // 更新节点索引，一轮节点结束后更新查询索引
+    scheduler->current_node_index++;
+    if (scheduler->current_node_index < scheduler->node_count) {
+        return;
+    }
+    scheduler->current_node_index = 0;
+    if (event.type == QUERY_EVENT_EXCEPTIONS) {
+        scheduler->current_exception_type = (scheduler->current_exception_type + 1) % 5; // 0-4循环
+    }
     scheduler->current_query_index = (scheduler->current_query_index + 1) % QUERY_TYPES_COUNT;
 }
 
+bool motor_status_scheduler_add_node(motor_status_scheduler_t* scheduler, uint8_t node_id) {
+    if (!scheduler) {
+        ESP_LOGE(TAG, "调度器句柄为空");
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < scheduler->node_count; i++) {
+        if (scheduler->node_ids[i] == node_id) {
+            return true;
+        }
+    }
+    
+    if (scheduler->is_running) {
+        ESP_LOGE(TAG, "调度器运行中，不能加入节点");
+        return false;
+    }
+    
+    if (scheduler->node_count >= MOTOR_SCHEDULER_MAX_NODES) {
+        ESP_LOGE(TAG, "UART%d 轮询节点数已达上限 %d", scheduler->uart_port, MOTOR_SCHEDULER_MAX_NODES);
+        return false;
+    }
+    
+    scheduler->node_ids[scheduler->node_count++] = node_id;
+    ESP_LOGI(TAG, "UART%d 加入轮询节点%d - 共%d个节点", scheduler->uart_port, node_id, scheduler->node_count);
+    return true;
+}
+
 bool motor_status_scheduler_start(motor_status_scheduler_t* scheduler) {
     if (!scheduler) {
         ESP_LOGE(TAG, "调度器句柄为空");
@@ -178,6 +277,9 @@ bool motor_status_scheduler_start(motor_status_scheduler_t* scheduler) {
     scheduler->auto_query_enabled = true;
     scheduler->current_query_index = 0;
     scheduler->current_exception_type = 0;
+    scheduler->current_node_index = 0;
+    memset(scheduler->requested_us, 0, sizeof(scheduler->requested_us));
+    scheduler_publish_periods(scheduler, scheduler->query_frequency);
     
     if (xTimerStart(scheduler->query_timer, 0) != pdPASS) {
         ESP_LOGE(TAG, "启动定时器失败");
@@ -200,6 +302,7 @@ void motor_status_scheduler_stop(motor_status_scheduler_t* scheduler) {
     if (scheduler->query_timer) {
         xTimerStop(scheduler->query_timer, 0);
     }
+    scheduler_publish_periods(scheduler, 0.0f);
     
     scheduler->is_running = false;
     ESP_LOGI(TAG, "电机状态调度器已停止");
@@ -8,8 +8,11 @@
 #include "freertos/queue.h"
 #include "freertos/task.h"
 #include "driver/uart.h"
+#include "motor_control.h"
 
-// 查询事件类型
+#define MOTOR_SCHEDULER_MAX_NODES MOTOR_CONTROL_MAX_MOTORS   // 单个端口上轮询的节点数上限
+
+// 查询事件类型（与motor_status_group_t一一对应）
 typedef enum {
     QUERY_EVENT_TORQUE = 0,
     QUERY_EVENT_POWER,
@@ -23,6 +26,7 @@ typedef enum {
 typedef struct {
     query_event_type_t type;
     uart_port_t uart_port;
+    uint8_t node_id;     // 目标驱动器节点ID
     int exception_type;  // 异常查询类型(0-4)，其他查询忽略
 } query_event_t;
 
@@ -30,6 +34,9 @@ typedef struct {
     float query_frequency;          // 查询频率 (Hz)
     bool auto_query_enabled;        // 是否启用自动查询
     uart_port_t uart_port;          // UART端口
+    uint8_t node_ids[MOTOR_SCHEDULER_MAX_NODES]; // 该端口上轮询的驱动器节点
+    uint8_t node_count;             // 节点数量
+    uint8_t current_node_index;     // 当前轮询到的节点
     TimerHandle_t query_timer;      // FreeRTOS定时器句柄
     uint8_t current_query_index;    // 当前查询索引(轮询不同状态)
     uint8_t current_exception_type; // 当前异常查询类型(0-4循环)
@@ -38,16 +45,29 @@ typedef struct {
     // 新增：事件队列和任务句柄
     QueueHandle_t query_queue;      // 查询事件队列
     TaskHandle_t query_task_handle; // 查询任务句柄
+    uint32_t queries_sent;          // 已发出的查询数（对时间求导即实际查询频率）
+    uint32_t queries_skipped;       // 查询队列满而跳过的定时周期数
+    uint32_t queries_requeried;     // 优先补查过期分组的次数
+    int64_t requested_us[MOTOR_SCHEDULER_MAX_NODES][QUERY_EVENT_MAX]; // 各节点各分组最近一次入队查询的时间
 } motor_status_scheduler_t;
 
 typedef struct {
     float frequency;                // 查询频率 (Hz, 范围: 1.0 - 100.0)
     uart_port_t uart_port;         // UART端口
+    uint8_t node_id;               // 首个轮询节点ID，同一端口的其他节点用motor_status_scheduler_add_node加入
     bool enable_all_queries;       // 是否启用全部查询类型
 } scheduler_config_t;
 
 motor_status_scheduler_t* motor_status_scheduler_init(const scheduler_config_t* config);
 
+/**
+ * @brief 向调度器加入同一UART上的另一个驱动器节点（节点间轮流查询）
+ * @param scheduler 调度器句柄
+ * @param node_id 驱动器节点ID
+ * @return 是否加入成功（重复节点视为成功）
+ */
+bool motor_status_scheduler_add_node(motor_status_scheduler_t* scheduler, uint8_t node_id);
+
 bool motor_status_scheduler_start(motor_status_scheduler_t* scheduler);
 
 void motor_status_scheduler_stop(motor_status_scheduler_t* scheduler);
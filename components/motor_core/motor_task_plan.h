@@ -0,0 +1,57 @@
+#ifndef MOTOR_TASK_PLAN_H
+#define MOTOR_TASK_PLAN_H
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 实时任务的核心与优先级规划（menuconfig: Motor Configuration -> Real-time task placement）
+//
+// 节拍链路：esp_timer -> traj_stream -> UART写 -> 驱动器响应 -> uart_monitor解析
+// 优先级按离节拍最近到最远排列：traj_stream > uart_monitor > can_monitor = gcode_exec > motor_query
+//
+// SHARED（默认）：保持原有的不绑核、优先级5-6，低于lwIP(18)与WiFi(23)任务
+// APP_CORE：全部绑到CONFIG_MOTOR_TASK_CORE（Kconfig限定为核1）并抬到网络任务之上，HTTP服务器绑到另一个核；
+//           WiFi固定在核0、lwIP不绑核，应用核上电机任务只会被更高优先级的电机任务抢占
+//           轨迹定时器回调仍由核0上的esp_timer任务派发，节拍抖动见/metrics的motor_trajectory_tick_jitter_microseconds
+
+#if CONFIG_MOTOR_TASK_PLAN_APP_CORE
+#define MOTOR_TASK_CORE                 CONFIG_MOTOR_TASK_CORE
+#define MOTOR_TASK_NETWORK_CORE         (1 - CONFIG_MOTOR_TASK_CORE)
+#define MOTOR_TASK_PRIORITY_QUERY       (CONFIG_MOTOR_TASK_PRIORITY_BASE)
+#define MOTOR_TASK_PRIORITY_CAN         (CONFIG_MOTOR_TASK_PRIORITY_BASE + 1)
+#define MOTOR_TASK_PRIORITY_GCODE       (CONFIG_MOTOR_TASK_PRIORITY_BASE + 1)
+#define MOTOR_TASK_PRIORITY_UART        (CONFIG_MOTOR_TASK_PRIORITY_BASE + 2)
+#define MOTOR_TASK_PRIORITY_STREAM      (CONFIG_MOTOR_TASK_PRIORITY_BASE + 3)
+#else
+#define MOTOR_TASK_CORE                 tskNO_AFFINITY
+#define MOTOR_TASK_NETWORK_CORE         tskNO_AFFINITY
+#define MOTOR_TASK_PRIORITY_QUERY       5
+#define MOTOR_TASK_PRIORITY_CAN         5
+#define MOTOR_TASK_PRIORITY_GCODE       5
+#define MOTOR_TASK_PRIORITY_UART        5
+#define MOTOR_TASK_PRIORITY_STREAM      6       // 高于CAN/UART监听任务，保证设定点节拍
+#endif
+
+/**
+ * @brief 按任务规划创建电机实时任务（APP_CORE时绑定到应用核）
+ * @return pdPASS表示成功
+ */
+static inline BaseType_t motor_task_create(TaskFunction_t function, const char* name, uint32_t stack_size,
+                                           void* arg, UBaseType_t priority, TaskHandle_t* handle) {
+#if CONFIG_MOTOR_TASK_PLAN_APP_CORE
+    return xTaskCreatePinnedToCore(function, name, stack_size, arg, priority, handle, MOTOR_TASK_CORE);
+#else
+    return xTaskCreate(function, name, stack_size, arg, priority, handle);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_TASK_PLAN_H
@@ -0,0 +1,93 @@
+#ifndef MOTOR_UART_H
+#define MOTOR_UART_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "driver/uart.h"
+#include "motor_drive_sim.h"
+#include "wire_trace.h"
+
+// 电机UART传输层：电机控制与UART监听只通过这里收发字节
+// CONFIG_MOTOR_DRIVE_SIM 打开时接到软件驱动器模拟器，否则直接调用ESP-IDF UART驱动
+// CONFIG_WIRE_TRACE 打开时收发字节同时写入线路抓包
+
+/**
+ * @brief 安装UART驱动（模拟模式下只创建事件队列并挂接模拟总线）
+ */
+static inline esp_err_t motor_uart_driver_install(uart_port_t uart_port, int rx_buffer_size, int tx_buffer_size,
+                                                  int queue_size, QueueHandle_t* uart_queue) {
+#if CONFIG_MOTOR_DRIVE_SIM
+    return motor_drive_sim_attach(uart_port, rx_buffer_size, queue_size, uart_queue) ? ESP_OK : ESP_FAIL;
+#else
+    return uart_driver_install(uart_port, rx_buffer_size, tx_buffer_size, queue_size, uart_queue, 0);
+#endif
+}
+
+/**
+ * @brief 设置波特率和引脚（模拟模式下无物理接口，直接返回）
+ */
+static inline void motor_uart_configure(uart_port_t uart_port, int baud_rate, int txd_pin, int rxd_pin) {
+#if !CONFIG_MOTOR_DRIVE_SIM
+    uart_config_t uart_config = {
+        .baud_rate = baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT
+    };
+    uart_param_config(uart_port, &uart_config);
+    uart_set_pin(uart_port, txd_pin, rxd_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+#endif
+}
+
+static inline void motor_uart_driver_delete(uart_port_t uart_port) {
+#if CONFIG_MOTOR_DRIVE_SIM
+    motor_drive_sim_detach(uart_port);
+#else
+    uart_driver_delete(uart_port);
+#endif
+}
+
+static inline int motor_uart_write(uart_port_t uart_port, const uint8_t* data, size_t length) {
+    WIRE_TRACE_RECORD(WIRE_TRACE_UART_TX, uart_port, data, length);
+#if CONFIG_MOTOR_DRIVE_SIM
+    return motor_drive_sim_write(uart_port, data, length);
+#else
+    return uart_write_bytes(uart_port, data, length);
+#endif
+}
+
+static inline int motor_uart_read(uart_port_t uart_port, uint8_t* buffer, size_t length) {
+#if CONFIG_MOTOR_DRIVE_SIM
+    int received = motor_drive_sim_read(uart_port, buffer, length);
+#else
+    int received = uart_read_bytes(uart_port, buffer, length, 0);
+#endif
+    if (received > 0) {
+        WIRE_TRACE_RECORD(WIRE_TRACE_UART_RX, uart_port, buffer, received);
+    }
+    return received;
+}
+
+static inline size_t motor_uart_buffered_len(uart_port_t uart_port) {
+    size_t available = 0;
+#if CONFIG_MOTOR_DRIVE_SIM
+    available = motor_drive_sim_buffered_len(uart_port);
+#else
+    uart_get_buffered_data_len(uart_port, &available);
+#endif
+    return available;
+}
+
+static inline void motor_uart_flush_input(uart_port_t uart_port) {
+#if CONFIG_MOTOR_DRIVE_SIM
+    motor_drive_sim_flush_input(uart_port);
+#else
+    uart_flush_input(uart_port);
+#endif
+}
+
+#endif // MOTOR_UART_H
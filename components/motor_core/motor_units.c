@@ -0,0 +1,304 @@
+#include "motor_units.h"
+#include "motor_config.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include <string.h>
+#include <math.h>
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "nvs.h"
+#endif
+
+static const char *TAG = "MOTOR_UNITS";
+
+#define UNITS_MAX_OFFSET    368640.0f   // 偏移上限：1024圈输出轴
+
+#define MOTOR_UNITS_DEFAULT_PROFILE {               \
+    .ratio = 0.0f,                                  \
+    .scale = ANGLE_TO_POSITION_SCALE,               \
+    .offset = 0.0f,                                 \
+    .torque_factor = 0.0f,                          \
+    .direction = 1,                                 \
+    .turn_mode = MOTOR_UNITS_SINGLE_TURN,           \
+}
+
+// 默认标定下的换算系数（未调用motor_units_init的linux目标同样可用）
+#define MOTOR_UNITS_DEFAULT_AXIS {                                          \
+    .position_per_degree = GEAR_RATIO * ANGLE_TO_POSITION_SCALE / 360.0f,   \
+    .degree_per_position = 360.0f / (GEAR_RATIO * ANGLE_TO_POSITION_SCALE), \
+    .velocity_factor = GEAR_RATIO,                                          \
+    .velocity_inverse = 1.0f / GEAR_RATIO,                                  \
+    .torque_factor = TORQUE_FACTOR,                                         \
+    .offset = 0.0f,                                                         \
+    .turn_mode = MOTOR_UNITS_SINGLE_TURN,                                   \
+    .exact_position_per_degree = (double)GEAR_RATIO * ANGLE_TO_POSITION_SCALE / 360.0, \
+    .degree_per_count = 360.0 / ((double)GEAR_RATIO * CONFIG_MOTOR_ENCODER_CPR),        \
+}
+
+// 持久化格式
+typedef struct {
+    uint32_t version;
+    motor_units_profile_t profiles[MOTOR_UNITS_MAX_AXES];
+} motor_units_blob_t;
+
+static const motor_units_profile_t units_default_profile = MOTOR_UNITS_DEFAULT_PROFILE;
+
+static motor_units_profile_t g_profiles[MOTOR_UNITS_MAX_AXES] = {
+    MOTOR_UNITS_DEFAULT_PROFILE, MOTOR_UNITS_DEFAULT_PROFILE, MOTOR_UNITS_DEFAULT_PROFILE,
+    MOTOR_UNITS_DEFAULT_PROFILE, MOTOR_UNITS_DEFAULT_PROFILE, MOTOR_UNITS_DEFAULT_PROFILE,
+};
+
+static motor_units_axis_t g_axes[MOTOR_UNITS_MAX_AXES] = {
+    MOTOR_UNITS_DEFAULT_AXIS, MOTOR_UNITS_DEFAULT_AXIS, MOTOR_UNITS_DEFAULT_AXIS,
+    MOTOR_UNITS_DEFAULT_AXIS, MOTOR_UNITS_DEFAULT_AXIS, MOTOR_UNITS_DEFAULT_AXIS,
+};
+
+// ====================================================================================
+// --- 标定与换算系数 ---
+// ====================================================================================
+
+static bool units_profile_valid(const motor_units_profile_t* profile) {
+    if (!isfinite(profile->ratio) || !isfinite(profile->scale) ||
+        !isfinite(profile->offset) || !isfinite(profile->torque_factor)) {
+        return false;
+    }
+    // 减速比与力矩系数为0时跟随运行时配置，否则取值范围与/api/config一致
+    if (profile->ratio != 0.0f && (profile->ratio < 1.0f || profile->ratio > 1000.0f)) {
+        return false;
+    }
+    if (profile->torque_factor != 0.0f && (profile->torque_factor < 0.001f || profile->torque_factor > 100.0f)) {
+        return false;
+    }
+    return profile->scale >= 0.001f && profile->scale <= 1000000.0f &&
+           fabsf(profile->offset) <= UNITS_MAX_OFFSET &&
+           (profile->direction == 1 || profile->direction == -1) &&
+           profile->turn_mode < MOTOR_UNITS_TURN_MODES;
+}
+
+/**
+ * @brief 由标定与运行时配置计算一个轴的换算系数
+ */
+static void units_compute(const motor_units_profile_t* profile, motor_units_axis_t* axis) {
+    float ratio = profile->ratio != 0.0f ? profile->ratio : g_motor_config.gear_ratio;
+    float torque_factor = profile->torque_factor != 0.0f ? profile->torque_factor : g_motor_config.torque_factor;
+    float direction = (float)profile->direction;
+
+    // 先算好完整结构再整体写入：换算只在标定修改时发生，读者最多读到一次新旧系数混合
+    motor_units_axis_t computed = {
+        .position_per_degree = direction * ratio * profile->scale / 360.0f,
+        .degree_per_position = direction * 360.0f / (ratio * profile->scale),
+        .velocity_factor = direction * ratio,
+        .velocity_inverse = direction / ratio,
+        .torque_factor = direction * torque_factor,
+        .offset = profile->offset,
+        .turn_mode = profile->turn_mode,
+        .exact_position_per_degree = (double)direction * ratio * profile->scale / 360.0,
+        .degree_per_count = (double)direction * 360.0 / ((double)ratio * CONFIG_MOTOR_ENCODER_CPR),
+    };
+    *axis = computed;
+}
+
+static inline const motor_units_axis_t* units_axis(uint8_t axis) {
+    return &g_axes[axis < MOTOR_UNITS_MAX_AXES ? axis : 0];
+}
+
+// ====================================================================================
+// --- NVS持久化 ---
+// ====================================================================================
+
+#if !CONFIG_IDF_TARGET_LINUX
+static bool units_load(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MOTOR_CONFIG_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return true;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "打开NVS失败: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    motor_units_blob_t blob;
+    size_t length = sizeof(blob);
+    err = nvs_get_blob(handle, MOTOR_UNITS_NVS_KEY, &blob, &length);
+    nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return true;
+    }
+    if (err != ESP_OK || length != sizeof(blob) || blob.version != MOTOR_UNITS_VERSION) {
+        // 长度或版本不符（固件改变了标定格式）：整体使用默认标定，下次保存时覆盖
+        ESP_LOGW(TAG, "保存的标定无法识别，使用默认标定");
+        return true;
+    }
+
+    for (uint8_t i = 0; i < MOTOR_UNITS_MAX_AXES; i++) {
+        if (units_profile_valid(&blob.profiles[i])) {
+            g_profiles[i] = blob.profiles[i];
+        } else {
+            ESP_LOGW(TAG, "轴%d 保存的标定越界，使用默认标定", i);
+        }
+    }
+    ESP_LOGI(TAG, "已从NVS加载各轴标定");
+    return true;
+}
+#endif
+
+// ====================================================================================
+// --- 对外接口 ---
+// ====================================================================================
+
+bool motor_units_init(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    motor_units_refresh();
+    return false;
+#else
+    bool ok = units_load();
+    motor_units_refresh();
+    return ok;
+#endif
+}
+
+void motor_units_refresh(void) {
+    for (uint8_t i = 0; i < MOTOR_UNITS_MAX_AXES; i++) {
+        units_compute(&g_profiles[i], &g_axes[i]);
+    }
+}
+
+const motor_units_profile_t* motor_units_default_profile(void) {
+    return &units_default_profile;
+}
+
+bool motor_units_get_profile(uint8_t axis, motor_units_profile_t* profile) {
+    if (axis >= MOTOR_UNITS_MAX_AXES || !profile) {
+        return false;
+    }
+    *profile = g_profiles[axis];
+    return true;
+}
+
+bool motor_units_set_profile(uint8_t axis, const motor_units_profile_t* profile) {
+    if (axis >= MOTOR_UNITS_MAX_AXES || !profile || !units_profile_valid(profile)) {
+        return false;
+    }
+    g_profiles[axis] = *profile;
+    memset(g_profiles[axis].reserved, 0, sizeof(g_profiles[axis].reserved));
+    units_compute(&g_profiles[axis], &g_axes[axis]);
+    static const char* const turn_mode_names[MOTOR_UNITS_TURN_MODES] = { "单圈", "多圈", "最短路径" };
+    ESP_LOGI(TAG, "轴%d 标定: 减速比%g 比例%g 偏移%g° 力矩系数%g 方向%d %s", axis,
+             profile->ratio, profile->scale, profile->offset, profile->torque_factor, profile->direction,
+             turn_mode_names[profile->turn_mode]);
+    return true;
+}
+
+const motor_units_axis_t* motor_units_axis(uint8_t axis) {
+    return axis < MOTOR_UNITS_MAX_AXES ? &g_axes[axis] : NULL;
+}
+
+bool motor_units_save(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return false;
+#else
+    motor_units_blob_t blob = { .version = MOTOR_UNITS_VERSION };
+    memcpy(blob.profiles, g_profiles, sizeof(blob.profiles));
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MOTOR_CONFIG_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, MOTOR_UNITS_NVS_KEY, &blob, sizeof(blob));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存标定失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+#endif
+}
+
+float motor_units_normalize_degrees(float degrees) {
+    // 常见情况已在范围内，直接返回；fmodf结果精确且迭代次数受指数差限制
+    if (degrees >= 0.0f && degrees < 360.0f) {
+        return degrees;
+    }
+    float wrapped = fmodf(degrees, 360.0f);
+    if (wrapped < 0.0f) {
+        wrapped += 360.0f;
+        // 极小的负数加360后舍入为360
+        if (wrapped >= 360.0f) {
+            wrapped = 0.0f;
+        }
+    }
+    return wrapped;
+}
+
+static double units_normalize_exact(double degrees) {
+    double wrapped = fmod(degrees, 360.0);
+    if (wrapped < 0.0) {
+        wrapped += 360.0;
+        if (wrapped >= 360.0) {
+            wrapped = 0.0;
+        }
+    }
+    return wrapped;
+}
+
+double motor_units_resolve_target(uint8_t axis, double current_degrees, double value_degrees, bool relative) {
+    const motor_units_axis_t* units = units_axis(axis);
+    if (relative) {
+        double target = current_degrees + value_degrees;
+        return units->turn_mode == MOTOR_UNITS_SINGLE_TURN ? units_normalize_exact(target) : target;
+    }
+    switch (units->turn_mode) {
+        case MOTOR_UNITS_MULTI_TURN:
+            return value_degrees;
+        case MOTOR_UNITS_SHORTEST_PATH:
+            // remainder结果在[-180, 180]，恰好半圈时按正方向取整规则任选其一
+            return current_degrees + remainder(value_degrees - current_degrees, 360.0);
+        default:
+            return units_normalize_exact(value_degrees);
+    }
+}
+
+bool motor_units_needs_current(uint8_t axis, bool relative) {
+    return relative || units_axis(axis)->turn_mode == MOTOR_UNITS_SHORTEST_PATH;
+}
+
+float motor_units_absolute_to_position(uint8_t axis, double angle_degrees) {
+    const motor_units_axis_t* units = units_axis(axis);
+    return (float)((angle_degrees - units->offset) * units->exact_position_per_degree);
+}
+
+double motor_units_count_to_angle(uint8_t axis, int64_t count) {
+    const motor_units_axis_t* units = units_axis(axis);
+    return (double)count * units->degree_per_count + units->offset;
+}
+
+float motor_units_angle_to_position(uint8_t axis, float angle_degrees) {
+    const motor_units_axis_t* units = units_axis(axis);
+    // 先对输出轴角度归一化再减偏移：同一次运动内的设定点不会跨越偏移点而跳变一整圈
+    if (units->turn_mode != MOTOR_UNITS_MULTI_TURN) {
+        angle_degrees = motor_units_normalize_degrees(angle_degrees);
+    }
+    return (angle_degrees - units->offset) * units->position_per_degree;
+}
+
+float motor_units_position_to_angle(uint8_t axis, float position) {
+    const motor_units_axis_t* units = units_axis(axis);
+    float angle = position * units->degree_per_position + units->offset;
+    return units->turn_mode != MOTOR_UNITS_MULTI_TURN ? motor_units_normalize_degrees(angle) : angle;
+}
+
+float motor_units_velocity_to_internal(uint8_t axis, float external_velocity) {
+    return external_velocity * units_axis(axis)->velocity_factor;
+}
+
+float motor_units_velocity_to_external(uint8_t axis, float internal_velocity) {
+    return internal_velocity * units_axis(axis)->velocity_inverse;
+}
+
+float motor_units_torque_to_internal(uint8_t axis, float external_torque) {
+    return external_torque * units_axis(axis)->torque_factor;
+}
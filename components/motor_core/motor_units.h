@@ -0,0 +1,155 @@
+#ifndef MOTOR_UNITS_H
+#define MOTOR_UNITS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单位换算：输出轴角度/速度/力矩 <-> 电机位置/速度/力矩，每轴一套标定
+// 标定改变时预先算好换算系数及其倒数，热点路径（HTTP、G代码、500Hz轨迹设定点）只做乘加，
+// 单圈归一化用有界的fmodf代替逐次加减360的循环（输入再大耗时也固定）
+// 多圈绝对位置（G代码已下发目标、编码器展开计数）一律用double/int64表示，只在组帧时转为float，长时间运行不累积误差
+
+// 角度映射参数（减速比与力矩系数为默认值，运行时取g_motor_config，可经/api/config修改并保存到NVS）
+#define GEAR_RATIO 19.2158f          // 外部减速比
+#define TORQUE_FACTOR 0.3667f        // 力矩转换系数：30Nm外部 -> 11Nm内部
+#define ANGLE_TO_POSITION_SCALE 8.0f // 0-8对应0-360度
+
+#define MOTOR_UNITS_MAX_AXES        6       // 与MOTOR_CONTROL_MAX_MOTORS一致
+#define MOTOR_UNITS_NVS_KEY         "units" // 标定在MOTOR_CONFIG_NAMESPACE中的键
+#define MOTOR_UNITS_VERSION         1       // 标定存储格式版本
+
+// 圈数模式
+typedef enum {
+    MOTOR_UNITS_SINGLE_TURN = 0,            // 目标角度归一化到0-360度（默认，与原行为一致）
+    MOTOR_UNITS_MULTI_TURN,                 // 角度不归一化，720度即输出轴转两圈
+    MOTOR_UNITS_SHORTEST_PATH,              // 目标按360度取模，从当前绝对位置沿最短方向到达（不超过半圈）
+    MOTOR_UNITS_TURN_MODES
+} motor_units_turn_mode_t;
+
+// 每轴标定
+typedef struct {
+    float ratio;                            // 外部减速比，0表示跟随运行时配置gear_ratio
+    float scale;                            // 电机每转对应的位置值
+    float offset;                           // 电机位置0对应的输出轴角度（度）
+    float torque_factor;                    // 输出轴力矩 -> 电机力矩系数，0表示跟随运行时配置torque_factor
+    int8_t direction;                       // 1同向，-1电机与输出轴反向（位置、速度、力矩同时取反）
+    uint8_t turn_mode;                      // motor_units_turn_mode_t
+    uint8_t reserved[2];
+} motor_units_profile_t;
+
+// 由标定预先算好的换算系数（热点路径只读）
+typedef struct {
+    float position_per_degree;              // direction * 减速比 * scale / 360
+    float degree_per_position;              // 上式的倒数
+    float velocity_factor;                  // direction * 减速比
+    float velocity_inverse;
+    float torque_factor;                    // direction * 力矩系数
+    float offset;
+    uint8_t turn_mode;
+    double exact_position_per_degree;       // 多圈绝对位置换算用的双精度系数
+    double degree_per_count;                // direction * 360 / (减速比 * 编码器每转计数)
+} motor_units_axis_t;
+
+/**
+ * @brief 从NVS加载各轴标定并计算换算系数（须在motor_config_init之后调用；未调用时各轴使用默认标定）
+ * @return NVS不可用时返回false，此时使用默认标定
+ */
+bool motor_units_init(void);
+
+/**
+ * @brief 按当前标定与运行时配置（gear_ratio/torque_factor）重新计算全部轴的换算系数
+ */
+void motor_units_refresh(void);
+
+/**
+ * @brief 默认标定（减速比与力矩系数跟随运行时配置，同向、单圈、无偏移）
+ */
+const motor_units_profile_t* motor_units_default_profile(void);
+
+/**
+ * @brief 获取一个轴的标定，轴号越界返回false
+ */
+bool motor_units_get_profile(uint8_t axis, motor_units_profile_t* profile);
+
+/**
+ * @brief 校验并设置一个轴的标定，立即生效（需调用motor_units_save持久化）
+ * @return 轴号越界或参数非法返回false
+ */
+bool motor_units_set_profile(uint8_t axis, const motor_units_profile_t* profile);
+
+/**
+ * @brief 获取一个轴的换算系数，轴号越界返回NULL
+ */
+const motor_units_axis_t* motor_units_axis(uint8_t axis);
+
+/**
+ * @brief 把全部轴的标定写入NVS
+ * @return NVS不可用或写入失败返回false
+ */
+bool motor_units_save(void);
+
+/**
+ * @brief 角度归一化到[0, 360)，耗时与输入大小无关
+ */
+float motor_units_normalize_degrees(float degrees);
+
+/**
+ * @brief 按该轴圈数模式把命令值解析为绝对目标角度
+ * @param current_degrees 当前绝对角度（相对运动与最短路径的起点）
+ * @param value_degrees 命令值
+ * @param relative 相对运动（G91）：目标 = 当前 + 命令值，单圈轴再归一化
+ * @return 单圈轴为[0, 360)；多圈轴为命令值；最短路径轴为与命令值模360相等且离当前最近的角度
+ */
+double motor_units_resolve_target(uint8_t axis, double current_degrees, double value_degrees, bool relative);
+
+/**
+ * @brief 目标角度是否依赖当前位置（相对运动或最短路径轴）
+ */
+bool motor_units_needs_current(uint8_t axis, bool relative);
+
+/**
+ * @brief 绝对角度（双精度，不归一化）转换为电机位置值
+ */
+float motor_units_absolute_to_position(uint8_t axis, double angle_degrees);
+
+/**
+ * @brief 编码器展开计数转换为输出轴绝对角度（双精度，不归一化）
+ */
+double motor_units_count_to_angle(uint8_t axis, int64_t count);
+
+/**
+ * @brief 输出轴角度转换为电机位置值（单圈与最短路径轴先归一化到[0, 360)）
+ * @param axis 轴号（越界按轴0换算）
+ * @param angle_degrees 输出轴角度(度)
+ */
+float motor_units_angle_to_position(uint8_t axis, float angle_degrees);
+
+/**
+ * @brief 电机位置值转换为输出轴角度（单圈与最短路径轴归一化到[0, 360)）
+ */
+float motor_units_position_to_angle(uint8_t axis, float position);
+
+/**
+ * @brief 输出轴速度 (r/s) 转换为电机速度 (r/s)
+ */
+float motor_units_velocity_to_internal(uint8_t axis, float external_velocity);
+
+/**
+ * @brief 电机速度 (r/s) 转换为输出轴速度 (r/s)
+ */
+float motor_units_velocity_to_external(uint8_t axis, float internal_velocity);
+
+/**
+ * @brief 输出轴力矩 (Nm) 转换为电机力矩 (Nm)
+ */
+float motor_units_torque_to_internal(uint8_t axis, float external_torque);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTOR_UNITS_H
@@ -0,0 +1,419 @@
+#include "trajectory_generator.h"
+#include "motor_metrics.h"
+#include "motor_task_plan.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "TRAJECTORY";
+
+#define TRAJECTORY_STREAM_STACK_SIZE 4096
+#define S_CURVE_SEARCH_ITERATIONS    32     // 短行程时二分搜索可达峰值速度的迭代次数
+
+// ====================================================================================
+// --- 运动规划（纯计算） ---
+// ====================================================================================
+
+/**
+ * @brief 追加一个恒定加加速度段，段起点位置/速度由上一段积分得到
+ */
+static void plan_append_segment(trajectory_plan_t* plan, float duration, float jerk, float acceleration) {
+    if (duration <= 0.0f || plan->segment_count >= TRAJECTORY_MAX_SEGMENTS) {
+        return;
+    }
+
+    float position = 0.0f;
+    float velocity = 0.0f;
+    if (plan->segment_count > 0) {
+        const trajectory_segment_t* prev = &plan->segments[plan->segment_count - 1];
+        float t = prev->duration;
+        position = prev->start_position + prev->start_velocity * t +
+                   prev->start_acceleration * t * t * 0.5f + prev->jerk * t * t * t / 6.0f;
+        velocity = prev->start_velocity + prev->start_acceleration * t + prev->jerk * t * t * 0.5f;
+    }
+
+    trajectory_segment_t* seg = &plan->segments[plan->segment_count++];
+    seg->duration = duration;
+    seg->jerk = jerk;
+    seg->start_position = position;
+    seg->start_velocity = velocity;
+    seg->start_acceleration = acceleration;
+    plan->total_time += duration;
+}
+
+/**
+ * @brief 上一段结束时的加速度（S曲线各段加速度连续）
+ */
+static float plan_end_acceleration(const trajectory_plan_t* plan) {
+    if (plan->segment_count == 0) {
+        return 0.0f;
+    }
+    const trajectory_segment_t* prev = &plan->segments[plan->segment_count - 1];
+    return prev->start_acceleration + prev->jerk * prev->duration;
+}
+
+/**
+ * @brief S曲线从静止加速到速度v所需时间
+ * @param tj 加加速度段时长
+ * @param ta 加速阶段总时长（含两个加加速度段）
+ */
+static void s_curve_accel_phase(float v, float max_acc, float max_jerk, float* tj, float* ta) {
+    if (v * max_jerk >= max_acc * max_acc) {
+        // 能达到最大加速度：加加速度段 + 恒加速段 + 减加速度段
+        *tj = max_acc / max_jerk;
+        *ta = *tj + v / max_acc;
+    } else {
+        // 达不到最大加速度：只有两个加加速度段
+        *tj = sqrtf(v / max_jerk);
+        *ta = 2.0f * *tj;
+    }
+}
+
+static void plan_trapezoidal(trajectory_plan_t* plan, float distance, const trajectory_limits_t* limits) {
+    float v = limits->max_velocity;
+    float a = limits->max_acceleration;
+
+    // 行程不足以加速到最大速度时退化为三角形速度曲线
+    if (v * v / a > distance) {
+        v = sqrtf(distance * a);
+    }
+
+    float ta = v / a;
+    float tv = (distance - v * v / a) / v;
+
+    plan_append_segment(plan, ta, 0.0f, a);
+    plan_append_segment(plan, tv, 0.0f, 0.0f);
+    plan_append_segment(plan, ta, 0.0f, -a);
+
+    plan->peak_velocity = v;
+    plan->peak_acceleration = a;
+}
+
+static void plan_s_curve(trajectory_plan_t* plan, float distance, const trajectory_limits_t* limits) {
+    float a = limits->max_acceleration;
+    float j = limits->max_jerk;
+    float v = limits->max_velocity;
+    float tj, ta;
+
+    // 加速+减速行程 = v*ta，超过总行程时二分搜索可达的峰值速度
+    s_curve_accel_phase(v, a, j, &tj, &ta);
+    if (v * ta > distance) {
+        float lo = 0.0f;
+        float hi = v;
+        for (int i = 0; i < S_CURVE_SEARCH_ITERATIONS; i++) {
+            float mid = 0.5f * (lo + hi);
+            s_curve_accel_phase(mid, a, j, &tj, &ta);
+            if (mid * ta > distance) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        v = lo;
+        s_curve_accel_phase(v, a, j, &tj, &ta);
+    }
+
+    float tc = ta - 2.0f * tj;                  // 恒加速段
+    float tv = (distance - v * ta) / v;         // 匀速段
+    if (tc < 0.0f) tc = 0.0f;
+    if (tv < 0.0f) tv = 0.0f;
+
+    plan_append_segment(plan, tj, j, 0.0f);
+    plan_append_segment(plan, tc, 0.0f, plan_end_acceleration(plan));
+    plan_append_segment(plan, tj, -j, plan_end_acceleration(plan));
+    plan_append_segment(plan, tv, 0.0f, 0.0f);
+    plan_append_segment(plan, tj, -j, 0.0f);
+    plan_append_segment(plan, tc, 0.0f, plan_end_acceleration(plan));
+    plan_append_segment(plan, tj, j, plan_end_acceleration(plan));
+
+    plan->peak_velocity = v;
+    plan->peak_acceleration = j * tj;
+}
+
+bool trajectory_plan_move(trajectory_plan_t* plan, float start, float target,
+                          trajectory_profile_t profile, const trajectory_limits_t* limits) {
+    if (!plan || !limits || limits->max_velocity <= 0.0f || limits->max_acceleration <= 0.0f) {
+        return false;
+    }
+    if (profile == TRAJECTORY_PROFILE_S_CURVE && limits->max_jerk <= 0.0f) {
+        return false;
+    }
+
+    memset(plan, 0, sizeof(trajectory_plan_t));
+    plan->start = start;
+    plan->target = target;
+    plan->direction = (target >= start) ? 1.0f : -1.0f;
+
+    float distance = fabsf(target - start);
+    if (distance <= 0.0f) {
+        return true; // 原地不动：空规划，采样直接返回终点
+    }
+
+    if (profile == TRAJECTORY_PROFILE_S_CURVE) {
+        plan_s_curve(plan, distance, limits);
+    } else {
+        plan_trapezoidal(plan, distance, limits);
+    }
+    return true;
+}
+
+void trajectory_sample(const trajectory_plan_t* plan, float t,
+                       float* position, float* velocity, float* acceleration) {
+    float p, v, a;
+
+    if (t >= plan->total_time || plan->segment_count == 0) {
+        // 运动结束：精确返回终点，避免积分误差残留
+        p = plan->target;
+        v = 0.0f;
+        a = 0.0f;
+    } else {
+        if (t < 0.0f) {
+            t = 0.0f;
+        }
+
+        const trajectory_segment_t* seg = &plan->segments[0];
+        float seg_start = 0.0f;
+        for (uint8_t i = 0; i < plan->segment_count; i++) {
+            seg = &plan->segments[i];
+            if (t < seg_start + seg->duration || i == plan->segment_count - 1) {
+                break;
+            }
+            seg_start += seg->duration;
+        }
+
+        float tau = t - seg_start;
+        float s = seg->start_position + seg->start_velocity * tau +
+                  seg->start_acceleration * tau * tau * 0.5f + seg->jerk * tau * tau * tau / 6.0f;
+        v = seg->start_velocity + seg->start_acceleration * tau + seg->jerk * tau * tau * 0.5f;
+        a = seg->start_acceleration + seg->jerk * tau;
+
+        p = plan->start + plan->direction * s;
+        v *= plan->direction;
+        a *= plan->direction;
+    }
+
+    if (position) *position = p;
+    if (velocity) *velocity = v;
+    if (acceleration) *acceleration = a;
+}
+
+// ====================================================================================
+// --- 定时器驱动的设定点流式输出 ---
+// ====================================================================================
+
+static void trajectory_finish(trajectory_generator_t* generator, bool completed) {
+    esp_timer_stop(generator->timer);
+    generator->active = false;
+    generator->abort_requested = false;
+    if (completed) {
+        generator->stats.moves_completed++;
+    } else {
+        generator->stats.moves_aborted++;
+    }
+    xSemaphoreGive(generator->done_semaphore);
+}
+
+// 定时器回调只负责唤醒流式任务，串口发送在任务中完成
+static void trajectory_timer_callback(void* arg) {
+    trajectory_generator_t* generator = (trajectory_generator_t*)arg;
+    xTaskNotifyGive(generator->stream_task);
+}
+
+static void trajectory_stream_task(void *pvParameters) {
+    trajectory_generator_t* generator = (trajectory_generator_t*)pvParameters;
+
+    ESP_LOGI(TAG, "轨迹流式任务启动成功 - %lu Hz", (unsigned long)generator->config.rate_hz);
+
+    while (true) {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!generator->active) {
+            continue;
+        }
+        if (generator->abort_requested) {
+            // 中止请求会立即唤醒本任务，不计入节拍统计
+            generator->last_tick_us = 0;
+            trajectory_finish(generator, false);
+            continue;
+        }
+        if (pending > 1) {
+            generator->stats.ticks_missed += pending - 1;
+        }
+
+        // 节拍抖动：相邻两次唤醒的间隔与定时周期之差（含esp_timer派发与本任务被抢占的延迟）
+        int64_t now_us = esp_timer_get_time();
+        if (generator->last_tick_us) {
+            int64_t deviation = now_us - generator->last_tick_us - generator->period_us;
+            motor_metrics_observe(&g_motor_metrics.stream_jitter_us,
+                                  (uint32_t)(deviation < 0 ? -deviation : deviation));
+        }
+        generator->last_tick_us = now_us;
+
+        // 按实际经过时间采样，漏掉的节拍不会拉长运动时间
+        float t = (float)(now_us - generator->start_time_us) / 1000000.0f;
+        float distance;
+        trajectory_sample(&generator->plan, t, &distance, NULL, NULL);
+        
+        // 各轴共享同一归一化进度，保证同时开始、同时结束
+        float progress = generator->path_length > 0.0f ? distance / generator->path_length : 1.0f;
+        float positions[TRAJECTORY_MAX_AXES];
+        for (uint8_t i = 0; i < generator->axis_count; i++) {
+            positions[i] = generator->axis_start[i] + generator->axis_delta[i] * progress;
+        }
+        generator->config.setpoint_cb(positions, generator->axis_count, generator->config.context);
+        generator->stats.setpoints_sent++;
+
+        if (t >= generator->plan.total_time) {
+            trajectory_finish(generator, true);
+        }
+    }
+}
+
+trajectory_generator_t* trajectory_generator_init(const trajectory_generator_config_t* config) {
+    if (!config || !config->setpoint_cb) {
+        ESP_LOGE(TAG, "配置参数无效");
+        return NULL;
+    }
+
+    if (config->rate_hz < TRAJECTORY_MIN_RATE_HZ || config->rate_hz > TRAJECTORY_MAX_RATE_HZ) {
+        ESP_LOGE(TAG, "设定点频率超出范围 [%d, %d]: %lu", TRAJECTORY_MIN_RATE_HZ, TRAJECTORY_MAX_RATE_HZ,
+                 (unsigned long)config->rate_hz);
+        return NULL;
+    }
+
+    trajectory_generator_t* generator = malloc(sizeof(trajectory_generator_t));
+    if (!generator) {
+        ESP_LOGE(TAG, "内存分配失败");
+        return NULL;
+    }
+
+    memset(generator, 0, sizeof(trajectory_generator_t));
+    memcpy(&generator->config, config, sizeof(trajectory_generator_config_t));
+
+    generator->done_semaphore = xSemaphoreCreateBinary();
+    if (!generator->done_semaphore) {
+        ESP_LOGE(TAG, "创建完成信号量失败");
+        free(generator);
+        return NULL;
+    }
+
+    BaseType_t ret = motor_task_create(trajectory_stream_task, "traj_stream", TRAJECTORY_STREAM_STACK_SIZE,
+                                       generator, MOTOR_TASK_PRIORITY_STREAM, &generator->stream_task);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "创建轨迹流式任务失败");
+        vSemaphoreDelete(generator->done_semaphore);
+        free(generator);
+        return NULL;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = trajectory_timer_callback,
+        .arg = generator,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "traj_timer",
+    };
+    if (esp_timer_create(&timer_args, &generator->timer) != ESP_OK) {
+        ESP_LOGE(TAG, "创建轨迹定时器失败");
+        vTaskDelete(generator->stream_task);
+        vSemaphoreDelete(generator->done_semaphore);
+        free(generator);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "轨迹发生器初始化成功 - %s, %lu Hz, Vmax=%.1f, Amax=%.1f, Jmax=%.1f",
+             config->profile == TRAJECTORY_PROFILE_S_CURVE ? "S曲线" : "梯形",
+             (unsigned long)config->rate_hz, config->limits.max_velocity,
+             config->limits.max_acceleration, config->limits.max_jerk);
+    return generator;
+}
+
+void trajectory_generator_deinit(trajectory_generator_t* generator) {
+    if (!generator) {
+        return;
+    }
+
+    esp_timer_stop(generator->timer);
+    esp_timer_delete(generator->timer);
+    vTaskDelete(generator->stream_task);
+    vSemaphoreDelete(generator->done_semaphore);
+    free(generator);
+    ESP_LOGI(TAG, "轨迹发生器已销毁");
+}
+
+bool trajectory_generator_start_move(trajectory_generator_t* generator, float start, float target,
+                                     float max_velocity) {
+    return trajectory_generator_start_move_multi(generator, 1, &start, &target, max_velocity);
+}
+
+bool trajectory_generator_start_move_multi(trajectory_generator_t* generator, uint8_t axis_count,
+                                           const float* start, const float* target, float max_velocity) {
+    if (!generator || generator->active || !start || !target ||
+        axis_count == 0 || axis_count > TRAJECTORY_MAX_AXES) {
+        return false;
+    }
+
+    trajectory_limits_t limits = generator->config.limits;
+    if (max_velocity > 0.0f && max_velocity < limits.max_velocity) {
+        limits.max_velocity = max_velocity;
+    }
+
+    // 位移最大的轴决定路径长度，其余轴的速度/加速度按位移比例缩小
+    float path_length = 0.0f;
+    for (uint8_t i = 0; i < axis_count; i++) {
+        generator->axis_start[i] = start[i];
+        generator->axis_delta[i] = target[i] - start[i];
+        float distance = fabsf(generator->axis_delta[i]);
+        if (distance > path_length) {
+            path_length = distance;
+        }
+    }
+
+    if (!trajectory_plan_move(&generator->plan, 0.0f, path_length, generator->config.profile, &limits)) {
+        ESP_LOGE(TAG, "运动规划失败");
+        return false;
+    }
+    generator->axis_count = axis_count;
+    generator->path_length = path_length;
+
+    ESP_LOGI(TAG, "开始运动: %d轴, 路径 %.2f, 时长 %.3f s, 峰值速度 %.2f",
+             axis_count, path_length, generator->plan.total_time, generator->plan.peak_velocity);
+
+    xSemaphoreTake(generator->done_semaphore, 0); // 清除上一次运动遗留的完成信号
+    generator->abort_requested = false;
+    generator->start_time_us = esp_timer_get_time();
+    generator->last_tick_us = 0;
+    generator->period_us = 1000000 / generator->config.rate_hz;
+    generator->active = true;
+
+    if (esp_timer_start_periodic(generator->timer, generator->period_us) != ESP_OK) {
+        ESP_LOGE(TAG, "启动轨迹定时器失败");
+        generator->active = false;
+        return false;
+    }
+    return true;
+}
+
+bool trajectory_generator_wait_done(trajectory_generator_t* generator, TickType_t timeout) {
+    if (!generator) {
+        return false;
+    }
+    if (!generator->active) {
+        return true;
+    }
+    return xSemaphoreTake(generator->done_semaphore, timeout) == pdTRUE;
+}
+
+void trajectory_generator_abort(trajectory_generator_t* generator) {
+    if (generator && generator->active) {
+        generator->abort_requested = true;
+        // 立即唤醒流式任务，不必等到下一个节拍
+        xTaskNotifyGive(generator->stream_task);
+    }
+}
+
+bool trajectory_generator_is_active(trajectory_generator_t* generator) {
+    if (!generator) {
+        return false;
+    }
+    return generator->active;
+}
@@ -0,0 +1,185 @@
+#ifndef TRAJECTORY_GENERATOR_H
+#define TRAJECTORY_GENERATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRAJECTORY_MAX_SEGMENTS 7           // S曲线最多7段
+#define TRAJECTORY_MIN_RATE_HZ  50
+#define TRAJECTORY_MAX_RATE_HZ  1000
+#define TRAJECTORY_MAX_AXES     6           // 单次协调运动最多轴数
+
+// 速度曲线类型
+typedef enum {
+    TRAJECTORY_PROFILE_TRAPEZOIDAL = 0,     // 梯形速度（加速度阶跃）
+    TRAJECTORY_PROFILE_S_CURVE = 1          // S曲线（加加速度受限，7段）
+} trajectory_profile_t;
+
+// 运动约束（单位与位置一致，例如 度、度/s、度/s²、度/s³）
+typedef struct {
+    float max_velocity;                     // 最大速度
+    float max_acceleration;                 // 最大加速度
+    float max_jerk;                         // 最大加加速度（仅S曲线使用）
+} trajectory_limits_t;
+
+// 恒定加加速度段：段内 a(τ)=a0+jτ，v、p按多项式积分
+typedef struct {
+    float duration;                         // 段时长 (s)
+    float jerk;                             // 段内加加速度
+    float start_position;                   // 段起点位置（相对起点的行程）
+    float start_velocity;                   // 段起点速度
+    float start_acceleration;               // 段起点加速度
+} trajectory_segment_t;
+
+// 单次点到点运动规划结果
+typedef struct {
+    float start;                            // 起点
+    float target;                           // 终点
+    float direction;                        // 运动方向 (+1/-1)
+    float total_time;                       // 总时长 (s)
+    float peak_velocity;                    // 实际达到的最大速度
+    float peak_acceleration;                // 实际达到的最大加速度
+    uint8_t segment_count;                  // 有效段数
+    trajectory_segment_t segments[TRAJECTORY_MAX_SEGMENTS];
+} trajectory_plan_t;
+
+/**
+ * @brief 设定点输出回调（在流式任务上下文中调用）
+ * @param positions 当前时刻各轴的位置设定点（顺序与start_move_multi传入一致）
+ * @param axis_count 轴数
+ * @param context 用户上下文
+ */
+typedef void (*trajectory_setpoint_cb_t)(const float* positions, uint8_t axis_count, void* context);
+
+// 轨迹发生器配置
+typedef struct {
+    uint32_t rate_hz;                       // 设定点输出频率 (Hz, 50-1000)
+    trajectory_profile_t profile;           // 速度曲线类型
+    trajectory_limits_t limits;             // 默认运动约束
+    trajectory_setpoint_cb_t setpoint_cb;   // 设定点输出回调
+    void* context;                          // 回调上下文
+} trajectory_generator_config_t;
+
+// 轨迹发生器统计
+typedef struct {
+    uint32_t moves_completed;               // 完成的运动数
+    uint32_t moves_aborted;                 // 被中止的运动数
+    uint32_t setpoints_sent;                // 已输出的设定点数
+    uint32_t ticks_missed;                  // 流式任务未及时处理的定时周期数
+} trajectory_stats_t;
+
+// 轨迹发生器句柄
+typedef struct {
+    trajectory_generator_config_t config;   // 配置信息
+    esp_timer_handle_t timer;               // 周期定时器
+    TaskHandle_t stream_task;               // 设定点计算与发送任务
+    SemaphoreHandle_t done_semaphore;       // 运动完成信号
+    trajectory_plan_t plan;                 // 当前运动规划（沿合成路径的行程，0 -> path_length）
+    uint8_t axis_count;                     // 当前运动的轴数
+    float path_length;                      // 路径长度（各轴位移绝对值的最大者）
+    float axis_start[TRAJECTORY_MAX_AXES];  // 各轴起点
+    float axis_delta[TRAJECTORY_MAX_AXES];  // 各轴位移
+    int64_t start_time_us;                  // 当前运动开始时间
+    int64_t last_tick_us;                   // 上一次节拍的处理时间（0表示本次运动尚无节拍）
+    uint32_t period_us;                     // 定时周期
+    volatile bool active;                   // 是否正在执行运动
+    volatile bool abort_requested;          // 是否请求中止
+    trajectory_stats_t stats;               // 统计信息
+} trajectory_generator_t;
+
+/**
+ * @brief 规划一次点到点运动（纯计算，不依赖定时器，可在主机上运行）
+ * @param plan 输出规划结果
+ * @param start 起点
+ * @param target 终点
+ * @param profile 速度曲线类型
+ * @param limits 运动约束
+ * @return 约束无效时返回false
+ */
+bool trajectory_plan_move(trajectory_plan_t* plan, float start, float target,
+                          trajectory_profile_t profile, const trajectory_limits_t* limits);
+
+/**
+ * @brief 计算规划在时刻t的位置/速度/加速度
+ * @param plan 规划结果
+ * @param t 自运动开始的时间 (s)，超出总时长时返回终点静止状态
+ * @param position 输出位置（可为NULL）
+ * @param velocity 输出速度（可为NULL）
+ * @param acceleration 输出加速度（可为NULL）
+ */
+void trajectory_sample(const trajectory_plan_t* plan, float t,
+                       float* position, float* velocity, float* acceleration);
+
+/**
+ * @brief 初始化轨迹发生器
+ * @param config 配置参数
+ * @return 轨迹发生器句柄，失败返回NULL
+ */
+trajectory_generator_t* trajectory_generator_init(const trajectory_generator_config_t* config);
+
+/**
+ * @brief 销毁轨迹发生器
+ * @param generator 轨迹发生器句柄
+ */
+void trajectory_generator_deinit(trajectory_generator_t* generator);
+
+/**
+ * @brief 开始一次运动，设定点由定时器按配置频率输出
+ * @param generator 轨迹发生器句柄
+ * @param start 起点
+ * @param target 终点
+ * @param max_velocity 本次运动速度上限（<=0时使用默认约束）
+ * @return 是否开始成功（已有运动进行中时返回false）
+ */
+bool trajectory_generator_start_move(trajectory_generator_t* generator, float start, float target,
+                                     float max_velocity);
+
+/**
+ * @brief 开始一次多轴协调运动：各轴同时开始、同时结束
+ * 按位移最大的轴规划速度曲线，其余轴按相同的归一化进度线性插补，
+ * 因此每个轴都不超过约束，且在同一个定时节拍内得到各自的设定点
+ * @param generator 轨迹发生器句柄
+ * @param axis_count 轴数 (1-TRAJECTORY_MAX_AXES)
+ * @param start 各轴起点
+ * @param target 各轴终点
+ * @param max_velocity 位移最大轴的速度上限（<=0时使用默认约束）
+ * @return 是否开始成功（已有运动进行中时返回false）
+ */
+bool trajectory_generator_start_move_multi(trajectory_generator_t* generator, uint8_t axis_count,
+                                           const float* start, const float* target, float max_velocity);
+
+/**
+ * @brief 等待当前运动结束
+ * @param generator 轨迹发生器句柄
+ * @param timeout 超时时间
+ * @return 运动在超时前结束返回true
+ */
+bool trajectory_generator_wait_done(trajectory_generator_t* generator, TickType_t timeout);
+
+/**
+ * @brief 中止当前运动（停在当前设定点）
+ * 立即唤醒流式任务处理，之后不再发送设定点；可用trajectory_generator_is_active确认已停止
+ * @param generator 轨迹发生器句柄
+ */
+void trajectory_generator_abort(trajectory_generator_t* generator);
+
+/**
+ * @brief 是否正在执行运动
+ * @param generator 轨迹发生器句柄
+ * @return 运行状态
+ */
+bool trajectory_generator_is_active(trajectory_generator_t* generator);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRAJECTORY_GENERATOR_H
@@ -0,0 +1,389 @@
+#include "uart_monitor.h"
+#include "motor_control.h"
+#include "motor_uart.h"
+#include "motor_metrics.h"
+#include "motor_task_plan.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "UART_MONITOR";
+
+/**
+ * @brief 解析一帧电机响应并写入对应电机状态
+ */
+void parse_motor_can_data(uart_port_t uart_port, const uint8_t *data, int length) {
+    // 提取CAN ID (大端序)：高位为节点ID，低5位为命令号
+    uint16_t can_id = (data[0] << 8) | data[1];
+    uint8_t node_id = MOTOR_FRAME_NODE(can_id);
+    uint8_t cmd = MOTOR_FRAME_CMD(can_id);
+    
+    motor_controller_t *controller = motor_control_find(uart_port, node_id);
+    if (!controller || length < UART_MONITOR_FRAME_SIZE) {
+        MOTOR_METRICS_INC(g_motor_metrics.uart_parse_errors);
+        ESP_LOGW(TAG, "UART%d 节点%d 无对应电机或数据长度不足，当前: %d", uart_port, node_id, length);
+        return;
+    }
+    motor_status_t *status = &controller->status;
+    MOTOR_METRICS_INC(controller->rx_frames[cmd]);
+    
+    ESP_LOGD(TAG, "UART%d 节点%d 解析电机CAN响应 - ID: 0x%04X, 数据: %02X %02X %02X %02X %02X %02X %02X %02X", 
+             uart_port, node_id, can_id, data[2], data[3], data[4], data[5], data[6], data[7], data[8], data[9]);
+    
+    // 根据CAN ID调用对应的解析函数
+    switch (cmd) {
+        case MOTOR_CMD_QUERY_TORQUE:      // 0x1C 力矩查询响应
+            parse_torque_data(&data[2], status);  // 跳过CAN ID，从第3字节开始
+            motor_derived_torque(&controller->derived, status->current_torque);
+            ESP_LOGI(TAG, "力矩数据 - 目标: %.3f Nm, 当前: %.3f Nm", 
+                     status->target_torque, status->current_torque);
+            break;
+            
+        case MOTOR_CMD_QUERY_POWER:       // 0x1D 功率查询响应  
+            parse_power_data(&data[2], status);
+            motor_derived_power(&controller->derived, status->electrical_power, status->mechanical_power,
+                                status->group_update_us[MOTOR_STATUS_GROUP_POWER]);
+            ESP_LOGI(TAG, "功率数据 - 电功率: %.3f W, 机械功率: %.3f W", 
+                     status->electrical_power, status->mechanical_power);
+            break;
+            
+        case MOTOR_CMD_QUERY_ENCODER:     // 0x0A 编码器查询响应
+            parse_encoder_data(&data[2], status);
+            motor_derived_encoder(&controller->derived, status->shadow_count,
+                                  status->group_update_us[MOTOR_STATUS_GROUP_ENCODER]);
+            ESP_LOGI(TAG, "编码器数据 - Shadow: %d, CPR内计数: %d", 
+                     status->shadow_count, status->count_in_cpr);
+            break;
+            
+        case MOTOR_CMD_QUERY_POS_SPEED:   // 0x09 位置速度查询响应
+            parse_position_speed_data(&data[2], status);
+            motor_control_latency_feedback(controller);
+            ESP_LOGI(TAG, "位置速度数据 - 位置: %.3f, 速度: %.3f", 
+                     status->position, status->velocity);
+            break;
+            
+        case MOTOR_CMD_QUERY_EXCEPTION:   // 0x03 异常查询响应
+            {
+                int current_exception_type = get_last_exception_query_type(uart_port, node_id);
+                ESP_LOGI(TAG, "收到异常响应 - 当前记录的查询类型: %d", current_exception_type);
+                parse_error_data(&data[2], current_exception_type, status);
+                if (data[2] | data[3] | data[4] | data[5]) {
+                    // 驱动器报告异常：故障停机后目标已不可信，G代码下一次运动重新读取编码器
+                    motor_control_setpoint_changed(controller);
+                }
+                ESP_LOGI(TAG, "异常数据 - 查询类型: %d, 电机错误: 0x%08X, 编码器错误: 0x%08X, 控制器错误: 0x%08X, 系统错误: 0x%08X", 
+                         current_exception_type, status->motor_error, status->encoder_error, 
+                         status->controller_error, status->system_error);
+            }
+            break;
+            
+        default:
+            MOTOR_METRICS_INC(g_motor_metrics.uart_parse_errors);
+            ESP_LOGW(TAG, "未知的CAN ID: 0x%04X (节点%d, 命令0x%02X)", can_id, node_id, cmd);
+            break;
+    }
+}
+
+
+/**
+ * @brief 帧ID是否为本端口上已注册节点的响应（用于在字节流中对齐帧边界）
+ */
+static bool uart_monitor_is_response_id(uart_port_t uart_port, uint16_t can_id) {
+    switch (MOTOR_FRAME_CMD(can_id)) {
+        case MOTOR_CMD_QUERY_EXCEPTION:
+        case MOTOR_CMD_QUERY_POS_SPEED:
+        case MOTOR_CMD_QUERY_ENCODER:
+        case MOTOR_CMD_QUERY_TORQUE:
+        case MOTOR_CMD_QUERY_POWER:
+            break;
+        default:
+            return false;
+    }
+    return can_id <= MOTOR_FRAME_ID(MOTOR_MAX_NODE_ID, 0x1F) &&
+           motor_control_find(uart_port, MOTOR_FRAME_NODE(can_id)) != NULL;
+}
+
+/**
+ * @brief 按10字节帧边界解析端口缓冲区，未成帧的尾部字节保留到下次
+ */
+static void uart_monitor_consume_frames(uart_monitor_port_t* port) {
+    int offset = 0;
+    while (offset + UART_MONITOR_FRAME_SIZE <= port->rx_length) {
+        // 检查是否是有效的CAN响应包（前2字节是ID）
+        uint16_t can_id = (port->rx_buffer[offset] << 8) | port->rx_buffer[offset + 1];
+        if (uart_monitor_is_response_id(port->uart_port, can_id)) {
+            parse_motor_can_data(port->uart_port, &port->rx_buffer[offset], UART_MONITOR_FRAME_SIZE);
+            port->frames_parsed++;
+            offset += UART_MONITOR_FRAME_SIZE;
+        } else {
+            // 如果不是有效包，跳过1字节继续寻找
+            port->bytes_discarded++;
+            offset++;
+        }
+    }
+    
+    // 处理粘包/半包：剩余不足一帧的字节移到缓冲区头部
+    port->rx_length -= offset;
+    if (offset > 0 && port->rx_length > 0) {
+        memmove(port->rx_buffer, &port->rx_buffer[offset], port->rx_length);
+    }
+}
+
+static uart_monitor_port_t* uart_monitor_find_port(uart_monitor_t* monitor, uart_port_t uart_port) {
+    for (int i = 0; i < monitor->port_count; i++) {
+        if (monitor->ports[i].uart_port == uart_port) {
+            return &monitor->ports[i];
+        }
+    }
+    return NULL;
+}
+
+bool uart_monitor_feed(uart_monitor_t* monitor, uart_port_t uart_port, const uint8_t* data, size_t length) {
+    if (!monitor || !data) {
+        return false;
+    }
+    uart_monitor_port_t* port = uart_monitor_find_port(monitor, uart_port);
+    if (!port) {
+        return false;
+    }
+
+    // 每次解析后剩余不足一帧，缓冲区始终有空间
+    while (length > 0) {
+        int space = monitor->config.buf_size - port->rx_length;
+        int chunk = (int)length < space ? (int)length : space;
+        memcpy(&port->rx_buffer[port->rx_length], data, chunk);
+        port->rx_length += chunk;
+        data += chunk;
+        length -= chunk;
+        uart_monitor_consume_frames(port);
+    }
+    return true;
+}
+
+/**
+ * @brief 读取端口驱动缓冲区中已到达的全部数据并解析（不阻塞）
+ */
+static void uart_monitor_read_port(uart_monitor_t* monitor, uart_monitor_port_t* port) {
+    size_t available = motor_uart_buffered_len(port->uart_port);
+    
+    while (available > 0) {
+        int space = monitor->config.buf_size - port->rx_length;
+        int chunk = (int)available < space ? (int)available : space;
+        int length = motor_uart_read(port->uart_port, &port->rx_buffer[port->rx_length], chunk);
+        if (length <= 0) {
+            break;
+        }
+        
+        ESP_LOG_BUFFER_HEXDUMP(monitor->config.tag, &port->rx_buffer[port->rx_length], length, ESP_LOG_DEBUG);
+        
+        port->rx_length += length;
+        available -= length;
+        uart_monitor_consume_frames(port);
+    }
+}
+
+/**
+ * @brief 共享UART监听任务：阻塞在所有端口的事件队列集合上，仅在有数据时唤醒
+ */
+static void uart_monitor_task(void *pvParameters) {
+    uart_monitor_t* monitor = (uart_monitor_t*)pvParameters;
+    
+    ESP_LOGI(monitor->config.tag, "UART监听任务已启动 - 端口数:%d", monitor->port_count);
+    
+    while (monitor->is_running) {
+        // 超时仅用于定期检查运行标志
+        QueueSetMemberHandle_t member = xQueueSelectFromSet(monitor->queue_set, pdMS_TO_TICKS(100));
+        if (!member) {
+            continue;
+        }
+        
+        uart_monitor_port_t* port = NULL;
+        for (int i = 0; i < monitor->port_count; i++) {
+            if (monitor->ports[i].event_queue == member) {
+                port = &monitor->ports[i];
+                break;
+            }
+        }
+        
+        uart_event_t event;
+        if (!port || xQueueReceive((QueueHandle_t)member, &event, 0) != pdTRUE) {
+            continue;
+        }
+        
+        switch (event.type) {
+            case UART_DATA:
+                uart_monitor_read_port(monitor, port);
+                break;
+                
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // 溢出后缓冲区内容已不连续，清空后重新对齐帧
+                ESP_LOGW(monitor->config.tag, "UART%d 接收溢出，清空缓冲区", port->uart_port);
+                motor_uart_flush_input(port->uart_port);
+                port->rx_length = 0;
+                port->overflow_count++;
+                break;
+                
+            default:
+                break;
+        }
+    }
+    
+    ESP_LOGI(monitor->config.tag, "UART监听任务已停止");
+    monitor->task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+uart_monitor_t* uart_monitor_init(const uart_monitor_config_t* config) {
+    if (!config || config->buf_size < UART_MONITOR_FRAME_SIZE * 2) {
+        ESP_LOGE(TAG, "配置参数无效");
+        return NULL;
+    }
+    
+    if (config->init_uart) {
+        // 如果需要初始化UART（独立使用场景）
+        ESP_LOGE(TAG, "当前版本不支持独立初始化UART，请设置init_uart为false");
+        return NULL;
+    }
+    
+    uart_monitor_t* monitor = calloc(1, sizeof(uart_monitor_t));
+    if (!monitor) {
+        ESP_LOGE(TAG, "内存分配失败");
+        return NULL;
+    }
+    
+    // 复制配置
+    memcpy(&monitor->config, config, sizeof(uart_monitor_config_t));
+    monitor->is_running = false;
+    
+    // 队列集合容量须不小于所有成员队列长度之和
+    monitor->queue_set = xQueueCreateSet(UART_MONITOR_MAX_PORTS * MOTOR_UART_EVENT_QUEUE_SIZE);
+    if (!monitor->queue_set) {
+        ESP_LOGE(TAG, "创建队列集合失败");
+        free(monitor);
+        return NULL;
+    }
+    
+    ESP_LOGI(TAG, "UART监听器初始化成功");
+    return monitor;
+}
+
+bool uart_monitor_add_port(uart_monitor_t* monitor, uart_port_t uart_port, QueueHandle_t event_queue) {
+    if (!monitor || !event_queue) {
+        ESP_LOGE(TAG, "监听器句柄或事件队列为空");
+        return false;
+    }
+    
+    if (monitor->is_running) {
+        ESP_LOGE(TAG, "监听器运行中，无法添加端口");
+        return false;
+    }
+    
+    if (monitor->port_count >= UART_MONITOR_MAX_PORTS) {
+        ESP_LOGE(TAG, "监听端口数已达上限 %d", UART_MONITOR_MAX_PORTS);
+        return false;
+    }
+    
+    uart_monitor_port_t* port = &monitor->ports[monitor->port_count];
+    port->rx_buffer = malloc(monitor->config.buf_size);
+    if (!port->rx_buffer) {
+        ESP_LOGE(TAG, "内存分配失败");
+        return false;
+    }
+    
+    // 加入队列集合前队列必须为空，启动前收到的数据一并丢弃
+    motor_uart_flush_input(uart_port);
+    xQueueReset(event_queue);
+    if (xQueueAddToSet(event_queue, monitor->queue_set) != pdPASS) {
+        ESP_LOGE(TAG, "UART%d 事件队列加入队列集合失败", uart_port);
+        free(port->rx_buffer);
+        port->rx_buffer = NULL;
+        return false;
+    }
+    
+    port->uart_port = uart_port;
+    port->event_queue = event_queue;
+    port->rx_length = 0;
+    port->frames_parsed = 0;
+    port->bytes_discarded = 0;
+    port->overflow_count = 0;
+    monitor->port_count++;
+    
+    ESP_LOGI(TAG, "UART监听器添加端口:%d", uart_port);
+    return true;
+}
+
+bool uart_monitor_start(uart_monitor_t* monitor) {
+    if (!monitor) {
+        ESP_LOGE(TAG, "监听器句柄为空");
+        return false;
+    }
+    
+    if (monitor->is_running) {
+        ESP_LOGW(TAG, "UART监听器已经在运行");
+        return true;
+    }
+    
+    if (monitor->port_count == 0) {
+        ESP_LOGE(TAG, "未注册任何监听端口");
+        return false;
+    }
+    
+    monitor->is_running = true;
+    
+    // 创建共享UART监听任务（所有端口共用一个任务）
+    BaseType_t ret = motor_task_create(uart_monitor_task, "uart_monitor", 4096,
+                                       monitor, MOTOR_TASK_PRIORITY_UART, &monitor->task_handle);
+    
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "创建UART监听任务失败");
+        monitor->is_running = false;
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "UART监听器启动成功");
+    return true;
+}
+
+void uart_monitor_stop(uart_monitor_t* monitor) {
+    if (!monitor || !monitor->is_running) {
+        return;
+    }
+    
+    monitor->is_running = false;
+    
+    // 等待任务结束
+    while (monitor->task_handle) {
+        vTaskDelay(pdMS_TO_TICKS(20)); // 任务最多在一个选择超时周期内退出
+    }
+    
+    ESP_LOGI(TAG, "UART监听器已停止");
+}
+
+void uart_monitor_deinit(uart_monitor_t* monitor) {
+    if (!monitor) {
+        return;
+    }
+    
+    // 停止监听
+    uart_monitor_stop(monitor);
+    
+    // 注意：不删除UART驱动，因为可能还有其他模块在使用
+    for (int i = 0; i < monitor->port_count; i++) {
+        xQueueRemoveFromSet(monitor->ports[i].event_queue, monitor->queue_set);
+        free(monitor->ports[i].rx_buffer);
+    }
+    vQueueDelete(monitor->queue_set);
+    free(monitor);
+    
+    ESP_LOGI(TAG, "UART监听器已销毁");
+}
+
+bool uart_monitor_is_running(uart_monitor_t* monitor) {
+    if (!monitor) {
+        return false;
+    }
+    return monitor->is_running;
+}
\ No newline at end of file
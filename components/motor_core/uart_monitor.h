@@ -0,0 +1,113 @@
+#ifndef UART_MONITOR_H
+#define UART_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_MONITOR_MAX_PORTS  3     // 单个监听任务最多服务的UART端口数
+#define UART_MONITOR_FRAME_SIZE 10    // 电机响应帧长度（2字节CAN ID + 8字节数据）
+
+// UART监听器配置结构
+typedef struct {
+    int buf_size;                   // 每个端口的接收缓冲区大小
+    char* tag;                      // 日志标签
+    bool init_uart;                 // 是否需要初始化UART（false表示复用已有的）
+} uart_monitor_config_t;
+
+// 单个被监听端口的状态
+typedef struct {
+    uart_port_t uart_port;          // UART端口号
+    QueueHandle_t event_queue;      // UART驱动事件队列
+    uint8_t* rx_buffer;             // 接收缓冲区（保留跨事件的不完整帧）
+    int rx_length;                  // 缓冲区中未解析的字节数
+    uint32_t frames_parsed;         // 已解析的响应帧数
+    uint32_t bytes_discarded;       // 因无法对齐帧而丢弃的字节数
+    uint32_t overflow_count;        // FIFO/环形缓冲区溢出次数
+} uart_monitor_port_t;
+
+// UART监听器句柄（一个任务通过队列集合服务所有端口）
+typedef struct {
+    uart_monitor_config_t config;   // 配置信息
+    bool is_running;                // 运行状态
+    TaskHandle_t task_handle;       // 共享监听任务句柄
+    QueueSetHandle_t queue_set;     // 所有端口事件队列组成的队列集合
+    uart_monitor_port_t ports[UART_MONITOR_MAX_PORTS];
+    uint8_t port_count;             // 已注册端口数
+} uart_monitor_t;
+
+/**
+ * @brief 初始化UART监听器
+ * @param config 配置参数
+ * @return UART监听器句柄，失败返回NULL
+ */
+uart_monitor_t* uart_monitor_init(const uart_monitor_config_t* config);
+
+/**
+ * @brief 注册一个需要监听的UART端口（需在启动前调用）
+ * @param monitor UART监听器句柄
+ * @param uart_port UART端口号（驱动须已由电机控制模块安装）
+ * @param event_queue 该端口的UART驱动事件队列
+ * @return 是否注册成功
+ */
+bool uart_monitor_add_port(uart_monitor_t* monitor, uart_port_t uart_port, QueueHandle_t event_queue);
+
+/**
+ * @brief 启动UART数据监听任务
+ * @param monitor UART监听器句柄
+ * @return 是否启动成功
+ */
+bool uart_monitor_start(uart_monitor_t* monitor);
+
+/**
+ * @brief 停止UART数据监听任务
+ * @param monitor UART监听器句柄
+ */
+void uart_monitor_stop(uart_monitor_t* monitor);
+
+/**
+ * @brief 销毁UART监听器
+ * @param monitor UART监听器句柄
+ */
+void uart_monitor_deinit(uart_monitor_t* monitor);
+
+/**
+ * @brief 获取UART监听器运行状态
+ * @param monitor UART监听器句柄
+ * @return 运行状态
+ */
+bool uart_monitor_is_running(uart_monitor_t* monitor);
+
+/**
+ * @brief 把一段接收字节送入端口的帧对齐与解析路径（与监听任务读到的数据处理方式相同）
+ * 用于抓包回放等离线场景，调用时监听任务不应在运行
+ * @param monitor UART监听器句柄
+ * @param uart_port 已注册的UART端口号
+ * @param data 接收字节
+ * @param length 字节数
+ * @return 端口未注册返回false
+ */
+bool uart_monitor_feed(uart_monitor_t* monitor, uart_port_t uart_port, const uint8_t* data, size_t length);
+
+/**
+ * @brief 解析一帧电机响应（2字节CAN ID + 8字节数据）并写入对应电机状态
+ * 监听任务对齐帧边界后调用；也供主机基准等离线路径直接喂帧
+ * @param uart_port 帧所在的UART端口
+ * @param data 帧数据
+ * @param length 帧长度（不足UART_MONITOR_FRAME_SIZE时丢弃）
+ */
+void parse_motor_can_data(uart_port_t uart_port, const uint8_t *data, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_MONITOR_H
\ No newline at end of file
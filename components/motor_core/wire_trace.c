@@ -0,0 +1,377 @@
+#include "wire_trace.h"
+#include "can_isotp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "WIRE_TRACE";
+
+#define TRACE_MAX_RECORD    (1 + 10 + 5 + WIRE_TRACE_MAX_CHUNK)   // 标记 + 64位varint + 32位varint + 数据
+
+// 抓包环形缓冲区：变长记录首尾相接，写满时从最旧记录开始覆盖
+typedef struct {
+    SemaphoreHandle_t lock;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t tail;                    // 最旧记录起点
+    size_t used;                    // 已用字节数
+    int64_t base_time_us;           // 最旧记录之前的时间基准
+    int64_t last_time_us;           // 最新记录的时间
+    uint32_t record_count;
+    uint32_t dropped_records;
+    volatile bool enabled;
+} wire_trace_t;
+
+static wire_trace_t g_trace;
+
+// ====================================================================================
+// --- varint与环形缓冲区读写 ---
+// ====================================================================================
+
+static size_t trace_put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint8_t trace_ring_byte(size_t index) {
+    return g_trace.buffer[index % g_trace.capacity];
+}
+
+static uint64_t trace_ring_varint(size_t* index) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = trace_ring_byte((*index)++);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief 丢弃最旧的一条记录，时间基准前移到该记录
+ */
+static void trace_drop_oldest(void) {
+    size_t index = g_trace.tail;
+    uint8_t length = trace_ring_byte(index++) & 0x0F;
+    g_trace.base_time_us += (int64_t)trace_ring_varint(&index);
+    trace_ring_varint(&index);
+    index += length;
+
+    size_t record_size = index - g_trace.tail;
+    g_trace.tail = index % g_trace.capacity;
+    g_trace.used -= record_size;
+    g_trace.record_count--;
+    g_trace.dropped_records++;
+}
+
+static void trace_write(const uint8_t* data, size_t length) {
+    size_t head = (g_trace.tail + g_trace.used) % g_trace.capacity;
+    size_t first = g_trace.capacity - head < length ? g_trace.capacity - head : length;
+    memcpy(&g_trace.buffer[head], data, first);
+    memcpy(g_trace.buffer, data + first, length - first);
+    g_trace.used += length;
+}
+
+// ====================================================================================
+// --- 记录 ---
+// ====================================================================================
+
+bool wire_trace_init(size_t capacity) {
+    if (g_trace.buffer) {
+        return true;
+    }
+    if (capacity < TRACE_MAX_RECORD * 4) {
+        ESP_LOGE(TAG, "抓包缓冲区过小: %u字节", (unsigned)capacity);
+        return false;
+    }
+
+    g_trace.lock = xSemaphoreCreateMutex();
+    g_trace.buffer = malloc(capacity);
+    if (!g_trace.lock || !g_trace.buffer) {
+        ESP_LOGE(TAG, "抓包缓冲区分配失败");
+        if (g_trace.lock) vSemaphoreDelete(g_trace.lock);
+        free(g_trace.buffer);
+        memset(&g_trace, 0, sizeof(g_trace));
+        return false;
+    }
+
+    g_trace.capacity = capacity;
+    wire_trace_clear();
+    g_trace.enabled = true;
+    ESP_LOGI(TAG, "线路抓包已启动 - 缓冲区 %u 字节", (unsigned)capacity);
+    return true;
+}
+
+void wire_trace_record(wire_trace_source_t source, uint32_t channel, const uint8_t* data, size_t length) {
+    if (!g_trace.enabled || !data) {
+        return;
+    }
+
+    uint8_t record[TRACE_MAX_RECORD];
+    xSemaphoreTake(g_trace.lock, portMAX_DELAY);
+    // 时间戳在锁内获取，保证记录顺序与时间单调一致
+    int64_t now_us = esp_timer_get_time();
+    do {
+        size_t chunk = length < WIRE_TRACE_MAX_CHUNK ? length : WIRE_TRACE_MAX_CHUNK;
+        size_t n = 0;
+        record[n++] = (uint8_t)((source << 4) | chunk);
+        n += trace_put_varint(&record[n], (uint64_t)(now_us - g_trace.last_time_us));
+        n += trace_put_varint(&record[n], channel);
+        memcpy(&record[n], data, chunk);
+        n += chunk;
+
+        while (g_trace.capacity - g_trace.used < n) {
+            trace_drop_oldest();
+        }
+        trace_write(record, n);
+        g_trace.last_time_us = now_us;
+        g_trace.record_count++;
+
+        data += chunk;
+        length -= chunk;
+    } while (length > 0);
+    xSemaphoreGive(g_trace.lock);
+}
+
+void wire_trace_set_enabled(bool enabled) {
+    if (g_trace.buffer) {
+        g_trace.enabled = enabled;
+    }
+}
+
+void wire_trace_clear(void) {
+    if (!g_trace.buffer) {
+        return;
+    }
+    xSemaphoreTake(g_trace.lock, portMAX_DELAY);
+    g_trace.tail = 0;
+    g_trace.used = 0;
+    g_trace.record_count = 0;
+    g_trace.dropped_records = 0;
+    g_trace.base_time_us = esp_timer_get_time();
+    g_trace.last_time_us = g_trace.base_time_us;
+    xSemaphoreGive(g_trace.lock);
+}
+
+void wire_trace_get_stats(wire_trace_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!g_trace.buffer) {
+        return;
+    }
+    xSemaphoreTake(g_trace.lock, portMAX_DELAY);
+    stats->enabled = g_trace.enabled;
+    stats->capacity = g_trace.capacity;
+    stats->used_bytes = g_trace.used;
+    stats->record_count = g_trace.record_count;
+    stats->dropped_records = g_trace.dropped_records;
+    xSemaphoreGive(g_trace.lock);
+}
+
+uint8_t* wire_trace_export(size_t* length) {
+    if (!g_trace.buffer || !length) {
+        return NULL;
+    }
+
+    xSemaphoreTake(g_trace.lock, portMAX_DELAY);
+    size_t total = sizeof(wire_trace_header_t) + g_trace.used;
+    uint8_t* capture = malloc(total);
+    if (capture) {
+        wire_trace_header_t header = {
+            .version = WIRE_TRACE_FORMAT_VERSION,
+            .base_time_us = g_trace.base_time_us,
+            .record_count = g_trace.record_count,
+            .dropped_records = g_trace.dropped_records,
+            .data_length = (uint32_t)g_trace.used
+        };
+        memcpy(header.magic, WIRE_TRACE_MAGIC, sizeof(header.magic));
+        memcpy(capture, &header, sizeof(header));
+
+        // 从最旧记录开始按顺序拷出（可能跨越缓冲区末尾）
+        uint8_t* out = capture + sizeof(header);
+        size_t first = g_trace.capacity - g_trace.tail < g_trace.used ? g_trace.capacity - g_trace.tail : g_trace.used;
+        memcpy(out, &g_trace.buffer[g_trace.tail], first);
+        memcpy(out + first, g_trace.buffer, g_trace.used - first);
+        *length = total;
+    }
+    xSemaphoreGive(g_trace.lock);
+
+    if (!capture) {
+        ESP_LOGE(TAG, "导出缓冲区分配失败 (%u字节)", (unsigned)total);
+    }
+    return capture;
+}
+
+// ====================================================================================
+// --- 解码 ---
+// ====================================================================================
+
+static bool trace_read_varint(wire_trace_reader_t* reader, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && reader->offset < reader->length; shift += 7) {
+        uint8_t byte = reader->data[reader->offset++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool wire_trace_reader_init(wire_trace_reader_t* reader, const uint8_t* capture, size_t length) {
+    wire_trace_header_t header;
+    if (!reader || !capture || length < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, capture, sizeof(header));
+    if (memcmp(header.magic, WIRE_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != WIRE_TRACE_FORMAT_VERSION ||
+        header.data_length > length - sizeof(header)) {
+        return false;
+    }
+
+    reader->data = capture + sizeof(header);
+    reader->length = header.data_length;
+    reader->offset = 0;
+    reader->time_us = header.base_time_us;
+    return true;
+}
+
+bool wire_trace_reader_next(wire_trace_reader_t* reader, wire_trace_event_t* event) {
+    if (!reader || !event || reader->offset >= reader->length) {
+        return false;
+    }
+
+    uint8_t tag = reader->data[reader->offset++];
+    uint64_t delta_us, channel;
+    if (!trace_read_varint(reader, &delta_us) || !trace_read_varint(reader, &channel)) {
+        return false;
+    }
+
+    uint8_t length = tag & 0x0F;
+    if ((tag >> 4) > WIRE_TRACE_CAN_RX || reader->length - reader->offset < length) {
+        return false;
+    }
+
+    reader->time_us += (int64_t)delta_us;
+    event->source = (wire_trace_source_t)(tag >> 4);
+    event->channel = (uint32_t)channel;
+    event->time_us = reader->time_us;
+    event->data = &reader->data[reader->offset];
+    event->length = length;
+    reader->offset += length;
+    return true;
+}
+
+// ====================================================================================
+// --- 回放 ---
+// ====================================================================================
+
+static void trace_replay_can(const wire_trace_replay_config_t* config, can_isotp_rx_t* isotp,
+                             const wire_trace_event_t* event, wire_trace_replay_stats_t* stats) {
+    if (!config->gcode_controller || (event->channel & 1)) {
+        return;     // 无G代码控制器或扩展帧
+    }
+
+    uint32_t identifier = event->channel >> 1;
+    if (identifier == WIRE_TRACE_GCODE_CAN_ID) {
+        // 与can_monitor相同：补上00 01两字节ID后按单帧G代码片段处理
+        uint8_t frame[2 + 8] = {0x00, 0x01};
+        uint8_t size = event->length < 8 ? event->length : 8;
+        memcpy(&frame[2], event->data, size);
+        if (gcode_process_can_frame(config->gcode_controller, frame, 2 + size) != GCODE_RESULT_OK) {
+            stats->gcode_errors++;
+        }
+    } else if (identifier == config->isotp_rx_id) {
+        // 与can_monitor共用ISO-TP接收状态机，按录制时间判断N_Cr超时，回放时不发送流控帧
+        static const can_isotp_config_t replay_config = {0};
+        if (!can_isotp_receive(isotp, &replay_config, event->data, event->length, event->time_us)) {
+            return;
+        }
+        stats->isotp_messages++;
+        if (gcode_process_program(config->gcode_controller, (char*)isotp->buffer,
+                                  isotp->received_length) != GCODE_RESULT_OK) {
+            stats->gcode_errors++;
+        }
+    }
+}
+
+bool wire_trace_replay(const uint8_t* capture, size_t length, const wire_trace_replay_config_t* config,
+                       wire_trace_replay_stats_t* stats) {
+    wire_trace_reader_t reader;
+    if (!config || !config->monitor || !wire_trace_reader_init(&reader, capture, length)) {
+        ESP_LOGE(TAG, "回放参数无效或抓包格式不符");
+        return false;
+    }
+
+    wire_trace_replay_stats_t local_stats;
+    if (!stats) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    can_isotp_rx_t* isotp = calloc(1, sizeof(can_isotp_rx_t));
+    if (!isotp) {
+        ESP_LOGE(TAG, "ISO-TP重组缓冲区分配失败");
+        return false;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int64_t first_us = 0;
+    int64_t last_us = 0;
+    wire_trace_event_t event;
+
+    while (wire_trace_reader_next(&reader, &event)) {
+        if (stats->records == 0) {
+            first_us = event.time_us;
+        }
+        last_us = event.time_us;
+
+        if (config->realtime) {
+            // 按录制间隔等待（节拍分辨率），落后时不等待直接追赶
+            int64_t wait_us = (event.time_us - first_us) - (esp_timer_get_time() - start_us);
+            if (wait_us >= 1000) {
+                vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+            }
+        }
+
+        switch (event.source) {
+            case WIRE_TRACE_UART_TX:
+                stats->uart_tx_bytes += event.length;
+                break;
+            case WIRE_TRACE_UART_RX:
+                if (uart_monitor_feed(config->monitor, (uart_port_t)event.channel, event.data, event.length)) {
+                    stats->uart_rx_bytes += event.length;
+                }
+                break;
+            case WIRE_TRACE_CAN_RX:
+                stats->can_frames++;
+                trace_replay_can(config, isotp, &event, stats);
+                break;
+        }
+        stats->records++;
+    }
+
+    free(isotp);
+    stats->recorded_span_us = last_us - first_us;
+    stats->elapsed_us = esp_timer_get_time() - start_us;
+
+    if (reader.offset < reader.length) {
+        ESP_LOGW(TAG, "抓包在偏移%u处损坏，已回放%lu条记录", (unsigned)reader.offset, (unsigned long)stats->records);
+    }
+    return true;
+}
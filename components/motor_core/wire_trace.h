@@ -0,0 +1,164 @@
+#ifndef WIRE_TRACE_H
+#define WIRE_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "uart_monitor.h"
+#include "gcode_unified_control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 线路抓包：电机UART收发字节与CAN接收帧按微秒时间戳写入内存环形缓冲区（满时覆盖最旧记录）
+//
+// 导出格式（小端）：wire_trace_header_t + 按时间顺序排列的变长记录
+//   [标记: 来源<<4 | 数据长度(0-15)] [距上一条记录的微秒数: varint] [通道: varint] [数据]
+//   通道：UART记录为端口号；CAN记录为 (标识符 << 1) | 扩展帧标志
+// 第一条记录的时间 = base_time_us + 其时间差，之后逐条累加
+
+#define WIRE_TRACE_MAGIC            "WTRC"
+#define WIRE_TRACE_FORMAT_VERSION   1
+#define WIRE_TRACE_MAX_CHUNK        15      // 单条记录最多数据字节，更长的UART数据拆成多条
+#define WIRE_TRACE_GCODE_CAN_ID     0x001   // 单帧ASCII G代码片段的CAN ID（回放时送入gcode_process_can_frame）
+
+// 记录来源
+typedef enum {
+    WIRE_TRACE_UART_TX = 0,             // 发往驱动器的字节
+    WIRE_TRACE_UART_RX = 1,             // 从驱动器读到的字节（按读取块记录，不保证帧对齐）
+    WIRE_TRACE_CAN_RX = 2,              // 收到的CAN帧
+} wire_trace_source_t;
+
+// 导出文件头
+typedef struct __attribute__((packed)) {
+    char magic[4];                      // WIRE_TRACE_MAGIC
+    uint8_t version;                    // WIRE_TRACE_FORMAT_VERSION
+    uint8_t reserved[3];
+    int64_t base_time_us;               // 时间基准（esp_timer微秒）
+    uint32_t record_count;              // 记录条数
+    uint32_t dropped_records;           // 因缓冲区满被覆盖的记录数
+    uint32_t data_length;               // 文件头之后的记录字节数
+} wire_trace_header_t;
+
+// 抓包状态
+typedef struct {
+    bool enabled;                       // 是否正在记录
+    size_t capacity;                    // 环形缓冲区字节数
+    size_t used_bytes;                  // 已用字节数
+    uint32_t record_count;              // 缓冲区中的记录条数
+    uint32_t dropped_records;           // 被覆盖的记录数
+} wire_trace_stats_t;
+
+// 解码后的一条记录
+typedef struct {
+    wire_trace_source_t source;
+    uint32_t channel;                   // UART端口号 / CAN (标识符 << 1) | 扩展帧标志
+    int64_t time_us;                    // 绝对时间戳（esp_timer微秒）
+    const uint8_t* data;                // 指向导出缓冲区内的数据
+    uint8_t length;
+} wire_trace_event_t;
+
+// 导出数据的顺序读取器
+typedef struct {
+    const uint8_t* data;                // 记录区起点
+    size_t length;                      // 记录区长度
+    size_t offset;                      // 下一条记录的偏移
+    int64_t time_us;                    // 上一条记录的绝对时间
+} wire_trace_reader_t;
+
+// 回放配置
+typedef struct {
+    uart_monitor_t* monitor;            // UART接收记录送入该监听器（端口须已注册，监听任务不要启动）
+    gcode_controller_t* gcode_controller; // CAN接收记录送入G代码控制器（可为NULL）
+    uint32_t isotp_rx_id;               // ISO-TP G代码程序的CAN ID
+    bool realtime;                      // true按录制的时间间隔回放，false尽快回放
+} wire_trace_replay_config_t;
+
+// 回放统计
+typedef struct {
+    uint32_t records;                   // 回放的记录总数
+    uint32_t uart_tx_bytes;             // 录制的发送字节数（回放时不重发，作为对照）
+    uint32_t uart_rx_bytes;             // 送入监听器的接收字节数
+    uint32_t can_frames;                // CAN帧数
+    uint32_t gcode_errors;              // G代码处理返回错误的次数
+    uint32_t isotp_messages;            // 重组完成的ISO-TP程序数
+    int64_t recorded_span_us;           // 录制的时间跨度
+    int64_t elapsed_us;                 // 回放实际耗时
+} wire_trace_replay_stats_t;
+
+#if CONFIG_WIRE_TRACE
+#define WIRE_TRACE_RECORD(source, channel, data, length) wire_trace_record((source), (channel), (data), (length))
+#else
+#define WIRE_TRACE_RECORD(source, channel, data, length) ((void)0)
+#endif
+
+/**
+ * @brief 分配抓包缓冲区并开始记录
+ * @param capacity 环形缓冲区字节数
+ * @return 是否成功
+ */
+bool wire_trace_init(size_t capacity);
+
+/**
+ * @brief 记录一段收发数据（未初始化或已停止时直接返回）
+ * @param source 来源
+ * @param channel UART端口号 / CAN (标识符 << 1) | 扩展帧标志
+ * @param data 数据
+ * @param length 数据长度（超过WIRE_TRACE_MAX_CHUNK时拆成多条）
+ */
+void wire_trace_record(wire_trace_source_t source, uint32_t channel, const uint8_t* data, size_t length);
+
+/**
+ * @brief 开始/暂停记录（暂停后缓冲区内容保留，便于下载现场）
+ */
+void wire_trace_set_enabled(bool enabled);
+
+/**
+ * @brief 清空缓冲区
+ */
+void wire_trace_clear(void);
+
+/**
+ * @brief 获取抓包状态
+ */
+void wire_trace_get_stats(wire_trace_stats_t* stats);
+
+/**
+ * @brief 导出当前缓冲区（文件头 + 记录）
+ * @param length 输出导出数据长度
+ * @return malloc分配的导出数据，调用者负责free；未初始化或内存不足返回NULL
+ */
+uint8_t* wire_trace_export(size_t* length);
+
+/**
+ * @brief 校验导出数据的文件头并初始化读取器
+ * @return 格式不符返回false
+ */
+bool wire_trace_reader_init(wire_trace_reader_t* reader, const uint8_t* capture, size_t length);
+
+/**
+ * @brief 读取下一条记录
+ * @return 没有更多记录或记录损坏返回false
+ */
+bool wire_trace_reader_next(wire_trace_reader_t* reader, wire_trace_event_t* event);
+
+/**
+ * @brief 把抓包数据送回UART监听器与G代码控制器重现现场
+ * UART接收字节走监听器的帧对齐与解析路径；CAN帧按ID送入gcode_process_can_frame，
+ * ISO-TP程序重组后送入gcode_process_program；发送记录不重发，只计数供对照
+ * @param capture 导出数据
+ * @param length 导出数据长度
+ * @param config 回放配置
+ * @param stats 输出回放统计（可为NULL）
+ * @return 格式无效或配置为空返回false
+ */
+bool wire_trace_replay(const uint8_t* capture, size_t length, const wire_trace_replay_config_t* config,
+                       wire_trace_replay_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIRE_TRACE_H
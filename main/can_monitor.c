@@ -1,7 +1,11 @@
 #include "can_monitor.h"
+#include "wire_trace.h"
+#include "motor_metrics.h"
+#include "motor_task_plan.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -10,6 +14,75 @@ static const char *TAG = "CAN_MONITOR";
 // CAN监听任务句柄
 static TaskHandle_t can_monitor_task_handle = NULL;
 
+/**
+ * @brief 经TWAI发送ISO-TP流控帧（can_isotp回调）
+ */
+static void isotp_send_flow_control(const uint8_t* data, void* context) {
+    can_monitor_t* monitor = (can_monitor_t*)context;
+    twai_message_t fc_msg = {0};
+    fc_msg.identifier = monitor->config.isotp_tx_id;
+    fc_msg.data_length_code = CAN_ISOTP_FRAME_SIZE;
+    memcpy(fc_msg.data, data, CAN_ISOTP_FRAME_SIZE);
+
+    esp_err_t result = twai_transmit(&fc_msg, pdMS_TO_TICKS(10));
+    if (result != ESP_OK) {
+        ESP_LOGW(monitor->config.tag, "ISO-TP流控帧发送失败: %s", esp_err_to_name(result));
+    }
+}
+
+/**
+ * @brief 本监听器的ISO-TP接收参数
+ */
+static can_isotp_config_t isotp_config(can_monitor_t* monitor) {
+    return (can_isotp_config_t){
+        .block_size = monitor->config.isotp_block_size,
+        .st_min = monitor->config.isotp_st_min,
+        .send_flow_control = isotp_send_flow_control,
+        .context = monitor,
+    };
+}
+
+bool can_monitor_isotp_receive(can_monitor_t* monitor, const twai_message_t* msg) {
+    if (!monitor || !msg || msg->rtr || msg->data_length_code == 0) {
+        return false;
+    }
+
+    const can_isotp_config_t config = isotp_config(monitor);
+    return can_isotp_receive(&monitor->isotp, &config, msg->data, msg->data_length_code,
+                             esp_timer_get_time());
+}
+
+/**
+ * @brief 提交ISO-TP缓冲区中的G代码程序（从上次停下的行继续）
+ * 运动队列满时不等待：保持ISO-TP占用（新消息的首帧收到FC WAIT），由监听任务每CAN_MONITOR_FEED_MS重试；
+ * 提交完毕后解除占用，占用期间暂存的消息随即开始接收
+ */
+static void can_monitor_feed_program(can_monitor_t* monitor) {
+    char response[CAN_MONITOR_RESPONSE_LEN];
+    const can_isotp_config_t config = isotp_config(monitor);
+    bool complete = true;
+    while (complete) {
+        size_t consumed = 0;
+        gcode_result_t gcode_result = gcode_submit_program(
+            monitor->config.gcode_controller,
+            (char*)monitor->isotp.buffer + monitor->program_offset,
+            monitor->isotp.received_length - monitor->program_offset,
+            &consumed
+        );
+        monitor->program_offset += consumed;
+        if (gcode_result == GCODE_RESULT_BUFFER_FULL) {
+            can_isotp_hold(&monitor->isotp);
+            return;
+        }
+        ESP_LOGI(monitor->config.tag, "G代码程序提交结果: %d - %s", gcode_result,
+                 gcode_get_response(monitor->config.gcode_controller, response, sizeof(response)));
+
+        // 占用期间暂存的单帧在解除占用时即构成完整消息
+        monitor->program_offset = 0;
+        complete = can_isotp_release(&monitor->isotp, &config, esp_timer_get_time());
+    }
+}
+
 /**
  * @brief CAN数据接收和处理任务
  */
@@ -20,73 +93,69 @@ static void can_monitor_task(void *pvParameters) {
              monitor->config.tx_gpio, monitor->config.rx_gpio);
     
     uint32_t msg_count = 0;
+    char response[CAN_MONITOR_RESPONSE_LEN];
     
     while (monitor->is_running) {
+        if (monitor->isotp.held) {
+            // 上一段程序因运动队列满尚未提交完：继续提交，接收端仍忙时按间隔重发FC WAIT
+            can_monitor_feed_program(monitor);
+            const can_isotp_config_t config = isotp_config(monitor);
+            can_isotp_poll(&monitor->isotp, &config, esp_timer_get_time());
+        }
+
         twai_message_t rx_msg;
-        esp_err_t result = twai_receive(&rx_msg, 100 / portTICK_PERIOD_MS);
+        esp_err_t result = twai_receive(&rx_msg, pdMS_TO_TICKS(monitor->isotp.held ? CAN_MONITOR_FEED_MS
+                                                                                   : CAN_MONITOR_RECEIVE_MS));
         
         if (result == ESP_OK) {
             msg_count++;
+            WIRE_TRACE_RECORD(WIRE_TRACE_CAN_RX, (rx_msg.identifier << 1) | (rx_msg.extd ? 1 : 0),
+                              rx_msg.data, rx_msg.data_length_code);
+            MOTOR_METRICS_INC(g_motor_metrics.can_rx_frames[
+                rx_msg.identifier == monitor->config.isotp_rx_id ? MOTOR_METRICS_CAN_ISOTP :
+                rx_msg.identifier == 0x001 ? MOTOR_METRICS_CAN_GCODE : MOTOR_METRICS_CAN_OTHER]);
             
-            // 获取当前时间戳
-            uint32_t timestamp = esp_log_timestamp();
+            ESP_LOGD(monitor->config.tag, "消息#%lu: ID=0x%03lX, DLC=%d, 格式=%s%s", 
+                     msg_count, rx_msg.identifier, rx_msg.data_length_code,
+                     rx_msg.extd ? "扩展帧" : "标准帧", rx_msg.rtr ? ", 远程帧" : "");
             
-            ESP_LOGI(monitor->config.tag, "[%lu ms] 消息#%lu: ID=0x%03lX, DLC=%d", 
-                     timestamp, msg_count, rx_msg.identifier, rx_msg.data_length_code);
-            
-            // 显示消息类型和数据
-            if (rx_msg.rtr) {
-                ESP_LOGI(monitor->config.tag, "类型=远程帧");
-            } else {
-                // 显示数据帧内容
-                char hex_str[64];
-                hex_str[0] = '\0';
-                for (int i = 0; i < rx_msg.data_length_code; i++) {
-                    char hex_byte[4];
-                    snprintf(hex_byte, sizeof(hex_byte), "%02X ", rx_msg.data[i]);
-                    strcat(hex_str, hex_byte);
+            if (rx_msg.rtr || !monitor->config.gcode_controller) {
+                continue;
+            }
+
+            if (rx_msg.identifier == monitor->config.isotp_rx_id) {
+                // ISO-TP传输的G代码程序：完整重组后逐行提交，本任务不等待运动队列空位
+                if (can_monitor_isotp_receive(monitor, &rx_msg)) {
+                    ESP_LOGI(monitor->config.tag, "ISO-TP消息接收完成 (%u字节)，开始提交G代码程序",
+                             monitor->isotp.received_length);
+                    monitor->program_offset = 0;
+                    can_monitor_feed_program(monitor);
                 }
-                ESP_LOGI(monitor->config.tag, "类型=数据帧, 数据=[%s]", hex_str);
+            } else if (rx_msg.identifier == 0x001) {
+                // 兼容旧格式：ID 0x001 直接携带ASCII G代码片段
+                // 构建包含CAN ID的数据包，模拟原来UART接收的格式 (00 01 表示G代码帧)
+                uint8_t can_frame_data[16];
+                size_t frame_length = 0;
+                can_frame_data[frame_length++] = 0x00;
+                can_frame_data[frame_length++] = 0x01;
                 
-                // 如果有G代码控制器，尝试处理G代码
-                if (monitor->config.gcode_controller) {
-                    // 构建包含CAN ID的数据包，模拟原来UART接收的格式
-                    uint8_t can_frame_data[16];
-                    size_t frame_length = 0;
-                    
-                    // 添加CAN ID (模拟原来的格式：00 01 表示G代码帧)
-                    if (rx_msg.identifier == 0x001) {
-                        can_frame_data[frame_length++] = 0x00;
-                        can_frame_data[frame_length++] = 0x01;
-                        
-                        // 添加数据载荷
-                        for (int i = 0; i < rx_msg.data_length_code && frame_length < sizeof(can_frame_data); i++) {
-                            can_frame_data[frame_length++] = rx_msg.data[i];
-                        }
-                        
-                        // 处理G代码帧
-                        ESP_LOGI(monitor->config.tag, "检测到G代码CAN帧，开始处理");
-                        gcode_result_t gcode_result = gcode_process_can_frame(
-                            monitor->config.gcode_controller, 
-                            can_frame_data, 
-                            frame_length
-                        );
-                        
-                        const char* response = gcode_get_response(monitor->config.gcode_controller);
-                        ESP_LOGI(monitor->config.tag, "G代码执行结果: %d - %s", gcode_result, response);
-                    }
+                // 添加数据载荷
+                for (int i = 0; i < rx_msg.data_length_code && frame_length < sizeof(can_frame_data); i++) {
+                    can_frame_data[frame_length++] = rx_msg.data[i];
                 }
+                
+                gcode_result_t gcode_result = gcode_process_can_frame(
+                    monitor->config.gcode_controller, 
+                    can_frame_data, 
+                    frame_length
+                );
+                
+                ESP_LOGI(monitor->config.tag, "G代码执行结果: %d - %s", gcode_result,
+                         gcode_get_response(monitor->config.gcode_controller, response, sizeof(response)));
             }
-            
-            // 显示帧格式
-            ESP_LOGI(monitor->config.tag, "格式=%s", rx_msg.extd ? "扩展帧" : "标准帧");
-            
         } else if (result != ESP_ERR_TIMEOUT) {
             ESP_LOGW(monitor->config.tag, "接收失败: %s", esp_err_to_name(result));
         }
-        
-        // 短暂延时避免CPU占用过高
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
     
     ESP_LOGI(monitor->config.tag, "CAN监听任务已停止");
@@ -109,9 +178,11 @@ can_monitor_t* can_monitor_init(const can_monitor_config_t* config) {
     // 复制配置
     memcpy(&monitor->config, config, sizeof(can_monitor_config_t));
     monitor->is_running = false;
+    can_isotp_reset(&monitor->isotp);
+    monitor->program_offset = 0;
     
-    ESP_LOGI(TAG, "CAN监听器初始化成功 - TX:%d, RX:%d", 
-             config->tx_gpio, config->rx_gpio);
+    ESP_LOGI(TAG, "CAN监听器初始化成功 - TX:%d, RX:%d, ISO-TP RX:0x%03lX/FC:0x%03lX", 
+             config->tx_gpio, config->rx_gpio, config->isotp_rx_id, config->isotp_tx_id);
     
     return monitor;
 }
@@ -133,6 +204,8 @@ bool can_monitor_start(can_monitor_t* monitor) {
         monitor->config.rx_gpio, 
         TWAI_MODE_NORMAL
     );
+    // ISO-TP连续帧可以背靠背到达（BS=0, STmin=0），加深接收队列避免丢帧
+    general_config.rx_queue_len = CAN_MONITOR_RX_QUEUE_LEN;
     
     // 安装TWAI驱动
     esp_err_t result = twai_driver_install(&general_config, 
@@ -156,8 +229,8 @@ bool can_monitor_start(can_monitor_t* monitor) {
     monitor->is_running = true;
     
     // 创建CAN监听任务
-    BaseType_t ret = xTaskCreate(can_monitor_task, "can_monitor", 4096, 
-                                monitor, 5, &can_monitor_task_handle);
+    BaseType_t ret = motor_task_create(can_monitor_task, "can_monitor", 4096,
+                                       monitor, MOTOR_TASK_PRIORITY_CAN, &can_monitor_task_handle);
     
     if (ret != pdPASS) {
         ESP_LOGE(TAG, "创建CAN监听任务失败");
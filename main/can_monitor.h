@@ -3,13 +3,21 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "driver/twai.h"
 #include "gcode_unified_control.h"
+#include "can_isotp.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define CAN_MONITOR_RX_QUEUE_LEN  32      // TWAI驱动接收队列长度（帧）
+#define CAN_MONITOR_RESPONSE_LEN  128     // 日志中打印的G代码响应长度（超长截断）
+#define CAN_MONITOR_RECEIVE_MS    100     // 无待提交程序时等待CAN帧的超时
+#define CAN_MONITOR_FEED_MS       10      // ISO-TP程序因运动队列满暂停提交时，重试提交的间隔
+
 // CAN监听器配置结构
 typedef struct {
     int tx_gpio;                        // CAN TX引脚
@@ -18,12 +26,18 @@ typedef struct {
     twai_filter_config_t filter_config; // CAN滤波配置
     char* tag;                          // 日志标签
     gcode_controller_t* gcode_controller; // G代码控制器
+    uint32_t isotp_rx_id;               // ISO-TP接收CAN ID（主机 -> ESP32）
+    uint32_t isotp_tx_id;               // ISO-TP流控帧发送CAN ID（ESP32 -> 主机）
+    uint8_t isotp_block_size;           // 流控块大小BS（0表示不分块，一次发送全部连续帧）
+    uint8_t isotp_st_min;               // 流控最小帧间隔STmin (ms, 0-127)
 } can_monitor_config_t;
 
 // CAN监听器句柄
 typedef struct {
     can_monitor_config_t config;        // 配置信息
     bool is_running;                    // 运行状态
+    can_isotp_rx_t isotp;               // ISO-TP接收状态
+    size_t program_offset;              // 运动队列满时ISO-TP程序已提交的字节数（isotp.held期间有效）
 } can_monitor_t;
 
 /**
@@ -59,6 +73,20 @@ void can_monitor_deinit(can_monitor_t* monitor);
  */
 bool can_monitor_is_running(can_monitor_t* monitor);
 
+/**
+ * @brief 获取CAN监听任务句柄（用于查询栈余量）
+ * @return 任务句柄，未运行时返回NULL
+ */
+TaskHandle_t can_monitor_get_task_handle(void);
+
+/**
+ * @brief 处理一帧ISO-TP数据（单帧/首帧/连续帧），必要时发送流控帧
+ * @param monitor CAN监听器句柄
+ * @param msg 接收到的CAN帧（标识符需等于isotp_rx_id）
+ * @return 完整消息重组完成时返回true
+ */
+bool can_monitor_isotp_receive(can_monitor_t* monitor, const twai_message_t* msg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1849 @@
+#include "host_bench.h"
+#include "sdkconfig.h"
+
+#if CONFIG_HOST_BENCHMARK
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "motor_control.h"
+#include "motor_registry.h"
+#include "motor_uart.h"
+#include "uart_monitor.h"
+#include "gcode_unified_control.h"
+#include "web_interface.h"
+#include "motor_units.h"
+#include "motor_config.h"
+#include "motor_task_plan.h"
+#include "can_isotp.h"
+#include "trajectory_generator.h"
+#include "motor_metrics.h"
+#include <math.h>
+
+// 协议编解码热点路径基准：合成流量（固定种子，可跨提交复现）+ 录制流量（模拟驱动器实际响应 / 标准输入G代码）
+// 每项重复CONFIG_HOST_BENCHMARK_REPEATS次，报告最好值与中位数；分配计数覆盖整个进程（含后台任务）
+
+static const char *TAG = "HOST_BENCH";
+
+#define BENCH_FRAME_SIZE            UART_MONITOR_FRAME_SIZE
+#define BENCH_GCODE_PAYLOAD         8       // G代码CAN帧载荷（帧 = 2字节ID + 8字节ASCII）
+#define BENCH_SYNTHETIC_FRAMES      256     // 合成响应帧池，循环取用
+#define BENCH_RECORDED_MAX_FRAMES   1024
+#define BENCH_CAPTURE_ROUNDS        32      // 从模拟驱动器录制响应的轮数
+#define BENCH_CAPTURE_WAIT_MS       20      // 每轮查询后等待响应（大于模拟响应延迟）
+#define BENCH_CAPTURE_BUFFER        1024
+#define BENCH_GCODE_MAX_FRAMES      4096
+#define BENCH_SYNTHETIC_GCODE_LINES 64
+#define BENCH_RNG_SEED              0x2545F491u
+#define BENCH_UNIT_SAMPLES          1024    // 单位换算输入角度池
+#define BENCH_UNIT_POSITION_TOL     1e-4    // 换算结果相对双精度参考的允许误差（电机位置值，约0.0002度输出轴）
+#define BENCH_UNIT_ROUNDTRIP_TOL    1e-3    // 多圈标定角度->位置->角度往返的允许误差（度）
+#define BENCH_UNWRAP_STEP           1000003 // 多圈计数展开检查的每样本步长（计数），约2^31/2147步回绕一次
+#define BENCH_UNWRAP_SAMPLES        100000  // 展开检查样本数（累计约1e11计数，远超int32范围）
+#define BENCH_ENCODER_STACK_SIZE    4096    // 编码器样本注入任务栈
+#define BENCH_PARSE_FUZZ_ITERATIONS 200000  // 解析器变异输入数（固定种子）
+#define BENCH_PARSE_LINE_MAX        96      // 变异行最大长度
+#define BENCH_ISOTP_LONG            4000    // ISO-TP长消息长度（约570个连续帧，序号回绕约36次）
+#define BENCH_ISOTP_FRAME_US        200     // 模拟总线上相邻帧的间隔
+#define BENCH_PLAN_SAMPLES          4096    // 每个规划的采样点数
+#define BENCH_METRICS_CHUNK         1024    // 与/metrics分块缓冲区相同
+#define BENCH_ABORT_QUEUE_DEPTH     8       // 中止检查的运动队列深度
+#define BENCH_ABORT_WAIT_MS         2000    // 中止检查等待执行任务的最长时间
+#define BENCH_ABORT_STOP_MS         100     // 改写设定点/M0提交到轨迹停止的允许时间（远小于单段运动时长）
+#define BENCH_BACKPRESSURE_DEPTH    2       // 背压检查的运动队列深度
+#define BENCH_UNDERRUN_WINDOW_MS    50      // 欠载检查的判定窗口
+#define BENCH_PLAN_TOL              1e-4    // 峰值与约束、终点行程与目标的相对允许误差（单精度积分）
+
+// ====================================================================================
+// --- 分配计数 ---
+// ====================================================================================
+
+// 可执行文件中的malloc/calloc/realloc优先于glibc同名符号，计数后转发给glibc实现（free无需覆盖）
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static uint64_t g_alloc_count;
+static uint64_t g_alloc_bytes;
+
+void* malloc(size_t size) {
+    __atomic_fetch_add(&g_alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc_bytes, size, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&g_alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc_bytes, count * size, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    __atomic_fetch_add(&g_alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc_bytes, size, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+// ====================================================================================
+// --- 基准数据 ---
+// ====================================================================================
+
+// 一组电机响应帧（录制或合成），按所在UART端口喂给解析函数
+typedef struct {
+    uart_port_t port[BENCH_RECORDED_MAX_FRAMES];
+    uint8_t frames[BENCH_RECORDED_MAX_FRAMES][BENCH_FRAME_SIZE];
+    uint32_t count;
+} bench_frames_t;
+
+// 一组G代码CAN帧
+typedef struct {
+    gcode_controller_t* controller;
+    uint8_t (*frames)[BENCH_FRAME_SIZE];
+    uint32_t count;
+    uint32_t errors;
+} bench_gcode_t;
+
+typedef void (*bench_fn_t)(void* context, uint32_t iterations);
+
+// 单位换算输入：常用范围与极大值（原逐次减360的归一化对后者需要数百万次循环）
+typedef struct {
+    float angles[BENCH_UNIT_SAMPLES];
+} bench_units_t;
+
+static bench_frames_t g_synthetic;
+static bench_frames_t g_recorded;
+static volatile float g_float_sink;
+static volatile size_t g_size_sink;
+static char g_gcode_response[256];
+
+static uint32_t bench_rand(uint32_t* state) {
+    // xorshift32：固定种子，保证各次运行的合成流量一致
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// 计时期间把标准输出重定向到/dev/null：被测路径中的printf日志不计入结果，也不混进JSON输出
+static int bench_quiet_begin(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull >= 0) {
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+    return saved;
+}
+
+static void bench_quiet_end(int saved) {
+    fflush(stdout);
+    if (saved >= 0) {
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+}
+
+/**
+ * @brief 运行一项基准并打印一行JSON结果
+ * @param items 数据集大小（帧数/轴数）
+ * @param bytes_per_op 每次操作处理的字节数（用于计算吞吐量）
+ */
+static void bench_report(const char* name, const char* traffic, bench_fn_t fn, void* context,
+                         uint32_t items, size_t bytes_per_op) {
+    const uint32_t iterations = CONFIG_HOST_BENCHMARK_ITERATIONS;
+    const int repeats = CONFIG_HOST_BENCHMARK_REPEATS;
+    double ns_per_op[CONFIG_HOST_BENCHMARK_REPEATS];
+
+    int saved = bench_quiet_begin();
+    fn(context, iterations / 10 + 1);   // 预热：填充缓存、完成首次惰性初始化
+
+    uint64_t alloc_count = __atomic_load_n(&g_alloc_count, __ATOMIC_RELAXED);
+    uint64_t alloc_bytes = __atomic_load_n(&g_alloc_bytes, __ATOMIC_RELAXED);
+    for (int r = 0; r < repeats; r++) {
+        int64_t start_ns = bench_now_ns();
+        fn(context, iterations);
+        ns_per_op[r] = (double)(bench_now_ns() - start_ns) / iterations;
+    }
+    alloc_count = __atomic_load_n(&g_alloc_count, __ATOMIC_RELAXED) - alloc_count;
+    alloc_bytes = __atomic_load_n(&g_alloc_bytes, __ATOMIC_RELAXED) - alloc_bytes;
+    bench_quiet_end(saved);
+
+    qsort(ns_per_op, repeats, sizeof(ns_per_op[0]), bench_compare_double);
+    double best = ns_per_op[0];
+    double total_ops = (double)iterations * repeats;
+
+    printf("{\"bench\":\"%s\",\"traffic\":\"%s\",\"items\":%lu,\"iterations\":%lu,\"repeats\":%d,"
+           "\"ns_per_op\":%.2f,\"ns_per_op_median\":%.2f,\"ops_per_sec\":%.0f,\"bytes_per_sec\":%.0f,"
+           "\"allocs_per_op\":%.4f,\"alloc_bytes_per_op\":%.2f}\n",
+           name, traffic, (unsigned long)items, (unsigned long)iterations, repeats,
+           best, ns_per_op[repeats / 2], best > 0.0 ? 1e9 / best : 0.0,
+           best > 0.0 ? 1e9 / best * bytes_per_op : 0.0,
+           alloc_count / total_ops, alloc_bytes / total_ops);
+    fflush(stdout);
+}
+
+// ====================================================================================
+// --- 被测函数 ---
+// ====================================================================================
+
+static void bench_send_frame(void* context, uint32_t iterations) {
+    // send_serial_can_frame为内部函数，经无日志的流式设定点入口调用（含模拟传输层的收帧开销）
+    uint8_t count = motor_registry_count();
+    uint8_t axis = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        const motor_driver_config_t* cfg = &motor_registry_get(axis)->controller->driver_config;
+        stream_target_position(cfg->uart_port, cfg->node_id, (float)(i & 1023) * 0.01f);
+        if (++axis == count) {
+            axis = 0;
+        }
+    }
+}
+
+static void bench_parse_frame(void* context, uint32_t iterations) {
+    bench_frames_t* set = (bench_frames_t*)context;
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        parse_motor_can_data(set->port[index], set->frames[index], BENCH_FRAME_SIZE);
+        if (++index == set->count) {
+            index = 0;
+        }
+    }
+}
+
+static void bench_angle_to_position(void* context, uint32_t iterations) {
+    const bench_units_t* set = (const bench_units_t*)context;
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < iterations; i++) {
+        sum += motor_units_angle_to_position(0, set->angles[i & (BENCH_UNIT_SAMPLES - 1)]);
+    }
+    g_float_sink = sum;
+}
+
+static void bench_position_to_angle(void* context, uint32_t iterations) {
+    const bench_units_t* set = (const bench_units_t*)context;
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < iterations; i++) {
+        sum += motor_units_position_to_angle(0, set->angles[i & (BENCH_UNIT_SAMPLES - 1)]);
+    }
+    g_float_sink = sum;
+}
+
+static void bench_bytes_to_float(void* context, uint32_t iterations) {
+    bench_frames_t* set = (bench_frames_t*)context;
+    uint32_t index = 0;
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < iterations; i++) {
+        // 交替取帧内两个float字段（数据偏移2和6）
+        sum += ieee754_bytes_to_float(&set->frames[index][2 + (i & 1) * 4]);
+        if ((i & 1) && ++index == set->count) {
+            index = 0;
+        }
+    }
+    g_float_sink = sum;
+}
+
+static void bench_gcode_frame(void* context, uint32_t iterations) {
+    bench_gcode_t* set = (bench_gcode_t*)context;
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (gcode_process_can_frame(set->controller, set->frames[index], BENCH_FRAME_SIZE) != GCODE_RESULT_OK) {
+            set->errors++;
+        }
+        if (++index == set->count) {
+            index = 0;
+        }
+    }
+}
+
+static void bench_status_json(void* context, uint32_t iterations) {
+    uint8_t count = motor_registry_count();
+    uint8_t axis = 0;
+    size_t total = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        total += strlen(get_motor_status_json(axis));
+        if (++axis == count) {
+            axis = 0;
+        }
+    }
+    g_size_sink = total;
+}
+
+/**
+ * @brief 模拟一帧只改变位置的位置速度响应，返回上一代次
+ */
+static uint32_t bench_touch_position(motor_status_t* status) {
+    uint32_t since_gen = status->generation++;
+    status->field_generation[MOTOR_STATUS_POSITION] = status->generation;
+    status->field_generation[MOTOR_STATUS_LAST_UPDATE_TIME] = status->generation;
+    return since_gen;
+}
+
+// 增量状态：每次位置更新后按上一次的代次取变化字段（Web页面轮询的常态）
+static void bench_status_delta_json(void* context, uint32_t iterations) {
+    motor_status_t* status = context;
+    size_t total = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        total += strlen(get_motor_status_delta_json(0, bench_touch_position(status)));
+    }
+    g_size_sink = total;
+}
+
+// ====================================================================================
+// --- 流量准备 ---
+// ====================================================================================
+
+static void bench_put_frame(bench_frames_t* set, uart_port_t port, uint16_t can_id, const uint8_t* data) {
+    if (set->count >= BENCH_RECORDED_MAX_FRAMES) {
+        return;
+    }
+    set->port[set->count] = port;
+    set->frames[set->count][0] = (can_id >> 8) & 0xFF;
+    set->frames[set->count][1] = can_id & 0xFF;
+    memcpy(&set->frames[set->count][2], data, 8);
+    set->count++;
+}
+
+/**
+ * @brief 合成响应帧：已注册节点 x 五种查询响应，数值随机
+ */
+static void bench_build_synthetic(bench_frames_t* set) {
+    static const uint8_t cmds[] = {
+        MOTOR_CMD_QUERY_TORQUE, MOTOR_CMD_QUERY_POWER, MOTOR_CMD_QUERY_ENCODER,
+        MOTOR_CMD_QUERY_POS_SPEED, MOTOR_CMD_QUERY_EXCEPTION
+    };
+    uint32_t rng = BENCH_RNG_SEED;
+
+    set->count = 0;
+    for (uint32_t i = 0; i < BENCH_SYNTHETIC_FRAMES; i++) {
+        const motor_driver_config_t* cfg =
+            &motor_registry_get(bench_rand(&rng) % motor_registry_count())->controller->driver_config;
+        uint8_t cmd = cmds[bench_rand(&rng) % sizeof(cmds)];
+        uint8_t data[8] = {0};
+
+        if (cmd == MOTOR_CMD_QUERY_ENCODER) {
+            int32_t counts[2] = {(int32_t)bench_rand(&rng) >> 8, (int32_t)(bench_rand(&rng) & 0x3FFF)};
+            memcpy(data, counts, sizeof(counts));
+        } else if (cmd == MOTOR_CMD_QUERY_EXCEPTION) {
+            uint32_t code = (bench_rand(&rng) & 0xF) == 0 ? (1u << (bench_rand(&rng) & 31)) : 0;
+            memcpy(data, &code, sizeof(code));
+        } else {
+            float values[2] = {
+                (float)(int32_t)bench_rand(&rng) / 2147483648.0f * 100.0f,
+                (float)(int32_t)bench_rand(&rng) / 2147483648.0f * 10.0f
+            };
+            memcpy(data, values, sizeof(values));
+        }
+        bench_put_frame(set, cfg->uart_port, MOTOR_FRAME_ID(cfg->node_id, cmd), data);
+    }
+}
+
+/**
+ * @brief 从模拟驱动器录制真实响应流：各电机速度模式运转，逐轮发出全部查询并读回原始字节
+ */
+static void bench_capture_recorded(bench_frames_t* set) {
+    static const int exception_types[] = {0, 1, 3, 4};
+    uint8_t count = motor_registry_count();
+    uint8_t buffer[BENCH_CAPTURE_BUFFER];
+
+    set->count = 0;
+    int saved = bench_quiet_begin();
+    for (uint8_t i = 0; i < count; i++) {
+        motor_controller_t* motor = motor_registry_get(i)->controller;
+        motor_control_enable(motor, true);
+        motor_control_set_velocity_mode(motor);
+        motor_control_set_velocity(motor, 1.0f + i);
+    }
+
+    for (int round = 0; round < BENCH_CAPTURE_ROUNDS && set->count < BENCH_RECORDED_MAX_FRAMES; round++) {
+        for (uint8_t i = 0; i < count; i++) {
+            const motor_driver_config_t* cfg = &motor_registry_get(i)->controller->driver_config;
+            query_motor_torque(cfg->uart_port, cfg->node_id);
+            query_motor_power(cfg->uart_port, cfg->node_id);
+            query_encoder_count(cfg->uart_port, cfg->node_id);
+            query_motor_position_speed(cfg->uart_port, cfg->node_id);
+            query_motor_exceptions(cfg->uart_port, cfg->node_id, exception_types[round % 4]);
+        }
+        vTaskDelay(pdMS_TO_TICKS(BENCH_CAPTURE_WAIT_MS));
+
+        bool port_done[UART_NUM_MAX] = {false};
+        for (uint8_t i = 0; i < count; i++) {
+            uart_port_t port = motor_registry_get(i)->controller->driver_config.uart_port;
+            if (port_done[port]) {
+                continue;
+            }
+            port_done[port] = true;
+
+            int length = motor_uart_read(port, buffer, sizeof(buffer));
+            // 与监听任务相同的对齐规则：ID指向本端口已注册节点才算一帧，否则丢弃1字节（模拟噪声/损坏时）
+            for (int offset = 0; offset + BENCH_FRAME_SIZE <= length; ) {
+                uint16_t can_id = (buffer[offset] << 8) | buffer[offset + 1];
+                if (motor_control_find(port, MOTOR_FRAME_NODE(can_id))) {
+                    bench_put_frame(set, port, can_id, &buffer[offset + 2]);
+                    offset += BENCH_FRAME_SIZE;
+                } else {
+                    offset++;
+                }
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        motor_control_enable(motor_registry_get(i)->controller, false);
+    }
+    bench_quiet_end(saved);
+}
+
+/**
+ * @brief 把G代码程序按8字节载荷切成CAN帧（不足一帧以0x00填充，解析时丢弃）
+ * @return 帧数，程序为空或超过容量时返回0
+ */
+static uint32_t bench_build_gcode_frames(const char* program, size_t length, uint8_t (*frames)[BENCH_FRAME_SIZE]) {
+    uint32_t count = (uint32_t)((length + BENCH_GCODE_PAYLOAD - 1) / BENCH_GCODE_PAYLOAD);
+    if (count == 0 || count > BENCH_GCODE_MAX_FRAMES) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        size_t offset = (size_t)i * BENCH_GCODE_PAYLOAD;
+        size_t chunk = length - offset < BENCH_GCODE_PAYLOAD ? length - offset : BENCH_GCODE_PAYLOAD;
+        memset(frames[i], 0, BENCH_FRAME_SIZE);
+        frames[i][0] = 0x00;    // G代码帧ID（gcode_is_gcode_can_frame）
+        frames[i][1] = 0x01;
+        memcpy(&frames[i][2], program + offset, chunk);
+    }
+    return count;
+}
+
+/**
+ * @brief 合成G代码程序：速度/力矩/使能/位置命令轮流作用于各轴
+ */
+static size_t bench_build_synthetic_program(char* program, size_t size) {
+    uint8_t count = motor_registry_count();
+    size_t used = 0;
+
+    for (int line = 0; line < BENCH_SYNTHETIC_GCODE_LINES; line++) {
+        int axis = line % count;
+        int written;
+        switch (line % 4) {
+            case 0:
+                written = snprintf(program + used, size - used, "G1 F%.2f P%d\n", 0.5f + 0.25f * axis, axis);
+                break;
+            case 1:
+                written = snprintf(program + used, size - used, "G1 T%.2f P%d\n", 0.1f * (axis + 1), axis);
+                break;
+            case 2:
+                written = snprintf(program + used, size - used, "M1 P%d\n", axis);
+                break;
+            default:
+                written = snprintf(program + used, size - used, "N%d G1 %c%.1f\n", line,
+                                   motor_registry_get(axis)->axis_letter, 15.0f * line);
+                break;
+        }
+        if (written < 0 || (size_t)written >= size - used) {
+            break;
+        }
+        used += written;
+    }
+    return used;
+}
+
+static void bench_run_gcode(const char* traffic, gcode_controller_t* controller, const char* program, size_t length) {
+    static uint8_t frames[BENCH_GCODE_MAX_FRAMES][BENCH_FRAME_SIZE];
+    bench_gcode_t set = {
+        .controller = controller,
+        .frames = frames,
+        .count = bench_build_gcode_frames(program, length, frames)
+    };
+    if (set.count == 0) {
+        ESP_LOGW(TAG, "%s G代码流量为空或超过%d帧，跳过", traffic, BENCH_GCODE_MAX_FRAMES);
+        return;
+    }
+
+    bench_report("gcode_process_can_frame", traffic, bench_gcode_frame, &set, set.count, BENCH_GCODE_PAYLOAD);
+    if (set.errors) {
+        ESP_LOGW(TAG, "%s G代码流量中有%lu帧返回错误", traffic, (unsigned long)set.errors);
+    }
+}
+
+/**
+ * @brief 送入一帧G代码CAN帧（载荷按给定长度原样发送，可含0x00填充）
+ */
+static gcode_result_t bench_feed_gcode(gcode_controller_t* controller, const char* payload, size_t length) {
+    uint8_t frame[2 + BENCH_GCODE_PAYLOAD] = {0x00, 0x01};
+    memcpy(&frame[2], payload, length);
+    return gcode_process_can_frame(controller, frame, 2 + length);
+}
+
+// 按行分帧的G代码：每行拆成若干CAN帧，一次操作送完一行的全部帧
+typedef struct {
+    gcode_controller_t* controller;
+    uint8_t (*frames)[BENCH_FRAME_SIZE];
+    uint8_t* lengths;                   // 每帧总长度（2字节ID + 载荷）
+    uint16_t* line_ends;                // 每行最后一帧之后的帧序号
+    uint32_t lines;
+    uint32_t line;                      // 跨调用保持行位置
+    uint32_t errors;
+} bench_gcode_lines_t;
+
+static void bench_gcode_line(void* context, uint32_t iterations) {
+    bench_gcode_lines_t* set = (bench_gcode_lines_t*)context;
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t first = set->line == 0 ? 0 : set->line_ends[set->line - 1];
+        for (uint32_t f = first; f < set->line_ends[set->line]; f++) {
+            if (gcode_process_can_frame(set->controller, set->frames[f], set->lengths[f]) != GCODE_RESULT_OK) {
+                set->errors++;
+            }
+        }
+        if (++set->line == set->lines) {
+            set->line = 0;
+        }
+    }
+}
+
+/**
+ * @brief 把程序逐行拆成不带换行符的CAN帧：偶数行最后一帧补0到DLC 8，奇数行最后一帧为短帧；
+ * 行长恰为8的倍数时另发一个只含换行符的短帧
+ * @return 行数，超过容量时返回0
+ */
+static uint32_t bench_build_line_frames(const char* program, size_t length, bench_gcode_lines_t* set,
+                                        uint32_t max_frames, uint32_t max_lines) {
+    uint32_t frames = 0;
+    uint32_t lines = 0;
+    size_t start = 0;
+    while (start < length) {
+        const char* newline = memchr(program + start, '\n', length - start);
+        size_t line_length = newline ? (size_t)(newline - (program + start)) : length - start;
+        if (lines == max_lines || frames + line_length / BENCH_GCODE_PAYLOAD + 1 > max_frames) {
+            return 0;
+        }
+        for (size_t offset = 0; offset < line_length || line_length % BENCH_GCODE_PAYLOAD == 0;
+             offset += BENCH_GCODE_PAYLOAD) {
+            size_t chunk = line_length - offset < BENCH_GCODE_PAYLOAD ? line_length - offset : BENCH_GCODE_PAYLOAD;
+            uint8_t* frame = set->frames[frames];
+            memset(frame, 0, BENCH_FRAME_SIZE);
+            frame[0] = 0x00;
+            frame[1] = 0x01;
+            if (chunk == 0) {
+                frame[2] = '\n';
+                chunk = 1;
+            } else {
+                memcpy(&frame[2], program + start + offset, chunk);
+            }
+            bool last = offset + chunk >= line_length;
+            set->lengths[frames++] = (uint8_t)(2 + (last && (lines & 1) ? chunk : BENCH_GCODE_PAYLOAD));
+            if (last && (chunk < BENCH_GCODE_PAYLOAD || frame[2] == '\n')) {
+                break;
+            }
+        }
+        set->line_ends[lines++] = (uint16_t)frames;
+        start += line_length + 1;
+    }
+    return lines;
+}
+
+static void bench_run_gcode_lines(gcode_controller_t* controller, const char* program, size_t length) {
+    static uint8_t frames[BENCH_GCODE_MAX_FRAMES][BENCH_FRAME_SIZE];
+    static uint8_t lengths[BENCH_GCODE_MAX_FRAMES];
+    static uint16_t line_ends[BENCH_SYNTHETIC_GCODE_LINES];
+    bench_gcode_lines_t set = {
+        .controller = controller,
+        .frames = frames,
+        .lengths = lengths,
+        .line_ends = line_ends
+    };
+    set.lines = bench_build_line_frames(program, length, &set, BENCH_GCODE_MAX_FRAMES, BENCH_SYNTHETIC_GCODE_LINES);
+    if (set.lines == 0) {
+        ESP_LOGW(TAG, "分帧G代码流量为空或超过容量，跳过");
+        return;
+    }
+    // 上一项按固定帧数计时，可能停在行中间：先用换行符结束留下的半行
+    bench_feed_gcode(controller, "\n", 1);
+
+    bench_report("gcode_can_line", "fragmented", bench_gcode_line, &set, set.lines, length / set.lines);
+    if (set.errors) {
+        ESP_LOGW(TAG, "分帧G代码流量中有%lu帧返回错误", (unsigned long)set.errors);
+    }
+}
+
+/**
+ * @brief 行已执行且为期望的目标角度
+ */
+static bool bench_gcode_executed(const gcode_controller_t* controller, uint32_t lines, double angle) {
+    return controller->line_ring.lines_completed == lines && fabs(controller->commanded_angle[0] - angle) < 1e-6;
+}
+
+/**
+ * @brief G代码CAN帧重组检查：0x00填充的DLC 8帧、短帧、跨帧的行、一帧多行与超长行溢出后恢复
+ * 使用独立控制器，不受基准流量留下的半行影响
+ * @return 各场景的执行行数与目标角度均符合预期返回true
+ */
+static bool bench_check_gcode_frames(const gcode_controller_config_t* config) {
+    gcode_controller_t* controller = gcode_controller_init(config);
+    if (!controller) {
+        ESP_LOGE(TAG, "G代码控制器初始化失败");
+        return false;
+    }
+
+    char axis = motor_registry_get(0)->axis_letter;
+    char payload[BENCH_GCODE_PAYLOAD + 1];
+    uint32_t lines = 0;
+
+    // 补0到DLC 8："G1 X12\0\0"
+    memset(payload, 0, sizeof(payload));
+    snprintf(payload, sizeof(payload), "G1 %c12", axis);
+    bool padded = bench_feed_gcode(controller, payload, BENCH_GCODE_PAYLOAD) == GCODE_RESULT_OK &&
+                  bench_gcode_executed(controller, ++lines, 12.0);
+
+    // 短帧：DLC 6
+    snprintf(payload, sizeof(payload), "G1 %c13", axis);
+    bool short_frame = bench_feed_gcode(controller, payload, strlen(payload)) == GCODE_RESULT_OK &&
+                       bench_gcode_executed(controller, ++lines, 13.0);
+
+    // 跨帧：无填充的完整8字节帧不能提前执行，由后续短帧结束
+    snprintf(payload, sizeof(payload), "G1 %c100.", axis);
+    bool fragmented = bench_feed_gcode(controller, payload, BENCH_GCODE_PAYLOAD) == GCODE_RESULT_OK &&
+                      bench_gcode_executed(controller, lines, 13.0) &&
+                      bench_feed_gcode(controller, "25", 2) == GCODE_RESULT_OK &&
+                      bench_gcode_executed(controller, ++lines, 100.25);
+
+    // 一帧含换行符结束的一行和下一行的开头
+    snprintf(payload, sizeof(payload), "G1 %c5\nG1", axis);
+    bool multi_line = bench_feed_gcode(controller, payload, BENCH_GCODE_PAYLOAD) == GCODE_RESULT_OK &&
+                      bench_gcode_executed(controller, ++lines, 5.0);
+    snprintf(payload, sizeof(payload), " %c6", axis);
+    multi_line = multi_line && bench_feed_gcode(controller, payload, strlen(payload)) == GCODE_RESULT_OK &&
+                 bench_gcode_executed(controller, ++lines, 6.0);
+
+    // 超长行（无换行符）：报告一次溢出，丢到下一个短帧为止，之后的命令正常执行
+    gcode_result_t overflow_result = GCODE_RESULT_OK;
+    snprintf(payload, sizeof(payload), "G1 %c1111", axis);
+    for (int i = 0; i <= GCODE_LINE_RING_SIZE / BENCH_GCODE_PAYLOAD + 8; i++) {
+        gcode_result_t result = bench_feed_gcode(controller, payload, BENCH_GCODE_PAYLOAD);
+        if (result != GCODE_RESULT_OK) {
+            overflow_result = result;
+        }
+        memset(payload, '1', BENCH_GCODE_PAYLOAD);
+    }
+    bool overflow_recovered = overflow_result == GCODE_RESULT_BUFFER_FULL &&
+                              bench_feed_gcode(controller, "1", 1) == GCODE_RESULT_OK &&
+                              controller->line_ring.overflow_count == 1 &&
+                              bench_gcode_executed(controller, lines, 6.0);
+    snprintf(payload, sizeof(payload), "G1 %c14", axis);
+    overflow_recovered = overflow_recovered &&
+                         bench_feed_gcode(controller, payload, strlen(payload)) == GCODE_RESULT_OK &&
+                         bench_gcode_executed(controller, ++lines, 14.0);
+
+    bool ok = padded && short_frame && fragmented && multi_line && overflow_recovered;
+    printf("{\"check\":\"gcode_frames\",\"padded\":%s,\"short_frame\":%s,\"fragmented\":%s,\"multi_line\":%s,"
+           "\"overflow_recovered\":%s,\"lines_completed\":%lu,\"overflow_bytes\":%lu,\"ok\":%s}\n",
+           padded ? "true" : "false", short_frame ? "true" : "false", fragmented ? "true" : "false",
+           multi_line ? "true" : "false", overflow_recovered ? "true" : "false",
+           (unsigned long)controller->line_ring.lines_completed,
+           (unsigned long)controller->line_ring.overflow_bytes, ok ? "true" : "false");
+
+    gcode_controller_deinit(controller);
+    return ok;
+}
+
+// ====================================================================================
+// --- G代码解析器 ---
+// ====================================================================================
+
+// 解析基准：合成程序切成的行
+typedef struct {
+    const char* lines[BENCH_SYNTHETIC_GCODE_LINES];
+    uint32_t count;
+} bench_parse_t;
+
+static void bench_parse_line(void* context, uint32_t iterations) {
+    const bench_parse_t* set = (const bench_parse_t*)context;
+    gcode_line_t parsed;
+    uint32_t index = 0;
+    uint32_t words = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        gcode_parse_line(set->lines[index], &parsed);
+        words += parsed.word_mask;
+        if (++index == set->count) {
+            index = 0;
+        }
+    }
+    g_size_sink = words;
+}
+
+/**
+ * @brief 按解析器的规则计算整行*校验值（所有字节异或）
+ */
+static uint8_t bench_line_checksum(const char* line) {
+    uint8_t sum = 0;
+    while (*line) {
+        sum ^= (uint8_t)*line++;
+    }
+    return sum;
+}
+
+/**
+ * @brief 解析成功的结果须自洽：只含字母位、数值有限、N行号与N字一致
+ */
+static bool bench_parsed_consistent(const gcode_line_t* parsed) {
+    if (parsed->word_mask >> GCODE_WORD_COUNT) {
+        return false;
+    }
+    for (int i = 0; i < GCODE_WORD_COUNT; i++) {
+        if ((parsed->word_mask & (1UL << i)) && !isfinite(parsed->values[i])) {
+            return false;
+        }
+    }
+    return (parsed->word_mask & GCODE_WORD_BIT('N')) ? parsed->line_number == (int32_t)parsed->values['N' - 'A']
+                                                     : parsed->line_number == -1;
+}
+
+/**
+ * @brief 解析结果的不变量：返回值只可能是OK/参数错误/校验错误；OK时结果自洽，
+ * 按定点格式重新格式化后再解析得到相同的字与数值，且补上正确/错误的*校验分别被接受/拒绝
+ * @return 违反的不变量个数（0或1）
+ */
+static uint32_t bench_parse_invariants(const char* line) {
+    gcode_line_t parsed;
+    gcode_result_t result = gcode_parse_line(line, &parsed);
+    if (result == GCODE_RESULT_INVALID_PARAMETER || result == GCODE_RESULT_CHECKSUM_ERROR) {
+        return 0;
+    }
+    if (result != GCODE_RESULT_OK || !bench_parsed_consistent(&parsed)) {
+        return 1;
+    }
+
+    char rebuilt[GCODE_WORD_COUNT * 56 + 8];
+    size_t used = 0;
+    for (int i = 0; i < GCODE_WORD_COUNT; i++) {
+        if (parsed.word_mask & (1UL << i)) {
+            // 定点格式：解析器不支持指数写法（%g的"e"会被当作字母E）
+            used += snprintf(rebuilt + used, sizeof(rebuilt) - used, "%c%.9f ", 'A' + i, parsed.values[i]);
+        }
+    }
+    rebuilt[used] = '\0';
+    gcode_line_t reparsed;
+    if (gcode_parse_line(rebuilt, &reparsed) != GCODE_RESULT_OK || reparsed.word_mask != parsed.word_mask) {
+        return 1;
+    }
+    for (int i = 0; i < GCODE_WORD_COUNT; i++) {
+        if ((parsed.word_mask & (1UL << i)) &&
+            fabsf(reparsed.values[i] - parsed.values[i]) > 1e-6f * fmaxf(1.0f, fabsf(parsed.values[i]))) {
+            return 1;
+        }
+    }
+
+    // 补校验：用重新格式化的行（不含注释），正确校验值必须接受，错一位必须报校验错误
+    uint8_t sum = bench_line_checksum(rebuilt);
+    snprintf(rebuilt + used, sizeof(rebuilt) - used, "*%u", sum);
+    if (gcode_parse_line(rebuilt, &reparsed) != GCODE_RESULT_OK || !reparsed.has_checksum || reparsed.checksum != sum) {
+        return 1;
+    }
+    snprintf(rebuilt + used, sizeof(rebuilt) - used, "*%u", (uint8_t)(sum + 1));
+    return gcode_parse_line(rebuilt, &reparsed) == GCODE_RESULT_CHECKSUM_ERROR ? 0 : 1;
+}
+
+/**
+ * @brief 解析器检查：畸形行与*校验的固定用例，以及固定种子的变异输入（替换/插入/删除/截断）
+ * @return 固定用例全部符合预期且变异输入没有违反不变量返回true
+ */
+static bool bench_check_parser(void) {
+    typedef struct {
+        const char* line;
+        gcode_result_t result;
+        char letter;                    // 需要核对数值的字母（0表示不核对）
+        float value;
+    } parse_case_t;
+    static const parse_case_t cases[] = {
+        { "G1 X10.5 F2",            GCODE_RESULT_OK,                'X', 10.5f },
+        { "g1 x-3 p1",              GCODE_RESULT_OK,                'X', -3.0f },
+        { "",                       GCODE_RESULT_OK,                0,   0.0f },
+        { "G1 X1 ; X2",             GCODE_RESULT_OK,                'X', 1.0f },
+        { "G1 (X9) X2",             GCODE_RESULT_OK,                'X', 2.0f },
+        { "G1 (X9",                 GCODE_RESULT_OK,                'G', 1.0f },
+        { "G1 X.5",                 GCODE_RESULT_OK,                'X', 0.5f },
+        { "G1 X123456789012",       GCODE_RESULT_OK,                'X', 123456789012.0f },
+        { "G1 X",                   GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "G1 X+",                  GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "G1 X-.",                 GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "G1 X999999999999999999999999999999999999999999999", GCODE_RESULT_INVALID_PARAMETER, 0, 0.0f },
+        { "G1 X1 X2",               GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "G1 X1.2.3",              GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "G1 X1 #",                GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "G1 \x80X1",              GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "N1 G1 X5*",              GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+        { "N1 G1 X5*256",           GCODE_RESULT_INVALID_PARAMETER, 0,   0.0f },
+    };
+
+    uint32_t case_failures = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        gcode_line_t parsed;
+        gcode_result_t result = gcode_parse_line(cases[i].line, &parsed);
+        bool ok = result == cases[i].result;
+        if (ok && result == GCODE_RESULT_OK) {
+            ok = bench_parsed_consistent(&parsed) &&
+                 (!cases[i].letter || fabsf(parsed.values[cases[i].letter - 'A'] - cases[i].value) <=
+                                      1e-6f * fmaxf(1.0f, fabsf(cases[i].value)));
+        }
+        if (!ok) {
+            ESP_LOGW(TAG, "解析用例失败: \"%s\" -> %d", cases[i].line, result);
+            case_failures++;
+        }
+    }
+
+    // *校验：正确值接受，错误值拒绝，校验后只允许空白或注释
+    char line[BENCH_PARSE_LINE_MAX + 16];
+    const char* body = "N7 G1 X5 (move) F1.5";
+    uint8_t sum = bench_line_checksum(body);
+    gcode_line_t parsed;
+    snprintf(line, sizeof(line), "%s*%u ; done", body, sum);
+    bool checksum_ok = gcode_parse_line(line, &parsed) == GCODE_RESULT_OK && parsed.has_checksum &&
+                       parsed.line_number == 7;
+    snprintf(line, sizeof(line), "%s*%u", body, (uint8_t)(sum ^ 0x20));
+    checksum_ok = checksum_ok && gcode_parse_line(line, &parsed) == GCODE_RESULT_CHECKSUM_ERROR;
+    snprintf(line, sizeof(line), "%s*%u X1", body, sum);
+    checksum_ok = checksum_ok && gcode_parse_line(line, &parsed) == GCODE_RESULT_INVALID_PARAMETER;
+    if (!checksum_ok) {
+        case_failures++;
+    }
+
+    // 变异输入：以固定用例为种子，每轮做1-4次字节级变异
+    static const char alphabet[] = "GMXYZABCFTPNgxn0123456789+-.. \t;()*#\x01\x7f\xff";
+    uint32_t rng = BENCH_RNG_SEED;
+    uint32_t violations = 0;
+    uint32_t accepted = 0;
+    for (uint32_t n = 0; n < BENCH_PARSE_FUZZ_ITERATIONS; n++) {
+        const char* seed = cases[bench_rand(&rng) % (sizeof(cases) / sizeof(cases[0]))].line;
+        size_t length = strlen(seed);
+        memcpy(line, seed, length);
+        int mutations = 1 + (int)(bench_rand(&rng) & 3);
+        for (int m = 0; m < mutations; m++) {
+            uint32_t r = bench_rand(&rng);
+            size_t at = length ? (r >> 8) % (length + 1) : 0;
+            char c = alphabet[(r >> 20) % (sizeof(alphabet) - 1)];
+            switch (r & 3) {
+                case 0:     // 替换
+                    if (at < length) {
+                        line[at] = c;
+                    }
+                    break;
+                case 1:     // 插入
+                    if (length < BENCH_PARSE_LINE_MAX) {
+                        memmove(&line[at + 1], &line[at], length - at);
+                        line[at] = c;
+                        length++;
+                    }
+                    break;
+                case 2:     // 删除
+                    if (at < length) {
+                        memmove(&line[at], &line[at + 1], length - at - 1);
+                        length--;
+                    }
+                    break;
+                default:    // 截断
+                    length = at;
+                    break;
+            }
+        }
+        line[length] = '\0';
+        uint32_t violation = bench_parse_invariants(line);
+        if (violation && violations == 0) {
+            ESP_LOGW(TAG, "解析不变量被违反: \"%s\"", line);
+        }
+        violations += violation;
+        accepted += gcode_parse_line(line, &parsed) == GCODE_RESULT_OK;
+    }
+
+    bool ok = case_failures == 0 && violations == 0;
+    printf("{\"check\":\"gcode_parser\",\"cases\":%lu,\"case_failures\":%lu,\"fuzz_inputs\":%lu,"
+           "\"fuzz_accepted\":%lu,\"invariant_violations\":%lu,\"ok\":%s}\n",
+           (unsigned long)(sizeof(cases) / sizeof(cases[0]) + 1), (unsigned long)case_failures,
+           (unsigned long)BENCH_PARSE_FUZZ_ITERATIONS, (unsigned long)accepted, (unsigned long)violations,
+           ok ? "true" : "false");
+    return ok;
+}
+
+/**
+ * @brief 单行解析基准：合成程序逐行解析，不执行
+ */
+static void bench_run_parser(const char* program, size_t length) {
+    static char lines[BENCH_SYNTHETIC_GCODE_LINES * 24];
+    static bench_parse_t set;
+    if (length >= sizeof(lines)) {
+        return;
+    }
+    memcpy(lines, program, length);
+    lines[length] = '\0';
+    set.count = 0;
+    size_t bytes = 0;
+    for (char* line = strtok(lines, "\n"); line && set.count < BENCH_SYNTHETIC_GCODE_LINES; line = strtok(NULL, "\n")) {
+        set.lines[set.count++] = line;
+        bytes += strlen(line);
+    }
+    if (set.count == 0) {
+        return;
+    }
+    bench_report("gcode_parse_line", "synthetic", bench_parse_line, &set, set.count, bytes / set.count);
+}
+
+/**
+ * @brief 生成单位换算输入：typical为±720度，huge为±1e9度
+ */
+static void bench_build_units(bench_units_t* set, float range) {
+    uint32_t rng = BENCH_RNG_SEED;
+    for (uint32_t i = 0; i < BENCH_UNIT_SAMPLES; i++) {
+        set->angles[i] = ((float)bench_rand(&rng) / 4294967296.0f * 2.0f - 1.0f) * range;
+    }
+}
+
+/**
+ * @brief 单位换算精度检查：默认标定与双精度参考比较，反向多圈标定做往返比较
+ * @return 误差在允许范围内返回true
+ */
+static bool bench_check_units(const bench_units_t* typical, const bench_units_t* huge) {
+    static const float edges[] = { 0.0f, -0.0f, 359.99997f, 360.0f, -1e-8f, -360.0f, 720.5f, 1e30f, -1e30f };
+    double ratio = g_motor_config.gear_ratio;
+    double max_position_error = 0.0;
+    double max_roundtrip_error = 0.0;
+    uint32_t samples = 0;
+
+    // 默认标定（单圈、同向、无偏移）：位置 = fmod(角度, 360) * 减速比 * 8 / 360
+    for (uint32_t i = 0; i < BENCH_UNIT_SAMPLES * 2 + sizeof(edges) / sizeof(edges[0]); i++) {
+        float angle = i < BENCH_UNIT_SAMPLES ? typical->angles[i] :
+                      i < BENCH_UNIT_SAMPLES * 2 ? huge->angles[i - BENCH_UNIT_SAMPLES] :
+                      edges[i - BENCH_UNIT_SAMPLES * 2];
+        double full_turn = ratio * ANGLE_TO_POSITION_SCALE;
+        double expected = fmod((double)angle, 360.0) * full_turn / 360.0;
+        // 按一整圈取模比较：-1e-8度归一化为0或359.99999999度是同一位置
+        double error = fabs(remainder((double)motor_units_angle_to_position(0, angle) - expected, full_turn));
+        if (!(error <= max_position_error)) {
+            max_position_error = error;
+        }
+        samples++;
+    }
+
+    // 多圈、反向、带偏移的标定：角度 -> 位置 -> 角度往返
+    motor_units_profile_t profile = *motor_units_default_profile();
+    profile.ratio = 50.0f;
+    profile.offset = 12.5f;
+    profile.direction = -1;
+    profile.turn_mode = MOTOR_UNITS_MULTI_TURN;
+    motor_units_set_profile(0, &profile);
+    for (uint32_t i = 0; i < BENCH_UNIT_SAMPLES; i++) {
+        float angle = typical->angles[i] * 5.0f;
+        float position = motor_units_angle_to_position(0, angle);
+        double error = fabs((double)motor_units_position_to_angle(0, position) - angle);
+        if (!(error <= max_roundtrip_error)) {
+            max_roundtrip_error = error;
+        }
+        samples++;
+    }
+
+    // 最短路径标定：目标与命令值模360相等，且离当前位置不超过半圈
+    double max_shortest_error = 0.0;
+    profile.turn_mode = MOTOR_UNITS_SHORTEST_PATH;
+    motor_units_set_profile(0, &profile);
+    for (uint32_t i = 0; i < BENCH_UNIT_SAMPLES; i++) {
+        double current = (double)typical->angles[i] * 1000.0;
+        double value = typical->angles[(i * 7 + 3) & (BENCH_UNIT_SAMPLES - 1)];
+        double target = motor_units_resolve_target(0, current, value, false);
+        double error = fabs(remainder(target - value, 360.0));
+        if (fabs(target - current) > 180.0 || !(error <= max_shortest_error)) {
+            max_shortest_error = fabs(target - current) > 180.0 ? INFINITY : error;
+        }
+        samples++;
+    }
+    motor_units_set_profile(0, motor_units_default_profile());
+
+    // 多圈计数展开：int32原始计数多次回绕后，64位绝对计数仍与参考值逐样本相等
+    motor_derived_t derived;
+    motor_derived_reset(&derived);
+    int64_t reference = -(int64_t)BENCH_UNWRAP_STEP * 7;
+    uint32_t unwrap_mismatches = 0;
+    for (uint32_t i = 0; i < BENCH_UNWRAP_SAMPLES; i++) {
+        int64_t count;
+        motor_derived_encoder(&derived, (int32_t)(uint32_t)(uint64_t)reference, (int64_t)i * 1000);
+        if (!motor_derived_absolute_count(&derived, &count) || count != reference) {
+            unwrap_mismatches++;
+        }
+        reference += BENCH_UNWRAP_STEP;
+    }
+
+    bool ok = max_position_error <= BENCH_UNIT_POSITION_TOL && max_roundtrip_error <= BENCH_UNIT_ROUNDTRIP_TOL &&
+              max_shortest_error <= BENCH_UNIT_POSITION_TOL && unwrap_mismatches == 0;
+    printf("{\"check\":\"motor_units\",\"samples\":%lu,\"max_position_error\":%.3g,"
+           "\"max_roundtrip_error_deg\":%.3g,\"max_shortest_error_deg\":%.3g,\"unwrap_mismatches\":%lu,\"ok\":%s}\n",
+           (unsigned long)samples, max_position_error, max_roundtrip_error, max_shortest_error,
+           (unsigned long)unwrap_mismatches, ok ? "true" : "false");
+    return ok;
+}
+
+// 基准不启动UART监听：由注入任务按节拍把设定的编码器计数写入派生信号，代替驱动器的编码器响应
+typedef struct {
+    motor_controller_t* motor;
+    volatile int32_t count;             // 当前注入的编码器计数
+    volatile bool running;
+    volatile bool stopped;
+} bench_encoder_feed_t;
+
+static void bench_encoder_feed_task(void* pvParameters) {
+    bench_encoder_feed_t* feed = (bench_encoder_feed_t*)pvParameters;
+    while (feed->running) {
+        motor_derived_encoder(&feed->motor->derived, feed->count, esp_timer_get_time());
+        vTaskDelay(1);
+    }
+    feed->stopped = true;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 设定编码器位置（输出轴角度）
+ */
+static void bench_encoder_set(bench_encoder_feed_t* feed, double angle) {
+    const motor_units_axis_t* units = motor_units_axis(0);
+    feed->count = (int32_t)llround((angle - units->offset) / units->degree_per_count);
+}
+
+/**
+ * @brief 目标角度与期望值相差不超过一个编码器计数
+ */
+static bool bench_angle_near(double angle, double expected) {
+    return fabs(angle - expected) <= fabs(motor_units_axis(0)->degree_per_count);
+}
+
+/**
+ * @brief 执行一段G代码程序，返回轴0的目标角度
+ */
+static double bench_gcode_target(gcode_controller_t* controller, const char* format, char axis) {
+    char program[64];
+    int length = snprintf(program, sizeof(program), format, axis, axis);
+    if (gcode_process_program(controller, program, (size_t)length) != GCODE_RESULT_OK) {
+        return NAN;
+    }
+    return controller->commanded_angle[0];
+}
+
+/**
+ * @brief 相对运动起点检查：上一条是走完的G代码轨迹运动时沿用目标（不查询编码器），
+ *        斜坡运动经编码器确认后才沿用，速度模式（G1 F P）或外部设定点改写之后必须改用编码器位置
+ * 使用独立的直接执行、启用轨迹的控制器（约束放宽，运动只需几毫秒），编码器由注入任务提供
+ * @return 各步的目标角度与执行路径均符合预期返回true
+ */
+static bool bench_check_gcode_start(const gcode_controller_config_t* config) {
+    gcode_controller_config_t trajectory_config = *config;
+    trajectory_config.use_trajectory = true;
+    trajectory_config.trajectory_rate_hz = TRAJECTORY_MAX_RATE_HZ;
+    trajectory_config.trajectory_profile = TRAJECTORY_PROFILE_S_CURVE;
+    trajectory_config.trajectory_limits = (trajectory_limits_t){
+        .max_velocity = 36000.0f, .max_acceleration = 3.6e6f, .max_jerk = 3.6e8f
+    };
+    gcode_controller_t* controller = gcode_controller_init(&trajectory_config);
+    if (!controller) {
+        ESP_LOGE(TAG, "G代码控制器初始化失败");
+        return false;
+    }
+
+    static bench_encoder_feed_t feed;
+    feed.motor = motor_registry_get(0)->controller;
+    feed.running = true;
+    feed.stopped = false;
+    bench_encoder_set(&feed, 90.0);
+    if (xTaskCreate(bench_encoder_feed_task, "bench_encoder", BENCH_ENCODER_STACK_SIZE, &feed,
+                    MOTOR_TASK_PRIORITY_UART, NULL) != pdPASS) {
+        gcode_controller_deinit(controller);
+        return false;
+    }
+    char axis = motor_registry_get(0)->axis_letter;
+    const trajectory_stats_t* stats = &controller->trajectory->stats;
+    int saved = bench_quiet_begin();
+
+    // 上电后起点未知：斜坡运动到90度；编码器确认后相对运动从90度起算，由轨迹执行
+    uint32_t moves = stats->moves_completed;
+    bool confirmed = bench_angle_near(bench_gcode_target(controller, "G90\nG1 %c90\nG91\nG1 %c10\n", axis), 100.0) &&
+                     stats->moves_completed == moves + 1;
+
+    // 上一条是走完的轨迹运动：沿用其目标，不受编码器读数影响
+    bench_encoder_set(&feed, 100.3);
+    bool cached = bench_angle_near(bench_gcode_target(controller, "G1 %c5\n", axis), 105.0) &&
+                  stats->moves_completed == moves + 2;
+
+    // 非G代码来源改写设定点（HTTP、故障）：从编码器位置起算
+    motor_control_set_position_mode(feed.motor);
+    bench_encoder_set(&feed, 120.0);
+    bool external = bench_angle_near(bench_gcode_target(controller, "G1 %c0\n", axis), 120.0) &&
+                    bench_angle_near(bench_gcode_target(controller, "G1 %c5\n", axis), 125.0) &&
+                    stats->moves_completed == moves + 3;
+
+    // G1 F1 P0（速度模式）期间轴转动，之后的G91 G1 X10从编码器位置起算，而不是上一条轨迹的目标
+    bench_gcode_target(controller, "G90\nG1 F1 P0\n", axis);
+    bench_encoder_set(&feed, 137.0);
+    double after_velocity = bench_gcode_target(controller, "G91\nG1 %c10\n", axis);
+    bool velocity = bench_angle_near(after_velocity, 147.0);
+
+    bench_quiet_end(saved);
+    feed.running = false;
+    while (!feed.stopped) {
+        vTaskDelay(1);
+    }
+    gcode_controller_deinit(controller);
+
+    bool ok = confirmed && cached && external && velocity;
+    printf("{\"check\":\"gcode_start\",\"confirmed\":%s,\"cached\":%s,\"external\":%s,\"after_velocity\":%s,"
+           "\"after_velocity_target\":%.3f,\"ok\":%s}\n",
+           confirmed ? "true" : "false", cached ? "true" : "false", external ? "true" : "false",
+           velocity ? "true" : "false", after_velocity, ok ? "true" : "false");
+    return ok;
+}
+
+/**
+ * @brief 等待执行任务执行完累计executed条命令
+ */
+static bool bench_wait_executed(gcode_controller_t* controller, uint32_t executed) {
+    gcode_queue_stats_t stats;
+    for (int waited = 0; waited < BENCH_ABORT_WAIT_MS; waited += portTICK_PERIOD_MS) {
+        if (gcode_get_queue_stats(controller, &stats) && stats.executed >= executed) {
+            return stats.executed == executed;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+/**
+ * @brief 等待轨迹发生器开始输出
+ */
+static bool bench_wait_trajectory_active(gcode_controller_t* controller) {
+    for (int waited = 0; waited < BENCH_ABORT_WAIT_MS; waited += portTICK_PERIOD_MS) {
+        if (trajectory_generator_is_active(controller->trajectory)) {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+/**
+ * @brief 带运动队列、启用轨迹的独立控制器，约束收紧使每段运动持续约1秒；编码器由注入任务提供（从0度开始）
+ * @return 失败返回NULL
+ */
+static gcode_controller_t* bench_slow_gcode_init(const gcode_controller_config_t* config, uint16_t depth,
+                                                 bench_encoder_feed_t* feed) {
+    gcode_controller_config_t slow_config = *config;
+    slow_config.motion_queue_depth = depth;
+    slow_config.use_trajectory = true;
+    slow_config.trajectory_rate_hz = TRAJECTORY_MAX_RATE_HZ;
+    slow_config.trajectory_profile = TRAJECTORY_PROFILE_S_CURVE;
+    slow_config.trajectory_limits = (trajectory_limits_t){
+        .max_velocity = 90.0f, .max_acceleration = 900.0f, .max_jerk = 9000.0f
+    };
+    gcode_controller_t* controller = gcode_controller_init(&slow_config);
+    if (!controller) {
+        ESP_LOGE(TAG, "G代码控制器初始化失败");
+        return NULL;
+    }
+
+    feed->motor = motor_registry_get(0)->controller;
+    feed->running = true;
+    feed->stopped = false;
+    bench_encoder_set(feed, 0.0);
+    if (xTaskCreate(bench_encoder_feed_task, "bench_encoder", BENCH_ENCODER_STACK_SIZE, feed,
+                    MOTOR_TASK_PRIORITY_UART, NULL) != pdPASS) {
+        gcode_controller_deinit(controller);
+        return NULL;
+    }
+    return controller;
+}
+
+static void bench_slow_gcode_deinit(gcode_controller_t* controller, bench_encoder_feed_t* feed) {
+    feed->running = false;
+    while (!feed->stopped) {
+        vTaskDelay(1);
+    }
+    gcode_controller_deinit(controller);
+}
+
+/**
+ * @brief 轨迹中止检查：运动中非G代码来源改写设定点（HTTP设置模式）时设定点流立即停止、排队命令被丢弃；
+ *        M0不排在运动之后，中止当前轨迹并清空队列后执行失能
+ * @return 两种停止都在BENCH_ABORT_STOP_MS内生效且计数符合预期返回true
+ */
+static bool bench_check_gcode_abort(const gcode_controller_config_t* config) {
+    static bench_encoder_feed_t feed;
+    gcode_controller_t* controller = bench_slow_gcode_init(config, BENCH_ABORT_QUEUE_DEPTH, &feed);
+    if (!controller) {
+        return false;
+    }
+    char axis = motor_registry_get(0)->axis_letter;
+    const trajectory_stats_t* stats = &controller->trajectory->stats;
+    int saved = bench_quiet_begin();
+
+    // 斜坡运动到0度，编码器确认后的运动由轨迹执行；第一段运动中改写设定点，后两条被丢弃
+    bench_gcode_target(controller, "G90\nG1 %c0\n", axis);
+    bool started = bench_wait_executed(controller, 2);
+    bench_gcode_target(controller, "G1 %c90\nG1 %c180\n", axis);
+    bench_gcode_target(controller, "G1 %c270\n", axis);
+    started = started && bench_wait_trajectory_active(controller);
+    uint32_t aborted = stats->moves_aborted;
+    int64_t begin_us = esp_timer_get_time();
+    motor_control_set_position_mode(feed.motor);
+    int64_t external_us = esp_timer_get_time() - begin_us;
+    bool external = started && !trajectory_generator_is_active(controller->trajectory) &&
+                    stats->moves_aborted == aborted + 1 && controller->queue_stats.flushed == 2 &&
+                    external_us < BENCH_ABORT_STOP_MS * 1000 && bench_wait_executed(controller, 3);
+
+    // 中止后起点未知：斜坡运动到90度并经编码器确认，之后的运动由轨迹执行；运动中提交M0
+    bench_gcode_target(controller, "G1 %c90\n", axis);
+    started = bench_wait_executed(controller, 4);
+    bench_encoder_set(&feed, 90.0);
+    bench_gcode_target(controller, "G1 %c180\nG1 %c270\n", axis);
+    started = started && bench_wait_trajectory_active(controller);
+    aborted = stats->moves_aborted;
+    begin_us = esp_timer_get_time();
+    bool submitted = gcode_execute_command(controller, "M0") == GCODE_RESULT_OK;
+    int64_t m0_us = esp_timer_get_time() - begin_us;
+    bool m0 = started && submitted && !trajectory_generator_is_active(controller->trajectory) &&
+              stats->moves_aborted == aborted + 1 && controller->queue_stats.flushed == 3 &&
+              m0_us < BENCH_ABORT_STOP_MS * 1000 && bench_wait_executed(controller, 6) &&
+              !motor_control_is_enabled(feed.motor);
+
+    // 恢复使能，后续检查与基准不受影响
+    gcode_execute_command(controller, "M1");
+    bench_wait_executed(controller, 7);
+
+    bench_quiet_end(saved);
+    bench_slow_gcode_deinit(controller, &feed);
+
+    bool ok = external && m0;
+    printf("{\"check\":\"gcode_abort\",\"external\":%s,\"external_us\":%lld,\"m0\":%s,\"m0_us\":%lld,"
+           "\"ok\":%s}\n",
+           external ? "true" : "false", (long long)external_us, m0 ? "true" : "false", (long long)m0_us,
+           ok ? "true" : "false");
+    return ok;
+}
+
+/**
+ * @brief 程序提交背压检查：运动队列满时gcode_submit_program立即返回GCODE_RESULT_BUFFER_FULL（不计为拒绝），
+ *        停在行边界上；队列腾出空位后从该处继续提交，每行恰好执行或被丢弃一次
+ * @return 提交不阻塞且续传结果符合预期返回true
+ */
+static bool bench_check_gcode_backpressure(const gcode_controller_config_t* config) {
+    static bench_encoder_feed_t feed;
+    gcode_controller_t* controller = bench_slow_gcode_init(config, BENCH_BACKPRESSURE_DEPTH, &feed);
+    if (!controller) {
+        return false;
+    }
+    char axis = motor_registry_get(0)->axis_letter;
+    int saved = bench_quiet_begin();
+
+    // 斜坡运动到0度，编码器确认后第一行由轨迹执行（约1秒），其余行填满队列
+    bench_gcode_target(controller, "G90\nG1 %c0\n", axis);
+    bool started = bench_wait_executed(controller, 2);
+    char program[64];
+    int length = snprintf(program, sizeof(program), "G1 %c90\nG1 %c180\nG1 %c270\nG1 %c300\n",
+                          axis, axis, axis, axis);
+    uint32_t rejected = controller->queue_stats.rejected;
+    size_t consumed = 0;
+    int64_t begin_us = esp_timer_get_time();
+    gcode_result_t result = gcode_submit_program(controller, program, (size_t)length, &consumed);
+    int64_t submit_us = esp_timer_get_time() - begin_us;
+    bool deferred = started && result == GCODE_RESULT_BUFFER_FULL && consumed > 0 && consumed < (size_t)length &&
+                    program[consumed - 1] == '\n' && controller->queue_stats.rejected == rejected &&
+                    submit_us < BENCH_ABORT_STOP_MS * 1000;
+
+    // 中止当前运动并清空队列后，剩余行从consumed处续传（起点未知，斜坡模式立即执行）
+    deferred = deferred && bench_wait_trajectory_active(controller);
+    motor_control_set_position_mode(feed.motor);
+    size_t offset = consumed;
+    for (int waited = 0; result == GCODE_RESULT_BUFFER_FULL && waited < BENCH_ABORT_WAIT_MS;
+         waited += portTICK_PERIOD_MS) {
+        vTaskDelay(1);
+        result = gcode_submit_program(controller, program + offset, (size_t)length - offset, &consumed);
+        offset += consumed;
+    }
+    gcode_queue_stats_t stats = {0};
+    for (int waited = 0; waited < BENCH_ABORT_WAIT_MS && stats.executed + stats.flushed < 6;
+         waited += portTICK_PERIOD_MS) {
+        vTaskDelay(1);
+        gcode_get_queue_stats(controller, &stats);
+    }
+    bool resumed = result == GCODE_RESULT_OK && offset == (size_t)length && stats.executed + stats.flushed == 6 &&
+                   stats.rejected == rejected && bench_angle_near(controller->commanded_angle[0], 300.0);
+
+    bench_quiet_end(saved);
+    bench_slow_gcode_deinit(controller, &feed);
+
+    bool ok = deferred && resumed;
+    printf("{\"check\":\"gcode_backpressure\",\"deferred\":%s,\"submit_us\":%lld,\"resumed\":%s,"
+           "\"flushed\":%lu,\"ok\":%s}\n",
+           deferred ? "true" : "false", (long long)submit_us, resumed ? "true" : "false",
+           (unsigned long)stats.flushed, ok ? "true" : "false");
+    return ok;
+}
+
+/**
+ * @brief 欠载计数检查：孤立的单条命令及间隔超过窗口的命令执行完排空队列不计，
+ *        窗口内连续到达的命令流排空计一次（无论执行任务在两条之间是否排空过）
+ * @return 欠载计数符合预期返回true
+ */
+static bool bench_check_gcode_underrun(const gcode_controller_config_t* config) {
+    gcode_controller_config_t underrun_config = *config;
+    underrun_config.motion_queue_depth = BENCH_ABORT_QUEUE_DEPTH;
+    underrun_config.use_trajectory = false;
+    underrun_config.underrun_window_ms = BENCH_UNDERRUN_WINDOW_MS;
+    gcode_controller_t* controller = gcode_controller_init(&underrun_config);
+    if (!controller) {
+        ESP_LOGE(TAG, "G代码控制器初始化失败");
+        return false;
+    }
+    int saved = bench_quiet_begin();
+
+    gcode_execute_command(controller, "G90");
+    bool isolated = bench_wait_executed(controller, 1) && controller->queue_stats.underruns == 0;
+    vTaskDelay(pdMS_TO_TICKS(BENCH_UNDERRUN_WINDOW_MS + 10));
+    gcode_execute_command(controller, "G90");
+    bool spaced = bench_wait_executed(controller, 2) && controller->queue_stats.underruns == 0;
+    vTaskDelay(pdMS_TO_TICKS(BENCH_UNDERRUN_WINDOW_MS + 10));
+    gcode_execute_command(controller, "G90");
+    gcode_execute_command(controller, "G90");
+    bool stream = bench_wait_executed(controller, 4) && controller->queue_stats.underruns == 1;
+
+    bench_quiet_end(saved);
+    gcode_controller_deinit(controller);
+
+    bool ok = isolated && spaced && stream;
+    printf("{\"check\":\"gcode_underrun\",\"isolated\":%s,\"spaced\":%s,\"stream\":%s,\"ok\":%s}\n",
+           isolated ? "true" : "false", spaced ? "true" : "false", stream ? "true" : "false",
+           ok ? "true" : "false");
+    return ok;
+}
+
+// ====================================================================================
+// --- ISO-TP回环 ---
+// ====================================================================================
+
+// 模拟TWAI总线：接收端的流控帧经回调记录在这里，由基准侧的分段发送端读取
+typedef struct {
+    uint8_t flow_control[CAN_ISOTP_FRAME_SIZE]; // 最近一帧流控帧
+    uint32_t flow_controls;             // 收到的流控帧数
+    uint32_t protocol_errors;           // 发送端发现的流控异常（缺帧、非CTS、填充错误）
+} bench_isotp_bus_t;
+
+static void bench_isotp_flow_control(const uint8_t* data, void* context) {
+    bench_isotp_bus_t* bus = (bench_isotp_bus_t*)context;
+    memcpy(bus->flow_control, data, CAN_ISOTP_FRAME_SIZE);
+    bus->flow_controls++;
+}
+
+/**
+ * @brief 发送端等待流控帧：必须恰好新到一帧CTS，且填充为0xCC
+ * @return 流控帧给出的块大小BS
+ */
+static uint8_t bench_isotp_expect_cts(bench_isotp_bus_t* bus, uint32_t* seen) {
+    bool ok = bus->flow_controls == *seen + 1 &&
+              bus->flow_control[0] == ((CAN_ISOTP_FLOW_CONTROL << 4) | CAN_ISOTP_FC_CONTINUE);
+    for (int i = 3; i < CAN_ISOTP_FRAME_SIZE; i++) {
+        ok = ok && bus->flow_control[i] == CAN_ISOTP_PADDING;
+    }
+    if (!ok) {
+        bus->protocol_errors++;
+    }
+    *seen = bus->flow_controls;
+    return bus->flow_control[1];
+}
+
+/**
+ * @brief 基准侧分段发送：短消息发单帧，长消息发首帧后按流控帧的BS分块发送连续帧
+ * @param skip_sequence 非0时跳过该序号的连续帧（制造序号错误）
+ * @param gap_us 首帧之后、第一个连续帧之前的额外延迟（制造N_Cr超时）
+ * @return 接收端完成重组且内容与发送一致返回true
+ */
+static bool bench_isotp_send(can_isotp_rx_t* rx, const can_isotp_config_t* config, bench_isotp_bus_t* bus,
+                             const uint8_t* message, uint16_t length, int64_t* now_us,
+                             uint32_t skip_sequence, int64_t gap_us) {
+    uint8_t frame[CAN_ISOTP_FRAME_SIZE];
+    bool complete;
+
+    if (length <= 7) {
+        frame[0] = (CAN_ISOTP_SINGLE_FRAME << 4) | length;
+        memcpy(&frame[1], message, length);
+        complete = can_isotp_receive(rx, config, frame, 1 + length, *now_us);
+    } else {
+        uint32_t seen = bus->flow_controls;
+        frame[0] = (CAN_ISOTP_FIRST_FRAME << 4) | (length >> 8);
+        frame[1] = length & 0xFF;
+        memcpy(&frame[2], message, 6);
+        complete = can_isotp_receive(rx, config, frame, CAN_ISOTP_FRAME_SIZE, *now_us);
+        uint8_t block_size = bench_isotp_expect_cts(bus, &seen);
+        *now_us += gap_us;
+
+        uint16_t offset = 6;
+        uint32_t sequence = 1;
+        uint8_t in_block = 0;
+        while (offset < length && !complete) {
+            uint16_t chunk = length - offset < 7 ? length - offset : 7;
+            *now_us += BENCH_ISOTP_FRAME_US;
+            if (sequence != skip_sequence) {
+                frame[0] = (CAN_ISOTP_CONSECUTIVE_FRAME << 4) | (sequence & 0x0F);
+                memcpy(&frame[1], message + offset, chunk);
+                complete = can_isotp_receive(rx, config, frame, 1 + chunk, *now_us);
+            }
+            offset += chunk;
+            sequence++;
+            if (block_size > 0 && ++in_block == block_size && offset < length) {
+                in_block = 0;
+                block_size = bench_isotp_expect_cts(bus, &seen);
+            }
+        }
+        // 不分块时整条消息只应有首帧后的一个流控帧
+        if (bus->flow_controls != seen) {
+            bus->protocol_errors++;
+        }
+    }
+    *now_us += BENCH_ISOTP_FRAME_US;
+    return complete && rx->received_length == length && memcmp(rx->buffer, message, length) == 0 &&
+           rx->buffer[length] == '\0';
+}
+
+/**
+ * @brief 发送端读取新到的流控帧
+ * @return 恰好新到一帧时返回其流控状态，否则返回-1
+ */
+static int bench_isotp_new_flow_status(bench_isotp_bus_t* bus, uint32_t* seen) {
+    int status = bus->flow_controls == *seen + 1 ? (bus->flow_control[0] & 0x0F) : -1;
+    *seen = bus->flow_controls;
+    return status;
+}
+
+/**
+ * @brief 接收端忙检查：占用期间新消息的首帧收到FC WAIT并按间隔重发，解除占用后回复CTS、消息正常完成；
+ *        FC WAIT达到N_WFTmax后以FC OVFLW拒绝
+ * @return 流控序列与统计计数符合预期返回true
+ */
+static bool bench_isotp_check_held(can_isotp_rx_t* rx, const can_isotp_config_t* config, bench_isotp_bus_t* bus,
+                                   const uint8_t* message, int64_t* now_us) {
+    const uint16_t length = 100;
+    uint8_t frame[CAN_ISOTP_FRAME_SIZE];
+    uint32_t seen = bus->flow_controls;
+    uint32_t completed = rx->messages_completed;
+
+    can_isotp_hold(rx);
+    frame[0] = (CAN_ISOTP_FIRST_FRAME << 4) | (length >> 8);
+    frame[1] = length & 0xFF;
+    memcpy(&frame[2], message, 6);
+    bool ok = !can_isotp_receive(rx, config, frame, CAN_ISOTP_FRAME_SIZE, *now_us) &&
+              bench_isotp_new_flow_status(bus, &seen) == CAN_ISOTP_FC_WAIT;
+    *now_us += BENCH_ISOTP_FRAME_US;
+    can_isotp_poll(rx, config, *now_us);
+    ok = ok && bus->flow_controls == seen;
+    *now_us += (int64_t)CAN_ISOTP_WAIT_INTERVAL_MS * 1000;
+    can_isotp_poll(rx, config, *now_us);
+    ok = ok && bench_isotp_new_flow_status(bus, &seen) == CAN_ISOTP_FC_WAIT;
+
+    // 解除占用：暂存的首帧此时回复CTS，发送端继续发连续帧
+    ok = ok && !can_isotp_release(rx, config, *now_us) &&
+         bench_isotp_new_flow_status(bus, &seen) == CAN_ISOTP_FC_CONTINUE;
+    bool complete = false;
+    for (uint16_t offset = 6, sequence = 1; offset < length && !complete; offset += 7, sequence++) {
+        uint16_t chunk = length - offset < 7 ? length - offset : 7;
+        *now_us += BENCH_ISOTP_FRAME_US;
+        frame[0] = (CAN_ISOTP_CONSECUTIVE_FRAME << 4) | (sequence & 0x0F);
+        memcpy(&frame[1], message + offset, chunk);
+        complete = can_isotp_receive(rx, config, frame, 1 + chunk, *now_us);
+    }
+    ok = ok && complete && rx->received_length == length && memcmp(rx->buffer, message, length) == 0 &&
+         rx->messages_completed == completed + 1;
+
+    // 一直不解除占用：达到N_WFTmax后拒绝
+    can_isotp_hold(rx);
+    frame[0] = (CAN_ISOTP_FIRST_FRAME << 4) | (length >> 8);
+    frame[1] = length & 0xFF;
+    memcpy(&frame[2], message, 6);
+    can_isotp_receive(rx, config, frame, CAN_ISOTP_FRAME_SIZE, *now_us);
+    uint32_t waits = bench_isotp_new_flow_status(bus, &seen) == CAN_ISOTP_FC_WAIT;
+    int status = -1;
+    for (int i = 0; i < CAN_ISOTP_MAX_WAIT_FRAMES; i++) {
+        *now_us += (int64_t)CAN_ISOTP_WAIT_INTERVAL_MS * 1000;
+        can_isotp_poll(rx, config, *now_us);
+        status = bench_isotp_new_flow_status(bus, &seen);
+        waits += status == CAN_ISOTP_FC_WAIT;
+    }
+    ok = ok && waits == CAN_ISOTP_MAX_WAIT_FRAMES && status == CAN_ISOTP_FC_OVERFLOW && rx->busy_rejects == 1 &&
+         !can_isotp_release(rx, config, *now_us) && !rx->in_progress && bus->flow_controls == seen;
+    *now_us += BENCH_ISOTP_FRAME_US;
+    return ok;
+}
+
+typedef struct {
+    can_isotp_rx_t* rx;
+    const uint8_t* frames;              // 预先分好的首帧+连续帧，每帧8字节
+    uint32_t count;
+    uint32_t index;                     // 跨调用保持帧位置，消息不被截断
+    int64_t now_us;
+} bench_isotp_t;
+
+static void bench_isotp_receive(void* context, uint32_t iterations) {
+    bench_isotp_t* set = (bench_isotp_t*)context;
+    static const can_isotp_config_t config = {0};
+    uint32_t completed = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        set->now_us += BENCH_ISOTP_FRAME_US;
+        completed += can_isotp_receive(set->rx, &config, &set->frames[set->index * CAN_ISOTP_FRAME_SIZE],
+                                       CAN_ISOTP_FRAME_SIZE, set->now_us);
+        if (++set->index == set->count) {
+            set->index = 0;
+        }
+    }
+    g_size_sink = completed;
+}
+
+/**
+ * @brief ISO-TP回环检查：单帧、不分块/分块的多帧、序号回绕、序号错误与N_Cr超时，随后测长消息重组吞吐
+ * @return 各场景结果与统计计数均符合预期返回true
+ */
+static bool bench_check_isotp(void) {
+    static can_isotp_rx_t rx;
+    static uint8_t message[BENCH_ISOTP_LONG];
+    uint32_t rng = BENCH_RNG_SEED;
+    for (uint32_t i = 0; i < sizeof(message); i++) {
+        message[i] = (uint8_t)bench_rand(&rng);
+    }
+
+    bench_isotp_bus_t bus = {0};
+    can_isotp_config_t config = { .block_size = 0, .send_flow_control = bench_isotp_flow_control, .context = &bus };
+    int64_t now_us = 0;
+    can_isotp_reset(&rx);
+
+    bool single = bench_isotp_send(&rx, &config, &bus, message, 5, &now_us, 0, 0);
+    bool unblocked = bench_isotp_send(&rx, &config, &bus, message, 100, &now_us, 0, 0);
+    config.block_size = 2;
+    bool blocked = bench_isotp_send(&rx, &config, &bus, message, 100, &now_us, 0, 0);
+    config.block_size = 8;
+    bool wrapped = bench_isotp_send(&rx, &config, &bus, message, BENCH_ISOTP_LONG, &now_us, 0, 0);
+    uint32_t flow_controls = bus.flow_controls;
+    uint32_t protocol_errors = bus.protocol_errors;
+
+    // 故障场景：丢一个连续帧应报序号错误（其后的连续帧也作为意外帧计数）；首帧后超过N_Cr才发连续帧应超时丢弃
+    config.block_size = 0;
+    bool sequence_rejected = !bench_isotp_send(&rx, &config, &bus, message, 100, &now_us, 3, 0) &&
+                             rx.sequence_errors > 0 && !rx.in_progress;
+    bool timeout_rejected = !bench_isotp_send(&rx, &config, &bus, message, 100, &now_us, 0,
+                                              (int64_t)CAN_ISOTP_RX_TIMEOUT_MS * 1000 + 1) &&
+                            rx.timeouts == 1;
+    // 超时后接收端恢复，下一条消息正常完成
+    bool recovered = bench_isotp_send(&rx, &config, &bus, message, 100, &now_us, 0, 0);
+    bool held = bench_isotp_check_held(&rx, &config, &bus, message, &now_us);
+
+    bool ok = single && unblocked && blocked && wrapped && sequence_rejected && timeout_rejected && recovered &&
+              held && protocol_errors == 0 && rx.messages_completed == 6;
+    printf("{\"check\":\"isotp\",\"single\":%s,\"unblocked\":%s,\"blocked\":%s,\"wrapped\":%s,"
+           "\"sequence_rejected\":%s,\"timeout_rejected\":%s,\"recovered\":%s,\"held\":%s,\"flow_controls\":%lu,"
+           "\"protocol_errors\":%lu,\"messages_completed\":%lu,\"ok\":%s}\n",
+           single ? "true" : "false", unblocked ? "true" : "false", blocked ? "true" : "false",
+           wrapped ? "true" : "false", sequence_rejected ? "true" : "false",
+           timeout_rejected ? "true" : "false", recovered ? "true" : "false", held ? "true" : "false",
+           (unsigned long)flow_controls,
+           (unsigned long)protocol_errors, (unsigned long)rx.messages_completed, ok ? "true" : "false");
+
+    // 吞吐：长消息预先分帧后反复重组（回放配置，不发流控帧）
+    static uint8_t frames[(BENCH_ISOTP_LONG / 7 + 2) * CAN_ISOTP_FRAME_SIZE];
+    bench_isotp_t set = { .rx = &rx, .frames = frames, .count = 0 };
+    uint8_t* frame = frames;
+    frame[0] = (CAN_ISOTP_FIRST_FRAME << 4) | (BENCH_ISOTP_LONG >> 8);
+    frame[1] = BENCH_ISOTP_LONG & 0xFF;
+    memcpy(&frame[2], message, 6);
+    set.count++;
+    for (uint32_t offset = 6, sequence = 1; offset < BENCH_ISOTP_LONG; offset += 7, sequence++) {
+        frame = &frames[set.count++ * CAN_ISOTP_FRAME_SIZE];
+        uint32_t chunk = BENCH_ISOTP_LONG - offset < 7 ? BENCH_ISOTP_LONG - offset : 7;
+        memset(frame, CAN_ISOTP_PADDING, CAN_ISOTP_FRAME_SIZE);
+        frame[0] = (CAN_ISOTP_CONSECUTIVE_FRAME << 4) | (sequence & 0x0F);
+        memcpy(&frame[1], message + offset, chunk);
+    }
+    can_isotp_reset(&rx);
+    bench_report("can_isotp_receive", "synthetic", bench_isotp_receive, &set, set.count, CAN_ISOTP_FRAME_SIZE);
+    return ok;
+}
+
+// ====================================================================================
+// --- 轨迹规划检查 ---
+// ====================================================================================
+
+/**
+ * @brief 检查单个规划：段内加加速度、采样得到的速度/加速度峰值不超过约束，
+ *        S曲线各段加速度连续，按段积分的终点行程等于目标且终点静止
+ * @return 相对误差（超过BENCH_PLAN_TOL即违反），规划失败返回INFINITY
+ */
+static double bench_check_plan(trajectory_profile_t profile, const trajectory_limits_t* limits,
+                               float start, float target) {
+    trajectory_plan_t plan;
+    if (!trajectory_plan_move(&plan, start, target, profile, limits)) {
+        return INFINITY;
+    }
+    double distance = fabs((double)target - start);
+    double worst = 0.0;
+
+    // 按段积分，不经过trajectory_sample（其在总时长处直接返回终点）
+    double position = 0.0;
+    double velocity = 0.0;
+    double acceleration = 0.0;
+    for (uint8_t i = 0; i < plan.segment_count; i++) {
+        const trajectory_segment_t* seg = &plan.segments[i];
+        if (profile == TRAJECTORY_PROFILE_S_CURVE) {
+            worst = fmax(worst, fabs(seg->start_acceleration - acceleration) / limits->max_acceleration);
+            worst = fmax(worst, fabs(seg->jerk) / limits->max_jerk - 1.0);
+        }
+        double t = seg->duration;
+        position = seg->start_position + seg->start_velocity * t + seg->start_acceleration * t * t * 0.5 +
+                   seg->jerk * t * t * t / 6.0;
+        velocity = seg->start_velocity + seg->start_acceleration * t + seg->jerk * t * t * 0.5;
+        acceleration = seg->start_acceleration + seg->jerk * t;
+    }
+    if (distance > 0.0) {
+        worst = fmax(worst, fabs(position - distance) / distance);
+        worst = fmax(worst, fabs(velocity) / limits->max_velocity);
+    }
+    if (profile == TRAJECTORY_PROFILE_S_CURVE) {
+        worst = fmax(worst, fabs(acceleration) / limits->max_acceleration);
+    }
+
+    // 采样：速度不反向、不超过速度/加速度约束
+    for (uint32_t k = 0; k <= BENCH_PLAN_SAMPLES; k++) {
+        float v, a;
+        trajectory_sample(&plan, plan.total_time * k / BENCH_PLAN_SAMPLES, NULL, &v, &a);
+        worst = fmax(worst, fabs(v) / limits->max_velocity - 1.0);
+        worst = fmax(worst, -v * plan.direction / limits->max_velocity);
+        worst = fmax(worst, fabs(a) / limits->max_acceleration - 1.0);
+    }
+    return worst;
+}
+
+/**
+ * @brief 轨迹规划检查：梯形与S曲线，短行程（三角形/达不到最大加速度）到长行程（含匀速段），两个方向
+ * @return 所有规划都在允许误差内返回true
+ */
+static bool bench_check_trajectory(void) {
+    static const trajectory_limits_t limits[] = {
+        { .max_velocity = 360.0f, .max_acceleration = 720.0f, .max_jerk = 7200.0f },    // 设备默认约束
+        { .max_velocity = 90.0f, .max_acceleration = 5000.0f, .max_jerk = 1000.0f },    // 加速度永远达不到上限
+    };
+    static const float distances[] = { 0.001f, 0.5f, 10.0f, 90.0f, 180.0f, 360.0f, 3600.0f, 1e5f };
+    static const trajectory_profile_t profiles[] = { TRAJECTORY_PROFILE_TRAPEZOIDAL, TRAJECTORY_PROFILE_S_CURVE };
+    double worst[2] = {0.0, 0.0};
+    uint32_t plans = 0;
+
+    for (uint32_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        for (uint32_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++) {
+            for (uint32_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++) {
+                double forward = bench_check_plan(profiles[p], &limits[l], 12.5f, 12.5f + distances[d]);
+                double backward = bench_check_plan(profiles[p], &limits[l], -7.0f, -7.0f - distances[d]);
+                worst[p] = fmax(worst[p], fmax(forward, backward));
+                plans += 2;
+            }
+        }
+    }
+    // 原地不动与无效约束
+    trajectory_plan_t plan;
+    trajectory_limits_t invalid = { .max_velocity = 360.0f, .max_acceleration = 720.0f, .max_jerk = 0.0f };
+    bool edges_ok = bench_check_plan(TRAJECTORY_PROFILE_S_CURVE, &limits[0], 30.0f, 30.0f) == 0.0 &&
+                    !trajectory_plan_move(&plan, 0.0f, 10.0f, TRAJECTORY_PROFILE_S_CURVE, &invalid) &&
+                    trajectory_plan_move(&plan, 0.0f, 10.0f, TRAJECTORY_PROFILE_TRAPEZOIDAL, &invalid);
+
+    bool ok = worst[0] <= BENCH_PLAN_TOL && worst[1] <= BENCH_PLAN_TOL && edges_ok;
+    printf("{\"check\":\"trajectory_plan\",\"plans\":%lu,\"trapezoidal_worst\":%.3g,\"s_curve_worst\":%.3g,"
+           "\"edges\":%s,\"tolerance\":%g,\"ok\":%s}\n",
+           (unsigned long)plans, worst[0], worst[1], edges_ok ? "true" : "false", BENCH_PLAN_TOL,
+           ok ? "true" : "false");
+    return ok;
+}
+
+// ====================================================================================
+// --- 指标直方图输出检查 ---
+// ====================================================================================
+
+// 模拟/metrics的分块写入器：满块时"发送"（计数并累计字节），行超过整块时计为丢弃
+typedef struct {
+    char buffer[BENCH_METRICS_CHUNK];
+    size_t used;
+    uint32_t chunks;
+    uint32_t lines;
+    uint32_t dropped;
+    size_t bytes;
+} bench_metrics_writer_t;
+
+static void bench_metrics_flush(bench_metrics_writer_t* writer) {
+    if (writer->used > 0) {
+        writer->chunks++;
+        writer->bytes += writer->used;
+    }
+    writer->used = 0;
+}
+
+static bool bench_metrics_write(const char* text, size_t length, void* context) {
+    bench_metrics_writer_t* writer = (bench_metrics_writer_t*)context;
+    if (length > sizeof(writer->buffer) - writer->used) {
+        bench_metrics_flush(writer);
+    }
+    if (length > sizeof(writer->buffer)) {
+        writer->dropped++;
+        return false;
+    }
+    memcpy(writer->buffer + writer->used, text, length);
+    writer->used += length;
+    writer->lines += text[length - 1] == '\n';
+    return true;
+}
+
+/**
+ * @brief 直方图导出检查：四个延迟阶段直方图（各桶计数取最大位数）经1KB分块写入器输出，
+ *        每个直方图都应完整输出bound_count+3行，单个直方图长于一个分块也不丢行
+ * @return 行数符合且没有丢弃返回true
+ */
+static bool bench_check_metrics(void) {
+    static bench_metrics_writer_t writer;
+    memset(&writer, 0, sizeof(writer));
+    uint32_t expected_lines = 0;
+    size_t largest = 0;
+    bool formatted = true;
+
+    for (int stage = 0; stage < MOTOR_LATENCY_STAGES; stage++) {
+        motor_metrics_histogram_t histogram = g_motor_metrics.latency_us[stage];
+        for (uint8_t i = 0; i <= histogram.bound_count; i++) {
+            histogram.buckets[i] = UINT32_MAX / (MOTOR_METRICS_MAX_BUCKETS + 1);
+        }
+        histogram.sum = UINT32_MAX;
+        char labels[32];
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", MOTOR_LATENCY_STAGE_NAMES[stage]);
+        size_t before = writer.bytes + writer.used;
+        formatted &= motor_metrics_format_histogram(bench_metrics_write, &writer, "motor_command_latency_microseconds",
+                                                    labels, &histogram);
+        size_t length = writer.bytes + writer.used - before;
+        largest = length > largest ? length : largest;
+        expected_lines += histogram.bound_count + 3;
+    }
+    bench_metrics_flush(&writer);
+
+    bool ok = formatted && writer.dropped == 0 && writer.lines == expected_lines && largest > BENCH_METRICS_CHUNK;
+    printf("{\"check\":\"metrics_histogram\",\"lines\":%lu,\"expected_lines\":%lu,\"chunks\":%lu,"
+           "\"largest_histogram_bytes\":%lu,\"dropped\":%lu,\"ok\":%s}\n",
+           (unsigned long)writer.lines, (unsigned long)expected_lines, (unsigned long)writer.chunks,
+           (unsigned long)largest, (unsigned long)writer.dropped, ok ? "true" : "false");
+    return ok;
+}
+
+// ====================================================================================
+// --- 入口 ---
+// ====================================================================================
+
+bool host_bench_run(const char* recorded_program, size_t length) {
+    if (motor_registry_count() == 0) {
+        ESP_LOGE(TAG, "没有已注册的电机");
+        return false;
+    }
+
+    // 直接执行模式（无运动队列、无轨迹）：每帧的解析与命令发送都在调用线程内完成
+    gcode_controller_config_t gcode_config = {
+        .response_buffer = g_gcode_response,
+        .response_buffer_size = sizeof(g_gcode_response),
+        .motion_queue_depth = 0,
+        .use_trajectory = false
+    };
+    gcode_controller_t* controller = gcode_controller_init(&gcode_config);
+    if (!controller) {
+        ESP_LOGE(TAG, "G代码控制器初始化失败");
+        return false;
+    }
+
+    // 基准不启动UART监听，无法完成上电握手：直接标记就绪，使G代码校验放行
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_control_mark_ready(motor_registry_get(i)->controller);
+    }
+
+    bench_build_synthetic(&g_synthetic);
+    bench_capture_recorded(&g_recorded);
+
+    // 被测路径中的ESP_LOGI只保留级别判断，不做格式化输出
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    printf("{\"meta\":\"host_bench\",\"axes\":%u,\"synthetic_frames\":%lu,\"recorded_frames\":%lu,"
+           "\"recorded_program_bytes\":%lu}\n",
+           (unsigned)motor_registry_count(), (unsigned long)g_synthetic.count,
+           (unsigned long)g_recorded.count, (unsigned long)(recorded_program ? length : 0));
+
+    bench_report("send_serial_can_frame", "synthetic", bench_send_frame, NULL, motor_registry_count(), BENCH_FRAME_SIZE);
+
+    bench_report("parse_motor_can_data", "synthetic", bench_parse_frame, &g_synthetic, g_synthetic.count, BENCH_FRAME_SIZE);
+    if (g_recorded.count > 0) {
+        bench_report("parse_motor_can_data", "recorded", bench_parse_frame, &g_recorded, g_recorded.count, BENCH_FRAME_SIZE);
+    } else {
+        ESP_LOGW(TAG, "未从模拟驱动器录到响应帧，跳过录制流量基准");
+    }
+
+    static bench_units_t typical_angles;
+    static bench_units_t huge_angles;
+    bench_build_units(&typical_angles, 720.0f);
+    bench_build_units(&huge_angles, 1e9f);
+    bool units_ok = bench_check_units(&typical_angles, &huge_angles);
+    bool start_ok = bench_check_gcode_start(&gcode_config);
+    bool abort_ok = bench_check_gcode_abort(&gcode_config);
+    bool backpressure_ok = bench_check_gcode_backpressure(&gcode_config);
+    bool underrun_ok = bench_check_gcode_underrun(&gcode_config);
+    bool isotp_ok = bench_check_isotp();
+    bool frames_ok = bench_check_gcode_frames(&gcode_config);
+    bool parser_ok = bench_check_parser();
+    bool trajectory_ok = bench_check_trajectory();
+    bool metrics_ok = bench_check_metrics();
+    bench_report("motor_units_angle_to_position", "typical", bench_angle_to_position, &typical_angles,
+                 BENCH_UNIT_SAMPLES, sizeof(float));
+    bench_report("motor_units_angle_to_position", "huge", bench_angle_to_position, &huge_angles,
+                 BENCH_UNIT_SAMPLES, sizeof(float));
+    bench_report("motor_units_position_to_angle", "typical", bench_position_to_angle, &typical_angles,
+                 BENCH_UNIT_SAMPLES, sizeof(float));
+
+    bench_report("ieee754_bytes_to_float", "synthetic", bench_bytes_to_float, &g_synthetic, g_synthetic.count, 4);
+    if (g_recorded.count > 0) {
+        bench_report("ieee754_bytes_to_float", "recorded", bench_bytes_to_float, &g_recorded, g_recorded.count, 4);
+    }
+
+    static char synthetic_program[BENCH_SYNTHETIC_GCODE_LINES * 24];
+    size_t synthetic_length = bench_build_synthetic_program(synthetic_program, sizeof(synthetic_program));
+    bench_run_parser(synthetic_program, synthetic_length);
+    bench_run_gcode("synthetic", controller, synthetic_program, synthetic_length);
+    bench_run_gcode_lines(controller, synthetic_program, synthetic_length);
+    if (recorded_program && length > 0) {
+        bench_run_gcode("recorded", controller, recorded_program, length);
+    }
+
+    // 状态JSON使用解析基准留下的状态（各字段均已填充）
+    size_t json_length = strlen(get_motor_status_json(0));
+    bench_report("get_motor_status_json", "synthetic", bench_status_json, NULL, motor_registry_count(), json_length);
+
+    motor_status_t* status = &motor_registry_get(0)->controller->status;
+    size_t delta_length = strlen(get_motor_status_delta_json(0, bench_touch_position(status)));
+    bench_report("get_motor_status_delta_json", "synthetic", bench_status_delta_json, status, 1, delta_length);
+
+    gcode_controller_deinit(controller);
+    return units_ok && start_ok && abort_ok && backpressure_ok && underrun_ok && isotp_ok && frames_ok && parser_ok && trajectory_ok && metrics_ok;
+}
+
+#endif // CONFIG_HOST_BENCHMARK
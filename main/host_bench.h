@@ -0,0 +1,25 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 运行协议编解码热点路径基准（linux目标，CONFIG_HOST_BENCHMARK）
+ * 每项基准向标准输出打印一行JSON（ns/op、每次操作的分配次数/字节、吞吐量），便于跨提交对比
+ * 电机须已通过注册表注册（接驱动器模拟器），UART监听任务不要启动：响应帧由基准直接喂给解析函数
+ * @param recorded_program 录制的G代码程序文本（作为gcode_process_can_frame的录制流量，可为NULL）
+ * @param length 程序长度
+ * @return 全部基准运行完成返回true
+ */
+bool host_bench_run(const char* recorded_program, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_BENCH_H
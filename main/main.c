@@ -5,164 +5,131 @@
 #include "nvs_flash.h"
 
 #include "motor_control.h"
+#include "motor_units.h"
+#include "motor_registry.h"
 #include "wifi_http_server.h"
 #include "uart_monitor.h"
 #include "can_monitor.h"
 #include "gcode_unified_control.h"
 #include "motor_status_scheduler.h"
-
-// 函数声明
-float angle_to_position(float angle_degrees);
-float external_velocity_to_internal(float external_velocity);
-float external_torque_to_internal(float external_torque);
+#include "wire_trace.h"
+#include "flight_recorder.h"
+#include "motor_config.h"
 
 static const char *TAG = "MAIN";
 
 // 全局变量
-static motor_controller_t* motor_controller = NULL;
 static httpd_handle_t web_server = NULL;
-static uart_monitor_t* uart_monitor = NULL;
 static can_monitor_t* can_monitor = NULL;
-static motor_status_scheduler_t* status_scheduler = NULL;
 gcode_controller_t* g_gcode_controller = NULL; // G代码控制器（供CAN监听使用）
 static char gcode_response_buffer[512]; // G代码响应缓冲区
 
-// 角度映射参数
-#define GEAR_RATIO 19.2158f          // 外部减速比
-#define ANGLE_TO_POSITION_SCALE 8.0f // 0-8对应0-360度
-
 /**
- * @brief 角度转换为电机位置值
- * @param angle_degrees 输入角度(度) - 外部输出轴角度
- * @return 电机位置值 - 内部电机需要的位置值
+ * @brief 按运行时配置的CAN波特率选择TWAI时序（取值已由motor_config校验）
  */
-float angle_to_position(float angle_degrees) {
-    // 角度归一化到0-360度范围
-    while (angle_degrees < 0) angle_degrees += 360.0f;
-    while (angle_degrees >= 360.0f) angle_degrees -= 360.0f;
-    
-    // 外部角度转换为内部电机需要转的圈数
-    // 外部转angle_degrees度，内部需要转 angle_degrees * (减速比/360度)
-    float internal_rotations = (angle_degrees / 360.0f) * GEAR_RATIO;
-    
-    // 内部转换为位置值：每转1圈对应位置值8
-    float motor_position = internal_rotations * ANGLE_TO_POSITION_SCALE;
-    
-    return motor_position;
-}
-
-/**
- * @brief 外部速度转换为内部电机速度
- * @param external_velocity 外部期望速度 (r/s) - 输出轴转速
- * @return 内部电机需要的速度 (r/s)
- */
-float external_velocity_to_internal(float external_velocity) {
-    // 外部转1 r/s，内部需要转 减速比 r/s
-    return external_velocity * GEAR_RATIO;
-}
-
-/**
- * @brief 外部力矩转换为内部电机力矩  
- * @param external_torque 外部期望力矩 (Nm) - 输出轴力矩
- * @return 内部电机需要的力矩 (Nm)
- */
-float external_torque_to_internal(float external_torque) {
-    // 力矩转换系数：30Nm外部 -> 11Nm内部
-    // 转换系数 = 11/30 = 0.3667
-    return external_torque * 0.3667f;
+static twai_timing_config_t can_timing_config(uint32_t bitrate) {
+    switch (bitrate) {
+        case 125000:  return (twai_timing_config_t)TWAI_TIMING_CONFIG_125KBITS();
+        case 250000:  return (twai_timing_config_t)TWAI_TIMING_CONFIG_250KBITS();
+        case 1000000: return (twai_timing_config_t)TWAI_TIMING_CONFIG_1MBITS();
+        default:      return (twai_timing_config_t)TWAI_TIMING_CONFIG_500KBITS();
+    }
 }
 
 // 电机初始化任务
 void motor_init_task(void *pvParameters) {
-    // 电机配置
-    motor_driver_config_t motor_config = {
-        .uart_port = UART_NUM_1,    // 使用UART1
-        .txd_pin = GPIO_NUM_13,     // TXD引脚
-        .rxd_pin = GPIO_NUM_12,     // RXD引脚
-        .baud_rate = 115200,        // 波特率
-        .buf_size = 1024            // 缓冲区大小
+#if CONFIG_WIRE_TRACE
+    // 先于电机与CAN初始化开始抓包，记录上电后的全部收发
+    if (!wire_trace_init(CONFIG_WIRE_TRACE_BUFFER_KB * 1024)) {
+        ESP_LOGW(TAG, "线路抓包初始化失败");
+    }
+#endif
+
+    // 所有电机UART由一个共享的事件驱动监听任务接收
+    uart_monitor_config_t uart_config = {
+        .buf_size = 256,                // 每端口帧重组缓冲区大小
+        .tag = "UART监听",               // 日志标签
+        .init_uart = false              // 复用电机控制模块安装的UART驱动
     };
     
-    // 初始化电机控制器
-    motor_controller = motor_control_init(&motor_config); 
-    if (!motor_controller) {
-        ESP_LOGE(TAG, "电机控制器初始化失败");
+    if (!motor_registry_init(&uart_config)) {
+        ESP_LOGE(TAG, "电机注册表初始化失败");
         vTaskDelete(NULL);
         return;
     }
     
-    ESP_LOGI(TAG, "电机控制器初始化成功");
+    // 按Kconfig注册各轴电机，查询频率取运行时配置（默认1Hz）
+    if (motor_registry_add_configured(g_motor_config.query_frequency) == 0) {
+        ESP_LOGE(TAG, "没有可用的电机");
+        vTaskDelete(NULL);
+        return;
+    }
     
-    // 等待2秒让电机稳定
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    ESP_LOGI(TAG, "电机控制器初始化成功 - 共%d轴", motor_registry_count());
+
+#if CONFIG_FLIGHT_RECORDER
+    // 各轴注册完成后启动：之后的模式切换与命令都进入记录
+    if (!flight_recorder_init()) {
+        ESP_LOGW(TAG, "飞行记录仪初始化失败");
+    }
+#endif
     
-    // 设置为位置模式
-    motor_control_set_position_mode(motor_controller);
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    // 先启动共享UART监听任务：上电握手与后续状态都依赖它解析驱动器响应
+    if (motor_registry_start()) {
+        ESP_LOGI(TAG, "UART数据监听器启动成功");
+    } else {
+        ESP_LOGE(TAG, "UART数据监听器启动失败");
+    }
     
-    // 启动Web服务器
-    web_server = start_webserver(motor_controller);
+    // Web服务器与G代码不等待驱动器：就绪前运动命令被拒绝，状态与配置接口立即可用
+    web_server = start_webserver();
     if (!web_server) {
         ESP_LOGE(TAG, "Web服务器启动失败");
     }
     
-    // 初始化状态查询调度器
-    scheduler_config_t scheduler_config = {
-        .frequency = 1.0f,               // 默认1Hz查询频率
-        .uart_port = UART_NUM_1,         // 使用与电机控制相同的UART端口
-        .enable_all_queries = false      // 默认不启动自动查询，等待用户手动启动
-    };
-    
-    status_scheduler = motor_status_scheduler_init(&scheduler_config);
-    if (status_scheduler) {
-        ESP_LOGI(TAG, "状态查询调度器初始化成功");
-        // 将调度器传递给Web服务器
-        set_status_scheduler(status_scheduler);
-    } else {
-        ESP_LOGE(TAG, "状态查询调度器初始化失败");
-    }
-    
     // 初始化G代码控制器
     gcode_controller_config_t gcode_config = {
-        .motor_controller = motor_controller,
         .response_buffer = gcode_response_buffer,
-        .response_buffer_size = sizeof(gcode_response_buffer)
+        .response_buffer_size = sizeof(gcode_response_buffer),
+        .motion_queue_depth = 32,                // CAN任务入队，执行任务异步发送
+        .use_trajectory = true,                  // G1 X由设备端轨迹发生器平滑执行
+        .trajectory_rate_hz = 500,               // 500Hz设定点（10字节帧@115200约占43%带宽）
+        .trajectory_profile = TRAJECTORY_PROFILE_S_CURVE,
+        .trajectory_limits = {
+            .max_velocity = 360.0f,              // 默认1 r/s（输出轴），G1 F可进一步限速
+            .max_acceleration = 720.0f,          // 度/s²
+            .max_jerk = 7200.0f                  // 度/s³
+        },
+        .underrun_window_ms = CONFIG_GCODE_UNDERRUN_WINDOW_MS   // 逐行命令流的欠载判定窗口
     };
     
     g_gcode_controller = gcode_controller_init(&gcode_config);
     if (g_gcode_controller) {
         ESP_LOGI(TAG, "G代码控制器初始化成功");
+        set_gcode_controller(g_gcode_controller);
     } else {
         ESP_LOGE(TAG, "G代码控制器初始化失败");
     }
     
-    // 初始化并启动UART监听器（专门监听电机控制的UART1接收数据）
-    uart_monitor_config_t uart_config = {
-        .uart_port = UART_NUM_1,        // 使用UART1（与电机控制相同）
-        .buf_size = 1024,               // 缓冲区大小
-        .tag = "UART监听",               // 日志标签
-        .init_uart = false              // 复用已初始化的UART1
-    };
-    
-    uart_monitor = uart_monitor_init(&uart_config);
-    if (uart_monitor) {
-        if (uart_monitor_start(uart_monitor)) {
-            ESP_LOGI(TAG, "UART数据监听器启动成功");
-        } else {
-            ESP_LOGE(TAG, "UART数据监听器启动失败");
+    // 运行时配置auto_query打开时上电即开始状态查询，否则等待用户手动启动
+    if (g_motor_config.auto_query) {
+        for (uint8_t i = 0; i < motor_registry_count(); i++) {
+            motor_status_scheduler_start(motor_registry_get(i)->scheduler);
         }
-    } else {
-        ESP_LOGE(TAG, "UART数据监听器初始化失败");
     }
     
     // 初始化并启动CAN监听器（专门监听G代码CAN数据）
     can_monitor_config_t can_config = {
         .tx_gpio = GPIO_NUM_1,               // CAN TX引脚
         .rx_gpio = GPIO_NUM_2,               // CAN RX引脚
-        .timing_config = TWAI_TIMING_CONFIG_500KBITS(), // 500K波特率
+        .timing_config = can_timing_config(g_motor_config.can_bitrate), // 运行时配置can_bitrate（默认500K）
         .filter_config = TWAI_FILTER_CONFIG_ACCEPT_ALL(), // 接收所有消息
         .tag = "CAN监听",                    // 日志标签
-        .gcode_controller = g_gcode_controller // G代码控制器
+        .gcode_controller = g_gcode_controller, // G代码控制器
+        .isotp_rx_id = 0x002,                // ISO-TP G代码程序接收ID
+        .isotp_tx_id = 0x003,                // ISO-TP流控帧发送ID
+        .isotp_block_size = 0,               // 不分块，首帧后连续发送全部连续帧
+        .isotp_st_min = 0                    // 不限制帧间隔，跑满总线带宽
     };
     
     can_monitor = can_monitor_init(&can_config);
@@ -176,11 +143,18 @@ void motor_init_task(void *pvParameters) {
         ESP_LOGE(TAG, "CAN数据监听器初始化失败");
     }
     
-    ESP_LOGI(TAG, "电机初始化完成，Web服务器已启动，G代码控制器已就绪");
+    ESP_LOGI(TAG, "Web服务器与G代码控制器已启动，等待驱动器响应");
     ESP_LOGI(TAG, "请连接WiFi热点，然后访问: http://192.168.4.1");
-    ESP_LOGI(TAG, "UART1监听: 电机响应数据 (GPIO12-RX, GPIO13-TX) @ 115200 baud");
-    ESP_LOGI(TAG, "CAN监听: G代码数据 (GPIO1-TX, GPIO2-RX) @ 500K baud");
-    ESP_LOGI(TAG, "支持G代码命令: G1 X{角度}(位置模式), G1 F{速度}(速度模式), G1 T{力矩}(力矩模式), M0/M1(失能/使能)");
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        const motor_driver_config_t* cfg = &motor_registry_get(i)->controller->driver_config;
+        ESP_LOGI(TAG, "轴%d(%c) UART%d 节点%d: GPIO%d-RX, GPIO%d-TX @ %d baud", i, motor_registry_get(i)->axis_letter,
+                 cfg->uart_port, cfg->node_id, cfg->rxd_pin, cfg->txd_pin, cfg->baud_rate);
+    }
+    ESP_LOGI(TAG, "CAN监听: G代码数据 (GPIO1-TX, GPIO2-RX) @ %lu baud", (unsigned long)g_motor_config.can_bitrate);
+    ESP_LOGI(TAG, "支持G代码命令: G1 X/Y/Z/A/B/C{角度}(位置模式), G1 F{速度} P{轴}(速度模式), G1 T{力矩} P{轴}(力矩模式), M0/M1 [P{轴}](失能/使能)");
+    
+    // 上电握手：主动探测各驱动器，一响应即设置上电模式并开放运动命令（不设超时，驱动器晚上电也能就绪）
+    motor_registry_bring_up(0);
     
     // 任务完成，删除自己
     vTaskDelete(NULL);
@@ -198,6 +172,15 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    // 运行时配置：在注册电机与启动CAN之前从NVS读入内存
+    if (!motor_config_init()) {
+        ESP_LOGW(TAG, "运行时配置无法持久化，使用默认值");
+    }
+    // 各轴标定（换算系数依赖运行时配置的减速比与力矩系数）
+    if (!motor_units_init()) {
+        ESP_LOGW(TAG, "各轴标定无法加载，使用默认标定");
+    }
+
     // 初始化WiFi热点
     ESP_LOGI(TAG, "初始化WiFi热点模式");
     wifi_init_softap();
@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "motor_control.h"
+#include "motor_registry.h"
+#include "motor_drive_sim.h"
+#include "gcode_unified_control.h"
+#include "host_bench.h"
+#include "wire_trace.h"
+#include "motor_metrics.h"
+#include "flight_recorder.h"
+
+// linux目标入口：控制核心 + 驱动器模拟器，无WiFi/Web/CAN
+// 用法：idf.py --preview set-target linux && idf.py build
+//       ./build/wifi_softAP.elf < program.gcode
+// G代码程序从标准输入读取并按CAN/ISO-TP程序同样的路径执行（运动队列 -> 轨迹 -> 协议 -> 模拟驱动器），
+// 结束后打印运行时间与各模块统计，可配合perf/valgrind对热点路径做剖析
+// CONFIG_HOST_BENCHMARK打开时改为运行协议编解码热点基准（标准输入的G代码作为录制流量）
+// 标准输入是线路抓包（/api/trace/download）时改为回放：UART接收字节送入uart_monitor，CAN帧送入G代码控制器
+// 标准输入是飞行记录仪分区转储（/api/flightrec/download）时按时间顺序输出CSV
+
+static const char *TAG = "MAIN_LINUX";
+
+#define HOST_PROGRAM_CHUNK      4096
+#define HOST_DRAIN_POLL_MS      10
+#define HOST_READBACK_WAIT_MS   50
+#define HOST_READY_TIMEOUT_MS   2000    // 上电握手超时（模拟驱动器首次被寻址即上线）
+#define HOST_ISOTP_RX_ID        0x002   // 与main.c中CAN监听的ISO-TP接收ID一致
+
+#if CONFIG_WIRE_TRACE_REPLAY_REALTIME
+#define HOST_REPLAY_REALTIME    true
+#else
+#define HOST_REPLAY_REALTIME    false
+#endif
+
+static char gcode_response_buffer[512];
+
+/**
+ * @brief 读取标准输入全部内容（末尾额外保留1字节供原地切分）
+ */
+static char* read_program(size_t* length) {
+    size_t capacity = HOST_PROGRAM_CHUNK;
+    size_t used = 0;
+    char* program = malloc(capacity + 1);
+    if (!program) {
+        return NULL;
+    }
+
+    size_t n;
+    while ((n = fread(program + used, 1, capacity - used, stdin)) > 0) {
+        used += n;
+        if (used == capacity) {
+            char* grown = realloc(program, capacity * 2 + 1);
+            if (!grown) {
+                free(program);
+                return NULL;
+            }
+            program = grown;
+            capacity *= 2;
+        }
+    }
+    program[used] = '\0';
+    *length = used;
+    return program;
+}
+
+static void print_report(gcode_controller_t* controller, int64_t elapsed_us, gcode_result_t result) {
+    gcode_queue_stats_t queue;
+    gcode_get_queue_stats(controller, &queue);
+    motor_drive_sim_stats_t sim;
+    motor_drive_sim_get_stats(&sim);
+
+    printf("result=%d elapsed_us=%lld\n", result, (long long)elapsed_us);
+    printf("queue enqueued=%lu executed=%lu errors=%lu high_watermark=%lu underruns=%lu "
+           "flushed=%lu coordinated_moves=%lu axis_skew_max_us=%lu\n",
+           (unsigned long)queue.enqueued, (unsigned long)queue.executed, (unsigned long)queue.execute_errors,
+           (unsigned long)queue.high_watermark, (unsigned long)queue.underruns,
+           (unsigned long)queue.flushed, (unsigned long)queue.coordinated_moves, (unsigned long)queue.axis_skew_max_us);
+    printf("sim frames_received=%lu responses_sent=%lu dropped=%lu corrupted=%lu rx_overflows=%lu\n",
+           (unsigned long)sim.frames_received, (unsigned long)sim.responses_sent,
+           (unsigned long)sim.responses_dropped, (unsigned long)sim.responses_corrupted,
+           (unsigned long)sim.rx_overflows);
+
+    for (int stage = 0; stage < MOTOR_LATENCY_STAGES; stage++) {
+        const motor_metrics_histogram_t* histogram = &g_motor_metrics.latency_us[stage];
+        printf("latency stage=%s count=%lu p50_us<=%lu p99_us<=%lu\n", MOTOR_LATENCY_STAGE_NAMES[stage],
+               (unsigned long)histogram->count,
+               (unsigned long)motor_metrics_histogram_percentile(histogram, 0.50f),
+               (unsigned long)motor_metrics_histogram_percentile(histogram, 0.99f));
+    }
+    const motor_metrics_histogram_t* jitter = &g_motor_metrics.stream_jitter_us;
+    printf("stream_jitter count=%lu p50_us<=%lu p99_us<=%lu\n", (unsigned long)jitter->count,
+           (unsigned long)motor_metrics_histogram_percentile(jitter, 0.50f),
+           (unsigned long)motor_metrics_histogram_percentile(jitter, 0.99f));
+
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_registry_entry_t* entry = motor_registry_get(i);
+        const motor_driver_config_t* cfg = &entry->controller->driver_config;
+        motor_drive_sim_node_t node = {0};
+        motor_drive_sim_get_node(cfg->uart_port, cfg->node_id, &node);
+        printf("axis%d(%c) uart=%d node=%d sim_position=%.4f sim_velocity=%.4f reported_position=%.4f ready_us=%lld\n",
+               i, entry->axis_letter, cfg->uart_port, cfg->node_id, node.position, node.velocity,
+               entry->controller->status.position, (long long)entry->controller->ready_us);
+    }
+    printf("system_ready_us=%lld\n", (long long)motor_registry_ready_us());
+}
+
+static void wait_queue_drained(gcode_controller_t* controller) {
+    gcode_queue_stats_t queue;
+    while (gcode_get_queue_stats(controller, &queue) && queue.executed < queue.enqueued) {
+        vTaskDelay(pdMS_TO_TICKS(HOST_DRAIN_POLL_MS));
+    }
+}
+
+/**
+ * @brief 回放线路抓包并打印统计：录制的发送帧数可与回放时模拟驱动器收到的帧数对照
+ */
+static void run_replay(gcode_controller_t* controller, const uint8_t* capture, size_t length) {
+    motor_drive_sim_stats_t sim_before;
+    motor_drive_sim_get_stats(&sim_before);
+
+    wire_trace_replay_config_t config = {
+        .monitor = motor_registry_get_monitor(),
+        .gcode_controller = controller,
+        .isotp_rx_id = HOST_ISOTP_RX_ID,
+        .realtime = HOST_REPLAY_REALTIME
+    };
+    // 回放时电机状态只来自抓包，不做上电握手：直接标记就绪，就绪门控不影响回放结果
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_control_mark_ready(motor_registry_get(i)->controller);
+    }
+
+    wire_trace_replay_stats_t stats;
+    if (!wire_trace_replay(capture, length, &config, &stats)) {
+        exit(2);
+    }
+    wait_queue_drained(controller);
+
+    motor_drive_sim_stats_t sim_after;
+    motor_drive_sim_get_stats(&sim_after);
+    printf("replay records=%lu recorded_span_us=%lld elapsed_us=%lld realtime=%d\n",
+           (unsigned long)stats.records, (long long)stats.recorded_span_us, (long long)stats.elapsed_us,
+           HOST_REPLAY_REALTIME);
+    printf("replay uart_rx_bytes=%lu can_frames=%lu isotp_messages=%lu gcode_errors=%lu "
+           "recorded_tx_frames=%lu replayed_tx_frames=%lu\n",
+           (unsigned long)stats.uart_rx_bytes, (unsigned long)stats.can_frames,
+           (unsigned long)stats.isotp_messages, (unsigned long)stats.gcode_errors,
+           (unsigned long)(stats.uart_tx_bytes / UART_MONITOR_FRAME_SIZE),
+           (unsigned long)(sim_after.frames_received - sim_before.frames_received));
+
+    print_report(controller, stats.elapsed_us, stats.gcode_errors ? GCODE_RESULT_ERROR : GCODE_RESULT_OK);
+    fflush(stdout);
+    exit(stats.gcode_errors ? 1 : 0);
+}
+
+/**
+ * @brief 把飞行记录仪转储按时间顺序输出为CSV，异常码附带逐位描述
+ */
+static void print_flight_recorder_csv(const uint8_t* dump, size_t length) {
+    flight_recorder_reader_t reader;
+    flight_recorder_event_t event;
+    motor_fault_list_t faults;
+    uint32_t records = 0;
+
+    flight_recorder_reader_init(&reader, dump, length);
+    printf("boot_id,sequence,frozen,time_us,type,uart,node,position,velocity,torque,command,value,"
+           "error_type,code,faults\n");
+    while (flight_recorder_reader_next(&reader, &event)) {
+        printf("%lu,%lu,%d,%lld,%s,%u,%u,", (unsigned long)event.boot_id, (unsigned long)event.sequence,
+               event.frozen, (long long)event.time_us, FLIGHT_RECORD_TYPE_NAMES[event.type],
+               event.uart_port, event.node_id);
+        switch (event.type) {
+            case FLIGHT_RECORD_STATUS:
+                printf("%.4f,%.3f,%.3f,,,,,\n", event.position, event.velocity, event.torque);
+                break;
+            case FLIGHT_RECORD_COMMAND:
+                printf(",,,%s,%.4f,,,\n", FLIGHT_COMMAND_NAMES[event.command], event.value);
+                break;
+            default:
+                printf(",,,,,%u,0x%08lX,", event.error_type, (unsigned long)event.code);
+                motor_error_decode(event.code, event.error_type, &faults);
+                for (uint8_t i = 0; i < faults.count; i++) {
+                    printf("%s%s", i ? "|" : "", motor_error_bit_description(event.error_type, faults.bits[i]));
+                }
+                printf("\n");
+                break;
+        }
+        records++;
+    }
+    fprintf(stderr, "flight recorder: %lu records from %lu sectors\n", (unsigned long)records,
+            (unsigned long)reader.sector_count);
+    fflush(stdout);
+    exit(0);
+}
+
+void app_main(void)
+{
+    uart_monitor_config_t uart_config = {
+        .buf_size = 256,
+        .tag = "UART监听",
+        .init_uart = false
+    };
+
+    if (!motor_registry_init(&uart_config) || motor_registry_add_configured(1.0f) == 0) {
+        ESP_LOGE(TAG, "电机初始化失败");
+        exit(2);
+    }
+
+#if CONFIG_HOST_BENCHMARK
+    // 基准模式不启动UART监听：响应帧由基准直接喂给解析函数
+    size_t recorded_length = 0;
+    char* recorded = isatty(STDIN_FILENO) ? NULL : read_program(&recorded_length);
+    bool bench_ok = host_bench_run(recorded, recorded_length);
+    free(recorded);
+    fflush(stdout);
+    exit(bench_ok ? 0 : 1);
+#endif
+
+    gcode_controller_config_t gcode_config = {
+        .response_buffer = gcode_response_buffer,
+        .response_buffer_size = sizeof(gcode_response_buffer),
+        .motion_queue_depth = 32,
+        .use_trajectory = true,
+        .trajectory_rate_hz = 500,
+        .trajectory_profile = TRAJECTORY_PROFILE_S_CURVE,
+        .trajectory_limits = {
+            .max_velocity = 360.0f,
+            .max_acceleration = 720.0f,
+            .max_jerk = 7200.0f
+        },
+        .underrun_window_ms = CONFIG_GCODE_UNDERRUN_WINDOW_MS
+    };
+
+    gcode_controller_t* controller = gcode_controller_init(&gcode_config);
+    if (!controller) {
+        ESP_LOGE(TAG, "G代码控制器初始化失败");
+        exit(2);
+    }
+
+    size_t length = 0;
+    char* program = read_program(&length);
+    if (!program) {
+        ESP_LOGE(TAG, "读取G代码程序失败");
+        exit(2);
+    }
+
+    wire_trace_reader_t trace_reader;
+    if (wire_trace_reader_init(&trace_reader, (const uint8_t*)program, length)) {
+        // 回放时不启动UART监听任务：电机状态只来自抓包中的接收字节
+        run_replay(controller, (const uint8_t*)program, length);
+    }
+
+    flight_recorder_reader_t flight_reader;
+    if (flight_recorder_reader_init(&flight_reader, (const uint8_t*)program, length)) {
+        print_flight_recorder_csv((const uint8_t*)program, length);
+    }
+
+    if (!motor_registry_start()) {
+        ESP_LOGE(TAG, "UART监听器启动失败");
+        exit(2);
+    }
+    if (motor_registry_bring_up(HOST_READY_TIMEOUT_MS) < motor_registry_count()) {
+        ESP_LOGE(TAG, "电机未在%dms内就绪", HOST_READY_TIMEOUT_MS);
+        exit(2);
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    gcode_result_t result = gcode_process_program(controller, program, length);
+
+    // 等待运动队列执行完毕
+    wait_queue_drained(controller);
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    // 经完整收发路径（查询 -> 模拟驱动器 -> uart_monitor解析）回读各轴最终位置
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        const motor_driver_config_t* cfg = &motor_registry_get(i)->controller->driver_config;
+        query_motor_position_speed(cfg->uart_port, cfg->node_id);
+    }
+    vTaskDelay(pdMS_TO_TICKS(HOST_READBACK_WAIT_MS));
+
+    print_report(controller, elapsed_us, result);
+    free(program);
+    fflush(stdout);
+    exit(result == GCODE_RESULT_OK ? 0 : 1);
+}
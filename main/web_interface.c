@@ -1,8 +1,13 @@
 #include "web_interface.h"
 #include "motor_control.h"
+#include "motor_registry.h"
+#include "motor_units.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
 
 // 网页界面HTML内容
 static const char* web_page_html = 
@@ -46,10 +51,15 @@ static const char* web_page_html =
 ".error-normal{background:#d4edda;color:#155724}"
 ".error-warning{background:#fff3cd;color:#856404}"
 ".error-danger{background:#f8d7da;color:#721c24}"
+".stale{opacity:.45}"
 "</style>"
 "</head><body>"
 "<div class='container'>"
 "<h1>⚙️ 电机多模式控制系统</h1>"
+"<div class='form-group'>"
+"<label for='axis'>🎯 控制轴</label>"
+"<select id='axis' onchange='updateMotorStatus()'><option value='0'>轴0 (X)</option></select>"
+"</div>"
 
 "<div class='radio-group'>"
 "<div class='radio-option active' onclick='selectMode(\"velocity\")'>"
@@ -137,30 +147,34 @@ static const char* web_page_html =
 "<div class='mode-title'>📊 电机实时状态</div>"
 "<div id='motor-status'>"
 "<div style='display:grid;grid-template-columns:1fr 1fr;gap:15px;margin-bottom:15px'>"
-"<div style='padding:10px;background:#f0f8ff;border-radius:8px'>"
+"<div id='group-torque' style='padding:10px;background:#f0f8ff;border-radius:8px'>"
 "<strong>🔥 力矩反馈</strong><br>"
 "目标力矩: <span id='target-torque'>--</span> Nm<br>"
-"当前力矩: <span id='current-torque'>--</span> Nm"
+"当前力矩: <span id='current-torque'>--</span> Nm<br>"
+"窗口最小/最大/RMS: <span id='torque-stats'>--</span> Nm"
 "</div>"
-"<div style='padding:10px;background:#f0fff0;border-radius:8px'>"
+"<div id='group-power' style='padding:10px;background:#f0fff0;border-radius:8px'>"
 "<strong>⚡ 功率反馈</strong><br>"
 "电功率: <span id='electrical-power'>--</span> W<br>"
-"机械功率: <span id='mechanical-power'>--</span> W"
+"机械功率: <span id='mechanical-power'>--</span> W<br>"
+"累计电能/机械能: <span id='energy'>--</span> J"
 "</div>"
 "</div>"
 "<div style='display:grid;grid-template-columns:1fr 1fr;gap:15px;margin-bottom:15px'>"
-"<div style='padding:10px;background:#fffaf0;border-radius:8px'>"
+"<div id='group-position_speed' style='padding:10px;background:#fffaf0;border-radius:8px'>"
 "<strong>📍 位置转速</strong><br>"
 "位置: <span id='position-display'>--</span> 转<br>"
 "转速: <span id='velocity-display'>--</span> 转/s"
 "</div>"
-"<div style='padding:10px;background:#fff0f5;border-radius:8px'>"
+"<div id='group-encoder' style='padding:10px;background:#fff0f5;border-radius:8px'>"
 "<strong>🔢 编码器</strong><br>"
 "多圈计数: <span id='shadow-count'>--</span><br>"
-"单圈计数: <span id='count-in-cpr'>--</span>"
+"单圈计数: <span id='count-in-cpr'>--</span><br>"
+"滤波速度: <span id='encoder-velocity'>--</span> 计数/s<br>"
+"加速度: <span id='encoder-acceleration'>--</span> 计数/s²"
 "</div>"
 "</div>"
-"<div style='padding:10px;background:#f5f5f5;border-radius:8px'>"
+"<div id='group-exception' style='padding:10px;background:#f5f5f5;border-radius:8px'>"
 "<strong>❗ 异常状态</strong><br>"
 "电机: <span id='motor-error' class='error-status'>正常</span> | "
 "编码器: <span id='encoder-error' class='error-status'>正常</span> | "
@@ -172,6 +186,14 @@ static const char* web_page_html =
 "</div>"
 
 "<script>"
+"function axisParam(){return 'axis='+document.getElementById('axis').value;}"
+"function syncAxes(n){"
+"let sel=document.getElementById('axis');"
+"if(!n||sel.options.length===n)return;"
+"let cur=sel.value;sel.innerHTML='';"
+"for(let i=0;i<n;i++){let o=document.createElement('option');o.value=i;o.textContent='轴'+i+' ('+'XYZABC'[i]+')';sel.appendChild(o);}"
+"sel.value=cur<n?cur:0;"
+"}"
 "let currentMode='velocity';"
 "function selectMode(mode){"
 "currentMode=mode;"
@@ -180,7 +202,7 @@ static const char* web_page_html =
 "document.getElementById(mode+'-content').classList.add('active');"
 "event.currentTarget.classList.add('active');"
 "document.getElementById('mode-'+mode).checked=true;"
-"fetch('/set_mode?mode='+mode).then(r=>r.text()).then(d=>{"
+"fetch('/set_mode?mode='+mode+'&'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='模式切换: '+getModeName(mode)+' | '+d;"
 "}).catch(e=>console.log('模式切换失败: '+e));"
 "}"
@@ -191,54 +213,65 @@ static const char* web_page_html =
 "function setVelocity(){"
 "let vel=document.getElementById('velocity').value;"
 "if(vel===''){alert('请输入速度值');return;}"
-"fetch('/set_velocity?value='+vel).then(r=>r.text()).then(d=>{"
+"fetch('/set_velocity?value='+vel+'&'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='速度设置: '+vel+' r/s | '+d;"
 "}).catch(e=>alert('设置失败: '+e));"
 "}"
 "function setPosition(){"
 "let pos=document.getElementById('position').value;"
 "if(pos===''){alert('请输入位置值');return;}"
-"fetch('/set_position?value='+pos).then(r=>r.text()).then(d=>{"
+"fetch('/set_position?value='+pos+'&'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='位置设置: '+pos+' | '+d;"
 "}).catch(e=>alert('设置失败: '+e));"
 "}"
 "function setAngle(){"
 "let angle=document.getElementById('angle').value;"
 "if(angle===''){alert('请输入角度值');return;}"
-"fetch('/set_angle?value='+angle).then(r=>r.text()).then(d=>{"
+"fetch('/set_angle?value='+angle+'&'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='角度设置: '+angle+'° | '+d;"
 "}).catch(e=>alert('设置失败: '+e));"
 "}"
 "function setTorque(){"
 "let torque=document.getElementById('torque').value;"
 "if(torque===''){alert('请输入力矩值');return;}"
-"fetch('/set_torque?value='+torque).then(r=>r.text()).then(d=>{"
+"fetch('/set_torque?value='+torque+'&'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='力矩设置: '+torque+' Nm | '+d;"
 "}).catch(e=>alert('设置失败: '+e));"
 "}"
 "function enableMotor(){"
-"fetch('/enable').then(r=>r.text()).then(d=>{"
+"fetch('/enable?'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='电机已使能 | '+d;"
 "}).catch(e=>alert('操作失败: '+e));"
 "}"
 "function disableMotor(){"
-"fetch('/disable').then(r=>r.text()).then(d=>{"
+"fetch('/disable?'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='电机已失能 | '+d;"
 "}).catch(e=>alert('操作失败: '+e));"
 "}"
 "function clearErrors(){"
-"fetch('/clear').then(r=>r.text()).then(d=>{"
+"fetch('/clear?'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='错误已清除 | '+d;"
 "}).catch(e=>alert('操作失败: '+e));"
 "}"
 "function restartMotor(){"
-"fetch('/restart').then(r=>r.text()).then(d=>{"
+"fetch('/restart?'+axisParam()).then(r=>r.text()).then(d=>{"
 "document.getElementById('status').textContent='电机已重启 | '+d;"
 "}).catch(e=>alert('操作失败: '+e));"
 "}"
 
+"let statusCache={axis:-1,gen:0,data:{}};"
 "function updateMotorStatus(){"
-"fetch('/api/motor_status').then(r=>r.json()).then(data=>{"
+"let axis=+document.getElementById('axis').value;"
+"let url='/api/motor_status?'+axisParam()+(statusCache.axis===axis?'&since_gen='+statusCache.gen:'');"
+"fetch(url).then(r=>r.json()).then(d=>{"
+"if(d.error)return;"
+"if(!d.delta||statusCache.axis!==d.axis)statusCache={axis:d.axis,gen:0,data:{}};"
+"let updated=Object.assign(statusCache.data.updated_us||{},d.updated_us);"
+"Object.assign(statusCache.data,d);statusCache.data.updated_us=updated;statusCache.gen=d.gen;"
+"let data=statusCache.data;"
+"['torque','power','encoder','position_speed','exception'].forEach(g=>"
+"document.getElementById('group-'+g).classList.toggle('stale',data.stale.includes(g)));"
+"syncAxes(data.axis_count);"
 "document.getElementById('target-torque').textContent=data.target_torque.toFixed(3)||'--';"
 "document.getElementById('current-torque').textContent=data.current_torque.toFixed(3)||'--';"
 "document.getElementById('electrical-power').textContent=data.electrical_power.toFixed(2)||'--';"
@@ -247,18 +280,23 @@ static const char* web_page_html =
 "document.getElementById('velocity-display').textContent=data.velocity.toFixed(3)||'--';"
 "document.getElementById('shadow-count').textContent=data.shadow_count||'--';"
 "document.getElementById('count-in-cpr').textContent=data.count_in_cpr||'--';"
+"document.getElementById('encoder-velocity').textContent=data.encoder_velocity.toFixed(1);"
+"document.getElementById('encoder-acceleration').textContent=data.encoder_acceleration.toFixed(1);"
+"document.getElementById('energy').textContent=data.electrical_energy.toFixed(1)+' / '+data.mechanical_energy.toFixed(1);"
+"document.getElementById('torque-stats').textContent=data.torque_window?"
+"data.torque_min.toFixed(3)+' / '+data.torque_max.toFixed(3)+' / '+data.torque_rms.toFixed(3):'--';"
 
-"updateErrorStatus('motor-error',data.motor_error,data.motor_error_desc);"
-"updateErrorStatus('encoder-error',data.encoder_error,data.encoder_error_desc);"
-"updateErrorStatus('controller-error',data.controller_error,data.controller_error_desc);"
-"updateErrorStatus('system-error',data.system_error,data.system_error_desc);"
+"updateErrorStatus('motor-error',data.motor_error,data.motor_faults);"
+"updateErrorStatus('encoder-error',data.encoder_error,data.encoder_faults);"
+"updateErrorStatus('controller-error',data.controller_error,data.controller_faults);"
+"updateErrorStatus('system-error',data.system_error,data.system_faults);"
 "}).catch(e=>console.log('状态更新失败:',e));"
 "}"
 
-"function updateErrorStatus(id,code,desc){"
+"function updateErrorStatus(id,code,faults){"
 "let elem=document.getElementById(id);"
 "elem.className='error-status '+(code?'error-danger':'error-normal');"
-"elem.textContent=desc||'正常';"
+"elem.textContent=faults&&faults.length?faults.map(f=>f.desc).join('、'):'正常';"
 "}"
 
 "let autoQueryRunning=false;"
@@ -324,11 +362,18 @@ static const char* debug_page_html =
 ".status{margin-top:20px;padding:15px;border-radius:8px;background:#e8f5e8;border-left:4px solid #4CAF50;font-family:monospace;max-height:200px;overflow-y:auto}"
 ".nav-link{display:inline-block;margin:10px 0;color:#2196F3;text-decoration:none;font-weight:bold}"
 ".nav-link:hover{text-decoration:underline}"
+".task-table{width:100%;border-collapse:collapse;font-family:monospace;font-size:13px;margin-top:10px}"
+".task-table th,.task-table td{border-bottom:1px solid #ddd;padding:4px 6px;text-align:right}"
+".task-table th:first-child,.task-table td:first-child{text-align:left}"
 "</style>"
 "</head><body>"
 "<div class='container'>"
 "<h1>🔧 电机调试工具</h1>"
 "<a href='/' class='nav-link'>← 返回主控制页面</a>"
+"<div class='exception-group'>"
+"<strong>🎯 控制轴</strong>"
+"<select id='axis'><option value='0'>轴0 (X)</option></select>"
+"</div>"
 
 "<div class='debug-section'>"
 "<div class='section-title'>电机控制指令</div>"
@@ -360,6 +405,16 @@ static const char* debug_page_html =
 "</div>"
 "</div>"
 
+"<div class='debug-section'>"
+"<div class='section-title'>任务与队列</div>"
+"<div class='exception-group'>"
+"<button class='btn btn-query' onclick='loadTasks()'>📊 刷新</button>"
+"<label><input type='checkbox' id='tasksAuto'> 每2秒自动刷新</label>"
+"</div>"
+"<table class='task-table' id='taskTable'></table>"
+"<table class='task-table' id='queueTable'></table>"
+"</div>"
+
 "<div class='status' id='debugStatus'>"
 "调试工具就绪，点击按钮发送CAN指令查询<br>"
 "注意：查询结果将通过串口监视器显示，请查看ESP32串口输出"
@@ -367,37 +422,64 @@ static const char* debug_page_html =
 "</div>"
 
 "<script>"
+"function axisParam(){return 'axis='+document.getElementById('axis').value;}"
+"function syncAxes(n){"
+"let sel=document.getElementById('axis');"
+"if(!n||sel.options.length===n)return;"
+"let cur=sel.value;sel.innerHTML='';"
+"for(let i=0;i<n;i++){let o=document.createElement('option');o.value=i;o.textContent='轴'+i+' ('+'XYZABC'[i]+')';sel.appendChild(o);}"
+"sel.value=cur<n?cur:0;"
+"}"
+"fetch('/api/motor_status').then(r=>r.json()).then(d=>syncAxes(d.axis_count)).catch(e=>{});"
 "function restartMotor(){"
-"fetch('/debug/restart').then(r=>r.text()).then(d=>{"
+"fetch('/debug/restart?'+axisParam()).then(r=>r.text()).then(d=>{"
 "addStatus('重启电机指令已发送 | '+d);"
 "}).catch(e=>addStatus('重启失败: '+e));"
 "}"
 "function queryTorque(){"
-"fetch('/debug/query_torque').then(r=>r.text()).then(d=>{"
+"fetch('/debug/query_torque?'+axisParam()).then(r=>r.text()).then(d=>{"
 "addStatus('查询力矩指令已发送 | '+d);"
 "}).catch(e=>addStatus('查询失败: '+e));"
 "}"
 "function queryPower(){"
-"fetch('/debug/query_power').then(r=>r.text()).then(d=>{"
+"fetch('/debug/query_power?'+axisParam()).then(r=>r.text()).then(d=>{"
 "addStatus('查询功率指令已发送 | '+d);"
 "}).catch(e=>addStatus('查询失败: '+e));"
 "}"
 "function queryEncoder(){"
-"fetch('/debug/query_encoder').then(r=>r.text()).then(d=>{"
+"fetch('/debug/query_encoder?'+axisParam()).then(r=>r.text()).then(d=>{"
 "addStatus('查询编码器指令已发送 | '+d);"
 "}).catch(e=>addStatus('查询失败: '+e));"
 "}"
 "function queryPosSpeed(){"
-"fetch('/debug/query_pos_speed').then(r=>r.text()).then(d=>{"
+"fetch('/debug/query_pos_speed?'+axisParam()).then(r=>r.text()).then(d=>{"
 "addStatus('查询位置转速指令已发送 | '+d);"
 "}).catch(e=>addStatus('查询失败: '+e));"
 "}"
 "function queryException(){"
 "let type=document.getElementById('exceptionType').value;"
-"fetch('/debug/query_exception?type='+type).then(r=>r.text()).then(d=>{"
+"fetch('/debug/query_exception?type='+type+'&'+axisParam()).then(r=>r.text()).then(d=>{"
 "addStatus('查询异常指令已发送(类型:'+type+') | '+d);"
 "}).catch(e=>addStatus('查询失败: '+e));"
 "}"
+"function loadTasks(){"
+"fetch('/debug/tasks').then(r=>r.json()).then(d=>{"
+"let t='<tr><th>任务</th><th>状态</th><th>优先级</th><th>核心</th><th>CPU%</th><th>累计CPU%</th><th>栈余量(B)</th></tr>';"
+"d.tasks.sort((a,b)=>b.cpu-a.cpu).forEach(k=>{"
+"t+='<tr><td>'+k.name+'</td><td>'+k.state+'</td><td>'+k.priority+'</td><td>'+(k.core<0?'-':k.core)+'</td><td>'"
+"+k.cpu.toFixed(1)+'</td><td>'+k.cpu_total.toFixed(1)+'</td><td>'+k.stack_free+'</td></tr>';"
+"});"
+"if(!d.runtime_stats)t+='<tr><td colspan=7>未启用FreeRTOS运行时间统计，CPU占比不可用</td></tr>';"
+"document.getElementById('taskTable').innerHTML=t;"
+"let q='<tr><th>队列</th><th>端口</th><th>占用</th><th>容量</th><th>丢失/溢出</th></tr>';"
+"d.queues.forEach(k=>{"
+"q+='<tr><td>'+k.name+'</td><td>'+(k.uart<0?'-':k.uart)+'</td><td>'+k.waiting+'</td><td>'+k.capacity+'</td><td>'"
+"+(k.missed!==undefined?k.missed+'/'+k.overrun:'-')+'</td></tr>';"
+"});"
+"document.getElementById('queueTable').innerHTML=q;"
+"}).catch(e=>addStatus('任务信息获取失败: '+e));"
+"}"
+"setInterval(()=>{if(document.getElementById('tasksAuto').checked)loadTasks();},2000);"
 "function addStatus(msg){"
 "let status=document.getElementById('debugStatus');"
 "let time=new Date().toLocaleTimeString();"
@@ -415,62 +497,205 @@ const char* get_debug_page_html(void) {
     return debug_page_html;
 }
 
-// 全局JSON缓冲区
-static char motor_status_json_buffer[1024];
+// 全局JSON缓冲区（四类异常全部置位时的异常列表约1.5KB）
+static char motor_status_json_buffer[2560];
+
+#define STATUS_JSON_TAIL_RESERVE    32      // 为",\"faults_truncated\":true}"预留
+
+// 异常码字段：异常类型编号与parse_error_data的error_type一致
+typedef struct {
+    motor_status_field_t field;
+    size_t code_offset;                     // 异常码在motor_status_t中的偏移量
+    uint8_t error_type;
+    const char *name;                       // JSON字段前缀：<name>_error / <name>_error_desc / <name>_faults
+} status_error_field_t;
+
+static const status_error_field_t status_error_fields[] = {
+    {MOTOR_STATUS_MOTOR_ERROR,      offsetof(motor_status_t, motor_error),      0, "motor"},
+    {MOTOR_STATUS_ENCODER_ERROR,    offsetof(motor_status_t, encoder_error),    1, "encoder"},
+    {MOTOR_STATUS_CONTROLLER_ERROR, offsetof(motor_status_t, controller_error), 3, "controller"},
+    {MOTOR_STATUS_SYSTEM_ERROR,     offsetof(motor_status_t, system_error),     4, "system"}
+};
 
-const char* get_motor_status_json(void) {
-    motor_status_t *status = get_motor_status();
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t used;
+    bool overflow;
+} status_json_t;
+
+static void status_json_printf(status_json_t *json, const char *format, ...) {
+    if (json->overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(json->buffer + json->used, json->size - json->used, format, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= json->size - json->used) {
+        json->overflow = true;
+        json->buffer[json->used] = '\0';
+        return;
+    }
+    json->used += n;
+}
+
+/**
+ * @brief 追加一类异常：,"motor_error":N,"motor_error_desc":"...","motor_faults":[{"bit":12,"desc":"..."}]
+ * @return 缓冲区不足时回退到追加前并返回false
+ */
+static bool status_json_error(status_json_t *json, const motor_status_t *status, const status_error_field_t *error) {
+    size_t mark = json->used;
+    uint32_t code = *(const uint32_t*)((const char*)status + error->code_offset);
+    const motor_fault_list_t *faults = get_motor_faults(status, error->error_type);
+
+    status_json_printf(json, ",\"%s_error\":%lu,\"%s_error_desc\":\"%s\",\"%s_faults\":[",
+                       error->name, (unsigned long)code, error->name,
+                       get_error_description(code, error->error_type), error->name);
+    for (uint8_t i = 0; faults && i < faults->count; i++) {
+        status_json_printf(json, "%s{\"bit\":%u,\"desc\":\"%s\"}", i ? "," : "", (unsigned)faults->bits[i],
+                           motor_error_bit_description(error->error_type, faults->bits[i]));
+    }
+    status_json_printf(json, "]");
+
+    if (json->overflow) {
+        json->overflow = false;
+        json->used = mark;
+        json->buffer[mark] = '\0';
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 生成状态JSON
+ * @param delta 为true时只输出代次大于since_gen的字段（客户端代次比设备新时退回完整输出）
+ */
+static const char* format_motor_status(uint8_t axis, bool delta, uint32_t since_gen) {
+    motor_registry_entry_t *entry = motor_registry_get(axis);
+    motor_status_t *status = entry ? &entry->controller->status : NULL;
     if (!status) {
         strcpy(motor_status_json_buffer, "{\"error\":\"状态获取失败\"}");
         return motor_status_json_buffer;
     }
-    
-    // 获取异常描述
-    const char *motor_error_desc = get_error_description(status->motor_error, 0);
-    const char *encoder_error_desc = get_error_description(status->encoder_error, 1);
-    const char *controller_error_desc = get_error_description(status->controller_error, 3);
-    const char *system_error_desc = get_error_description(status->system_error, 4);
-    
-    snprintf(motor_status_json_buffer, sizeof(motor_status_json_buffer),
-        "{"
-        "\"target_torque\":%.3f,"
-        "\"current_torque\":%.3f,"
-        "\"electrical_power\":%.2f,"
-        "\"mechanical_power\":%.2f,"
-        "\"position\":%.2f,"
-        "\"velocity\":%.3f,"
-        "\"shadow_count\":%ld,"
-        "\"count_in_cpr\":%ld,"
-        "\"motor_error\":%lu,"
-        "\"encoder_error\":%lu,"
-        "\"controller_error\":%lu,"
-        "\"system_error\":%lu,"
-        "\"motor_error_desc\":\"%s\","
-        "\"encoder_error_desc\":\"%s\","
-        "\"controller_error_desc\":\"%s\","
-        "\"system_error_desc\":\"%s\","
-        "\"data_valid\":%s,"
-        "\"last_update_time\":%lu"
-        "}",
-        status->target_torque,
-        status->current_torque,
-        status->electrical_power,
-        status->mechanical_power,
-        status->position,
-        status->velocity,
-        (long)status->shadow_count,
-        (long)status->count_in_cpr,
-        (unsigned long)status->motor_error,
-        (unsigned long)status->encoder_error,
-        (unsigned long)status->controller_error,
-        (unsigned long)status->system_error,
-        motor_error_desc,
-        encoder_error_desc,
-        controller_error_desc,
-        system_error_desc,
-        status->data_valid ? "true" : "false",
-        (unsigned long)status->last_update_time
-    );
-    
+
+    // 先取代次再读字段：读取期间写入的新字段会多输出一次，不会遗漏
+    uint32_t generation = __atomic_load_n(&status->generation, __ATOMIC_ACQUIRE);
+    if (since_gen > generation) {
+        delta = false;
+    }
+    const uint32_t *changed = status->field_generation;
+
+    status_json_t json = {
+        .buffer = motor_status_json_buffer,
+        .size = sizeof(motor_status_json_buffer) - STATUS_JSON_TAIL_RESERVE,
+    };
+    status_json_printf(&json, "{\"axis\":%u,\"gen\":%lu,\"delta\":%s", (unsigned)axis, (unsigned long)generation,
+                       delta ? "true" : "false");
+    if (!delta) {
+        status_json_printf(&json, ",\"axis_count\":%u,\"uart\":%d,\"node_id\":%u",
+                           (unsigned)motor_registry_count(), (int)entry->controller->driver_config.uart_port,
+                           (unsigned)entry->controller->driver_config.node_id);
+    }
+    if (!delta || changed[MOTOR_STATUS_TARGET_TORQUE] > since_gen) {
+        status_json_printf(&json, ",\"target_torque\":%.3f", status->target_torque);
+    }
+    if (!delta || changed[MOTOR_STATUS_CURRENT_TORQUE] > since_gen) {
+        status_json_printf(&json, ",\"current_torque\":%.3f", status->current_torque);
+    }
+    if (!delta || changed[MOTOR_STATUS_ELECTRICAL_POWER] > since_gen) {
+        status_json_printf(&json, ",\"electrical_power\":%.2f", status->electrical_power);
+    }
+    if (!delta || changed[MOTOR_STATUS_MECHANICAL_POWER] > since_gen) {
+        status_json_printf(&json, ",\"mechanical_power\":%.2f", status->mechanical_power);
+    }
+    if (!delta || changed[MOTOR_STATUS_POSITION] > since_gen) {
+        status_json_printf(&json, ",\"position\":%.2f", status->position);
+    }
+    if (!delta || changed[MOTOR_STATUS_VELOCITY] > since_gen) {
+        status_json_printf(&json, ",\"velocity\":%.3f", status->velocity);
+    }
+    if (!delta || changed[MOTOR_STATUS_SHADOW_COUNT] > since_gen) {
+        status_json_printf(&json, ",\"shadow_count\":%ld", (long)status->shadow_count);
+    }
+    if (!delta || changed[MOTOR_STATUS_COUNT_IN_CPR] > since_gen) {
+        status_json_printf(&json, ",\"count_in_cpr\":%ld", (long)status->count_in_cpr);
+    }
+    if (!delta || changed[MOTOR_STATUS_DATA_VALID] > since_gen) {
+        status_json_printf(&json, ",\"data_valid\":%s", status->data_valid ? "true" : "false");
+    }
+    if (!delta || changed[MOTOR_STATUS_LAST_UPDATE_TIME] > since_gen) {
+        status_json_printf(&json, ",\"last_update_time\":%lu", (unsigned long)status->last_update_time);
+    }
+
+    // 派生信号随对应分组的响应更新
+    const motor_derived_t *derived = &entry->controller->derived;
+    if (!delta || status->group_generation[MOTOR_STATUS_GROUP_ENCODER] > since_gen) {
+        status_json_printf(&json, ",\"encoder_velocity\":%.1f,\"encoder_acceleration\":%.1f",
+                           derived->velocity, derived->acceleration);
+        int64_t absolute_count;
+        if (motor_derived_absolute_count(derived, &absolute_count)) {
+            status_json_printf(&json, ",\"absolute_count\":%lld,\"absolute_angle\":%.3f", (long long)absolute_count,
+                               motor_units_count_to_angle(axis, absolute_count));
+        }
+    }
+    if (!delta || status->group_generation[MOTOR_STATUS_GROUP_POWER] > since_gen) {
+        status_json_printf(&json, ",\"electrical_energy\":%.3f,\"mechanical_energy\":%.3f",
+                           derived->electrical_energy, derived->mechanical_energy);
+    }
+    if (!delta || status->group_generation[MOTOR_STATUS_GROUP_TORQUE] > since_gen) {
+        motor_derived_torque_stats_t torque;
+        motor_derived_get_torque_stats(derived, &torque);
+        status_json_printf(&json, ",\"torque_window\":%u,\"torque_min\":%.3f,\"torque_max\":%.3f,\"torque_rms\":%.3f",
+                           (unsigned)torque.samples, torque.min, torque.max, torque.rms);
+    }
+
+    // 分组新鲜度：updated_us只输出有新响应的分组，过期列表每次都按当前时间重新计算
+    int64_t now_us = esp_timer_get_time();
+    const char *sep = "";
+    status_json_printf(&json, ",\"now_us\":%lld", (long long)now_us);
+    // 上电握手状态每次都输出（量小，且前端据此决定是否允许运动命令）
+    status_json_printf(&json, ",\"ready\":%s,\"ready_us\":%lld", motor_control_is_ready(entry->controller) ? "true" : "false",
+                       (long long)(motor_control_is_ready(entry->controller) ? entry->controller->ready_us : 0));
+    for (int group = 0; group < MOTOR_STATUS_GROUPS; group++) {
+        if (!delta || status->group_generation[group] > since_gen) {
+            status_json_printf(&json, "%s\"%s\":%lld", *sep ? sep : ",\"updated_us\":{",
+                               MOTOR_STATUS_GROUP_NAMES[group], (long long)status->group_update_us[group]);
+            sep = ",";
+        }
+    }
+    status_json_printf(&json, "%s,\"stale\":[", *sep ? "}" : "");
+    sep = "";
+    for (int group = 0; group < MOTOR_STATUS_GROUPS; group++) {
+        if (motor_status_group_stale(status, group, now_us)) {
+            status_json_printf(&json, "%s\"%s\"", sep, MOTOR_STATUS_GROUP_NAMES[group]);
+            sep = ",";
+        }
+    }
+    status_json_printf(&json, "]");
+    if (json.overflow) {
+        strcpy(motor_status_json_buffer, "{\"error\":\"状态缓冲区不足\"}");
+        return motor_status_json_buffer;
+    }
+
+    // 异常列表放最后：放不下时（如驱动器上报全1异常码）去掉该类异常，仍返回其余状态
+    bool truncated = false;
+    for (size_t i = 0; i < sizeof(status_error_fields) / sizeof(status_error_fields[0]); i++) {
+        const status_error_field_t *error = &status_error_fields[i];
+        if ((!delta || changed[error->field] > since_gen) && !status_json_error(&json, status, error)) {
+            truncated = true;
+        }
+    }
+
+    json.size = sizeof(motor_status_json_buffer);
+    status_json_printf(&json, "%s}", truncated ? ",\"faults_truncated\":true" : "");
     return motor_status_json_buffer;
-}
\ No newline at end of file
+}
+
+const char* get_motor_status_json(uint8_t axis) {
+    return format_motor_status(axis, false, 0);
+}
+
+const char* get_motor_status_delta_json(uint8_t axis, uint32_t since_gen) {
+    return format_motor_status(axis, true, since_gen);
+}
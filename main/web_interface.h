@@ -9,8 +9,14 @@ extern "C" {
 const char* get_web_page_html(void);
 const char* get_debug_page_html(void);
 
-// 获取电机状态JSON数据
-const char* get_motor_status_json(void);
+#include <stdint.h>
+
+// 获取指定轴电机状态JSON数据（含axis与axis_count字段）
+const char* get_motor_status_json(uint8_t axis);
+
+// 获取指定轴自代次since_gen以来变化的状态字段（含axis/gen/delta字段；since_gen比设备新时返回完整状态）
+// 客户端保存响应中的gen作为下一次的since_gen，按字段合并到本地状态
+const char* get_motor_status_delta_json(uint8_t axis, uint32_t since_gen);
 
 #ifdef __cplusplus
 }
@@ -1,19 +1,26 @@
 #include "wifi_http_server.h"
 #include "web_interface.h"
 #include "motor_status_scheduler.h"
+#include "motor_drive_sim.h"
+#include "motor_units.h"
+#include "wire_trace.h"
+#include "flight_recorder.h"
+#include "motor_config.h"
+#include "motor_metrics.h"
+#include "can_monitor.h"
+#include "motor_task_plan.h"
 #include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
 #include "esp_mac.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lwip/err.h"
 #include "lwip/sys.h"
 
-// 外部函数声明
-extern float angle_to_position(float angle_degrees);
-extern float external_velocity_to_internal(float external_velocity);
-extern float external_torque_to_internal(float external_torque);
-
 /* WiFi配置 */
 #define EXAMPLE_ESP_WIFI_SSID      CONFIG_ESP_WIFI_SSID
 #define EXAMPLE_ESP_WIFI_PASS      CONFIG_ESP_WIFI_PASSWORD
@@ -26,13 +33,12 @@ extern float external_torque_to_internal(float external_torque);
 #define EXAMPLE_GTK_REKEY_INTERVAL 0
 #endif
 
-static const char *TAG = "WiFi_HTTP";
+#define HTTP_ENCODER_WAIT_MS       50      // 最短路径轴set_angle等待编码器响应的最长时间
 
-// 全局电机控制器指针
-static motor_controller_t* g_motor_controller = NULL;
+static const char *TAG = "WiFi_HTTP";
 
-// 全局状态查询调度器指针
-static motor_status_scheduler_t* g_status_scheduler = NULL;
+// 全局G代码控制器指针
+static gcode_controller_t* g_gcode_controller = NULL;
 
 // WiFi事件处理
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
@@ -101,6 +107,95 @@ void wifi_init_softap(void)
              EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS, EXAMPLE_ESP_WIFI_CHANNEL);
 }
 
+// 请求中axis参数的状态
+typedef enum {
+    REQUEST_AXIS_ABSENT = 0,            // 没有axis参数
+    REQUEST_AXIS_VALID,                 // 合法的已注册轴号
+    REQUEST_AXIS_INVALID                // 有axis参数但不是数字或超出已注册轴数
+} request_axis_t;
+
+/**
+ * @brief 解析请求中的axis参数（只接受完整的十进制数字，"abc"、"1x"、空值均为非法）
+ */
+static request_axis_t parse_request_axis(httpd_req_t *req, uint8_t *axis) {
+    char query[200];
+    char axis_str[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
+        return REQUEST_AXIS_ABSENT;
+    }
+    esp_err_t result = httpd_query_key_value(query, "axis", axis_str, sizeof(axis_str));
+    if (result == ESP_ERR_NOT_FOUND) {
+        return REQUEST_AXIS_ABSENT;
+    }
+    if (result != ESP_OK || axis_str[0] == '\0') {
+        return REQUEST_AXIS_INVALID;
+    }
+    char *end;
+    long value = strtol(axis_str, &end, 10);
+    if (*end != '\0' || value < 0 || value >= motor_registry_count()) {
+        return REQUEST_AXIS_INVALID;
+    }
+    *axis = (uint8_t)value;
+    return REQUEST_AXIS_VALID;
+}
+
+/**
+ * @brief 读取请求中的axis参数
+ * @return 请求带有合法的axis参数时返回true
+ */
+static bool get_request_axis(httpd_req_t *req, uint8_t *axis) {
+    return parse_request_axis(req, axis) == REQUEST_AXIS_VALID;
+}
+
+/**
+ * @brief axis参数存在但非法时以400拒绝请求，避免拼写错误作用到轴0
+ * @return 已拒绝返回true
+ */
+static bool reject_invalid_axis(httpd_req_t *req) {
+    uint8_t axis;
+    if (parse_request_axis(req, &axis) != REQUEST_AXIS_INVALID) {
+        return false;
+    }
+    httpd_resp_set_status(req, "400 Bad Request");
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_send(req, "invalid axis", HTTPD_RESP_USE_STRLEN);
+    return true;
+}
+
+/**
+ * @brief 获取请求选择的电机及其轴号（axis参数，缺省为轴0）
+ * 调用前须先经reject_invalid_axis排除非法axis参数
+ */
+static motor_controller_t* get_request_motor_axis(httpd_req_t *req, uint8_t *axis) {
+    *axis = 0;
+    if (parse_request_axis(req, axis) == REQUEST_AXIS_INVALID) {
+        return NULL;
+    }
+    motor_registry_entry_t* entry = motor_registry_get(*axis);
+    return entry ? entry->controller : NULL;
+}
+
+/**
+ * @brief 获取请求选择的电机（axis参数，缺省为轴0）
+ */
+static motor_controller_t* get_request_motor(httpd_req_t *req) {
+    uint8_t axis;
+    return get_request_motor_axis(req, &axis);
+}
+
+/**
+ * @brief 电机尚未完成上电握手时以503拒绝运动/使能请求
+ * @return 已拒绝返回true（电机未初始化时返回false，交由调用者按原逻辑处理）
+ */
+static bool reject_not_ready(httpd_req_t *req, motor_controller_t* motor_controller) {
+    if (!motor_controller || motor_control_is_ready(motor_controller)) {
+        return false;
+    }
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_send(req, "电机未就绪", HTTPD_RESP_USE_STRLEN);
+    return true;
+}
+
 // HTTP处理函数
 static esp_err_t web_page_handler(httpd_req_t *req) {
     httpd_resp_set_type(req, "text/html");
@@ -109,23 +204,53 @@ static esp_err_t web_page_handler(httpd_req_t *req) {
 }
 
 static esp_err_t motor_status_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, get_motor_status_json(), HTTPD_RESP_USE_STRLEN);
+    uint8_t axis = 0;
+    get_request_axis(req, &axis);
+
+    // since_gen=N时只返回代次N之后变化的字段
+    char query[64];
+    char gen_str[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since_gen", gen_str, sizeof(gen_str)) == ESP_OK) {
+        httpd_resp_send(req, get_motor_status_delta_json(axis, strtoul(gen_str, NULL, 10)), HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+    httpd_resp_send(req, get_motor_status_json(axis), HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
 }
 
 static esp_err_t set_angle_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    uint32_t ingest_us = (uint32_t)esp_timer_get_time();
+    uint8_t axis;
+    motor_controller_t* motor_controller = get_request_motor_axis(req, &axis);
+    if (reject_not_ready(req, motor_controller)) {
+        return ESP_OK;
+    }
     char query[200];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char angle_str[32];
         if (httpd_query_key_value(query, "value", angle_str, sizeof(angle_str)) == ESP_OK) {
             float angle = atof(angle_str);
-            // 使用角度映射函数进行转换
-            float position = angle_to_position(angle);
+            // 按该轴标定换算（单圈轴归一化到0-360度）；最短路径轴以编码器绝对位置为起点，编码器无响应时按单圈处理
+            float position = motor_units_angle_to_position(axis, angle);
+            int64_t count;
+            if (motor_controller && isfinite(angle) && motor_units_needs_current(axis, false) &&
+                motor_control_query_absolute_count(motor_controller, HTTP_ENCODER_WAIT_MS, &count)) {
+                double target = motor_units_resolve_target(axis, motor_units_count_to_angle(axis, count), angle, false);
+                position = motor_units_absolute_to_position(axis, target);
+            }
             
-            if (g_motor_controller) {
-                motor_control_set_position(g_motor_controller, position);
+            if (motor_controller && isfinite(angle)) {
+                motor_control_latency_begin(motor_controller, ingest_us);
+                motor_control_set_position(motor_controller, position);
                 char response[100];
                 snprintf(response, sizeof(response), "角度: %.1f° -> 位置值: %.3f", angle, position);
                 httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
@@ -138,15 +263,25 @@ static esp_err_t set_angle_handler(httpd_req_t *req) {
 }
 
 static esp_err_t set_position_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    uint32_t ingest_us = (uint32_t)esp_timer_get_time();
+    uint8_t axis;
+    motor_controller_t* motor_controller = get_request_motor_axis(req, &axis);
+    if (reject_not_ready(req, motor_controller)) {
+        return ESP_OK;
+    }
     char query[200];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char pos_str[32];
         if (httpd_query_key_value(query, "value", pos_str, sizeof(pos_str)) == ESP_OK) {
             float position = atof(pos_str);
             
-            if (g_motor_controller) {
-                motor_control_set_position(g_motor_controller, position);
-                float angle = position;
+            if (motor_controller && isfinite(position)) {
+                motor_control_latency_begin(motor_controller, ingest_us);
+                motor_control_set_position(motor_controller, position);
+                float angle = motor_units_position_to_angle(axis, position);
                 char response[100];
                 snprintf(response, sizeof(response), "角度: %.3f°", angle);
                 httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
@@ -159,8 +294,15 @@ static esp_err_t set_position_handler(httpd_req_t *req) {
 }
 
 static esp_err_t enable_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        motor_control_enable(g_motor_controller, true);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (reject_not_ready(req, motor_controller)) {
+        return ESP_OK;
+    }
+    if (motor_controller) {
+        motor_control_enable(motor_controller, true);
         httpd_resp_send(req, "成功", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机未初始化", HTTPD_RESP_USE_STRLEN);
@@ -169,8 +311,12 @@ static esp_err_t enable_handler(httpd_req_t *req) {
 }
 
 static esp_err_t disable_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        motor_control_enable(g_motor_controller, false);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        motor_control_enable(motor_controller, false);
         httpd_resp_send(req, "成功", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机未初始化", HTTPD_RESP_USE_STRLEN);
@@ -179,8 +325,12 @@ static esp_err_t disable_handler(httpd_req_t *req) {
 }
 
 static esp_err_t clear_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        motor_control_clear_errors(g_motor_controller);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        motor_control_clear_errors(motor_controller);
         httpd_resp_send(req, "成功", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机未初始化", HTTPD_RESP_USE_STRLEN);
@@ -189,8 +339,13 @@ static esp_err_t clear_handler(httpd_req_t *req) {
 }
 
 static esp_err_t restart_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        restart_motor(g_motor_controller->driver_config.uart_port);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        motor_control_setpoint_changed(motor_controller);
+        restart_motor(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id);
         httpd_resp_send(req, "成功", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机未初始化", HTTPD_RESP_USE_STRLEN);
@@ -199,19 +354,23 @@ static esp_err_t restart_handler(httpd_req_t *req) {
 }
 
 static esp_err_t set_mode_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
     char query[200];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char mode_str[32];
         if (httpd_query_key_value(query, "mode", mode_str, sizeof(mode_str)) == ESP_OK) {
-            if (g_motor_controller) {
+            if (motor_controller) {
                 if (strcmp(mode_str, "velocity") == 0) {
-                    motor_control_set_velocity_mode(g_motor_controller);
+                    motor_control_set_velocity_mode(motor_controller);
                     httpd_resp_send(req, "已切换到速度模式", HTTPD_RESP_USE_STRLEN);
                 } else if (strcmp(mode_str, "position") == 0) {
-                    motor_control_set_position_mode(g_motor_controller);
+                    motor_control_set_position_mode(motor_controller);
                     httpd_resp_send(req, "已切换到位置模式", HTTPD_RESP_USE_STRLEN);
                 } else if (strcmp(mode_str, "torque") == 0) {
-                    motor_control_set_torque_mode(g_motor_controller);
+                    motor_control_set_torque_mode(motor_controller);
                     httpd_resp_send(req, "已切换到力矩模式", HTTPD_RESP_USE_STRLEN);
                 } else {
                     httpd_resp_send(req, "未知模式", HTTPD_RESP_USE_STRLEN);
@@ -225,16 +384,26 @@ static esp_err_t set_mode_handler(httpd_req_t *req) {
 }
 
 static esp_err_t set_velocity_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    uint32_t ingest_us = (uint32_t)esp_timer_get_time();
+    uint8_t axis;
+    motor_controller_t* motor_controller = get_request_motor_axis(req, &axis);
+    if (reject_not_ready(req, motor_controller)) {
+        return ESP_OK;
+    }
     char query[200];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char vel_str[32];
         if (httpd_query_key_value(query, "value", vel_str, sizeof(vel_str)) == ESP_OK) {
             float external_velocity = atof(vel_str);
             // 转换为内部电机速度
-            float internal_velocity = external_velocity_to_internal(external_velocity);
+            float internal_velocity = motor_units_velocity_to_internal(axis, external_velocity);
             
-            if (g_motor_controller) {
-                motor_control_set_velocity(g_motor_controller, internal_velocity);
+            if (motor_controller && isfinite(external_velocity)) {
+                motor_control_latency_begin(motor_controller, ingest_us);
+                motor_control_set_velocity(motor_controller, internal_velocity);
                 char response[120];
                 snprintf(response, sizeof(response), "外部速度: %.2f r/s -> 内部速度: %.2f r/s", 
                         external_velocity, internal_velocity);
@@ -248,16 +417,26 @@ static esp_err_t set_velocity_handler(httpd_req_t *req) {
 }
 
 static esp_err_t set_torque_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    uint32_t ingest_us = (uint32_t)esp_timer_get_time();
+    uint8_t axis;
+    motor_controller_t* motor_controller = get_request_motor_axis(req, &axis);
+    if (reject_not_ready(req, motor_controller)) {
+        return ESP_OK;
+    }
     char query[200];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char torque_str[32];
         if (httpd_query_key_value(query, "value", torque_str, sizeof(torque_str)) == ESP_OK) {
             float external_torque = atof(torque_str);
             // 转换为内部电机力矩
-            float internal_torque = external_torque_to_internal(external_torque);
+            float internal_torque = motor_units_torque_to_internal(axis, external_torque);
             
-            if (g_motor_controller) {
-                motor_control_set_torque(g_motor_controller, internal_torque);
+            if (motor_controller && isfinite(external_torque)) {
+                motor_control_latency_begin(motor_controller, ingest_us);
+                motor_control_set_torque(motor_controller, internal_torque);
                 char response[120];
                 snprintf(response, sizeof(response), "外部力矩: %.3f Nm -> 内部力矩: %.3f Nm", 
                         external_torque, internal_torque);
@@ -279,8 +458,13 @@ static esp_err_t debug_page_handler(httpd_req_t *req) {
 
 // Debug功能处理器
 static esp_err_t debug_restart_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        restart_motor(g_motor_controller->driver_config.uart_port);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        motor_control_setpoint_changed(motor_controller);
+        restart_motor(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id);
         httpd_resp_send(req, "重启电机指令已发送", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机控制器未初始化", HTTPD_RESP_USE_STRLEN);
@@ -289,8 +473,12 @@ static esp_err_t debug_restart_handler(httpd_req_t *req) {
 }
 
 static esp_err_t debug_query_torque_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        query_motor_torque(g_motor_controller->driver_config.uart_port);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        query_motor_torque(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id);
         httpd_resp_send(req, "查询力矩指令已发送", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机控制器未初始化", HTTPD_RESP_USE_STRLEN);
@@ -299,8 +487,12 @@ static esp_err_t debug_query_torque_handler(httpd_req_t *req) {
 }
 
 static esp_err_t debug_query_power_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        query_motor_power(g_motor_controller->driver_config.uart_port);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        query_motor_power(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id);
         httpd_resp_send(req, "查询功率指令已发送", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机控制器未初始化", HTTPD_RESP_USE_STRLEN);
@@ -309,8 +501,12 @@ static esp_err_t debug_query_power_handler(httpd_req_t *req) {
 }
 
 static esp_err_t debug_query_encoder_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        query_encoder_count(g_motor_controller->driver_config.uart_port);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        query_encoder_count(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id);
         httpd_resp_send(req, "查询编码器指令已发送", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机控制器未初始化", HTTPD_RESP_USE_STRLEN);
@@ -319,8 +515,12 @@ static esp_err_t debug_query_encoder_handler(httpd_req_t *req) {
 }
 
 static esp_err_t debug_query_pos_speed_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
-        query_motor_position_speed(g_motor_controller->driver_config.uart_port);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
+        query_motor_position_speed(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id);
         httpd_resp_send(req, "查询位置转速指令已发送", HTTPD_RESP_USE_STRLEN);
     } else {
         httpd_resp_send(req, "电机控制器未初始化", HTTPD_RESP_USE_STRLEN);
@@ -329,7 +529,11 @@ static esp_err_t debug_query_pos_speed_handler(httpd_req_t *req) {
 }
 
 static esp_err_t debug_query_exception_handler(httpd_req_t *req) {
-    if (g_motor_controller) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    motor_controller_t* motor_controller = get_request_motor(req);
+    if (motor_controller) {
         char query[200];
         int exception_type = 0; // 默认值
         
@@ -340,7 +544,7 @@ static esp_err_t debug_query_exception_handler(httpd_req_t *req) {
             }
         }
         
-        query_motor_exceptions(g_motor_controller->driver_config.uart_port, exception_type);
+        query_motor_exceptions(motor_controller->driver_config.uart_port, motor_controller->driver_config.node_id, exception_type);
         char response[100];
         snprintf(response, sizeof(response), "查询异常指令已发送(类型: %d)", exception_type);
         httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
@@ -350,23 +554,47 @@ static esp_err_t debug_query_exception_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+/**
+ * @brief 获取请求涉及的调度器范围：带axis参数时为单轴，否则为全部轴
+ */
+static void get_request_axis_range(httpd_req_t *req, uint8_t *first, uint8_t *count) {
+    uint8_t axis;
+    if (get_request_axis(req, &axis)) {
+        *first = axis;
+        *count = 1;
+    } else {
+        *first = 0;
+        *count = motor_registry_count();
+    }
+}
+
 static esp_err_t api_set_query_frequency_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
     char query[200];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char freq_str[32];
         if (httpd_query_key_value(query, "freq", freq_str, sizeof(freq_str)) == ESP_OK) {
             float frequency = atof(freq_str);
+            uint8_t first, count;
+            get_request_axis_range(req, &first, &count);
             
-            if (g_status_scheduler) {
-                if (motor_status_scheduler_set_frequency(g_status_scheduler, frequency)) {
-                    char response[100];
-                    snprintf(response, sizeof(response), "查询频率已设置为: %.1f Hz", frequency);
-                    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
-                } else {
-                    httpd_resp_send(req, "频率设置失败", HTTPD_RESP_USE_STRLEN);
+            int updated = 0;
+            for (uint8_t i = first; i < first + count; i++) {
+                motor_registry_entry_t* entry = motor_registry_get(i);
+                if (entry && entry->scheduler &&
+                    motor_status_scheduler_set_frequency(entry->scheduler, frequency)) {
+                    updated++;
                 }
+            }
+            
+            if (updated > 0) {
+                char response[100];
+                snprintf(response, sizeof(response), "查询频率已设置为: %.1f Hz (%d个电机)", frequency, updated);
+                httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
             } else {
-                httpd_resp_send(req, "状态调度器未初始化", HTTPD_RESP_USE_STRLEN);
+                httpd_resp_send(req, "频率设置失败", HTTPD_RESP_USE_STRLEN);
             }
             return ESP_OK;
         }
@@ -375,113 +603,1126 @@ static esp_err_t api_set_query_frequency_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+/**
+ * @brief 运行时配置：?键=值（可多个）修改并立即生效，action=commit立即保存、action=reset恢复默认值；
+ * 返回全部字段的当前值、默认值、范围与是否需重启，pending为尚未写入NVS的字段数
+ */
+static esp_err_t api_config_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    char query[256];
+    char text[32];
+    const char* rejected = NULL;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "action", text, sizeof(text)) == ESP_OK &&
+            strcmp(text, "reset") == 0) {
+            motor_config_reset();
+        }
+        for (uint8_t i = 0; i < motor_config_field_count(); i++) {
+            const motor_config_field_t* field = motor_config_field(i);
+            if (httpd_query_key_value(query, field->key, text, sizeof(text)) == ESP_OK &&
+                !motor_config_set(field->key, text) && !rejected) {
+                rejected = field->key;
+            }
+        }
+        if (httpd_query_key_value(query, "action", text, sizeof(text)) == ESP_OK &&
+            strcmp(text, "commit") == 0) {
+            motor_config_commit();
+        }
+    }
+
+    char response[1024];
+    size_t used = snprintf(response, sizeof(response), "{\"version\":%d,\"pending\":%d,\"commits\":%lu,",
+                           MOTOR_CONFIG_VERSION, motor_config_pending(), (unsigned long)motor_config_commit_count());
+    if (rejected) {
+        used += snprintf(response + used, sizeof(response) - used, "\"rejected\":\"%s\",", rejected);
+    }
+    used += snprintf(response + used, sizeof(response) - used, "\"fields\":[");
+    for (uint8_t i = 0; i < motor_config_field_count() && used < sizeof(response); i++) {
+        const motor_config_field_t* field = motor_config_field(i);
+        char value[24];
+        char fallback[24];
+        motor_config_format(field, &g_motor_config, value, sizeof(value));
+        motor_config_format(field, motor_config_defaults(), fallback, sizeof(fallback));
+        used += snprintf(response + used, sizeof(response) - used,
+                         "%s{\"key\":\"%s\",\"value\":%s,\"default\":%s,\"min\":%g,\"max\":%g,\"restart\":%s}",
+                         i ? "," : "", field->key, value, fallback, field->min, field->max,
+                         field->restart_required ? "true" : "false");
+    }
+    if (used < sizeof(response)) {
+        snprintf(response + used, sizeof(response) - used, "]}");
+    }
+
+    if (rejected) {
+        httpd_resp_set_status(req, "400 Bad Request");
+    }
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+/**
+ * @brief 读取标定参数中的一个浮点数
+ * @return 参数不存在或可解析时返回true（存在时写入value），格式错误返回false
+ */
+static bool get_calibration_float(const char* query, const char* key, float* value) {
+    char text[24];
+    if (httpd_query_key_value(query, key, text, sizeof(text)) != ESP_OK) {
+        return true;
+    }
+    char* end = NULL;
+    float parsed = strtof(text, &end);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+// 圈数模式在/api/calibration中的名称（下标为motor_units_turn_mode_t）
+static const char* const calibration_turn_modes[MOTOR_UNITS_TURN_MODES] = { "single", "multi", "shortest" };
+
+/**
+ * @brief 各轴单位换算标定：?axis=N&ratio=&scale=&offset=&torque_factor=&direction=&turn_mode=修改一个轴并立即生效，
+ * action=reset恢复该轴默认标定，action=save把全部轴写入NVS；返回各轴标定与生效的换算系数
+ */
+static esp_err_t api_calibration_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    char query[256];
+    char text[16];
+    uint8_t axis;
+    bool rejected = false;
+    bool saved = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (get_request_axis(req, &axis)) {
+            motor_units_profile_t profile;
+            motor_units_get_profile(axis, &profile);
+            if (httpd_query_key_value(query, "action", text, sizeof(text)) == ESP_OK && strcmp(text, "reset") == 0) {
+                profile = *motor_units_default_profile();
+            }
+            rejected = !get_calibration_float(query, "ratio", &profile.ratio) ||
+                       !get_calibration_float(query, "scale", &profile.scale) ||
+                       !get_calibration_float(query, "offset", &profile.offset) ||
+                       !get_calibration_float(query, "torque_factor", &profile.torque_factor);
+            if (httpd_query_key_value(query, "direction", text, sizeof(text)) == ESP_OK) {
+                // 先按int解析再校验，避免direction=257截断成1后通过标定检查
+                char *end;
+                long direction = strtol(text, &end, 10);
+                if (end == text || *end != '\0' || (direction != 1 && direction != -1)) {
+                    rejected = true;
+                } else {
+                    profile.direction = (int8_t)direction;
+                }
+            }
+            if (httpd_query_key_value(query, "turn_mode", text, sizeof(text)) == ESP_OK) {
+                profile.turn_mode = MOTOR_UNITS_TURN_MODES;
+                for (uint8_t mode = 0; mode < MOTOR_UNITS_TURN_MODES; mode++) {
+                    if (strcmp(text, calibration_turn_modes[mode]) == 0) {
+                        profile.turn_mode = mode;
+                    }
+                }
+            }
+            rejected = rejected || !motor_units_set_profile(axis, &profile);
+        }
+        if (httpd_query_key_value(query, "action", text, sizeof(text)) == ESP_OK && strcmp(text, "save") == 0) {
+            saved = motor_units_save();
+        }
+    }
+
+    static char response[1536];     // HTTP服务器单任务处理请求，静态缓冲区不占任务栈
+    size_t used = snprintf(response, sizeof(response), "{\"version\":%d,\"saved\":%s,\"axes\":[",
+                           MOTOR_UNITS_VERSION, saved ? "true" : "false");
+    for (uint8_t i = 0; i < motor_registry_count() && used < sizeof(response); i++) {
+        motor_units_profile_t profile;
+        motor_units_get_profile(i, &profile);
+        const motor_units_axis_t* units = motor_units_axis(i);
+        used += snprintf(response + used, sizeof(response) - used,
+                         "%s{\"axis\":%d,\"ratio\":%g,\"scale\":%g,\"offset\":%g,\"torque_factor\":%g,"
+                         "\"direction\":%d,\"turn_mode\":\"%s\",\"position_per_degree\":%g,"
+                         "\"velocity_factor\":%g,\"torque_scale\":%g}",
+                         i ? "," : "", i, profile.ratio, profile.scale, profile.offset, profile.torque_factor,
+                         profile.direction, calibration_turn_modes[profile.turn_mode],
+                         units->position_per_degree, units->velocity_factor, units->torque_factor);
+    }
+    if (used < sizeof(response)) {
+        snprintf(response + used, sizeof(response) - used, "]}");
+    }
+
+    if (rejected) {
+        httpd_resp_set_status(req, "400 Bad Request");
+    }
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
 static esp_err_t api_start_query_handler(httpd_req_t *req) {
-    if (g_status_scheduler) {
-        if (motor_status_scheduler_start(g_status_scheduler)) {
-            float freq = motor_status_scheduler_get_frequency(g_status_scheduler);
-            char response[100];
-            snprintf(response, sizeof(response), "自动查询已启动，频率: %.1f Hz", freq);
-            httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
-        } else {
-            httpd_resp_send(req, "启动自动查询失败", HTTPD_RESP_USE_STRLEN);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    uint8_t first, count;
+    get_request_axis_range(req, &first, &count);
+    
+    int started = 0;
+    float freq = 0.0f;
+    for (uint8_t i = first; i < first + count; i++) {
+        motor_registry_entry_t* entry = motor_registry_get(i);
+        if (entry && entry->scheduler && motor_status_scheduler_start(entry->scheduler)) {
+            freq = motor_status_scheduler_get_frequency(entry->scheduler);
+            started++;
         }
+    }
+    
+    if (started > 0) {
+        char response[100];
+        snprintf(response, sizeof(response), "自动查询已启动，频率: %.1f Hz (%d个电机)", freq, started);
+        httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
     } else {
-        httpd_resp_send(req, "状态调度器未初始化", HTTPD_RESP_USE_STRLEN);
+        httpd_resp_send(req, "启动自动查询失败", HTTPD_RESP_USE_STRLEN);
     }
     return ESP_OK;
 }
 
 static esp_err_t api_stop_query_handler(httpd_req_t *req) {
-    if (g_status_scheduler) {
-        motor_status_scheduler_stop(g_status_scheduler);
-        httpd_resp_send(req, "自动查询已停止", HTTPD_RESP_USE_STRLEN);
-    } else {
-        httpd_resp_send(req, "状态调度器未初始化", HTTPD_RESP_USE_STRLEN);
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
     }
+    uint8_t first, count;
+    get_request_axis_range(req, &first, &count);
+    
+    for (uint8_t i = first; i < first + count; i++) {
+        motor_registry_entry_t* entry = motor_registry_get(i);
+        if (entry && entry->scheduler) {
+            motor_status_scheduler_stop(entry->scheduler);
+        }
+    }
+    httpd_resp_send(req, "自动查询已停止", HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
 }
 
-void set_status_scheduler(motor_status_scheduler_t* scheduler) {
-    g_status_scheduler = scheduler;
+static esp_err_t api_gcode_queue_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    gcode_queue_stats_t stats;
+    if (!gcode_get_queue_stats(g_gcode_controller, &stats)) {
+        httpd_resp_send(req, "{\"error\":\"运动队列未初始化\"}", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    char response[384];
+    snprintf(response, sizeof(response),
+        "{"
+        "\"depth\":%lu,"
+        "\"capacity\":%lu,"
+        "\"high_watermark\":%lu,"
+        "\"enqueued\":%lu,"
+        "\"executed\":%lu,"
+        "\"execute_errors\":%lu,"
+        "\"rejected\":%lu,"
+        "\"flushed\":%lu,"
+        "\"underruns\":%lu,"
+        "\"coordinated_moves\":%lu,"
+        "\"axis_skew_last_us\":%lu,"
+        "\"axis_skew_max_us\":%lu"
+        "}",
+        (unsigned long)stats.depth,
+        (unsigned long)stats.capacity,
+        (unsigned long)stats.high_watermark,
+        (unsigned long)stats.enqueued,
+        (unsigned long)stats.executed,
+        (unsigned long)stats.execute_errors,
+        (unsigned long)stats.rejected,
+        (unsigned long)stats.flushed,
+        (unsigned long)stats.underruns,
+        (unsigned long)stats.coordinated_moves,
+        (unsigned long)stats.axis_skew_last_us,
+        (unsigned long)stats.axis_skew_max_us
+    );
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
 }
 
-httpd_handle_t start_webserver(motor_controller_t* motor_controller) {
-    g_motor_controller = motor_controller;  // 保存电机控制器句柄
-    
+#if CONFIG_MOTOR_DRIVE_SIM
+/**
+ * @brief 驱动器模拟器：设置故障注入参数/注入异常码，并返回模拟器统计与所选轴的模型状态
+ *
+ * 参数（均可选）：latency_us, fragment, drop, corrupt, noise (‰), axis, error_type + error_code
+ */
+static esp_err_t api_sim_handler(httpd_req_t *req) {
+    if (reject_invalid_axis(req)) {
+        return ESP_OK;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    motor_controller_t* motor_controller = get_request_motor(req);
+    motor_drive_sim_faults_t faults;
+    motor_drive_sim_get_faults(&faults);
+
+    char query[200];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        bool faults_changed = false;
+        if (httpd_query_key_value(query, "latency_us", value, sizeof(value)) == ESP_OK) {
+            faults.latency_us = strtoul(value, NULL, 10);
+            faults_changed = true;
+        }
+        if (httpd_query_key_value(query, "fragment", value, sizeof(value)) == ESP_OK) {
+            faults.fragment_size = atoi(value);
+            faults_changed = true;
+        }
+        if (httpd_query_key_value(query, "drop", value, sizeof(value)) == ESP_OK) {
+            faults.drop_permille = atoi(value);
+            faults_changed = true;
+        }
+        if (httpd_query_key_value(query, "corrupt", value, sizeof(value)) == ESP_OK) {
+            faults.corrupt_permille = atoi(value);
+            faults_changed = true;
+        }
+        if (httpd_query_key_value(query, "noise", value, sizeof(value)) == ESP_OK) {
+            faults.noise_permille = atoi(value);
+            faults_changed = true;
+        }
+        if (faults_changed) {
+            motor_drive_sim_set_faults(&faults);
+            motor_drive_sim_get_faults(&faults);
+        }
+
+        char code_str[16];
+        if (motor_controller &&
+            httpd_query_key_value(query, "error_type", value, sizeof(value)) == ESP_OK &&
+            httpd_query_key_value(query, "error_code", code_str, sizeof(code_str)) == ESP_OK) {
+            motor_drive_sim_set_error(motor_controller->driver_config.uart_port,
+                                      motor_controller->driver_config.node_id,
+                                      atoi(value), strtoul(code_str, NULL, 0));
+        }
+    }
+
+    motor_drive_sim_stats_t stats;
+    motor_drive_sim_get_stats(&stats);
+    motor_drive_sim_node_t node = {0};
+    bool node_valid = motor_controller &&
+                      motor_drive_sim_get_node(motor_controller->driver_config.uart_port,
+                                               motor_controller->driver_config.node_id, &node);
+
+    char response[768];
+    snprintf(response, sizeof(response),
+        "{"
+        "\"latency_us\":%lu,"
+        "\"fragment\":%u,"
+        "\"drop\":%u,"
+        "\"corrupt\":%u,"
+        "\"noise\":%u,"
+        "\"frames_received\":%lu,"
+        "\"frames_ignored\":%lu,"
+        "\"responses_sent\":%lu,"
+        "\"responses_dropped\":%lu,"
+        "\"responses_corrupted\":%lu,"
+        "\"noise_bytes\":%lu,"
+        "\"rx_overflows\":%lu,"
+        "\"pending_high_watermark\":%lu,"
+        "\"node_valid\":%s,"
+        "\"enabled\":%s,"
+        "\"control_mode\":%u,"
+        "\"input_mode\":%u,"
+        "\"position\":%.4f,"
+        "\"velocity\":%.4f,"
+        "\"torque\":%.4f,"
+        "\"target\":%.4f,"
+        "\"motor_error\":%lu"
+        "}",
+        (unsigned long)faults.latency_us,
+        (unsigned)faults.fragment_size,
+        (unsigned)faults.drop_permille,
+        (unsigned)faults.corrupt_permille,
+        (unsigned)faults.noise_permille,
+        (unsigned long)stats.frames_received,
+        (unsigned long)stats.frames_ignored,
+        (unsigned long)stats.responses_sent,
+        (unsigned long)stats.responses_dropped,
+        (unsigned long)stats.responses_corrupted,
+        (unsigned long)stats.noise_bytes,
+        (unsigned long)stats.rx_overflows,
+        (unsigned long)stats.pending_high_watermark,
+        node_valid ? "true" : "false",
+        node.enabled ? "true" : "false",
+        (unsigned)node.control_mode,
+        (unsigned)node.input_mode,
+        node.position,
+        node.velocity,
+        node.torque,
+        node.target,
+        (unsigned long)node.errors[0]
+    );
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+#endif
+
+#if CONFIG_WIRE_TRACE
+/**
+ * @brief 线路抓包控制：action=start|stop|clear，返回抓包状态
+ */
+static esp_err_t api_trace_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    char query[64];
+    char action[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "action", action, sizeof(action)) == ESP_OK) {
+        if (strcmp(action, "start") == 0) {
+            wire_trace_set_enabled(true);
+        } else if (strcmp(action, "stop") == 0) {
+            wire_trace_set_enabled(false);
+        } else if (strcmp(action, "clear") == 0) {
+            wire_trace_clear();
+        }
+    }
+
+    wire_trace_stats_t stats;
+    wire_trace_get_stats(&stats);
+    char response[256];
+    snprintf(response, sizeof(response),
+        "{"
+        "\"enabled\":%s,"
+        "\"capacity\":%u,"
+        "\"used_bytes\":%u,"
+        "\"record_count\":%lu,"
+        "\"dropped_records\":%lu"
+        "}",
+        stats.enabled ? "true" : "false",
+        (unsigned)stats.capacity,
+        (unsigned)stats.used_bytes,
+        (unsigned long)stats.record_count,
+        (unsigned long)stats.dropped_records
+    );
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+/**
+ * @brief 下载抓包（二进制，格式见wire_trace.h），可直接送入linux目标程序回放
+ */
+static esp_err_t api_trace_download_handler(httpd_req_t *req) {
+    size_t length = 0;
+    uint8_t* capture = wire_trace_export(&length);
+    if (!capture) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "trace unavailable");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"wire_trace.bin\"");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    esp_err_t result = httpd_resp_send(req, (const char*)capture, length);
+    free(capture);
+    return result;
+}
+#endif
+
+#if CONFIG_FLIGHT_RECORDER
+/**
+ * @brief 飞行记录仪控制：action=flush|clear，返回记录仪状态
+ */
+static esp_err_t api_flightrec_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    char query[64];
+    char action[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "action", action, sizeof(action)) == ESP_OK) {
+        if (strcmp(action, "flush") == 0) {
+            flight_recorder_flush();
+        } else if (strcmp(action, "clear") == 0) {
+            flight_recorder_clear();
+        }
+    }
+
+    flight_recorder_stats_t stats;
+    flight_recorder_get_stats(&stats);
+    char response[384];
+    snprintf(response, sizeof(response),
+        "{"
+        "\"enabled\":%s,"
+        "\"sector_count\":%lu,"
+        "\"current_sector\":%lu,"
+        "\"sequence\":%lu,"
+        "\"boot_id\":%lu,"
+        "\"frozen_sectors\":%lu,"
+        "\"records\":%lu,"
+        "\"dropped_commands\":%lu,"
+        "\"bytes_written\":%lu,"
+        "\"sector_erases\":%lu,"
+        "\"freezes\":%lu,"
+        "\"skipped_freezes\":%lu"
+        "}",
+        stats.enabled ? "true" : "false",
+        (unsigned long)stats.sector_count,
+        (unsigned long)stats.current_sector,
+        (unsigned long)stats.sequence,
+        (unsigned long)stats.boot_id,
+        (unsigned long)stats.frozen_sectors,
+        (unsigned long)stats.records,
+        (unsigned long)stats.dropped_commands,
+        (unsigned long)stats.bytes_written,
+        (unsigned long)stats.sector_erases,
+        (unsigned long)stats.freezes,
+        (unsigned long)stats.skipped_freezes
+    );
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+/**
+ * @brief 下载记录分区转储（二进制，格式见flight_recorder.h），送入linux目标程序可转成CSV
+ * 按扇区分块读取发送，不需要整块分区大小的内存
+ */
+static esp_err_t api_flightrec_download_handler(httpd_req_t *req) {
+    size_t size = flight_recorder_partition_size();
+    uint8_t *sector = malloc(FLIGHT_RECORDER_SECTOR_SIZE);
+    if (size == 0 || !sector) {
+        free(sector);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "flight recorder unavailable");
+        return ESP_FAIL;
+    }
+
+    flight_recorder_flush();
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"flightrec.bin\"");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    esp_err_t result = ESP_OK;
+    for (size_t offset = 0; offset < size && result == ESP_OK; offset += FLIGHT_RECORDER_SECTOR_SIZE) {
+        if (!flight_recorder_read(offset, sector, FLIGHT_RECORDER_SECTOR_SIZE)) {
+            // 读失败的扇区按擦除态发送，解码时跳过
+            memset(sector, 0xFF, FLIGHT_RECORDER_SECTOR_SIZE);
+        }
+        result = httpd_resp_send_chunk(req, (const char*)sector, FLIGHT_RECORDER_SECTOR_SIZE);
+    }
+    free(sector);
+    if (result != ESP_OK) {
+        return result;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+#endif
+
+// /metrics输出分块缓冲区
+#define METRICS_CHUNK_SIZE 1024
+
+typedef struct {
+    httpd_req_t *req;
+    char buffer[METRICS_CHUNK_SIZE];
+    size_t used;
+    esp_err_t error;
+    uint32_t dropped_lines;             // 本次响应中无法输出的行数
+} metrics_writer_t;
+
+static uint32_t g_metrics_dropped_lines;    // 开机以来所有分块响应中无法输出的行数（/metrics导出）
+
+static void metrics_flush(metrics_writer_t *writer) {
+    if (writer->used > 0 && writer->error == ESP_OK) {
+        writer->error = httpd_resp_send_chunk(writer->req, writer->buffer, writer->used);
+    }
+    writer->used = 0;
+}
+
+static metrics_writer_t* metrics_writer_create(httpd_req_t *req) {
+    metrics_writer_t *writer = malloc(sizeof(metrics_writer_t));
+    if (writer) {
+        writer->req = req;
+        writer->used = 0;
+        writer->error = ESP_OK;
+        writer->dropped_lines = 0;
+    }
+    return writer;
+}
+
+/**
+ * @brief 发送剩余内容并结束分块响应，释放写入器
+ */
+static esp_err_t metrics_writer_finish(metrics_writer_t *writer) {
+    metrics_flush(writer);
+    if (writer->dropped_lines > 0) {
+        ESP_LOGW(TAG, "%s: %lu行输出超过分块缓冲区，已丢弃", writer->req->uri, (unsigned long)writer->dropped_lines);
+        MOTOR_METRICS_ADD(g_metrics_dropped_lines, writer->dropped_lines);
+    }
+    esp_err_t result = writer->error;
+    httpd_req_t *req = writer->req;
+    free(writer);
+    if (result != ESP_OK) {
+        return result;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/**
+ * @brief 追加一段文本，缓冲区放不下时先发送已有内容；超过整个缓冲区的文本计入丢弃行数
+ */
+static bool metrics_write(const char *text, size_t length, void *context) {
+    metrics_writer_t *writer = (metrics_writer_t *)context;
+    if (length > sizeof(writer->buffer) - writer->used) {
+        metrics_flush(writer);
+    }
+    if (length > sizeof(writer->buffer)) {
+        writer->dropped_lines++;
+        return false;
+    }
+    memcpy(writer->buffer + writer->used, text, length);
+    writer->used += length;
+    return true;
+}
+
+/**
+ * @brief 追加一行指标文本，缓冲区放不下时先发送已有内容
+ */
+static void metrics_printf(metrics_writer_t *writer, const char *fmt, ...) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(writer->buffer + writer->used, sizeof(writer->buffer) - writer->used, fmt, args);
+        va_end(args);
+        if (n >= 0 && (size_t)n < sizeof(writer->buffer) - writer->used) {
+            writer->used += n;
+            return;
+        }
+        metrics_flush(writer);
+    }
+    writer->dropped_lines++;
+}
+
+/**
+ * @brief 逐行输出直方图，行之间按需分块发送
+ */
+static void metrics_histogram(metrics_writer_t *writer, const char *name, const char *labels,
+                              const motor_metrics_histogram_t *histogram) {
+    uint32_t dropped = writer->dropped_lines;
+    if (!motor_metrics_format_histogram(metrics_write, writer, name, labels, histogram) &&
+        writer->dropped_lines == dropped) {
+        // 单行超过MOTOR_METRICS_LINE_MAX（标签过长），未经过写入回调
+        writer->dropped_lines++;
+    }
+}
+
+static void metrics_task_stack(metrics_writer_t *writer, TaskHandle_t task) {
+    if (task) {
+        metrics_printf(writer, "motor_task_stack_high_water_bytes{task=\"%s\"} %u\n",
+                       pcTaskGetName(task), (unsigned)uxTaskGetStackHighWaterMark(task));
+    }
+}
+
+/**
+ * @brief 轴所在UART的调度器；同一UART的节点共用调度器，只在该UART的第一个轴返回，避免重复样本
+ */
+static motor_status_scheduler_t* metrics_axis_scheduler(uint8_t axis) {
+    motor_status_scheduler_t *scheduler = motor_registry_get(axis)->scheduler;
+    for (uint8_t i = 0; i < axis; i++) {
+        if (motor_registry_get(i)->scheduler == scheduler) {
+            return NULL;
+        }
+    }
+    return scheduler;
+}
+
+static const char* const GCODE_RESULT_NAMES[MOTOR_METRICS_GCODE_RESULTS] = {
+    "ok", "error", "invalid_command", "invalid_parameter", "motor_error", "buffer_full", "checksum_error",
+    "not_ready"
+};
+
+static const char* const CAN_KIND_NAMES[MOTOR_METRICS_CAN_KINDS] = { "gcode", "isotp", "other" };
+
+/**
+ * @brief Prometheus文本格式的运行指标
+ * 计数器由各模块在热点路径上原子自增，这里只读取；按命令号的收发帧计数只输出非零项
+ */
+static esp_err_t metrics_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    metrics_writer_t *writer = metrics_writer_create(req);
+    if (!writer) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "out of memory");
+        return ESP_FAIL;
+    }
+
+    // 电机UART收发（按节点与命令号）
+    metrics_printf(writer, "# TYPE motor_uart_tx_frames_total counter\n");
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_controller_t *controller = motor_registry_get(i)->controller;
+        for (int cmd = 0; cmd < (1 << MOTOR_CMD_BITS); cmd++) {
+            uint32_t frames = MOTOR_METRICS_GET(controller->tx_frames[cmd]);
+            if (frames) {
+                metrics_printf(writer, "motor_uart_tx_frames_total{uart=\"%d\",node=\"%d\",cmd=\"0x%02X\"} %lu\n",
+                               controller->driver_config.uart_port, controller->driver_config.node_id, cmd,
+                               (unsigned long)frames);
+            }
+        }
+    }
+    metrics_printf(writer, "# TYPE motor_uart_rx_frames_total counter\n");
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_controller_t *controller = motor_registry_get(i)->controller;
+        for (int cmd = 0; cmd < (1 << MOTOR_CMD_BITS); cmd++) {
+            uint32_t frames = MOTOR_METRICS_GET(controller->rx_frames[cmd]);
+            if (frames) {
+                metrics_printf(writer, "motor_uart_rx_frames_total{uart=\"%d\",node=\"%d\",cmd=\"0x%02X\"} %lu\n",
+                               controller->driver_config.uart_port, controller->driver_config.node_id, cmd,
+                               (unsigned long)frames);
+            }
+        }
+    }
+    metrics_printf(writer, "# TYPE motor_uart_tx_unmatched_frames_total counter\n"
+                           "motor_uart_tx_unmatched_frames_total %lu\n"
+                           "# TYPE motor_uart_parse_errors_total counter\n"
+                           "motor_uart_parse_errors_total %lu\n",
+                   (unsigned long)MOTOR_METRICS_GET(g_motor_metrics.uart_tx_unmatched),
+                   (unsigned long)MOTOR_METRICS_GET(g_motor_metrics.uart_parse_errors));
+
+    uart_monitor_t *monitor = motor_registry_get_monitor();
+    if (monitor) {
+        metrics_printf(writer, "# TYPE motor_uart_frames_parsed_total counter\n"
+                               "# TYPE motor_uart_bytes_discarded_total counter\n"
+                               "# TYPE motor_uart_overflows_total counter\n");
+        for (uint8_t i = 0; i < monitor->port_count; i++) {
+            const uart_monitor_port_t *port = &monitor->ports[i];
+            metrics_printf(writer, "motor_uart_frames_parsed_total{uart=\"%d\"} %lu\n"
+                                   "motor_uart_bytes_discarded_total{uart=\"%d\"} %lu\n"
+                                   "motor_uart_overflows_total{uart=\"%d\"} %lu\n",
+                           port->uart_port, (unsigned long)port->frames_parsed,
+                           port->uart_port, (unsigned long)port->bytes_discarded,
+                           port->uart_port, (unsigned long)port->overflow_count);
+        }
+    }
+
+    // 上电握手：各驱动器与整个系统从上电到就绪的秒数，未就绪为0
+    metrics_printf(writer, "# TYPE motor_ready gauge\n"
+                           "# TYPE motor_boot_ready_seconds gauge\n");
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        const motor_controller_t *controller = motor_registry_get(i)->controller;
+        bool ready = motor_control_is_ready(controller);
+        metrics_printf(writer, "motor_ready{uart=\"%d\",node=\"%d\"} %d\n"
+                               "motor_boot_ready_seconds{uart=\"%d\",node=\"%d\"} %.3f\n",
+                       controller->driver_config.uart_port, controller->driver_config.node_id, ready,
+                       controller->driver_config.uart_port, controller->driver_config.node_id,
+                       ready ? (double)controller->ready_us / 1000000.0 : 0.0);
+    }
+    metrics_printf(writer, "# TYPE motor_system_ready_seconds gauge\nmotor_system_ready_seconds %.3f\n",
+                   (double)motor_registry_ready_us() / 1000000.0);
+
+    // 状态查询调度器：实际查询频率 = rate(motor_scheduler_queries_total)
+    metrics_printf(writer, "# TYPE motor_scheduler_target_hz gauge\n"
+                           "# TYPE motor_scheduler_queries_total counter\n"
+                           "# TYPE motor_scheduler_skipped_total counter\n"
+                           "# TYPE motor_scheduler_requeries_total counter\n");
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_status_scheduler_t *scheduler = metrics_axis_scheduler(i);
+        if (!scheduler) {
+            continue;
+        }
+        metrics_printf(writer, "motor_scheduler_target_hz{uart=\"%d\"} %.2f\n"
+                               "motor_scheduler_queries_total{uart=\"%d\"} %lu\n"
+                               "motor_scheduler_skipped_total{uart=\"%d\"} %lu\n"
+                               "motor_scheduler_requeries_total{uart=\"%d\"} %lu\n",
+                       scheduler->uart_port, scheduler->is_running ? scheduler->query_frequency : 0.0f,
+                       scheduler->uart_port, (unsigned long)MOTOR_METRICS_GET(scheduler->queries_sent),
+                       scheduler->uart_port, (unsigned long)MOTOR_METRICS_GET(scheduler->queries_skipped),
+                       scheduler->uart_port, (unsigned long)MOTOR_METRICS_GET(scheduler->queries_requeried));
+    }
+
+    // CAN接收与G代码结果
+    metrics_printf(writer, "# TYPE motor_can_rx_frames_total counter\n");
+    for (int kind = 0; kind < MOTOR_METRICS_CAN_KINDS; kind++) {
+        metrics_printf(writer, "motor_can_rx_frames_total{kind=\"%s\"} %lu\n", CAN_KIND_NAMES[kind],
+                       (unsigned long)MOTOR_METRICS_GET(g_motor_metrics.can_rx_frames[kind]));
+    }
+    metrics_printf(writer, "# TYPE gcode_results_total counter\n");
+    for (int result = 0; result < MOTOR_METRICS_GCODE_RESULTS; result++) {
+        metrics_printf(writer, "gcode_results_total{stage=\"submit\",result=\"%s\"} %lu\n"
+                               "gcode_results_total{stage=\"execute\",result=\"%s\"} %lu\n",
+                       GCODE_RESULT_NAMES[result],
+                       (unsigned long)MOTOR_METRICS_GET(g_motor_metrics.gcode_submit_results[result]),
+                       GCODE_RESULT_NAMES[result],
+                       (unsigned long)MOTOR_METRICS_GET(g_motor_metrics.gcode_execute_results[result]));
+    }
+
+    metrics_printf(writer, "# TYPE http_request_duration_microseconds histogram\n");
+    metrics_histogram(writer, "http_request_duration_microseconds", NULL, &g_motor_metrics.http_request_us);
+
+    metrics_printf(writer, "# TYPE motor_command_latency_microseconds histogram\n");
+    for (int stage = 0; stage < MOTOR_LATENCY_STAGES; stage++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", MOTOR_LATENCY_STAGE_NAMES[stage]);
+        metrics_histogram(writer, "motor_command_latency_microseconds", labels, &g_motor_metrics.latency_us[stage]);
+    }
+
+    metrics_printf(writer, "# TYPE motor_trajectory_tick_jitter_microseconds histogram\n");
+    metrics_histogram(writer, "motor_trajectory_tick_jitter_microseconds", NULL, &g_motor_metrics.stream_jitter_us);
+
+    // 堆与任务栈余量
+    metrics_printf(writer, "# TYPE heap_free_bytes gauge\nheap_free_bytes %lu\n"
+                           "# TYPE heap_min_free_bytes gauge\nheap_min_free_bytes %lu\n",
+                   (unsigned long)esp_get_free_heap_size(), (unsigned long)esp_get_minimum_free_heap_size());
+    metrics_printf(writer, "# TYPE motor_task_stack_high_water_bytes gauge\n");
+    metrics_task_stack(writer, xTaskGetCurrentTaskHandle());
+    metrics_task_stack(writer, monitor ? monitor->task_handle : NULL);
+    metrics_task_stack(writer, can_monitor_get_task_handle());
+    if (g_gcode_controller) {
+        metrics_task_stack(writer, g_gcode_controller->executor_task);
+        metrics_task_stack(writer, g_gcode_controller->trajectory ? g_gcode_controller->trajectory->stream_task : NULL);
+    }
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_status_scheduler_t *scheduler = metrics_axis_scheduler(i);
+        if (scheduler && scheduler->query_task_handle) {
+            metrics_printf(writer, "motor_task_stack_high_water_bytes{task=\"%s\",uart=\"%d\"} %u\n",
+                           pcTaskGetName(scheduler->query_task_handle), scheduler->uart_port,
+                           (unsigned)uxTaskGetStackHighWaterMark(scheduler->query_task_handle));
+        }
+    }
+
+    // 此前响应中放不下的行（本次响应丢弃的行在结束时计入，下次请求可见）
+    metrics_printf(writer, "# TYPE metrics_dropped_lines_total counter\nmetrics_dropped_lines_total %lu\n",
+                   (unsigned long)MOTOR_METRICS_GET(g_metrics_dropped_lines));
+
+    return metrics_writer_finish(writer);
+}
+
+/**
+ * @brief 输出一个分位数估计值（落在+Inf桶时为null）
+ */
+static void latency_print_percentile(metrics_writer_t *writer, const char *key,
+                                     const motor_metrics_histogram_t *histogram, float quantile) {
+    uint32_t value = motor_metrics_histogram_percentile(histogram, quantile);
+    if (value == UINT32_MAX) {
+        metrics_printf(writer, ",\"%s\":null", key);
+    } else {
+        metrics_printf(writer, ",\"%s\":%lu", key, (unsigned long)value);
+    }
+}
+
+/**
+ * @brief 命令->反馈延迟直方图（/set_position等HTTP命令与G1命令到首个位置速度响应）
+ * 分位数为所在桶上界；reset=1时返回当前数据后清零
+ */
+static esp_err_t api_latency_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    char query[32];
+    char reset_str[8];
+    bool reset = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                 httpd_query_key_value(query, "reset", reset_str, sizeof(reset_str)) == ESP_OK &&
+                 atoi(reset_str) != 0;
+
+    metrics_writer_t *writer = metrics_writer_create(req);
+    if (!writer) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "out of memory");
+        return ESP_FAIL;
+    }
+
+    const motor_metrics_histogram_t *first = &g_motor_metrics.latency_us[0];
+    metrics_printf(writer, "{\"bounds_us\":[");
+    for (uint8_t i = 0; i < first->bound_count; i++) {
+        metrics_printf(writer, "%s%lu", i ? "," : "", (unsigned long)first->bounds[i]);
+    }
+    metrics_printf(writer, "],\"stages\":[");
+    for (int stage = 0; stage < MOTOR_LATENCY_STAGES; stage++) {
+        motor_metrics_histogram_t *histogram = &g_motor_metrics.latency_us[stage];
+        metrics_printf(writer, "%s{\"stage\":\"%s\",\"count\":%lu,\"sum_us\":%lu",
+                       stage ? "," : "", MOTOR_LATENCY_STAGE_NAMES[stage],
+                       (unsigned long)MOTOR_METRICS_GET(histogram->count),
+                       (unsigned long)MOTOR_METRICS_GET(histogram->sum));
+        latency_print_percentile(writer, "p50_us", histogram, 0.50f);
+        latency_print_percentile(writer, "p90_us", histogram, 0.90f);
+        latency_print_percentile(writer, "p99_us", histogram, 0.99f);
+        metrics_printf(writer, ",\"buckets\":[");
+        for (uint8_t i = 0; i <= histogram->bound_count; i++) {
+            metrics_printf(writer, "%s%lu", i ? "," : "", (unsigned long)MOTOR_METRICS_GET(histogram->buckets[i]));
+        }
+        metrics_printf(writer, "]}");
+        if (reset) {
+            motor_metrics_histogram_reset(histogram);
+        }
+    }
+    metrics_printf(writer, "],\"reset\":%s}", reset ? "true" : "false");
+
+    return metrics_writer_finish(writer);
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+#define DEBUG_TASKS_MAX 32      // 运行时间差分快照保存的任务数上限
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#define DEBUG_RUNTIME_STATS "true"
+#else
+#define DEBUG_RUNTIME_STATS "false"     // 未打开时各任务运行时间为0，只有栈余量与队列占用有效
+#endif
+
+// 上一次请求时各任务的累计运行时间（按任务编号匹配），CPU占比按两次请求之间的差值计算
+typedef struct {
+    UBaseType_t task_number;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} debug_task_sample_t;
+
+static debug_task_sample_t s_task_samples[DEBUG_TASKS_MAX];
+static uint8_t s_task_sample_count = 0;
+static configRUN_TIME_COUNTER_TYPE s_total_runtime_prev = 0;
+
+static const char* task_state_name(eTaskState state) {
+    switch (state) {
+        case eRunning:   return "running";
+        case eReady:     return "ready";
+        case eBlocked:   return "blocked";
+        case eSuspended: return "suspended";
+        case eDeleted:   return "deleted";
+        default:         return "invalid";
+    }
+}
+
+static configRUN_TIME_COUNTER_TYPE task_previous_runtime(UBaseType_t task_number) {
+    for (uint8_t i = 0; i < s_task_sample_count; i++) {
+        if (s_task_samples[i].task_number == task_number) {
+            return s_task_samples[i].runtime;
+        }
+    }
+    return 0;
+}
+#endif
+
+static void debug_queue_json(metrics_writer_t *writer, bool *first, const char *name, int port, QueueHandle_t queue) {
+    if (!queue) {
+        return;
+    }
+    UBaseType_t waiting = uxQueueMessagesWaiting(queue);
+    metrics_printf(writer, "%s{\"name\":\"%s\",\"uart\":%d,\"waiting\":%u,\"capacity\":%u}",
+                   *first ? "" : ",", name, port, (unsigned)waiting,
+                   (unsigned)(waiting + uxQueueSpacesAvailable(queue)));
+    *first = false;
+}
+
+/**
+ * @brief 任务运行时剖析：各任务CPU占比（本次与上次请求之间 / 开机以来）、优先级、核心、栈余量，
+ * 以及状态查询队列、电机UART事件队列与TWAI接收队列的占用
+ * CPU占比以全部核心的总时间为100%；需要CONFIG_FREERTOS_USE_TRACE_FACILITY与GENERATE_RUN_TIME_STATS
+ */
+static esp_err_t debug_tasks_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    metrics_writer_t *writer = metrics_writer_create(req);
+    if (!writer) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "out of memory");
+        return ESP_FAIL;
+    }
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;   // 留余量应对采样期间新建的任务
+    TaskStatus_t *tasks = malloc(capacity * sizeof(TaskStatus_t));
+    configRUN_TIME_COUNTER_TYPE total_runtime = 0;
+    UBaseType_t task_count = tasks ? uxTaskGetSystemState(tasks, capacity, &total_runtime) : 0;
+    configRUN_TIME_COUNTER_TYPE window = total_runtime - s_total_runtime_prev;
+    float total_capacity = (float)total_runtime * configNUMBER_OF_CORES;
+    float window_capacity = (float)window * configNUMBER_OF_CORES;
+
+    metrics_printf(writer, "{\"runtime_stats\":%s,\"cores\":%d,\"window_us\":%lu,\"tasks\":[",
+                   DEBUG_RUNTIME_STATS, configNUMBER_OF_CORES,
+                   (unsigned long)window);
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        const TaskStatus_t *task = &tasks[i];
+        configRUN_TIME_COUNTER_TYPE delta = task->ulRunTimeCounter - task_previous_runtime(task->xTaskNumber);
+        BaseType_t core = xTaskGetCoreID(task->xHandle);
+        metrics_printf(writer, "%s{\"name\":\"%s\",\"state\":\"%s\",\"priority\":%u,\"core\":%d,"
+                               "\"cpu\":%.1f,\"cpu_total\":%.1f,\"stack_free\":%u}",
+                       i ? "," : "", task->pcTaskName, task_state_name(task->eCurrentState),
+                       (unsigned)task->uxCurrentPriority, core == tskNO_AFFINITY ? -1 : (int)core,
+                       window_capacity > 0 ? delta * 100.0f / window_capacity : 0.0f,
+                       total_capacity > 0 ? task->ulRunTimeCounter * 100.0f / total_capacity : 0.0f,
+                       (unsigned)task->usStackHighWaterMark);
+    }
+
+    s_task_sample_count = 0;
+    for (UBaseType_t i = 0; i < task_count && s_task_sample_count < DEBUG_TASKS_MAX; i++) {
+        s_task_samples[s_task_sample_count].task_number = tasks[i].xTaskNumber;
+        s_task_samples[s_task_sample_count].runtime = tasks[i].ulRunTimeCounter;
+        s_task_sample_count++;
+    }
+    s_total_runtime_prev = total_runtime;
+    free(tasks);
+#else
+    metrics_printf(writer, "{\"runtime_stats\":false,\"tasks\":[");
+#endif
+
+    metrics_printf(writer, "],\"queues\":[");
+    bool first = true;
+    for (uint8_t i = 0; i < motor_registry_count(); i++) {
+        motor_status_scheduler_t *scheduler = metrics_axis_scheduler(i);
+        if (scheduler) {
+            debug_queue_json(writer, &first, "motor_query", scheduler->uart_port, scheduler->query_queue);
+        }
+    }
+    uart_monitor_t *monitor = motor_registry_get_monitor();
+    for (uint8_t i = 0; monitor && i < monitor->port_count; i++) {
+        debug_queue_json(writer, &first, "uart_event", monitor->ports[i].uart_port, monitor->ports[i].event_queue);
+    }
+    if (g_gcode_controller) {
+        debug_queue_json(writer, &first, "gcode_motion", -1, g_gcode_controller->motion_queue);
+    }
+
+    twai_status_info_t twai_status;
+    if (can_monitor_get_task_handle() && twai_get_status_info(&twai_status) == ESP_OK) {
+        metrics_printf(writer, "%s{\"name\":\"twai_rx\",\"uart\":-1,\"waiting\":%lu,\"capacity\":%u,"
+                               "\"missed\":%lu,\"overrun\":%lu}",
+                       first ? "" : ",", (unsigned long)twai_status.msgs_to_rx, CAN_MONITOR_RX_QUEUE_LEN,
+                       (unsigned long)twai_status.rx_missed_count, (unsigned long)twai_status.rx_overrun_count);
+    }
+    metrics_printf(writer, "]}");
+
+    return metrics_writer_finish(writer);
+}
+
+/**
+ * @brief 统一入口：调用真实处理函数（存于user_ctx）并记录处理耗时
+ */
+static esp_err_t timed_uri_handler(httpd_req_t *req) {
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t result = ((esp_err_t (*)(httpd_req_t *))req->user_ctx)(req);
+    motor_metrics_observe(&g_motor_metrics.http_request_us, (uint32_t)(esp_timer_get_time() - start_us));
+    return result;
+}
+
+/**
+ * @brief 注册URI处理函数，经timed_uri_handler统计耗时
+ */
+static esp_err_t register_uri_handler(httpd_handle_t server, httpd_uri_t *uri) {
+    uri->user_ctx = (void *)uri->handler;
+    uri->handler = timed_uri_handler;
+    return httpd_register_uri_handler(server, uri);
+}
+
+void set_gcode_controller(gcode_controller_t* controller) {
+    g_gcode_controller = controller;
+}
+
+httpd_handle_t start_webserver(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
-    config.max_uri_handlers = 25;  // 增加最大URI处理程序数量以支持调试功能
+    config.max_uri_handlers = 36;  // 增加最大URI处理程序数量以支持调试功能
+    config.core_id = MOTOR_TASK_NETWORK_CORE;  // APP_CORE规划下与WiFi/lwIP同核，不占电机任务所在的应用核
     
     httpd_handle_t server = NULL;
     if (httpd_start(&server, &config) == ESP_OK) {
         // 注册处理程序
         httpd_uri_t root = { .uri = "/", .method = HTTP_GET, .handler = web_page_handler };
-        httpd_register_uri_handler(server, &root);
+        register_uri_handler(server, &root);
         
         httpd_uri_t motor_status = { .uri = "/api/motor_status", .method = HTTP_GET, .handler = motor_status_handler };
-        httpd_register_uri_handler(server, &motor_status);
+        register_uri_handler(server, &motor_status);
         
         httpd_uri_t set_angle = { .uri = "/set_angle", .method = HTTP_GET, .handler = set_angle_handler };
-        httpd_register_uri_handler(server, &set_angle);
+        register_uri_handler(server, &set_angle);
         
         httpd_uri_t set_position = { .uri = "/set_position", .method = HTTP_GET, .handler = set_position_handler };
-        httpd_register_uri_handler(server, &set_position);
+        register_uri_handler(server, &set_position);
         
         httpd_uri_t enable = { .uri = "/enable", .method = HTTP_GET, .handler = enable_handler };
-        httpd_register_uri_handler(server, &enable);
+        register_uri_handler(server, &enable);
         
         httpd_uri_t disable = { .uri = "/disable", .method = HTTP_GET, .handler = disable_handler };
-        httpd_register_uri_handler(server, &disable);
+        register_uri_handler(server, &disable);
         
         httpd_uri_t clear = { .uri = "/clear", .method = HTTP_GET, .handler = clear_handler };
-        httpd_register_uri_handler(server, &clear);
+        register_uri_handler(server, &clear);
         
         httpd_uri_t restart = { .uri = "/restart", .method = HTTP_GET, .handler = restart_handler };
-        httpd_register_uri_handler(server, &restart);
+        register_uri_handler(server, &restart);
         
         httpd_uri_t set_mode = { .uri = "/set_mode", .method = HTTP_GET, .handler = set_mode_handler };
-        httpd_register_uri_handler(server, &set_mode);
+        register_uri_handler(server, &set_mode);
         
         httpd_uri_t set_velocity = { .uri = "/set_velocity", .method = HTTP_GET, .handler = set_velocity_handler };
-        httpd_register_uri_handler(server, &set_velocity);
+        register_uri_handler(server, &set_velocity);
         
         httpd_uri_t set_torque = { .uri = "/set_torque", .method = HTTP_GET, .handler = set_torque_handler };
-        esp_err_t torque_reg_result = httpd_register_uri_handler(server, &set_torque);
+        esp_err_t torque_reg_result = register_uri_handler(server, &set_torque);
         ESP_LOGI(TAG, "注册 /set_torque 处理程序: %s", (torque_reg_result == ESP_OK) ? "成功" : "失败");
         
         // 注册调试页面处理程序
         httpd_uri_t debug_page = { .uri = "/debug", .method = HTTP_GET, .handler = debug_page_handler };
-        httpd_register_uri_handler(server, &debug_page);
+        register_uri_handler(server, &debug_page);
         
         httpd_uri_t debug_restart = { .uri = "/debug/restart", .method = HTTP_GET, .handler = debug_restart_handler };
-        httpd_register_uri_handler(server, &debug_restart);
+        register_uri_handler(server, &debug_restart);
         
         httpd_uri_t debug_query_torque = { .uri = "/debug/query_torque", .method = HTTP_GET, .handler = debug_query_torque_handler };
-        httpd_register_uri_handler(server, &debug_query_torque);
+        register_uri_handler(server, &debug_query_torque);
         
         httpd_uri_t debug_query_power = { .uri = "/debug/query_power", .method = HTTP_GET, .handler = debug_query_power_handler };
-        httpd_register_uri_handler(server, &debug_query_power);
+        register_uri_handler(server, &debug_query_power);
         
         httpd_uri_t debug_query_encoder = { .uri = "/debug/query_encoder", .method = HTTP_GET, .handler = debug_query_encoder_handler };
-        httpd_register_uri_handler(server, &debug_query_encoder);
+        register_uri_handler(server, &debug_query_encoder);
         
         httpd_uri_t debug_query_pos_speed = { .uri = "/debug/query_pos_speed", .method = HTTP_GET, .handler = debug_query_pos_speed_handler };
-        httpd_register_uri_handler(server, &debug_query_pos_speed);
+        register_uri_handler(server, &debug_query_pos_speed);
         
         httpd_uri_t debug_query_exception = { .uri = "/debug/query_exception", .method = HTTP_GET, .handler = debug_query_exception_handler };
-        httpd_register_uri_handler(server, &debug_query_exception);
+        register_uri_handler(server, &debug_query_exception);
+        
+        httpd_uri_t debug_tasks = { .uri = "/debug/tasks", .method = HTTP_GET, .handler = debug_tasks_handler };
+        register_uri_handler(server, &debug_tasks);
         
         // 注册状态查询控制API
         httpd_uri_t api_set_frequency = { .uri = "/api/set_query_frequency", .method = HTTP_GET, .handler = api_set_query_frequency_handler };
-        httpd_register_uri_handler(server, &api_set_frequency);
+        register_uri_handler(server, &api_set_frequency);
+
+        httpd_uri_t api_config = { .uri = "/api/config", .method = HTTP_GET, .handler = api_config_handler };
+        register_uri_handler(server, &api_config);
+
+        httpd_uri_t api_calibration = { .uri = "/api/calibration", .method = HTTP_GET, .handler = api_calibration_handler };
+        register_uri_handler(server, &api_calibration);
         
         httpd_uri_t api_start_query = { .uri = "/api/start_query", .method = HTTP_GET, .handler = api_start_query_handler };
-        httpd_register_uri_handler(server, &api_start_query);
+        register_uri_handler(server, &api_start_query);
         
         httpd_uri_t api_stop_query = { .uri = "/api/stop_query", .method = HTTP_GET, .handler = api_stop_query_handler };
-        esp_err_t stop_query_reg_result = httpd_register_uri_handler(server, &api_stop_query);
+        esp_err_t stop_query_reg_result = register_uri_handler(server, &api_stop_query);
         ESP_LOGI(TAG, "注册 /api/stop_query 处理程序: %s", (stop_query_reg_result == ESP_OK) ? "成功" : "失败");
         
+        httpd_uri_t api_gcode_queue = { .uri = "/api/gcode_queue", .method = HTTP_GET, .handler = api_gcode_queue_handler };
+        register_uri_handler(server, &api_gcode_queue);
+        
+#if CONFIG_MOTOR_DRIVE_SIM
+        httpd_uri_t api_sim = { .uri = "/api/sim", .method = HTTP_GET, .handler = api_sim_handler };
+        register_uri_handler(server, &api_sim);
+#endif
+
+#if CONFIG_WIRE_TRACE
+        httpd_uri_t api_trace = { .uri = "/api/trace", .method = HTTP_GET, .handler = api_trace_handler };
+        register_uri_handler(server, &api_trace);
+
+        httpd_uri_t api_trace_download = { .uri = "/api/trace/download", .method = HTTP_GET, .handler = api_trace_download_handler };
+        register_uri_handler(server, &api_trace_download);
+#endif
+
+#if CONFIG_FLIGHT_RECORDER
+        httpd_uri_t api_flightrec = { .uri = "/api/flightrec", .method = HTTP_GET, .handler = api_flightrec_handler };
+        register_uri_handler(server, &api_flightrec);
+
+        httpd_uri_t api_flightrec_download = { .uri = "/api/flightrec/download", .method = HTTP_GET, .handler = api_flightrec_download_handler };
+        register_uri_handler(server, &api_flightrec_download);
+#endif
+
+        httpd_uri_t metrics = { .uri = "/metrics", .method = HTTP_GET, .handler = metrics_handler };
+        register_uri_handler(server, &metrics);
+
+        httpd_uri_t api_latency = { .uri = "/api/latency", .method = HTTP_GET, .handler = api_latency_handler };
+        register_uri_handler(server, &api_latency);
+        
         ESP_LOGI(TAG, "Web服务器启动成功，端口: %d", config.server_port);
         ESP_LOGI(TAG, "剩余堆内存: %lu bytes", esp_get_free_heap_size());
     }
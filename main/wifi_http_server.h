@@ -3,7 +3,8 @@
 
 #include "esp_http_server.h"
 #include "motor_control.h"
-#include "motor_status_scheduler.h"
+#include "motor_registry.h"
+#include "gcode_unified_control.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,10 +17,11 @@ void wifi_init_softap(void);
 
 /**
  * @brief 启动Web服务器
- * @param motor_controller 电机控制器句柄
+ * 电机相关接口通过 axis 参数选择电机注册表中的轴（缺省轴0），
+ * 状态查询启停/频率接口不带 axis 时作用于全部电机
  * @return HTTP服务器句柄，失败返回NULL
  */
-httpd_handle_t start_webserver(motor_controller_t* motor_controller);
+httpd_handle_t start_webserver(void);
 
 /**
  * @brief 停止Web服务器
@@ -28,10 +30,10 @@ httpd_handle_t start_webserver(motor_controller_t* motor_controller);
 void stop_webserver(httpd_handle_t server);
 
 /**
- * @brief 设置状态查询调度器
- * @param scheduler 调度器句柄
+ * @brief 设置G代码控制器（用于运动队列状态查询）
+ * @param controller G代码控制器句柄
  */
-void set_status_scheduler(motor_status_scheduler_t* scheduler);
+void set_gcode_controller(gcode_controller_t* controller);
 
 #ifdef __cplusplus
 }